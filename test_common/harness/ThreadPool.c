@@ -18,6 +18,7 @@
 #include "fpcontrol.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if  defined( __APPLE__ ) || defined( __linux__ ) || defined( _WIN32 )  // or any other POSIX system
 
@@ -82,6 +83,33 @@ cl_int ThreadPool_AtomicAdd( volatile cl_int *a, cl_int b )
 #endif
 }
 
+// Atomic 64 bit compare and swap with mem barrier. Returns the old value.
+static cl_ulong ThreadPool_CompareAndSwap64( volatile cl_ulong *a, cl_ulong expected, cl_ulong desired )
+{
+#if defined (__MINGW32__)
+    // No atomics on Mingw32
+    EnterCriticalSection(&gAtomicLock);
+    cl_ulong old = *a;
+    if( old == expected )
+        *a = desired;
+    LeaveCriticalSection(&gAtomicLock);
+    return old;
+#elif defined( __GNUC__ )
+    return __sync_val_compare_and_swap( a, expected, desired );
+#elif defined( _MSC_VER )
+    return (cl_ulong) _InterlockedCompareExchange64( (volatile LONGLONG*) a, (LONGLONG) desired, (LONGLONG) expected );
+#else
+    if( pthread_mutex_lock(&gAtomicLock) )
+        log_error( "Atomic operation failed. pthread_mutex_lock(&gAtomicLock) returned an error\n");
+    cl_ulong old = *a;
+    if( old == expected )
+        *a = desired;
+    if( pthread_mutex_unlock(&gAtomicLock) )
+        log_error( "Failed to release gAtomicLock. Further atomic operations may deadlock!\n");
+    return old;
+#endif
+}
+
 #if defined( _WIN32 )
 // Uncomment the following line if Windows XP support is not required.
 // #define HAS_INIT_ONCE_EXECUTE_ONCE 1
@@ -208,205 +236,432 @@ pthread_once_t threadpool_init_control = PTHREAD_ONCE_INIT;
 #endif
 cl_int threadPoolInitErr = -1;          // set to CL_SUCCESS on successful thread launch
 
-// critical region lock around ThreadPool_Do.  We can only run one ThreadPool_Do at a time,
-// because we are too lazy to set up a queue here, and don't expect to need one.
+// critical region lock around top level ThreadPool_Do calls. Only one of them runs at a time,
+// mostly because the work stealing scheduler has a single set of job ranges.
 #if defined( _WIN32 )
 CRITICAL_SECTION    gThreadPoolLock[1];
 #else // !_WIN32
 pthread_mutex_t     gThreadPoolLock;
 #endif // !_WIN32
 
-// Condition variable to park ThreadPool threads when not working
+// Lock protecting the job set queue, and the condition variables that go with it
 #if defined( _WIN32 )
 CRITICAL_SECTION    cond_lock[1];
-_CONDITION_VARIABLE cond_var[1];
+_CONDITION_VARIABLE cond_var[1];                // signaled when a job set is queued, or the pool exits
+_CONDITION_VARIABLE done_var[1];                // signaled when a job set finishes, or a worker thread starts
 #else // !_WIN32
-pthread_mutex_t     cond_lock;
-pthread_cond_t      cond_var;
+pthread_mutex_t     cond_lock[1];
+pthread_cond_t      cond_var[1];                // signaled when a job set is queued, or the pool exits
+pthread_cond_t      done_var[1];                // signaled when a job set finishes, or a worker thread starts
 #endif // !_WIN32
-volatile cl_int     gRunCount = 0;              // Condition variable state. How many iterations on the function left to run.
-                                                // set to CL_INT_MAX to cause worker threads to exit. Note: this value might go negative.
-
-// State that only changes when the threadpool is not working.
-volatile TPFuncPtr  gFunc_ptr = NULL;
-volatile void       *gUserInfo = NULL;
-volatile cl_int     gJobCount = 0;
 
-// State that may change while the thread pool is working
-volatile cl_int     jobError = CL_SUCCESS;      // err code return for the job as a whole
-
-// Condition variable to park caller while waiting
-#if defined( _WIN32 )
-HANDLE              caller_event;
-#else // !_WIN32
-pthread_mutex_t     caller_cond_lock;
-pthread_cond_t      caller_cond_var;
-#endif // !_WIN32
-volatile cl_int     gRunning = 0;       // # of threads intended to be running. Running threads will decrement this as they discover they've run out of work to do.
+// A set of jobs run by the pool, from one ThreadPool_Do or ThreadPool_Submit call.
+// Threads claim job ids from next, so several workers (and the thread waiting for a nested
+// set) can work on the same set. The set is done once remaining and users both drop to 0.
+struct ThreadPoolJob
+{
+    TPFuncPtr               func_ptr;
+    void                    *userInfo;
+    cl_int                  count;          // number of jobs, or of tickets when work stealing
+    int                     stealing;       // non-zero if the jobs are tickets to work through gJobRanges
+    int                     nested;         // non-zero if a job of another set is waiting for this one
+    volatile cl_int         next;           // next job id to claim. May run past count.
+    volatile cl_int         remaining;      // jobs that have not finished yet
+    volatile cl_int         result;         // first non-zero result from func_ptr
+    cl_int                  users;          // threads claiming jobs from the set. Protected by cond_lock.
+    int                     queued;         // non-zero while the set is in the queue. Protected by cond_lock.
+    struct ThreadPoolJob    *link;          // next set in the queue. Protected by cond_lock.
+};
+
+// Queue of job sets that still have jobs to claim. Protected by cond_lock, but jobs may peek at
+// gQueueHead without the lock to see whether a nested set is waiting for help.
+struct ThreadPoolJob * volatile gQueueHead = NULL;
+struct ThreadPoolJob    *gQueueTail = NULL;
+volatile cl_int     gExiting = 0;               // set by ThreadPool_Exit to make the worker threads exit
+cl_int              gLaunched = 0;              // worker threads that have started. Protected by cond_lock.
 
 // The total number of threads launched.
 volatile cl_int     gThreadCount = 0;
-#ifdef _WIN32
-void ThreadPool_WorkerFunc( void *p )
+
+// thread_id of the pool worker running on this thread, or -1 if this is not a pool worker thread
+#if defined( _MSC_VER )
+__declspec( thread ) cl_int gWorkerThreadID = -1;
 #else
-void *ThreadPool_WorkerFunc( void *p )
+__thread cl_int     gWorkerThreadID = -1;
 #endif
-{
-    cl_uint threadID = ThreadPool_AtomicAdd( (volatile cl_int *) p, 1 );
-    cl_int item = ThreadPool_AtomicAdd( &gRunCount, -1 );
-//    log_info( "ThreadPool_WorkerFunc start: gRunning = %d\n", gRunning );
 
-    while( MAX_COUNT > item )
-    {
-        cl_int err;
-
-        // check for more work to do
-        if( 0 >= item )
-        {
-//            log_info( "Thread %d has run out of work.\n", threadID );
+// Scheduler selection. Only changes when the threadpool is not working.
+ThreadPoolScheduler gScheduler = kThreadPoolGlobalCounter;
+int                 gSchedulerSet = 0;          // non-zero once the scheduler was chosen by ThreadPool_SetScheduler or the environment
+
+// Work stealing state. Each worker thread owns a range of job ids [begin, end), packed into
+// a single 64 bit word so that the owner and thieves can update it with one compare and swap.
+// The owner claims chunks from the front, thieves take half of what is left from the back.
+#define RANGE_BEGIN( _r )           ((cl_uint) (_r))
+#define RANGE_END( _r )             ((cl_uint) ((_r) >> 32))
+#define MAKE_RANGE( _begin, _end )  ((cl_ulong) (_begin) | ((cl_ulong) (_end) << 32))
+typedef struct JobRange
+{
+    volatile cl_ulong   range;
+    char                pad[ 64 - sizeof( cl_ulong ) ];   // keep each range on its own cache line
+}JobRange;
+JobRange            *gJobRanges = NULL;         // one per worker thread
+volatile cl_uint    gStealChunk = 1;            // jobs claimed by the owner of a range at a time
 
-            // No work to do. Attempt to block waiting for work
+static void ThreadPool_LockQueue( void )
+{
 #if defined( _WIN32 )
-            EnterCriticalSection( cond_lock );
+    EnterCriticalSection( cond_lock );
 #else // !_WIN32
-            if((err = pthread_mutex_lock( &cond_lock) ))
-            {
-                log_error("Error %d from pthread_mutex_lock. Worker %d unable to block waiting for work. ThreadPool_WorkerFunc failed.\n", err, threadID );
-                goto exit;
-            }
+    int err = pthread_mutex_lock( cond_lock );
+    if( err )
+        log_error( "Error %d from pthread_mutex_lock. ThreadPool state may be corrupted.\n", err );
 #endif // !_WIN32
+}
 
-            cl_int remaining = ThreadPool_AtomicAdd( &gRunning, -1 );
-//            log_info( "ThreadPool_WorkerFunc: gRunning = %d\n", remaining - 1 );
-            if( 1 == remaining )
-            { // last thread out signal the main thread to wake up
+static void ThreadPool_UnlockQueue( void )
+{
 #if defined( _WIN32 )
-                SetEvent( caller_event );
+    LeaveCriticalSection( cond_lock );
 #else // !_WIN32
-                if((err = pthread_mutex_lock( &caller_cond_lock) ))
-                {
-                    log_error("Error %d from pthread_mutex_lock. Unable to wake caller.\n", err );
-                    goto exit;
-                }
-                if( (err = pthread_cond_broadcast( &caller_cond_var )))
-                {
-                    log_error("Error %d from pthread_cond_broadcast. Unable to wake up main thread. ThreadPool_WorkerFunc failed.\n", err );
-                    goto exit;
-                }
-                if((err = pthread_mutex_unlock( &caller_cond_lock) ))
-                {
-                    log_error("Error %d from pthread_mutex_lock. Unable to wake caller.\n", err );
-                    goto exit;
-                }
+    int err = pthread_mutex_unlock( cond_lock );
+    if( err )
+        log_error( "Error %d from pthread_mutex_unlock. Further ThreadPool calls may deadlock!\n", err );
 #endif // !_WIN32
-            }
+}
 
-            // loop in case we are woken only to discover that some other thread already did all the work
-            while( 0 >= item )
-            {
+// Block on one of the condition variables. cond_lock must be held.
 #if defined( _WIN32 )
-                _SleepConditionVariableCS( cond_var, cond_lock, INFINITE );
-#else // !_WIN32
-                if((err = pthread_cond_wait( &cond_var, &cond_lock) ))
-                {
-                    log_error("Error %d from pthread_cond_wait. Unable to block for waiting for work. ThreadPool_WorkerFunc failed.\n", err );
-                    pthread_mutex_unlock( &cond_lock);
-                    goto exit;
-                }
-#endif // !_WIN32
+static void ThreadPool_Sleep( _CONDITION_VARIABLE *cv )
+{
+    _SleepConditionVariableCS( cv, cond_lock, INFINITE );
+}
 
-                // try again to get a valid item id
-                item = ThreadPool_AtomicAdd( &gRunCount, -1 );
-                if( MAX_COUNT <= item )  // exit if we are done
-                {
-#if defined( _WIN32 )
-                    LeaveCriticalSection( cond_lock );
+static void ThreadPool_WakeAll( _CONDITION_VARIABLE *cv )
+{
+    _WakeAllConditionVariable( cv );
+}
 #else // !_WIN32
-                    pthread_mutex_unlock( &cond_lock);
+static void ThreadPool_Sleep( pthread_cond_t *cv )
+{
+    int err = pthread_cond_wait( cv, cond_lock );
+    if( err )
+        log_error( "Error %d from pthread_cond_wait. ThreadPool state may be corrupted.\n", err );
+}
+
+static void ThreadPool_WakeAll( pthread_cond_t *cv )
+{
+    int err = pthread_cond_broadcast( cv );
+    if( err )
+        log_error( "Error %d from pthread_cond_broadcast. ThreadPool threads may not wake up.\n", err );
+}
 #endif // !_WIN32
-                    goto exit;
-                }
-            }
 
-            ThreadPool_AtomicAdd( &gRunning, 1 );
-//            log_info( "Thread %d has found work.\n", threadID);
+// Record err as the result of set, if it is the first error there.
+static void ThreadPool_SetError( struct ThreadPoolJob *set, cl_int err )
+{
+#if defined (__MINGW32__)
+    EnterCriticalSection(&gAtomicLock);
+    if( set->result == CL_SUCCESS )
+        set->result = err;
+    LeaveCriticalSection(&gAtomicLock);
+#elif defined( __GNUC__ )
+    // GCC extension: http://gcc.gnu.org/onlinedocs/gcc/Atomic-Builtins.html#Atomic-Builtins
+    __sync_val_compare_and_swap( &set->result, CL_SUCCESS, err );
+#elif defined( _MSC_VER )
+    _InterlockedCompareExchange( (volatile LONG*) &set->result, err, CL_SUCCESS );
+#else
+    if( pthread_mutex_lock(&gAtomicLock) )
+        log_error( "Atomic operation failed. pthread_mutex_lock(&gAtomicLock) returned an error\n");
+    if( set->result == CL_SUCCESS )
+        set->result = err;
+    if( pthread_mutex_unlock(&gAtomicLock) )
+        log_error( "Failed to release gAtomicLock. Further atomic operations may deadlock\n");
+#endif
+}
+
+static void ThreadPool_InitSet( struct ThreadPoolJob *set, TPFuncPtr func_ptr, cl_uint count, void *userInfo )
+{
+    memset( set, 0, sizeof( *set ) );
+    set->func_ptr = func_ptr;
+    set->userInfo = userInfo;
+    set->count = set->remaining = (cl_int) count;
+    set->result = CL_SUCCESS;
+}
 
-#if defined( _WIN32 )
-            LeaveCriticalSection( cond_lock );
-#else // !_WIN32
-            if((err = pthread_mutex_unlock( &cond_lock) ))
+// Add set to the queue and wake up the workers. ThreadPool_Do sets go to the front, so that
+// threads which are idle, or who notice them between jobs, help there before going on with
+// submitted work. cond_lock must be held.
+static void ThreadPool_Enqueue( struct ThreadPoolJob *set, int front )
+{
+    set->queued = 1;
+    set->link = NULL;
+    if( NULL == gQueueHead )
+        gQueueHead = gQueueTail = set;
+    else if( front )
+    {
+        set->link = gQueueHead;
+        gQueueHead = set;
+    }
+    else
+    {
+        gQueueTail->link = set;
+        gQueueTail = set;
+    }
+
+    ThreadPool_WakeAll( cond_var );
+}
+
+// Remove set from the queue, if it is still there. cond_lock must be held.
+static void ThreadPool_Dequeue( struct ThreadPoolJob *set )
+{
+    struct ThreadPoolJob *prev = NULL, *cur = gQueueHead;
+
+    if( !set->queued )
+        return;
+
+    while( cur != set )
+    {
+        prev = cur;
+        cur = cur->link;
+    }
+    if( prev )
+        prev->link = set->link;
+    else
+        gQueueHead = set->link;
+    if( gQueueTail == set )
+        gQueueTail = prev;
+    set->queued = 0;
+}
+
+// Drop a reference taken on set by a thread claiming its jobs. cond_lock must be held.
+static void ThreadPool_ReleaseSet( struct ThreadPoolJob *set )
+{
+    // Once all the jobs are claimed, nobody else needs to find the set
+    if( set->next >= set->count )
+        ThreadPool_Dequeue( set );
+
+    if( 0 == --set->users && 0 == set->remaining )
+        ThreadPool_WakeAll( done_var );
+}
+
+// Block until all the jobs of set finished, and no other thread is looking at it. cond_lock must be held.
+static void ThreadPool_WaitForSet( struct ThreadPoolJob *set )
+{
+    while( set->remaining || set->users )
+        ThreadPool_Sleep( done_var );
+    ThreadPool_Dequeue( set );
+}
+
+// Claim the next job id of set. Returns 0 once all the jobs have been claimed.
+static int ThreadPool_ClaimJob( struct ThreadPoolJob *set, cl_uint *job )
+{
+    cl_int j;
+
+    // Don't let next run away from count while threads keep looking at an exhausted set
+    if( set->next >= set->count )
+        return 0;
+
+    j = ThreadPool_AtomicAdd( &set->next, 1 );
+    if( j >= set->count )
+        return 0;
+
+    *job = (cl_uint) j;
+    return 1;
+}
+
+static void ThreadPool_RunQueued( cl_uint threadID, struct ThreadPoolJob *current, int nestedOnly );
+
+// Claim up to gStealChunk jobs from the front of the range owned by threadID.
+// Returns the number of jobs claimed, starting at *first.
+static cl_uint ThreadPool_ClaimJobs( cl_uint threadID, cl_uint *first )
+{
+    volatile cl_ulong *range = &gJobRanges[ threadID ].range;
+    cl_ulong old = *range;
+
+    while( RANGE_BEGIN( old ) < RANGE_END( old ) )
+    {
+        cl_uint begin = RANGE_BEGIN( old );
+        cl_uint end = RANGE_END( old );
+        cl_uint n = end - begin < gStealChunk ? end - begin : gStealChunk;
+        cl_ulong seen = ThreadPool_CompareAndSwap64( range, old, MAKE_RANGE( begin + n, end ) );
+        if( seen == old )
+        {
+            *first = begin;
+            return n;
+        }
+        old = seen;
+    }
+
+    return 0;
+}
+
+// Move the back half of another thread's range into the empty range owned by threadID.
+// Returns 0 if there was nothing left to steal.
+static int ThreadPool_StealJobs( cl_uint threadID )
+{
+    cl_uint i;
+
+    for( i = 1; i < (cl_uint) gThreadCount; i++ )
+    {
+        volatile cl_ulong *range = &gJobRanges[ (threadID + i) % gThreadCount ].range;
+        cl_ulong old = *range;
+
+        while( RANGE_BEGIN( old ) < RANGE_END( old ) )
+        {
+            cl_uint begin = RANGE_BEGIN( old );
+            cl_uint end = RANGE_END( old );
+            cl_uint split = end - (end - begin + 1) / 2;    // take at least one job
+            cl_ulong seen = ThreadPool_CompareAndSwap64( range, old, MAKE_RANGE( begin, split ) );
+            if( seen == old )
             {
-                log_error("Error %d from pthread_mutex_unlock. Unable to block for waiting for work. ThreadPool_WorkerFunc failed.\n", err );
-                goto exit;
+                // Other thieves may be looking at our (empty) range, so this has to be atomic as well
+                volatile cl_ulong *mine = &gJobRanges[ threadID ].range;
+                cl_ulong current = *mine;
+                while( current != (seen = ThreadPool_CompareAndSwap64( mine, current, MAKE_RANGE( split, end ) )) )
+                    current = seen;
+                return 1;
             }
-#endif // !_WIN32
+            old = seen;
+        }
+    }
+
+    return 0;
+}
+
+// Work stealing version of the job loop. Runs jobs until there are none left in any range, or a job fails.
+static cl_int ThreadPool_RunJobRanges( struct ThreadPoolJob *set, cl_uint threadID )
+{
+    cl_uint first, n, i;
+    cl_int  err;
 
+    while( CL_SUCCESS == set->result )
+    {
+        n = ThreadPool_ClaimJobs( threadID, &first );
+        if( 0 == n )
+        {
+            if( ThreadPool_StealJobs( threadID ) )
+                continue;
+            break;
         }
 
-        // we have a valid item, so do the work
-        if( CL_SUCCESS == jobError )  // but only if we haven't already encountered an error
+        for( i = 0; i < n; i++ )
+            if( (err = set->func_ptr( first + i, threadID, set->userInfo )) )
+                return err;
+
+        // Help with nested ThreadPool_Do calls made by the jobs. Our range stays open to thieves meanwhile.
+        if( NULL != gQueueHead && set != gQueueHead )
         {
-//            log_info( "Thread %d doing job %d\n", threadID, item - 1);
+            ThreadPool_LockQueue();
+            ThreadPool_RunQueued( threadID, set, 1 );
+            ThreadPool_UnlockQueue();
+        }
+    }
+
+    return CL_SUCCESS;
+}
+
+// Run one job of set on thread threadID, unless an earlier job of the set failed.
+static void ThreadPool_RunJob( struct ThreadPoolJob *set, cl_uint job, cl_uint threadID )
+{
+    if( CL_SUCCESS == set->result )
+    {
+        cl_int err;
 
 #if defined(__APPLE__) && defined(__arm__)
-            // On most platforms which support denorm, default is FTZ off. However,
-            // on some hardware where the reference is computed, default might be flush denorms to zero e.g. arm.
-            // This creates issues in result verification. Since spec allows the implementation to either flush or
-            // not flush denorms to zero, an implementation may choose not be flush i.e. return denorm result whereas
-            // reference result may be zero (flushed denorm). Hence we need to disable denorm flushing on host side
-            // where reference is being computed to make sure we get non-flushed reference result. If implementation
-            // returns flushed result, we correctly take care of that in verification code.
-            FPU_mode_type oldMode;
-            DisableFTZ( &oldMode );
+        // On most platforms which support denorm, default is FTZ off. However,
+        // on some hardware where the reference is computed, default might be flush denorms to zero e.g. arm.
+        // This creates issues in result verification. Since spec allows the implementation to either flush or
+        // not flush denorms to zero, an implementation may choose not be flush i.e. return denorm result whereas
+        // reference result may be zero (flushed denorm). Hence we need to disable denorm flushing on host side
+        // where reference is being computed to make sure we get non-flushed reference result. If implementation
+        // returns flushed result, we correctly take care of that in verification code.
+        FPU_mode_type oldMode;
+        DisableFTZ( &oldMode );
 #endif
 
-            // Call the user's function with this item ID
-            err = gFunc_ptr( item - 1, threadID, (void*) gUserInfo );
+        // Call the user's function with this job ID. When work stealing, the job is just a
+        // ticket to go and work through the job ranges.
+        if( set->stealing )
+            err = ThreadPool_RunJobRanges( set, threadID );
+        else
+            err = set->func_ptr( job, threadID, set->userInfo );
+
 #if defined(__APPLE__) && defined(__arm__)
-            // Restore FP state
-            RestoreFPState( &oldMode );
+        // Restore FP state
+        RestoreFPState( &oldMode );
 #endif
 
-            if( err )
-            {
-#if (__MINGW32__)
-                EnterCriticalSection(&gAtomicLock);
-                if( jobError == CL_SUCCESS );
-                    jobError = err;
-                gRunCount = 0;
-                LeaveCriticalSection(&gAtomicLock);
-#elif defined( __GNUC__ )
-                // GCC extension: http://gcc.gnu.org/onlinedocs/gcc/Atomic-Builtins.html#Atomic-Builtins
-                // set the new error if we are the first one there.
-                __sync_val_compare_and_swap( &jobError, CL_SUCCESS, err );
+        if( err )
+            ThreadPool_SetError( set, err );
+    }
 
-                // drop run count to 0
-                gRunCount = 0;
-                __sync_synchronize();
-#elif defined( _MSC_VER )
-                // set the new error if we are the first one there.
-                _InterlockedCompareExchange( (volatile LONG*) &jobError, err, CL_SUCCESS );
+    // The last job out wakes up whoever waits for the set
+    if( 1 == ThreadPool_AtomicAdd( &set->remaining, -1 ) )
+    {
+        ThreadPool_LockQueue();
+        ThreadPool_WakeAll( done_var );
+        ThreadPool_UnlockQueue();
+    }
+}
+
+// Run jobs of set on thread threadID until they have all been claimed. The caller must hold a
+// reference on set. If yield is non-zero, stop early once another set is queued in front of it.
+static void ThreadPool_DrainSet( struct ThreadPoolJob *set, cl_uint threadID, int yield )
+{
+    cl_uint job;
+
+    while( ThreadPool_ClaimJob( set, &job ) )
+    {
+        ThreadPool_RunJob( set, job, threadID );
+        if( yield && gQueueHead != set )
+            break;
+    }
+}
+
+// Run jobs from the front of the queue on thread threadID, until the queue is empty or current is
+// at its front. If nestedOnly is set, only help with nested sets. cond_lock must be held; it is
+// dropped while the jobs run.
+static void ThreadPool_RunQueued( cl_uint threadID, struct ThreadPoolJob *current, int nestedOnly )
+{
+    while( NULL != gQueueHead && current != gQueueHead && (gQueueHead->nested || !nestedOnly) )
+    {
+        struct ThreadPoolJob *set = gQueueHead;
+
+        set->users++;
+        ThreadPool_UnlockQueue();
+        ThreadPool_DrainSet( set, threadID, 1 );
+        ThreadPool_LockQueue();
+        ThreadPool_ReleaseSet( set );
+    }
+}
 
-                // drop run count to 0
-                gRunCount = 0;
-                _mm_mfence();
+#ifdef _WIN32
+void ThreadPool_WorkerFunc( void *p )
 #else
-                if( pthread_mutex_lock(&gAtomicLock) )
-                    log_error( "Atomic operation failed. pthread_mutex_lock(&gAtomicLock) returned an error\n");
-                if( jobError == CL_SUCCESS );
-                    jobError = err;
-                gRunCount = 0;
-                if( pthread_mutex_unlock(&gAtomicLock) )
-                    log_error( "Failed to release gAtomicLock. Further atomic operations may deadlock\n");
+void *ThreadPool_WorkerFunc( void *p )
 #endif
-            }
-        }
+{
+    cl_uint threadID = ThreadPool_AtomicAdd( (volatile cl_int *) p, 1 );
+    gWorkerThreadID = threadID;
 
-        // get the next item
-        item = ThreadPool_AtomicAdd( &gRunCount, -1 );
+    ThreadPool_LockQueue();
+
+    // Let ThreadPool_Init know we are up
+    gLaunched++;
+    ThreadPool_WakeAll( done_var );
+
+    while( !gExiting )
+    {
+        ThreadPool_RunQueued( threadID, NULL, 0 );
+
+        // loop in case we are woken only to discover that some other thread already did all the work
+        if( !gExiting && NULL == gQueueHead )
+            ThreadPool_Sleep( cond_var );
     }
 
-exit:
+    ThreadPool_UnlockQueue();
+
     log_info( "ThreadPool: thread %d exiting.\n", threadID );
     ThreadPool_AtomicAdd( &gThreadCount, -1 );
 #if !defined(_WIN32)
@@ -437,6 +692,31 @@ void        SetThreadCount( int count )
     gThreadCount = count;
 }
 
+static void ThreadPool_InitScheduler( void )
+{
+    const char *env;
+
+    if( gSchedulerSet )
+        return;
+    gSchedulerSet = 1;
+
+    env = getenv( "CL_TEST_THREADPOOL_SCHEDULER" );
+    if( NULL != env && 0 == strcmp( env, "steal" ) )
+        gScheduler = kThreadPoolWorkStealing;
+}
+
+void ThreadPool_SetScheduler( ThreadPoolScheduler scheduler )
+{
+    gScheduler = scheduler;
+    gSchedulerSet = 1;
+}
+
+ThreadPoolScheduler ThreadPool_GetScheduler( void )
+{
+    ThreadPool_InitScheduler();
+    return gScheduler;
+}
+
 void ThreadPool_Init(void)
 {
     cl_int i;
@@ -531,18 +811,22 @@ void ThreadPool_Init(void)
         return;
     }
 
+    // If this fails, ThreadPool_Do falls back to the global counter
+    gJobRanges = (JobRange*) calloc( gThreadCount, sizeof( *gJobRanges ) );
+    if( NULL == gJobRanges )
+        log_error( "Error: Unable to allocate job ranges. Work stealing is disabled.\n" );
+
 #if defined( _WIN32 )
     InitializeCriticalSection( gThreadPoolLock );
     InitializeCriticalSection( cond_lock );
     _InitializeConditionVariable( cond_var );
-    caller_event = CreateEvent( NULL, FALSE, FALSE, NULL );
+    _InitializeConditionVariable( done_var );
 #elif defined (__GNUC__)
     // Dont rely on PTHREAD_MUTEX_INITIALIZER for intialization of a mutex since it might cause problem
     // with some flavors of gcc compilers.
-    pthread_cond_init(&cond_var, NULL);
-    pthread_mutex_init(&cond_lock ,NULL);
-    pthread_cond_init(&caller_cond_var, NULL);
-    pthread_mutex_init(&caller_cond_lock, NULL);
+    pthread_cond_init(cond_var, NULL);
+    pthread_cond_init(done_var, NULL);
+    pthread_mutex_init(cond_lock ,NULL);
     pthread_mutex_init(&gThreadPoolLock, NULL);
 #endif
 
@@ -551,18 +835,7 @@ void ThreadPool_Init(void)
 #elif defined (__MINGW32__)
     InitializeCriticalSection(&gAtomicLock);
 #endif
-    // Make sure the last thread done in the work pool doesn't signal us to wake before we get to the point where we are supposed to wait
-    //  That would cause a deadlock.
-#if !defined( _WIN32 )
-    if((err = pthread_mutex_lock( &caller_cond_lock) ))
-    {
-        log_error("Error %d from pthread_mutex_lock. Unable to block for work to finish. ThreadPool_Init failed.\n", err );
-        gThreadCount = 1;
-        return;
-    }
-#endif // !_WIN32
 
-    gRunning = gThreadCount;
     // init threads
     for( i = 0; i < gThreadCount; i++ )
     {
@@ -584,30 +857,14 @@ void ThreadPool_Init(void)
 
     atexit( ThreadPool_Exit );
 
-// block until they are done launching.
-    do
-    {
-#if defined( _WIN32 )
-        WaitForSingleObject( caller_event, INFINITE );
-#else // !_WIN32
-        if((err = pthread_cond_wait( &caller_cond_var, &caller_cond_lock) ))
-        {
-            log_error("Error %d from pthread_cond_wait. Unable to block for work to finish. ThreadPool_Init failed.\n", err );
-            pthread_mutex_unlock( &caller_cond_lock);
-            return;
-        }
-#endif // !_WIN32
-    }
-    while( gRunCount != -gThreadCount );
-#if !defined( _WIN32 )
-    if((err = pthread_mutex_unlock( &caller_cond_lock) ))
-    {
-        log_error("Error %d from pthread_mutex_unlock. Unable to block for work to finish. ThreadPool_Init failed.\n", err );
-        return;
-    }
-#endif // !_WIN32
+    // block until they are done launching.
+    ThreadPool_LockQueue();
+    while( gLaunched < gThreadCount )
+        ThreadPool_Sleep( done_var );
+    ThreadPool_UnlockQueue();
 
-    threadPoolInitErr = CL_SUCCESS;
+    if( gThreadCount > 0 )
+        threadPoolInitErr = CL_SUCCESS;
 }
 
 #if defined(_MSC_VER)
@@ -620,30 +877,21 @@ static BOOL CALLBACK _ThreadPool_Init(_PINIT_ONCE InitOnce, PVOID Parameter, PVO
 
 void ThreadPool_Exit(void)
 {
-    int err, count;
-    gRunCount = CL_INT_MAX;
+    int count;
 
-#if defined( __GNUC__ )
-    // GCC extension: http://gcc.gnu.org/onlinedocs/gcc/Atomic-Builtins.html#Atomic-Builtins
-    __sync_synchronize();
-#elif defined( _MSC_VER )
-    _mm_mfence();
-#else
-    #warning   If this is a weakly ordered memory system, please add a memory barrier here to force this and everything else to memory before we proceed
-#endif
+    ThreadPool_LockQueue();
+    gExiting = 1;
+    ThreadPool_UnlockQueue();
 
     // spin waiting for threads to die
     for (count = 0; 0 != gThreadCount && count < 1000; count++)
     {
+        ThreadPool_LockQueue();
+        ThreadPool_WakeAll( cond_var );
+        ThreadPool_UnlockQueue();
 #if defined( _WIN32 )
-        _WakeAllConditionVariable( cond_var );
         Sleep(1);
 #else // !_WIN32
-        if( (err = pthread_cond_broadcast( &cond_var )))
-        {
-            log_error("Error %d from pthread_cond_broadcast. Unable to wake up work threads. ThreadPool_Exit failed.\n", err );
-            break;
-        }
         usleep(1000);
 #endif // !_WIN32
     }
@@ -654,22 +902,10 @@ void ThreadPool_Exit(void)
         log_info( "Thread pool exited in a orderly fashion.\n" );
 }
 
-
-// Blocking API that farms out count jobs to a thread pool.
-// It may return with some work undone if func_ptr() returns a non-zero
-// result.
-//
-// This function obviously has its shortcommings. Only one call to ThreadPool_Do
-// can be running at a time. It is not intended for general purpose use.
-// If clEnqueueNativeKernelFn, out of order queues and a CL_DEVICE_TYPE_CPU were
-// all available then it would make more sense to use those features.
-cl_int ThreadPool_Do( TPFuncPtr func_ptr,
-                      cl_uint count,
-                      void *userInfo )
+// Lazily set up our threads. Returns non-zero if that failed.
+static int ThreadPool_Start( void )
 {
-    cl_int newErr;
-    cl_int err = 0;
-    // Lazily set up our threads
+    int err = 0;
 #if defined(_MSC_VER) && (_WIN32_WINNT >= 0x600)
     err = !_InitOnceExecuteOnce( &threadpool_init_control, _ThreadPool_Init, NULL, NULL );
 #elif defined (_WIN32)
@@ -681,11 +917,32 @@ cl_int ThreadPool_Do( TPFuncPtr func_ptr,
 #else //posix platform
     err = pthread_once( &threadpool_init_control, ThreadPool_Init );
     if( err )
-    {
-        log_error("Error %d from pthread_once. Unable to init threads. ThreadPool_Do failed.\n", err );
-        return err;
-    }
+        log_error("Error %d from pthread_once. Unable to init threads.\n", err );
 #endif
+    return err;
+}
+
+// Blocking API that farms out count jobs to a thread pool.
+// It may return with some work undone if func_ptr() returns a non-zero
+// result.
+//
+// Top level calls are serialized: only one of them runs on the pool at a time.
+// A call made from inside a job is queued in front of the others, and the
+// calling worker thread works on it too, so nesting neither deadlocks nor
+// runs serially. If clEnqueueNativeKernelFn, out of order queues and a
+// CL_DEVICE_TYPE_CPU were all available then it would make more sense to
+// use those features.
+cl_int ThreadPool_Do( TPFuncPtr func_ptr,
+                      cl_uint count,
+                      void *userInfo )
+{
+    struct ThreadPoolJob set;
+    cl_int newErr;
+    cl_int err = 0;
+
+    if( (err = ThreadPool_Start()) )
+        return err;
+
     // Single threaded code to handle case where threadpool wasn't allocated or was disabled by environment variable
     if( threadPoolInitErr )
     {
@@ -693,13 +950,7 @@ cl_int ThreadPool_Do( TPFuncPtr func_ptr,
         cl_int  result = CL_SUCCESS;
 
 #if defined(__APPLE__) && defined(__arm__)
-        // On most platforms which support denorm, default is FTZ off. However,
-        // on some hardware where the reference is computed, default might be flush denorms to zero e.g. arm.
-        // This creates issues in result verification. Since spec allows the implementation to either flush or
-        // not flush denorms to zero, an implementation may choose not be flush i.e. return denorm result whereas
-        // reference result may be zero (flushed denorm). Hence we need to disable denorm flushing on host side
-        // where reference is being computed to make sure we get non-flushed reference result. If implementation
-        // returns flushed result, we correctly take care of that in verification code.
+        // See ThreadPool_RunJob
         FPU_mode_type oldMode;
         DisableFTZ( &oldMode );
 #endif
@@ -727,6 +978,32 @@ cl_int ThreadPool_Do( TPFuncPtr func_ptr,
         return -1;
     }
 
+    if( 0 == count )
+        return CL_SUCCESS;
+
+    ThreadPool_InitSet( &set, func_ptr, count, userInfo );
+
+    // A nested call from one of our jobs. The other workers may be busy with the outer call, so
+    // put the set in front of the queue for whoever frees up first, and work on it ourselves.
+    // We only ever wait for jobs that are already running, so this can't deadlock.
+    if( gWorkerThreadID >= 0 )
+    {
+        set.nested = 1;
+        ThreadPool_LockQueue();
+        ThreadPool_Enqueue( &set, 1 );
+        set.users++;
+        ThreadPool_UnlockQueue();
+
+        ThreadPool_DrainSet( &set, gWorkerThreadID, 0 );
+
+        ThreadPool_LockQueue();
+        ThreadPool_ReleaseSet( &set );
+        ThreadPool_WaitForSet( &set );
+        ThreadPool_UnlockQueue();
+
+        return set.result;
+    }
+
     // Enter critical region
 #if defined( _WIN32 )
     EnterCriticalSection( gThreadPoolLock );
@@ -748,76 +1025,31 @@ cl_int ThreadPool_Do( TPFuncPtr func_ptr,
     }
 #endif // !_WIN32
 
-    // Start modifying the job state observable by worker threads
-#if defined( _WIN32 )
-    EnterCriticalSection( cond_lock );
-#else // !_WIN32
-    if((err = pthread_mutex_lock( &cond_lock) ))
+    ThreadPool_InitScheduler();
+    if( kThreadPoolWorkStealing == gScheduler && NULL != gJobRanges )
     {
-        log_error("Error %d from pthread_mutex_lock. Unable to wake up work threads. ThreadPool_Do failed.\n", err );
-        goto exit;
+        // Split the jobs evenly between the threads, and give each thread one ticket to run them
+        cl_int i;
+        for( i = 0; i < gThreadCount; i++ )
+            gJobRanges[i].range = MAKE_RANGE( (cl_ulong) count * i / gThreadCount, (cl_ulong) count * (i + 1) / gThreadCount );
+        gStealChunk = count / (gThreadCount * 16);
+        if( gStealChunk < 1 )
+            gStealChunk = 1;
+        else if( gStealChunk > 64 )
+            gStealChunk = 64;
+        set.stealing = 1;
+        set.count = set.remaining = gThreadCount;
     }
-#endif // !_WIN32
 
-    // Make sure the last thread done in the work pool doesn't signal us to wake before we get to the point where we are supposed to wait
-    //  That would cause a deadlock.
-#if !defined( _WIN32 )
-    if((err = pthread_mutex_lock( &caller_cond_lock) ))
-    {
-        log_error("Error %d from pthread_mutex_lock. Unable to block for work to finish. ThreadPool_Do failed.\n", err );
-        goto exit;
-    }
-#endif // !_WIN32
+    // Queue the set ahead of any submitted work and block until it is done. The caller does no jobs
+    // itself, so that every job runs with a worker's thread_id.
+    ThreadPool_LockQueue();
+    ThreadPool_Enqueue( &set, 1 );
+    ThreadPool_WaitForSet( &set );
+    ThreadPool_UnlockQueue();
 
-    // Prime the worker threads to get going
-    jobError = CL_SUCCESS;
-    gRunCount = gJobCount = count;
-    gFunc_ptr = func_ptr;
-    gUserInfo = userInfo;
+    err = set.result;
 
-#if defined( _WIN32 )
-    ResetEvent(caller_event);
-    _WakeAllConditionVariable( cond_var );
-    LeaveCriticalSection( cond_lock );
-#else // !_WIN32
-    if( (err = pthread_cond_broadcast( &cond_var )))
-    {
-        log_error("Error %d from pthread_cond_broadcast. Unable to wake up work threads. ThreadPool_Do failed.\n", err );
-        goto exit;
-    }
-    if((err = pthread_mutex_unlock( &cond_lock) ))
-    {
-        log_error("Error %d from pthread_mutex_unlock. Unable to wake up work threads. ThreadPool_Do failed.\n", err );
-        goto exit;
-    }
-#endif // !_WIN32
-
-// block until they are done.  It would be slightly more efficient to do some of the work here though.
-    do
-    {
-#if defined( _WIN32 )
-        WaitForSingleObject( caller_event, INFINITE );
-#else // !_WIN32
-        if((err = pthread_cond_wait( &caller_cond_var, &caller_cond_lock) ))
-        {
-            log_error("Error %d from pthread_cond_wait. Unable to block for work to finish. ThreadPool_Do failed.\n", err );
-            pthread_mutex_unlock( &caller_cond_lock);
-            goto exit;
-        }
-#endif // !_WIN32
-    }
-    while( gRunning );
-#if !defined(_WIN32)
-    if((err = pthread_mutex_unlock( &caller_cond_lock) ))
-    {
-        log_error("Error %d from pthread_mutex_unlock. Unable to block for work to finish. ThreadPool_Do failed.\n", err );
-        goto exit;
-    }
-#endif // !_WIN32
-
-    err = jobError;
-
-exit:
     // exit critical region
 #if defined( _WIN32 )
     LeaveCriticalSection( gThreadPoolLock );
@@ -833,25 +1065,68 @@ exit:
     return err;
 }
 
-cl_uint GetThreadCount( void )
+ThreadPoolJobHandle ThreadPool_Submit( TPFuncPtr func_ptr,
+                                       cl_uint count,
+                                       void *userInfo )
 {
-    // Lazily set up our threads
-#if defined(_MSC_VER) && (_WIN32_WINNT >= 0x600)
-    cl_int err = !_InitOnceExecuteOnce( &threadpool_init_control, _ThreadPool_Init, NULL, NULL );
-#elif defined (_WIN32)
-    if (threadpool_init_control == 0) {
-    #warning  This is buggy and race prone.  Find a better way.
-        ThreadPool_Init();
-        threadpool_init_control = 1;
+    struct ThreadPoolJob *job = (struct ThreadPoolJob*) calloc( 1, sizeof( *job ) );
+
+    if( NULL == job )
+    {
+        log_error( "Error: Unable to allocate a ThreadPool job handle.\n" );
+        return NULL;
     }
-#else
-    cl_int err = pthread_once( &threadpool_init_control, ThreadPool_Init );
-    if( err )
+
+    // Without worker threads, just do the work now. ThreadPool_Wait() then has nothing to wait for.
+    if( ThreadPool_Start() || threadPoolInitErr || 0 == count || count >= MAX_COUNT )
     {
-        log_error("Error %d from pthread_once. Unable to init threads. ThreadPool_Do failed.\n", err );
-        return err;
+        job->result = ThreadPool_Do( func_ptr, count, userInfo );
+        return job;
     }
-#endif // !_WIN32
+
+    ThreadPool_InitSet( job, func_ptr, count, userInfo );
+
+    ThreadPool_LockQueue();
+    ThreadPool_Enqueue( job, 0 );
+    ThreadPool_UnlockQueue();
+
+    return job;
+}
+
+cl_int ThreadPool_Wait( ThreadPoolJobHandle job )
+{
+    cl_int result;
+
+    if( NULL == job )
+        return CL_OUT_OF_HOST_MEMORY;
+
+    if( CL_SUCCESS == threadPoolInitErr )
+    {
+        ThreadPool_LockQueue();
+
+        // A worker thread helps with the jobs rather than blocking a pool thread for them
+        if( gWorkerThreadID >= 0 )
+        {
+            job->users++;
+            ThreadPool_UnlockQueue();
+            ThreadPool_DrainSet( job, gWorkerThreadID, 0 );
+            ThreadPool_LockQueue();
+            ThreadPool_ReleaseSet( job );
+        }
+
+        ThreadPool_WaitForSet( job );
+        ThreadPool_UnlockQueue();
+    }
+
+    result = job->result;
+    free( job );
+    return result;
+}
+
+cl_uint GetThreadCount( void )
+{
+    if( ThreadPool_Start() )
+        return 1;
 
     if( gThreadCount < 1 )
         return 1;
@@ -928,4 +1203,43 @@ void SetThreadCount( int count )
         log_info( "WARNING: SetThreadCount(%d) ignored\n", count );
 }
 
+void ThreadPool_SetScheduler( ThreadPoolScheduler scheduler )
+{
+}
+
+ThreadPoolScheduler ThreadPool_GetScheduler( void )
+{
+    return kThreadPoolGlobalCounter;
+}
+
+// Without threads, submitted jobs just run right away
+struct ThreadPoolJob
+{
+    cl_int      result;
+};
+
+ThreadPoolJobHandle ThreadPool_Submit(  TPFuncPtr func_ptr,
+                                        cl_uint count,
+                                        void *userInfo )
+{
+    struct ThreadPoolJob *job = (struct ThreadPoolJob*) calloc( 1, sizeof( *job ) );
+    if( NULL == job )
+        return NULL;
+
+    job->result = ThreadPool_Do( func_ptr, count, userInfo );
+    return job;
+}
+
+cl_int ThreadPool_Wait( ThreadPoolJobHandle job )
+{
+    cl_int result;
+
+    if( NULL == job )
+        return CL_OUT_OF_HOST_MEMORY;
+
+    result = job->result;
+    free( job );
+    return result;
+}
+
 #endif
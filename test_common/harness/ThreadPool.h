@@ -33,9 +33,10 @@ cl_int     ThreadPool_AtomicAdd( volatile cl_int *a, cl_int b );    // returns o
 // Your function prototype
 //
 // A function pointer to the function you want to execute in a multithreaded context.  No
-// synchronization primitives are provided, other than the atomic add above. You may not
-// call ThreadPool_Do from your function. ThreadPool_AtomicAdd() and GetThreadCount() should
-// work, however.
+// synchronization primitives are provided, other than the atomic add above. ThreadPool_Do,
+// ThreadPool_Submit and ThreadPool_Wait may be called from your function; the calling thread
+// works on the nested jobs while it waits for them, together with any idle workers.
+// ThreadPool_AtomicAdd() and GetThreadCount() work as well.
 //
 // job ids and thread ids are 0 based.  If number of jobs or threads was 8, they will numbered be 0 through 7.
 // Note that while every job will be run, it is not guaranteed that every thread will wake up before
@@ -44,11 +45,29 @@ typedef cl_int (*TPFuncPtr)( cl_uint /*job_id*/, cl_uint /* thread_id */, void *
 
 // returns first non-zero result from func_ptr, or CL_SUCCESS if all are zero.
 // Some workitems may not run if a non-zero result is returned from func_ptr().
-// This function may not be called from a TPFuncPtr.
+// Only one top level call runs on the thread pool at a time. A call from another thread waits
+// for it to finish. A nested call from a TPFuncPtr runs on the pool ahead of the outer jobs.
 cl_int      ThreadPool_Do(  TPFuncPtr func_ptr,
                             cl_uint count,
                             void *userInfo );
 
+// Asynchronous job submission.
+//
+// ThreadPool_Submit() queues count jobs on the worker threads and returns right away, so they
+// overlap with whatever the caller does next. Jobs of a ThreadPool_Do call go ahead of them;
+// workers go back to the submitted jobs once those are all taken. Like any other job they get
+// the thread_id of the worker running them. This is meant for work such as building programs
+// for the next test while the current one is verified.
+//
+// ThreadPool_Wait() blocks until the jobs are done, releases the handle and returns the first
+// non-zero result from func_ptr, or CL_SUCCESS. Every handle must be waited on exactly once.
+// Returns NULL only if the handle could not be allocated, in which case the jobs did not run.
+typedef struct ThreadPoolJob *ThreadPoolJobHandle;
+ThreadPoolJobHandle ThreadPool_Submit(  TPFuncPtr func_ptr,
+                                        cl_uint count,
+                                        void *userInfo );
+cl_int              ThreadPool_Wait( ThreadPoolJobHandle job );
+
 // Returns the number of worker threads that underlie the threadpool.  The value passed
 // as the TPFuncPtrs thread_id will be between 0 and this value less one, inclusive.
 // This is safe to call from a TPFuncPtr.
@@ -68,6 +87,28 @@ cl_uint     GetThreadCount( void );
 // otherwise the behavior is indefined. It may not be called from a TPFuncPtr.
 void        SetThreadCount( int count );
 
+// Scheduling policies for ThreadPool_Do.
+//
+// kThreadPoolGlobalCounter hands out job ids one at a time from a single shared counter.
+//
+// kThreadPoolWorkStealing gives each worker thread a contiguous range of the job ids, which it
+// works through in small chunks. A thread that runs out of work steals half of what is left
+// in another thread's range. This keeps the threads off shared state for most jobs, which helps
+// when there are many threads and many small jobs. Job ids still run exactly once, but in no
+// particular order.
+typedef enum ThreadPoolScheduler
+{
+    kThreadPoolGlobalCounter = 0,
+    kThreadPoolWorkStealing
+}ThreadPoolScheduler;
+
+// ThreadPool_SetScheduler() selects the scheduler used by later calls to ThreadPool_Do().
+// The default is kThreadPoolGlobalCounter, or kThreadPoolWorkStealing if the
+// CL_TEST_THREADPOOL_SCHEDULER environment variable is set to "steal". An explicit call
+// overrides the environment variable. It may not be called from a TPFuncPtr.
+void                ThreadPool_SetScheduler( ThreadPoolScheduler scheduler );
+ThreadPoolScheduler ThreadPool_GetScheduler( void );
+
 #ifdef __cplusplus
     }   /* extern "C" */
 #endif
@@ -0,0 +1,559 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// OpenCL API tracing layer, built as the libcl_api_trace shared library. See clApiTrace.h.
+// Each traced entry point forwards to the next definition of the same symbol (the OpenCL library or ICD
+// loader) found with dlsym( RTLD_NEXT ), and records how long the call took.
+
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE         // RTLD_NEXT
+#endif
+#ifndef CL_USE_DEPRECATED_OPENCL_1_2_APIS
+    #define CL_USE_DEPRECATED_OPENCL_1_2_APIS   1   // clCreateCommandQueue, still used by most tests
+#endif
+
+#include "clApiTrace.h"
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TRACE_ENTRY_POINTS( X )         \
+    X( clEnqueueReadBuffer )            \
+    X( clEnqueueWriteBuffer )           \
+    X( clEnqueueReadBufferRect )        \
+    X( clEnqueueWriteBufferRect )       \
+    X( clEnqueueCopyBuffer )            \
+    X( clEnqueueFillBuffer )            \
+    X( clEnqueueMapBuffer )             \
+    X( clEnqueueUnmapMemObject )        \
+    X( clEnqueueReadImage )             \
+    X( clEnqueueWriteImage )            \
+    X( clEnqueueNDRangeKernel )         \
+    X( clFinish )                       \
+    X( clFlush )                        \
+    X( clWaitForEvents )                \
+    X( clCreateBuffer )                 \
+    X( clReleaseMemObject )             \
+    X( clCreateProgramWithSource )      \
+    X( clCreateProgramWithBinary )      \
+    X( clBuildProgram )                 \
+    X( clReleaseProgram )               \
+    X( clCreateKernel )                 \
+    X( clSetKernelArg )                 \
+    X( clReleaseKernel )                \
+    X( clCreateContext )                \
+    X( clReleaseContext )               \
+    X( clCreateCommandQueue )           \
+    X( clCreateCommandQueueWithProperties ) \
+    X( clReleaseCommandQueue )
+
+#define TRACE_ENUM( name )      kTrace_##name,
+#define TRACE_NAME( name )      #name,
+
+enum
+{
+    TRACE_ENTRY_POINTS( TRACE_ENUM )
+    kTraceEntryCount
+};
+
+static const char *gTraceEntryNames[ kTraceEntryCount ] = { TRACE_ENTRY_POINTS( TRACE_NAME ) };
+
+#define TRACE_BUCKETS   40      // bucket i counts calls that took [2^i, 2^(i+1)) ns; the last one also counts longer calls
+
+typedef struct TraceCounters
+{
+    volatile cl_ulong   calls;
+    volatile cl_ulong   nanoseconds;
+    volatile cl_ulong   bytes;                          // host <-> device bytes moved
+    volatile cl_ulong   histogram[ TRACE_BUCKETS ];
+} TraceCounters;
+
+typedef struct TraceTest
+{
+    char                name[ 128 ];
+    TraceCounters       counters[ kTraceEntryCount ];
+    struct TraceTest    *next;
+} TraceTest;
+
+static TraceCounters    gTraceTotals[ kTraceEntryCount ];
+static TraceTest        *gTraceTests = NULL;           // in the order they ran
+static TraceTest        *volatile gTraceCurrentTest = NULL;
+static pthread_mutex_t  gTraceTestLock = PTHREAD_MUTEX_INITIALIZER;
+
+static cl_ulong trace_now( void )
+{
+    struct timespec t;
+    clock_gettime( CLOCK_MONOTONIC, &t );
+    return (cl_ulong) t.tv_sec * 1000000000ULL + (cl_ulong) t.tv_nsec;
+}
+
+static void *trace_resolve( const char *name )
+{
+    void *p = dlsym( RTLD_NEXT, name );
+    if( NULL == p )
+    {
+        fprintf( stderr, "OpenCL API trace: unable to find %s in the OpenCL library\n", name );
+        abort();
+    }
+    return p;
+}
+
+// Declares real, the function the traced entry point forwards to
+#define TRACE_REAL( name )                                          \
+    static __typeof__( &name ) real = NULL;                         \
+    if( NULL == real )                                              \
+        real = (__typeof__( &name )) trace_resolve( #name );
+
+static void trace_add( TraceCounters *c, cl_ulong ns, cl_ulong bytes, int bucket )
+{
+    __sync_fetch_and_add( &c->calls, 1 );
+    __sync_fetch_and_add( &c->nanoseconds, ns );
+    if( bytes )
+        __sync_fetch_and_add( &c->bytes, bytes );
+    __sync_fetch_and_add( &c->histogram[ bucket ], 1 );
+}
+
+static void trace_record( int entry, cl_ulong start, cl_ulong bytes )
+{
+    cl_ulong ns = trace_now() - start;
+    int bucket = 0;
+    while( bucket < TRACE_BUCKETS - 1 && ( ns >> ( bucket + 1 ) ) )
+        bucket++;
+
+    trace_add( gTraceTotals + entry, ns, bytes, bucket );
+
+    TraceTest *test = gTraceCurrentTest;
+    if( test )
+        trace_add( test->counters + entry, ns, bytes, bucket );
+}
+
+static cl_ulong trace_image_bytes( cl_mem image, const size_t *region )
+{
+    TRACE_REAL( clGetImageInfo );
+    size_t elementSize = 0;
+    if( NULL == region || CL_SUCCESS != real( image, CL_IMAGE_ELEMENT_SIZE, sizeof( elementSize ), &elementSize, NULL ) )
+        return 0;
+    return (cl_ulong) elementSize * region[0] * region[1] * region[2];
+}
+
+// -- Control --
+
+void clApiTraceBeginTest( const char *testName )
+{
+    TraceTest *test = (TraceTest*) calloc( 1, sizeof( TraceTest ) );
+    if( NULL == test )
+        return;
+    strncpy( test->name, testName, sizeof( test->name ) - 1 );
+
+    pthread_mutex_lock( &gTraceTestLock );
+    TraceTest **tail = &gTraceTests;
+    while( *tail )
+        tail = &(*tail)->next;
+    *tail = test;
+    gTraceCurrentTest = test;
+    pthread_mutex_unlock( &gTraceTestLock );
+}
+
+void clApiTraceGetTotals( cl_ulong *calls, cl_ulong *bytesMoved )
+{
+    int i;
+    *calls = *bytesMoved = 0;
+    for( i = 0; i < kTraceEntryCount; i++ )
+    {
+        *calls += gTraceTotals[i].calls;
+        *bytesMoved += gTraceTotals[i].bytes;
+    }
+}
+
+// Upper bound in microseconds of the bucket holding the given fraction of the calls
+static double trace_percentile( const TraceCounters *c, double fraction )
+{
+    cl_ulong target = (cl_ulong) ( fraction * c->calls + 0.5 );
+    cl_ulong seen = 0;
+    int i;
+    for( i = 0; i < TRACE_BUCKETS; i++ )
+    {
+        seen += c->histogram[i];
+        if( seen >= target && seen > 0 )
+            break;
+    }
+    return ( 1ULL << ( i + 1 ) ) * 1e-3;
+}
+
+static void trace_write_counters( FILE *f, const TraceCounters *counters, int histograms )
+{
+    int i, j;
+
+    fprintf( f, "  %-36s %10s %12s %10s %10s %10s %14s\n", "entry point", "calls", "total ms", "mean us", "p50 us", "p99 us", "bytes" );
+    for( i = 0; i < kTraceEntryCount; i++ )
+    {
+        const TraceCounters *c = counters + i;
+        if( 0 == c->calls )
+            continue;
+        fprintf( f, "  %-36s %10llu %12.3f %10.2f %10.2f %10.2f %14llu\n", gTraceEntryNames[i], (unsigned long long) c->calls,
+                 c->nanoseconds * 1e-6, c->nanoseconds * 1e-3 / c->calls,
+                 trace_percentile( c, 0.5 ), trace_percentile( c, 0.99 ), (unsigned long long) c->bytes );
+    }
+
+    if( ! histograms )
+        return;
+
+    fprintf( f, "\n  Latency histograms (calls taking less than the given time):\n" );
+    for( i = 0; i < kTraceEntryCount; i++ )
+    {
+        const TraceCounters *c = counters + i;
+        if( 0 == c->calls )
+            continue;
+        fprintf( f, "  %-36s", gTraceEntryNames[i] );
+        for( j = 0; j < TRACE_BUCKETS; j++ )
+        {
+            if( 0 == c->histogram[j] )
+                continue;
+            if( j < 9 )
+                fprintf( f, " <%lluns:%llu", 1ULL << ( j + 1 ), (unsigned long long) c->histogram[j] );
+            else if( j < 19 )
+                fprintf( f, " <%lluus:%llu", ( 1ULL << ( j + 1 ) ) / 1000, (unsigned long long) c->histogram[j] );
+            else
+                fprintf( f, " <%llums:%llu", ( 1ULL << ( j + 1 ) ) / 1000000, (unsigned long long) c->histogram[j] );
+        }
+        fprintf( f, "\n" );
+    }
+}
+
+__attribute__((destructor)) static void trace_write_summary( void )
+{
+    const char *path = getenv( "CL_API_TRACE_OUTPUT" );
+    FILE *f = path ? fopen( path, "w" ) : stderr;
+    cl_ulong calls, bytes;
+    TraceTest *test;
+
+    if( NULL == f )
+    {
+        fprintf( stderr, "OpenCL API trace: unable to open %s\n", path );
+        f = stderr;
+    }
+
+    clApiTraceGetTotals( &calls, &bytes );
+    fprintf( f, "\nOpenCL API trace: %llu calls, %llu bytes moved\n", (unsigned long long) calls, (unsigned long long) bytes );
+    trace_write_counters( f, gTraceTotals, 1 );
+
+    pthread_mutex_lock( &gTraceTestLock );
+    for( test = gTraceTests; test; test = test->next )
+    {
+        fprintf( f, "\nTest %s:\n", test->name );
+        trace_write_counters( f, test->counters, 0 );
+    }
+    pthread_mutex_unlock( &gTraceTestLock );
+
+    if( f != stderr )
+        fclose( f );
+}
+
+// -- Traced entry points --
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBuffer( cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_read,
+                                                     size_t offset, size_t size, void *ptr, cl_uint num_events_in_wait_list,
+                                                     const cl_event *event_wait_list, cl_event *event )
+{
+    TRACE_REAL( clEnqueueReadBuffer );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue, buffer, blocking_read, offset, size, ptr, num_events_in_wait_list, event_wait_list, event );
+    trace_record( kTrace_clEnqueueReadBuffer, start, size );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBuffer( cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_write,
+                                                      size_t offset, size_t size, const void *ptr, cl_uint num_events_in_wait_list,
+                                                      const cl_event *event_wait_list, cl_event *event )
+{
+    TRACE_REAL( clEnqueueWriteBuffer );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue, buffer, blocking_write, offset, size, ptr, num_events_in_wait_list, event_wait_list, event );
+    trace_record( kTrace_clEnqueueWriteBuffer, start, size );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBufferRect( cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_read,
+                                                         const size_t *buffer_offset, const size_t *host_offset, const size_t *region,
+                                                         size_t buffer_row_pitch, size_t buffer_slice_pitch,
+                                                         size_t host_row_pitch, size_t host_slice_pitch, void *ptr,
+                                                         cl_uint num_events_in_wait_list, const cl_event *event_wait_list, cl_event *event )
+{
+    TRACE_REAL( clEnqueueReadBufferRect );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue, buffer, blocking_read, buffer_offset, host_offset, region, buffer_row_pitch, buffer_slice_pitch,
+                       host_row_pitch, host_slice_pitch, ptr, num_events_in_wait_list, event_wait_list, event );
+    trace_record( kTrace_clEnqueueReadBufferRect, start, region ? (cl_ulong) region[0] * region[1] * region[2] : 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBufferRect( cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_write,
+                                                          const size_t *buffer_offset, const size_t *host_offset, const size_t *region,
+                                                          size_t buffer_row_pitch, size_t buffer_slice_pitch,
+                                                          size_t host_row_pitch, size_t host_slice_pitch, const void *ptr,
+                                                          cl_uint num_events_in_wait_list, const cl_event *event_wait_list, cl_event *event )
+{
+    TRACE_REAL( clEnqueueWriteBufferRect );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue, buffer, blocking_write, buffer_offset, host_offset, region, buffer_row_pitch, buffer_slice_pitch,
+                       host_row_pitch, host_slice_pitch, ptr, num_events_in_wait_list, event_wait_list, event );
+    trace_record( kTrace_clEnqueueWriteBufferRect, start, region ? (cl_ulong) region[0] * region[1] * region[2] : 0 );
+    return ret;
+}
+
+// Copies and fills stay on the device, so they move no host <-> device bytes
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueCopyBuffer( cl_command_queue command_queue, cl_mem src_buffer, cl_mem dst_buffer,
+                                                     size_t src_offset, size_t dst_offset, size_t size, cl_uint num_events_in_wait_list,
+                                                     const cl_event *event_wait_list, cl_event *event )
+{
+    TRACE_REAL( clEnqueueCopyBuffer );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue, src_buffer, dst_buffer, src_offset, dst_offset, size, num_events_in_wait_list, event_wait_list, event );
+    trace_record( kTrace_clEnqueueCopyBuffer, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueFillBuffer( cl_command_queue command_queue, cl_mem buffer, const void *pattern,
+                                                     size_t pattern_size, size_t offset, size_t size, cl_uint num_events_in_wait_list,
+                                                     const cl_event *event_wait_list, cl_event *event )
+{
+    TRACE_REAL( clEnqueueFillBuffer );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue, buffer, pattern, pattern_size, offset, size, num_events_in_wait_list, event_wait_list, event );
+    trace_record( kTrace_clEnqueueFillBuffer, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY void * CL_API_CALL clEnqueueMapBuffer( cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_map,
+                                                    cl_map_flags map_flags, size_t offset, size_t size, cl_uint num_events_in_wait_list,
+                                                    const cl_event *event_wait_list, cl_event *event, cl_int *errcode_ret )
+{
+    TRACE_REAL( clEnqueueMapBuffer );
+    cl_ulong start = trace_now();
+    void *ret = real( command_queue, buffer, blocking_map, map_flags, offset, size, num_events_in_wait_list, event_wait_list, event, errcode_ret );
+    trace_record( kTrace_clEnqueueMapBuffer, start, size );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueUnmapMemObject( cl_command_queue command_queue, cl_mem memobj, void *mapped_ptr,
+                                                         cl_uint num_events_in_wait_list, const cl_event *event_wait_list, cl_event *event )
+{
+    TRACE_REAL( clEnqueueUnmapMemObject );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue, memobj, mapped_ptr, num_events_in_wait_list, event_wait_list, event );
+    trace_record( kTrace_clEnqueueUnmapMemObject, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadImage( cl_command_queue command_queue, cl_mem image, cl_bool blocking_read,
+                                                    const size_t *origin, const size_t *region, size_t row_pitch, size_t slice_pitch,
+                                                    void *ptr, cl_uint num_events_in_wait_list, const cl_event *event_wait_list, cl_event *event )
+{
+    TRACE_REAL( clEnqueueReadImage );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue, image, blocking_read, origin, region, row_pitch, slice_pitch, ptr, num_events_in_wait_list, event_wait_list, event );
+    trace_record( kTrace_clEnqueueReadImage, start, trace_image_bytes( image, region ) );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteImage( cl_command_queue command_queue, cl_mem image, cl_bool blocking_write,
+                                                     const size_t *origin, const size_t *region, size_t input_row_pitch, size_t input_slice_pitch,
+                                                     const void *ptr, cl_uint num_events_in_wait_list, const cl_event *event_wait_list, cl_event *event )
+{
+    TRACE_REAL( clEnqueueWriteImage );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue, image, blocking_write, origin, region, input_row_pitch, input_slice_pitch, ptr, num_events_in_wait_list, event_wait_list, event );
+    trace_record( kTrace_clEnqueueWriteImage, start, trace_image_bytes( image, region ) );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueNDRangeKernel( cl_command_queue command_queue, cl_kernel kernel, cl_uint work_dim,
+                                                        const size_t *global_work_offset, const size_t *global_work_size,
+                                                        const size_t *local_work_size, cl_uint num_events_in_wait_list,
+                                                        const cl_event *event_wait_list, cl_event *event )
+{
+    TRACE_REAL( clEnqueueNDRangeKernel );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue, kernel, work_dim, global_work_offset, global_work_size, local_work_size, num_events_in_wait_list, event_wait_list, event );
+    trace_record( kTrace_clEnqueueNDRangeKernel, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clFinish( cl_command_queue command_queue )
+{
+    TRACE_REAL( clFinish );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue );
+    trace_record( kTrace_clFinish, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clFlush( cl_command_queue command_queue )
+{
+    TRACE_REAL( clFlush );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue );
+    trace_record( kTrace_clFlush, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clWaitForEvents( cl_uint num_events, const cl_event *event_list )
+{
+    TRACE_REAL( clWaitForEvents );
+    cl_ulong start = trace_now();
+    cl_int ret = real( num_events, event_list );
+    trace_record( kTrace_clWaitForEvents, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateBuffer( cl_context context, cl_mem_flags flags, size_t size, void *host_ptr, cl_int *errcode_ret )
+{
+    TRACE_REAL( clCreateBuffer );
+    cl_ulong start = trace_now();
+    cl_mem ret = real( context, flags, size, host_ptr, errcode_ret );
+    trace_record( kTrace_clCreateBuffer, start, ( flags & CL_MEM_COPY_HOST_PTR ) ? size : 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseMemObject( cl_mem memobj )
+{
+    TRACE_REAL( clReleaseMemObject );
+    cl_ulong start = trace_now();
+    cl_int ret = real( memobj );
+    trace_record( kTrace_clReleaseMemObject, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithSource( cl_context context, cl_uint count, const char **strings,
+                                                               const size_t *lengths, cl_int *errcode_ret )
+{
+    TRACE_REAL( clCreateProgramWithSource );
+    cl_ulong start = trace_now();
+    cl_program ret = real( context, count, strings, lengths, errcode_ret );
+    trace_record( kTrace_clCreateProgramWithSource, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_program CL_API_CALL clCreateProgramWithBinary( cl_context context, cl_uint num_devices, const cl_device_id *device_list,
+                                                               const size_t *lengths, const unsigned char **binaries,
+                                                               cl_int *binary_status, cl_int *errcode_ret )
+{
+    TRACE_REAL( clCreateProgramWithBinary );
+    cl_ulong start = trace_now();
+    cl_program ret = real( context, num_devices, device_list, lengths, binaries, binary_status, errcode_ret );
+    trace_record( kTrace_clCreateProgramWithBinary, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clBuildProgram( cl_program program, cl_uint num_devices, const cl_device_id *device_list,
+                                                const char *options, void (CL_CALLBACK *pfn_notify)( cl_program, void * ),
+                                                void *user_data )
+{
+    TRACE_REAL( clBuildProgram );
+    cl_ulong start = trace_now();
+    cl_int ret = real( program, num_devices, device_list, options, pfn_notify, user_data );
+    trace_record( kTrace_clBuildProgram, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseProgram( cl_program program )
+{
+    TRACE_REAL( clReleaseProgram );
+    cl_ulong start = trace_now();
+    cl_int ret = real( program );
+    trace_record( kTrace_clReleaseProgram, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_kernel CL_API_CALL clCreateKernel( cl_program program, const char *kernel_name, cl_int *errcode_ret )
+{
+    TRACE_REAL( clCreateKernel );
+    cl_ulong start = trace_now();
+    cl_kernel ret = real( program, kernel_name, errcode_ret );
+    trace_record( kTrace_clCreateKernel, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clSetKernelArg( cl_kernel kernel, cl_uint arg_index, size_t arg_size, const void *arg_value )
+{
+    TRACE_REAL( clSetKernelArg );
+    cl_ulong start = trace_now();
+    cl_int ret = real( kernel, arg_index, arg_size, arg_value );
+    trace_record( kTrace_clSetKernelArg, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseKernel( cl_kernel kernel )
+{
+    TRACE_REAL( clReleaseKernel );
+    cl_ulong start = trace_now();
+    cl_int ret = real( kernel );
+    trace_record( kTrace_clReleaseKernel, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_context CL_API_CALL clCreateContext( const cl_context_properties *properties, cl_uint num_devices, const cl_device_id *devices,
+                                                     void (CL_CALLBACK *pfn_notify)( const char *, const void *, size_t, void * ),
+                                                     void *user_data, cl_int *errcode_ret )
+{
+    TRACE_REAL( clCreateContext );
+    cl_ulong start = trace_now();
+    cl_context ret = real( properties, num_devices, devices, pfn_notify, user_data, errcode_ret );
+    trace_record( kTrace_clCreateContext, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseContext( cl_context context )
+{
+    TRACE_REAL( clReleaseContext );
+    cl_ulong start = trace_now();
+    cl_int ret = real( context );
+    trace_record( kTrace_clReleaseContext, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueue( cl_context context, cl_device_id device,
+                                                                cl_command_queue_properties properties, cl_int *errcode_ret )
+{
+    TRACE_REAL( clCreateCommandQueue );
+    cl_ulong start = trace_now();
+    cl_command_queue ret = real( context, device, properties, errcode_ret );
+    trace_record( kTrace_clCreateCommandQueue, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueueWithProperties( cl_context context, cl_device_id device,
+                                                                              const cl_queue_properties *properties, cl_int *errcode_ret )
+{
+    TRACE_REAL( clCreateCommandQueueWithProperties );
+    cl_ulong start = trace_now();
+    cl_command_queue ret = real( context, device, properties, errcode_ret );
+    trace_record( kTrace_clCreateCommandQueueWithProperties, start, 0 );
+    return ret;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseCommandQueue( cl_command_queue command_queue )
+{
+    TRACE_REAL( clReleaseCommandQueue );
+    cl_ulong start = trace_now();
+    cl_int ret = real( command_queue );
+    trace_record( kTrace_clReleaseCommandQueue, start, 0 );
+    return ret;
+}
@@ -0,0 +1,52 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef _clApiTrace_h
+#define _clApiTrace_h
+
+#ifdef __APPLE__
+    #include <OpenCL/opencl.h>
+#else
+    #include <CL/opencl.h>
+#endif
+
+/*
+ *  OpenCL API tracing layer.
+ *
+ *  libcl_api_trace is loaded ahead of the OpenCL library with LD_PRELOAD (DYLD_INSERT_LIBRARIES and
+ *  DYLD_FORCE_FLAT_NAMESPACE=1 on Mac OS X). It counts the calls to the common OpenCL entry points, the
+ *  bytes they move between host and device, and a log2 histogram of their latency, in total and per test.
+ *  A summary is written at exit to the file named by CL_API_TRACE_OUTPUT, or to stderr.
+ *
+ *  The test harness finds the functions below with dlsym when the layer is loaded; tests need not link it.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Attribute the calls made from now on to testName
+typedef void (*clApiTraceBeginTestFn)( const char *testName );
+extern void clApiTraceBeginTest( const char *testName );
+
+// Total calls and bytes moved since the layer was loaded
+typedef void (*clApiTraceGetTotalsFn)( cl_ulong *calls, cl_ulong *bytesMoved );
+extern void clApiTraceGetTotals( cl_ulong *calls, cl_ulong *bytesMoved );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _clApiTrace_h
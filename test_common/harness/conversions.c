@@ -961,19 +961,13 @@ void generate_random_data( ExplicitType type, size_t count, MTdata d, void *outD
 
         case kInt:
             intPtr = (cl_int *)outData;
-            for( i = 0; i < count; i++ )
-            {
-                intPtr[i] = (cl_int)genrand_int32(d);
-            }
+            genrand_fill_u32( d, (cl_uint *)intPtr, count );
             break;
 
         case kUInt:
         case kUnsignedInt:
             uintPtr = (cl_uint *)outData;
-            for( i = 0; i < count; i++ )
-            {
-                uintPtr[i] = (unsigned int)genrand_int32(d);
-            }
+            genrand_fill_u32( d, uintPtr, count );
             break;
 
         case kLong:
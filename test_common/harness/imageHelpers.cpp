@@ -21,6 +21,9 @@
 #if !defined (_WIN32) && !defined(__APPLE__)
 #include <malloc.h>
 #endif
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
 
 int gTestCount = 0;
 int gTestFailure = 0;
@@ -68,6 +71,66 @@ sRGBunmap(float fc)
     return result;
 }
 
+// Tables behind sRGBmap_unorm8 and sRGBunmap_unorm8. sRGBmap is monotonic over [0,1], so the unorm8
+// encoding of a value is the number of thresholds at or below it, where threshold k is the smallest
+// float that encodes to k.
+struct sRGBTables
+{
+    float unmap[ 256 ];
+    float mapThreshold[ 256 ];
+
+    sRGBTables()
+    {
+        union { float f; cl_uint u; } lo, hi, mid;
+        for( int i = 0; i < 256; i++ )
+            unmap[ i ] = (float)sRGBunmap( (float)i / 255.0f );
+
+        mapThreshold[ 0 ] = 0.0f;
+        for( int k = 1; k < 256; k++ )
+        {
+            // Bisect on the float bit patterns between 0 and 1
+            lo.f = mapThreshold[ k - 1 ];
+            hi.f = 1.0f;
+            while( lo.u < hi.u )
+            {
+                mid.u = lo.u + ( hi.u - lo.u ) / 2;
+                if( (int)(unsigned char)( sRGBmap( mid.f ) + 0.5 ) >= k )
+                    hi.u = mid.u;
+                else
+                    lo.u = mid.u + 1;
+            }
+            mapThreshold[ k ] = lo.f;
+        }
+    }
+};
+
+static const sRGBTables &get_sRGB_tables( void )
+{
+    static sRGBTables tables;
+    return tables;
+}
+
+cl_uchar sRGBmap_unorm8( float fc )
+{
+    // NaN and values at or below zero map to 0, values above one to 255
+    if( !( fc > 0.0f ) )
+        return 0;
+    if( fc > 1.0f )
+        return 255;
+
+    const float *threshold = get_sRGB_tables().mapThreshold;
+    int k = 0;
+    for( int step = 128; step > 0; step >>= 1 )
+        if( threshold[ k + step ] <= fc )
+            k += step;
+    return (cl_uchar)k;
+}
+
+float sRGBunmap_unorm8( cl_uchar c )
+{
+    return get_sRGB_tables().unmap[ c ];
+}
+
 
 size_t get_format_type_size( const cl_image_format *format )
 {
@@ -911,7 +974,7 @@ int get_format_min_int( cl_image_format *format )
     }
 }
 
-float convert_half_to_float( unsigned short halfValue )
+static float convert_half_to_float_scalar( unsigned short halfValue )
 {
     // We have to take care of a few special cases, but in general, we just extract
     // the same components from the half that exist in the float and re-stuff them
@@ -967,7 +1030,28 @@ float convert_half_to_float( unsigned short halfValue )
     return outFloat.floatValue;
 }
 
+// Every half converted by convert_half_to_float_scalar
+struct HalfToFloatTable
+{
+    float values[ 65536 ];
 
+    HalfToFloatTable()
+    {
+        for( int i = 0; i < 65536; i++ )
+            values[ i ] = convert_half_to_float_scalar( (unsigned short)i );
+    }
+};
+
+static const float *get_half_to_float_table( void )
+{
+    static HalfToFloatTable table;
+    return table.values;
+}
+
+float convert_half_to_float( unsigned short halfValue )
+{
+    return get_half_to_float_table()[ halfValue ];
+}
 
 cl_ushort convert_float_to_half( float f )
 {
@@ -1115,41 +1199,72 @@ void  __vstore_half_rte(float f, size_t index, uint16_t *p)
 
 TEST::TEST()
 {
-    return;
-    union
+    // Set CL_VERIFY_HALF_AND_SRGB_CONVERSIONS to check the conversion tables before any test runs
+    if( getenv( "CL_VERIFY_HALF_AND_SRGB_CONVERSIONS" ) && verify_half_and_sRGB_conversions() )
+        exit(-1);
+}
+
+int verify_half_and_sRGB_conversions( void )
+{
+    union { float f; cl_uint u; } a, b;
+    int failures = 0;
+    cl_uint u = 0;
+
+    log_info( "Verifying half and sRGB conversions" );
+
+    // Every half to float
+    for( int i = 0; i < 65536; i++ )
     {
-        float f;
-        uint32_t i;
-    } test;
-    uint16_t control, myval;
+        a.f = convert_half_to_float_scalar( (cl_ushort)i );
+        b.f = convert_half_to_float( (cl_ushort)i );
+        if( a.u != b.u )
+        {
+            if( failures++ < 16 )
+                log_error( "\nERROR: half 0x%4.4x: expected 0x%8.8x, table 0x%8.8x\n", i, a.u, b.u );
+        }
+    }
 
-    log_info(" &&&&&&&&&&&&&&&&&&&&&&&&&&&& TESTING HALFS &&&&&&&&&&&&&&&&&&&&\n" );
-    test.i = 0;
+    // Every float to half, and to unorm8 sRGB
     do
     {
-        if( ( test.i & 0xffffff ) == 0 )
+        if( ( u & 0xfffffff ) == 0 )
         {
-            if( ( test.i & 0xfffffff ) == 0 )
-                log_info( "*" );
-            else
-                log_info( "." );
-            fflush(stdout);
+            log_info( "." );
+            fflush( stdout );
         }
-        __vstore_half_rte( test.f, 0, &control );
-        myval = convert_float_to_half( test.f );
-        if( myval != control )
+
+        a.u = u;
+        cl_ushort rteRef = float2half_rte( a.f ), vstore;
+        __vstore_half_rte( a.f, 0, &vstore );
+        if( vstore != rteRef )
+        {
+            if( failures++ < 16 )
+                log_error( "\nERROR: float %a (0x%8.8x): rte 0x%4.4x, vstore 0x%4.4x\n", a.f, u, rteRef, vstore );
+        }
+
+        cl_uchar sRGBRef = (unsigned char)( sRGBmap( a.f ) + 0.5 );
+        if( sRGBmap_unorm8( a.f ) != sRGBRef )
         {
-            log_info( "\n******** ERROR: MyVal %04x control %04x source %12.24f\n", myval, control, test.f );
-            log_info( "         source bits: %08x   %a\n", test.i, test.f );
-            float t, c;
-            c = convert_half_to_float( control );
-            t = convert_half_to_float( myval );
-            log_info( "         converted control: %12.24f myval: %12.24f\n", c, t );
+            if( failures++ < 16 )
+                log_error( "\nERROR: float %a (0x%8.8x): sRGB %d, table %d\n", a.f, u, sRGBRef, sRGBmap_unorm8( a.f ) );
         }
-        test.i++;
-    } while( test.i != 0 );
-    log_info("\n &&&&&&&&&&&&&&&&&&&&&&&&&&&& TESTING HALFS &&&&&&&&&&&&&&&&&&&&\n" );
+    } while( ++u != 0 );
+
+    // Every unorm8 sRGB value to float
+    for( int i = 0; i < 256; i++ )
+    {
+        a.f = (float)sRGBunmap( (float)i / 255.0f );
+        b.f = sRGBunmap_unorm8( (cl_uchar)i );
+        if( a.u != b.u )
+        {
+            if( failures++ < 16 )
+                log_error( "\nERROR: sRGB %d: expected %a, table %a\n", i, a.f, b.f );
+        }
+    }
+
+    log_info( failures ? "\n%d half and sRGB conversion mismatches\n" : "\nhalf and sRGB conversions passed\n", failures );
 
+    return failures;
 }
 
 cl_ulong get_image_size( image_descriptor const *imageInfo )
@@ -1301,11 +1416,9 @@ char * generate_random_image_data( image_descriptor *imageInfo, BufferOwningPtr<
     }
 
     // Otherwise, we should be able to just fill with random bits no matter what
-    cl_uint *p = (cl_uint*) data;
-    for( i = 0; i + 4 <= allocSize; i += 4 )
-        p[ i / 4 ] = genrand_int32(d);
+    genrand_fill_u32( d, (cl_uint*) data, allocSize / 4 );
 
-    for( ; i < allocSize; i++ )
+    for( i = allocSize & ~(size_t) 3; i < allocSize; i++ )
         data[i] = genrand_int32(d);
 
     // Note: inf or nan float values would cause problems, although we don't know this will
@@ -1452,7 +1565,7 @@ void read_image_pixel_float( void *imageData, image_descriptor *imageInfo,
             unsigned char *dPtr = (unsigned char *)ptr;
             for( i = 0; i < channelCount; i++ ) {
                 if((is_sRGBA_order(imageInfo->format->image_channel_order)) && i<3) // only RGB need to be converted for sRGBA
-                    tempData[ i ] = (float)sRGBunmap((float)dPtr[ i ] / 255.0f) ;
+                    tempData[ i ] = sRGBunmap_unorm8( dPtr[ i ] );
                 else
                     tempData[ i ] = (float)dPtr[ i ] / 255.0f;
             }
@@ -1949,6 +2062,24 @@ FloatPixel sample_image_pixel_float( void *imageData, image_descriptor *imageInf
 FloatPixel sample_image_pixel_float_offset( void *imageData, image_descriptor *imageInfo,
                                            float x, float y, float z, float xAddressOffset, float yAddressOffset, float zAddressOffset,
                                            image_sampler_data *imageSampler, float *outData, int verbose, int *containsDenorms , int lod)
+{
+    return sample_image_pixel_float_offset( imageData, imageInfo, x, y, z, xAddressOffset, yAddressOffset, zAddressOffset,
+                                            imageSampler, outData, verbose, containsDenorms, lod, NULL );
+}
+
+static inline void read_sampled_pixel( const ImagePixelAccessor *accessor, void *imageData, image_descriptor *imageInfo,
+                                       int x, int y, int z, float *outData, int lod )
+{
+    if( accessor )
+        accessor->ReadPixel( imageData, x, y, z, outData );
+    else
+        read_image_pixel_float( imageData, imageInfo, x, y, z, outData, lod );
+}
+
+FloatPixel sample_image_pixel_float_offset( void *imageData, image_descriptor *imageInfo,
+                                           float x, float y, float z, float xAddressOffset, float yAddressOffset, float zAddressOffset,
+                                           image_sampler_data *imageSampler, float *outData, int verbose, int *containsDenorms, int lod,
+                                           const ImagePixelAccessor *accessor )
 {
     AddressFn adFn = sAddressingTable[ imageSampler ];
     FloatPixel returnVal;
@@ -2076,7 +2207,7 @@ FloatPixel sample_image_pixel_float_offset( void *imageData, image_descriptor *i
                 log_info( "\tReference integer coords calculated: { %d, %d }\n", ix, iy );
         }
 
-        read_image_pixel_float( imageData, imageInfo, ix, iy, iz, outData, lod );
+        read_sampled_pixel( accessor, imageData, imageInfo, ix, iy, iz, outData, lod );
         check_for_denorms( outData, containsDenorms );
         for( int i = 0; i < 4; i++ )
             returnVal.p[i] = fabsf( outData[i] );
@@ -2134,13 +2265,13 @@ FloatPixel sample_image_pixel_float_offset( void *imageData, image_descriptor *i
 
             float upLeft[ 4 ], upRight[ 4 ], lowLeft[ 4 ], lowRight[ 4 ];
             float maxUp[4], maxLow[4];
-            read_image_pixel_float( imgPtr, imageInfo, x1, y1, 0, upLeft, lod );
-            read_image_pixel_float( imgPtr, imageInfo, x2, y1, 0, upRight, lod );
+            read_sampled_pixel( accessor, imgPtr, imageInfo, x1, y1, 0, upLeft, lod );
+            read_sampled_pixel( accessor, imgPtr, imageInfo, x2, y1, 0, upRight, lod );
             check_for_denorms( upLeft, containsDenorms );
             check_for_denorms( upRight, containsDenorms );
             pixelMax( upLeft, upRight, maxUp );
-            read_image_pixel_float( imgPtr, imageInfo, x1, y2, 0, lowLeft, lod );
-            read_image_pixel_float( imgPtr, imageInfo, x2, y2, 0, lowRight, lod );
+            read_sampled_pixel( accessor, imgPtr, imageInfo, x1, y2, 0, lowLeft, lod );
+            read_sampled_pixel( accessor, imgPtr, imageInfo, x2, y2, 0, lowRight, lod );
             check_for_denorms( lowLeft, containsDenorms );
             check_for_denorms( lowRight, containsDenorms );
             pixelMax( lowLeft, lowRight, maxLow );
@@ -2210,24 +2341,24 @@ FloatPixel sample_image_pixel_float_offset( void *imageData, image_descriptor *i
             float upLeftA[ 4 ], upRightA[ 4 ], lowLeftA[ 4 ], lowRightA[ 4 ];
             float upLeftB[ 4 ], upRightB[ 4 ], lowLeftB[ 4 ], lowRightB[ 4 ];
             float pixelMaxA[4], pixelMaxB[4];
-            read_image_pixel_float( imageData, imageInfo, x1, y1, z1, upLeftA, lod );
-            read_image_pixel_float( imageData, imageInfo, x2, y1, z1, upRightA, lod );
+            read_sampled_pixel( accessor, imageData, imageInfo, x1, y1, z1, upLeftA, lod );
+            read_sampled_pixel( accessor, imageData, imageInfo, x2, y1, z1, upRightA, lod );
             check_for_denorms( upLeftA, containsDenorms );
             check_for_denorms( upRightA, containsDenorms );
             pixelMax( upLeftA, upRightA, pixelMaxA );
-            read_image_pixel_float( imageData, imageInfo, x1, y2, z1, lowLeftA, lod );
-            read_image_pixel_float( imageData, imageInfo, x2, y2, z1, lowRightA, lod );
+            read_sampled_pixel( accessor, imageData, imageInfo, x1, y2, z1, lowLeftA, lod );
+            read_sampled_pixel( accessor, imageData, imageInfo, x2, y2, z1, lowRightA, lod );
             check_for_denorms( lowLeftA, containsDenorms );
             check_for_denorms( lowRightA, containsDenorms );
             pixelMax( lowLeftA, lowRightA, pixelMaxB );
             pixelMax( pixelMaxA, pixelMaxB, returnVal.p);
-            read_image_pixel_float( imageData, imageInfo, x1, y1, z2, upLeftB, lod );
-            read_image_pixel_float( imageData, imageInfo, x2, y1, z2, upRightB, lod );
+            read_sampled_pixel( accessor, imageData, imageInfo, x1, y1, z2, upLeftB, lod );
+            read_sampled_pixel( accessor, imageData, imageInfo, x2, y1, z2, upRightB, lod );
             check_for_denorms( upLeftB, containsDenorms );
             check_for_denorms( upRightB, containsDenorms );
             pixelMax( upLeftB, upRightB, pixelMaxA );
-            read_image_pixel_float( imageData, imageInfo, x1, y2, z2, lowLeftB, lod );
-            read_image_pixel_float( imageData, imageInfo, x2, y2, z2, lowRightB, lod );
+            read_sampled_pixel( accessor, imageData, imageInfo, x1, y2, z2, lowLeftB, lod );
+            read_sampled_pixel( accessor, imageData, imageInfo, x2, y2, z2, lowRightB, lod );
             check_for_denorms( lowLeftB, containsDenorms );
             check_for_denorms( lowRightB, containsDenorms );
             pixelMax( lowLeftB, lowRightB, pixelMaxB );
@@ -2672,9 +2803,9 @@ void pack_image_pixel( float *srcVector, const cl_image_format *imageFormat, voi
             cl_uchar *ptr = (cl_uchar *)outData;
             if ( is_sRGBA_order(imageFormat->image_channel_order) )
             {
-                ptr[ 0 ] = (unsigned char)( sRGBmap( srcVector[ 0 ] ) + 0.5 );
-                ptr[ 1 ] = (unsigned char)( sRGBmap( srcVector[ 1 ] ) + 0.5 );
-                ptr[ 2 ] = (unsigned char)( sRGBmap( srcVector[ 2 ] ) + 0.5 );
+                ptr[ 0 ] = sRGBmap_unorm8( srcVector[ 0 ] );
+                ptr[ 1 ] = sRGBmap_unorm8( srcVector[ 1 ] );
+                ptr[ 2 ] = sRGBmap_unorm8( srcVector[ 2 ] );
                 if (channelCount == 4)
                     ptr[ 3 ] = (unsigned char)NORMALIZE( srcVector[ 3 ], 255.f );
             }
@@ -2790,6 +2921,280 @@ void pack_image_pixel( float *srcVector, const cl_image_format *imageFormat, voi
     }
 }
 
+// Channel decoders for ImagePixelAccessor. Each one decodes the channelCount channels of one pixel, with
+// exactly the per-channel arithmetic of read_image_pixel_float.
+
+template <class T> static void decode_integer( const void *src, size_t channelCount, float *dst )
+{
+    const T *dPtr = (const T *)src;
+    for( size_t i = 0; i < channelCount; i++ )
+        dst[ i ] = (float)dPtr[ i ];
+}
+
+static void decode_snorm_int8( const void *src, size_t channelCount, float *dst )
+{
+    const char *dPtr = (const char *)src;
+    for( size_t i = 0; i < channelCount; i++ )
+        dst[ i ] = CLAMP_FLOAT( (float)dPtr[ i ] / 127.0f );
+}
+
+static void decode_snorm_int16( const void *src, size_t channelCount, float *dst )
+{
+    const cl_short *dPtr = (const cl_short *)src;
+    for( size_t i = 0; i < channelCount; i++ )
+        dst[ i ] = CLAMP_FLOAT( (float)dPtr[ i ] / 32767.0f );
+}
+
+static void decode_unorm_int8( const void *src, size_t channelCount, float *dst )
+{
+    const cl_uchar *dPtr = (const cl_uchar *)src;
+    for( size_t i = 0; i < channelCount; i++ )
+        dst[ i ] = (float)dPtr[ i ] / 255.0f;
+}
+
+static void decode_srgb_int8( const void *src, size_t channelCount, float *dst )
+{
+    const cl_uchar *dPtr = (const cl_uchar *)src;
+    // only RGB need to be converted for sRGBA
+    for( size_t i = 0; i < channelCount; i++ )
+        dst[ i ] = ( i < 3 ) ? sRGBunmap_unorm8( dPtr[ i ] ) : (float)dPtr[ i ] / 255.0f;
+}
+
+static void decode_unorm_int16( const void *src, size_t channelCount, float *dst )
+{
+    const cl_ushort *dPtr = (const cl_ushort *)src;
+    for( size_t i = 0; i < channelCount; i++ )
+        dst[ i ] = (float)dPtr[ i ] / 65535.0f;
+}
+
+static void decode_half( const void *src, size_t channelCount, float *dst )
+{
+    const cl_ushort *dPtr = (const cl_ushort *)src;
+    for( size_t i = 0; i < channelCount; i++ )
+        dst[ i ] = convert_half_to_float( dPtr[ i ] );
+}
+
+static void decode_unorm_short_565( const void *src, size_t channelCount, float *dst )
+{
+    cl_ushort dPtr = *(const cl_ushort *)src;
+    dst[ 0 ] = (float)( dPtr >> 11 ) / (float)31;
+    dst[ 1 ] = (float)( ( dPtr >> 5 ) & 63 ) / (float)63;
+    dst[ 2 ] = (float)( dPtr & 31 ) / (float)31;
+}
+
+static void decode_unorm_short_555( const void *src, size_t channelCount, float *dst )
+{
+    cl_ushort dPtr = *(const cl_ushort *)src;
+    dst[ 0 ] = (float)( ( dPtr >> 10 ) & 31 ) / (float)31;
+    dst[ 1 ] = (float)( ( dPtr >> 5 ) & 31 ) / (float)31;
+    dst[ 2 ] = (float)( dPtr & 31 ) / (float)31;
+}
+
+static void decode_unorm_int_101010( const void *src, size_t channelCount, float *dst )
+{
+    cl_uint dPtr = *(const cl_uint *)src;
+    dst[ 0 ] = (float)( ( dPtr >> 20 ) & 0x3ff ) / (float)1023;
+    dst[ 1 ] = (float)( ( dPtr >> 10 ) & 0x3ff ) / (float)1023;
+    dst[ 2 ] = (float)( dPtr & 0x3ff ) / (float)1023;
+}
+
+static void set_swizzle( int *swizzle, int r, int g, int b, int a )
+{
+    swizzle[ 0 ] = r;
+    swizzle[ 1 ] = g;
+    swizzle[ 2 ] = b;
+    swizzle[ 3 ] = a;
+}
+
+ImagePixelAccessor::ImagePixelAccessor( image_descriptor *imageInfo, int lod )
+    : mImageInfo( imageInfo ), mLod( lod ), mDecode( NULL )
+{
+    cl_image_format *format = imageInfo->format;
+
+    // Size and pitches of the mip level, as read_image_pixel_float computes them
+    mWidth = imageInfo->width;
+    mHeight = imageInfo->height;
+    mDepth = imageInfo->depth;
+    if ( imageInfo->num_mip_levels > 1 )
+    {
+      switch(imageInfo->type)
+      {
+      case CL_MEM_OBJECT_IMAGE3D :
+        mDepth = ( imageInfo->depth >> lod ) ? ( imageInfo->depth >> lod ) : 1;
+      case CL_MEM_OBJECT_IMAGE2D :
+      case CL_MEM_OBJECT_IMAGE2D_ARRAY :
+        mHeight = ( imageInfo->height >> lod ) ? ( imageInfo->height >> lod ) : 1;
+      default :
+        mWidth = ( imageInfo->width >> lod ) ? ( imageInfo->width >> lod ) : 1;
+      }
+      mRowPitch = mWidth * get_pixel_size( format );
+      mSlicePitch = 0;
+      if ( imageInfo->type == CL_MEM_OBJECT_IMAGE1D_ARRAY )
+        mSlicePitch = mRowPitch;
+      else if ( imageInfo->type == CL_MEM_OBJECT_IMAGE3D || imageInfo->type == CL_MEM_OBJECT_IMAGE2D_ARRAY)
+        mSlicePitch = mRowPitch * mHeight;
+    }
+    else
+    {
+      mRowPitch = imageInfo->rowPitch;
+      mSlicePitch = imageInfo->slicePitch;
+    }
+
+    mPixelSize = get_pixel_size( format );
+    mChannelCount = get_format_channel_count( format );
+
+    // Border color
+    mDepthBorder = ( format->image_channel_order == CL_DEPTH );
+    mBorderColor[ 0 ] = mBorderColor[ 1 ] = mBorderColor[ 2 ] = mBorderColor[ 3 ] = 0;
+    if( !has_alpha( format ) )
+        mBorderColor[ 3 ] = alpha_is_x( format ) ? 0 : 1;
+
+    // Channel order. Orders that read_image_pixel_float treats specially and that are not listed here
+    // are left to it.
+    bool readableOrder = true;
+    switch( format->image_channel_order )
+    {
+        case CL_A:
+            set_swizzle( mReadSwizzle, kSwizzleZero, kSwizzleZero, kSwizzleZero, 0 );
+            break;
+        case CL_R:
+        case CL_Rx:
+        case CL_DEPTH:
+            set_swizzle( mReadSwizzle, 0, kSwizzleZero, kSwizzleZero, kSwizzleOne );
+            break;
+        case CL_RA:
+            set_swizzle( mReadSwizzle, 0, kSwizzleZero, kSwizzleZero, 1 );
+            break;
+        case CL_RG:
+        case CL_RGx:
+            set_swizzle( mReadSwizzle, 0, 1, kSwizzleZero, kSwizzleOne );
+            break;
+        case CL_RGB:
+        case CL_RGBx:
+        case CL_sRGB:
+        case CL_sRGBx:
+            set_swizzle( mReadSwizzle, 0, 1, 2, kSwizzleOne );
+            break;
+        case CL_RGBA:
+        case CL_sRGBA:
+            set_swizzle( mReadSwizzle, 0, 1, 2, 3 );
+            break;
+        case CL_ARGB:
+            set_swizzle( mReadSwizzle, 1, 2, 3, 0 );
+            break;
+        case CL_BGRA:
+        case CL_sBGRA:
+            set_swizzle( mReadSwizzle, 2, 1, 0, 3 );
+            break;
+        case CL_INTENSITY:
+            set_swizzle( mReadSwizzle, 0, 0, 0, 0 );
+            break;
+        case CL_LUMINANCE:
+            set_swizzle( mReadSwizzle, 0, 0, 0, kSwizzleOne );
+            break;
+#ifdef CL_1RGB_APPLE
+        case CL_1RGB_APPLE:
+            readableOrder = false;
+            break;
+#endif
+#ifdef CL_BGR1_APPLE
+        case CL_BGR1_APPLE:
+            readableOrder = false;
+            break;
+#endif
+        default:
+            readableOrder = false;
+            break;
+    }
+
+    bool srgb = is_sRGBA_order( format->image_channel_order );
+    switch( format->image_channel_data_type )
+    {
+        case CL_SNORM_INT8:
+            mDecode = decode_snorm_int8;
+            break;
+        case CL_UNORM_INT8:
+            mDecode = srgb ? decode_srgb_int8 : decode_unorm_int8;
+            break;
+        case CL_SIGNED_INT8:
+            mDecode = decode_integer<cl_char>;
+            break;
+        case CL_UNSIGNED_INT8:
+            mDecode = decode_integer<cl_uchar>;
+            break;
+        case CL_SNORM_INT16:
+            mDecode = decode_snorm_int16;
+            break;
+        case CL_UNORM_INT16:
+            mDecode = decode_unorm_int16;
+            break;
+        case CL_SIGNED_INT16:
+            mDecode = decode_integer<cl_short>;
+            break;
+        case CL_UNSIGNED_INT16:
+            mDecode = decode_integer<cl_ushort>;
+            break;
+        case CL_HALF_FLOAT:
+            mDecode = decode_half;
+            break;
+        case CL_SIGNED_INT32:
+            mDecode = decode_integer<cl_int>;
+            break;
+        case CL_UNSIGNED_INT32:
+            mDecode = decode_integer<cl_uint>;
+            break;
+        case CL_UNORM_SHORT_565:
+            mDecode = decode_unorm_short_565;
+            break;
+        case CL_UNORM_SHORT_555:
+            mDecode = decode_unorm_short_555;
+            break;
+        case CL_UNORM_INT_101010:
+            mDecode = decode_unorm_int_101010;
+            break;
+        case CL_FLOAT:
+            mDecode = decode_integer<cl_float>;
+            break;
+        default:
+            break;
+    }
+
+    if( !readableOrder )
+        mDecode = NULL;
+}
+
+static inline void apply_read_swizzle( const int *swizzle, const float *tempData, float *outData )
+{
+    for( int i = 0; i < 4; i++ )
+        outData[ i ] = swizzle[ i ] >= 0 ? tempData[ swizzle[ i ] ] : ( swizzle[ i ] == ImagePixelAccessor::kSwizzleZero ? 0.f : 1.f );
+}
+
+void ImagePixelAccessor::ReadPixel( void *imageData, int x, int y, int z, float *outData ) const
+{
+    if( mDecode == NULL )
+    {
+        read_image_pixel_float( imageData, mImageInfo, x, y, z, outData, mLod );
+        return;
+    }
+
+    if ( x < 0 || y < 0 || z < 0 || x >= (int)mWidth
+               || ( mHeight != 0 && y >= (int)mHeight )
+               || ( mDepth != 0 && z >= (int)mDepth )
+               || ( mImageInfo->arraySize != 0 && z >= (int)mImageInfo->arraySize ) )
+    {
+        if( mDepthBorder )
+            outData[ 0 ] = 0;
+        else
+            memcpy( outData, mBorderColor, sizeof( mBorderColor ) );
+        return;
+    }
+
+    char *ptr = (char *)imageData + z * mSlicePitch + y * mRowPitch + x * mPixelSize;
+    float tempData[ 4 ];
+    mDecode( ptr, mChannelCount, tempData );
+    apply_read_swizzle( mReadSwizzle, tempData, outData );
+}
+
 void pack_image_pixel_error( const float *srcVector, const cl_image_format *imageFormat, const void *results, float *errors )
 {
     size_t channelCount = get_format_channel_count( imageFormat );
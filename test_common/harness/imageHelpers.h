@@ -580,6 +580,14 @@ FloatPixel sample_image_pixel_float_offset( void *imageData, image_descriptor *i
                                            float x, float y, float z, float xAddressOffset, float yAddressOffset, float zAddressOffset,
                                            image_sampler_data *imageSampler, float *outData, int verbose, int *containsDenorms, int lod );
 
+// Same as above, but reads the texels through accessor, which must have been created for imageInfo and lod.
+// Verification loops should create the accessor once per image and lod, rather than once per sample.
+class ImagePixelAccessor;
+FloatPixel sample_image_pixel_float_offset( void *imageData, image_descriptor *imageInfo,
+                                           float x, float y, float z, float xAddressOffset, float yAddressOffset, float zAddressOffset,
+                                           image_sampler_data *imageSampler, float *outData, int verbose, int *containsDenorms, int lod,
+                                           const ImagePixelAccessor *accessor );
+
 
 extern void pack_image_pixel( unsigned int *srcVector, const cl_image_format *imageFormat, void *outData );
 extern void pack_image_pixel( int *srcVector, const cl_image_format *imageFormat, void *outData );
@@ -634,6 +642,35 @@ protected:
     size_t    mVecSize;
 };
 
+// Reads the pixels of one mip level of an image. The pitches, border color, channel decoder and
+// channel order swizzle are looked up once, when the accessor is created, rather than for every
+// pixel as read_image_pixel_float does, so create one per image and lod and reuse it. Results are
+// bitwise identical to read_image_pixel_float; formats without a specialized decoder fall back to it.
+class ImagePixelAccessor
+{
+public:
+    ImagePixelAccessor( image_descriptor *imageInfo, int lod = 0 );
+
+    // Same as read_image_pixel_float( imageData, imageInfo, x, y, z, outData, lod )
+    void        ReadPixel( void *imageData, int x, int y, int z, float *outData ) const;
+
+    typedef void (*DecodeFn)( const void *src, size_t channelCount, float *dst );
+
+    enum { kSwizzleZero = -1, kSwizzleOne = -2 };
+
+protected:
+
+    image_descriptor    *mImageInfo;
+    int                 mLod;
+    size_t              mWidth, mHeight, mDepth;
+    size_t              mRowPitch, mSlicePitch;
+    size_t              mPixelSize, mChannelCount;
+    DecodeFn            mDecode;            // NULL if reads are left to read_image_pixel_float
+    int                 mReadSwizzle[ 4 ];  // channel of the decoded pixel for each of RGBA, or kSwizzleZero / kSwizzleOne
+    float               mBorderColor[ 4 ];
+    bool                mDepthBorder;
+};
+
 extern int  DetectFloatToHalfRoundingMode( cl_command_queue );  // Returns CL_SUCCESS on success
 
 int inline is_half_nan( cl_ushort half ){ return (half & 0x7fff) > 0x7c00; }
@@ -641,6 +678,14 @@ int inline is_half_nan( cl_ushort half ){ return (half & 0x7fff) > 0x7c00; }
 cl_ushort convert_float_to_half( cl_float f );
 cl_float  convert_half_to_float( cl_ushort h );
 
+// Exhaustively checks the table driven half and sRGB conversions against the scalar reference code.
+// Returns the number of mismatches. This takes a minute or so.
+int verify_half_and_sRGB_conversions( void );
+
 extern double sRGBmap(float fc);
 
+// Table driven and bitwise identical to (unsigned char)( sRGBmap( fc ) + 0.5 ) and (float)sRGBunmap( c / 255.0f )
+extern cl_uchar sRGBmap_unorm8( float fc );
+extern float    sRGBunmap_unorm8( cl_uchar c );
+
 #endif // _imageHelpers_h
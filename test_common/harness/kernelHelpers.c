@@ -25,17 +25,60 @@
 #include <fstream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
 
 #if defined(__MINGW32__)
 #include "mingw_compat.h"
 #endif
 
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
 #if defined(_WIN32)
 std::string slash = "\\";
 #else
 std::string slash = "/";
 #endif
 
+static std::mutex gBuildTimeLock;
+static double gBuildSeconds = 0.0;
+static int gBuildsRunning = 0;
+static std::chrono::steady_clock::time_point gBuildsStart;
+
+double get_program_build_seconds(void)
+{
+    std::lock_guard<std::mutex> lock(gBuildTimeLock);
+    double seconds = gBuildSeconds;
+    if (gBuildsRunning)
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - gBuildsStart).count();
+    return seconds;
+}
+
+// Marks a program build from construction to destruction. gBuildSeconds grows by the wall time during which
+// at least one build is running, so builds on several threads at once are counted once.
+class BuildTimer
+{
+public:
+    BuildTimer()
+    {
+        std::lock_guard<std::mutex> lock(gBuildTimeLock);
+        if (gBuildsRunning++ == 0)
+            gBuildsStart = std::chrono::steady_clock::now();
+    }
+    ~BuildTimer()
+    {
+        std::lock_guard<std::mutex> lock(gBuildTimeLock);
+        if (--gBuildsRunning == 0)
+            gBuildSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - gBuildsStart).count();
+    }
+};
+
 std::string get_file_name(const std::string &baseName, int index, const std::string &extension)
 {
     std::ostringstream fileName;
@@ -356,7 +399,11 @@ int create_single_kernel_helper_create_program(cl_context context,
             // execute script
             log_info("Executing command: %s\n", runString.c_str());
             fflush(stdout);
-            int returnCode = system(runString.c_str());
+            int returnCode;
+            {
+                BuildTimer timer;
+                returnCode = system(runString.c_str());
+            }
             if (returnCode != 0)
             {
                 log_error("ERROR: Command finished with error: 0x%x\n", returnCode);
@@ -468,6 +515,405 @@ int create_single_kernel_helper_create_program(cl_context context,
     return 0;
 }
 
+// The program binary cache (-programCache <path>) stores the CL_PROGRAM_BINARIES of programs built from
+// source. Each entry is named after a hash of everything that can change the binary: the source, the
+// build options and the platform, device and driver versions. The full key is stored at the start of
+// the file and compared on load, so a hash collision is a miss rather than a wrong program.
+static std::string get_device_string(cl_device_id device, cl_device_info param)
+{
+    size_t size = 0;
+    if (clGetDeviceInfo(device, param, 0, NULL, &size) != CL_SUCCESS || size == 0)
+        return "";
+    std::vector<char> value(size);
+    if (clGetDeviceInfo(device, param, size, &value[0], NULL) != CL_SUCCESS)
+        return "";
+    return std::string(&value[0]);
+}
+
+static std::string get_platform_string(cl_platform_id platform, cl_platform_info param)
+{
+    size_t size = 0;
+    if (clGetPlatformInfo(platform, param, 0, NULL, &size) != CL_SUCCESS || size == 0)
+        return "";
+    std::vector<char> value(size);
+    if (clGetPlatformInfo(platform, param, size, &value[0], NULL) != CL_SUCCESS)
+        return "";
+    return std::string(&value[0]);
+}
+
+// 128-bit FNV-1a, as hi:lo. The prime is 2^88 + 0x13b, so the multiply is hash * 0x13b + (hash << 88).
+static void hash_program_cache_key(const std::string &key, cl_ulong *hi, cl_ulong *lo)
+{
+    cl_ulong h = 0x6c62272e07bb0142ULL;
+    cl_ulong l = 0x62b821756295c58dULL;
+    for (size_t i = 0; i < key.size(); i++)
+    {
+        l ^= (unsigned char)key[i];
+
+        // l * 0x13b as a 128-bit product, from the 32-bit halves of l
+        cl_ulong lowPart = (l & 0xffffffffULL) * 0x13b;
+        cl_ulong highPart = (l >> 32) * 0x13b;
+        cl_ulong productLo = lowPart + (highPart << 32);
+        cl_ulong productHi = (highPart >> 32) + (productLo < lowPart);
+
+        h = h * 0x13b + productHi + (l << 24);
+        l = productLo;
+    }
+    *hi = h;
+    *lo = l;
+}
+
+// Returns false if the program can't be cached, e.g. because the context has more than one device
+static bool get_program_cache_entry(cl_context context,
+                                    unsigned int numKernelLines,
+                                    const char **kernelProgram,
+                                    const char *buildOptions,
+                                    cl_device_id *device,
+                                    std::string &key,
+                                    std::string &fileName)
+{
+    cl_uint numDevices = 0;
+    if (clGetContextInfo(context, CL_CONTEXT_NUM_DEVICES, sizeof(numDevices), &numDevices, NULL) != CL_SUCCESS || numDevices != 1)
+        return false;
+    if (clGetContextInfo(context, CL_CONTEXT_DEVICES, sizeof(*device), device, NULL) != CL_SUCCESS)
+        return false;
+
+    cl_platform_id platform = NULL;
+    if (clGetDeviceInfo(*device, CL_DEVICE_PLATFORM, sizeof(platform), &platform, NULL) != CL_SUCCESS)
+        return false;
+
+    std::ostringstream header;
+    header << "platform: " << get_platform_string(platform, CL_PLATFORM_NAME) << "\n";
+    header << "platform version: " << get_platform_string(platform, CL_PLATFORM_VERSION) << "\n";
+    header << "device: " << get_device_string(*device, CL_DEVICE_NAME) << "\n";
+    header << "device version: " << get_device_string(*device, CL_DEVICE_VERSION) << "\n";
+    header << "driver version: " << get_device_string(*device, CL_DRIVER_VERSION) << "\n";
+    header << "options: " << (buildOptions ? buildOptions : "") << "\n";
+
+    std::string source;
+    for (unsigned int i = 0; i < numKernelLines; i++)
+        source += kernelProgram[i];
+    header << "source: " << source.size() << "\n";
+
+    // The key is length prefixed so that no key is a prefix of another
+    std::string body = header.str() + source;
+    std::ostringstream keyStream;
+    keyStream << "CL program cache 1 " << body.size() << "\n" << body;
+    key = keyStream.str();
+
+    cl_ulong hashHi, hashLo;
+    hash_program_cache_key(key, &hashHi, &hashLo);
+    std::ostringstream name;
+    name << std::hex << std::setfill('0') << std::setw(16) << hashHi << std::setw(16) << hashLo;
+    fileName = gProgramCachePath + slash + name.str() + ".bin";
+    return true;
+}
+
+// Returns NULL on a miss
+static cl_program load_cached_program(cl_context context, cl_device_id device, const std::string &key, const std::string &fileName)
+{
+    std::ifstream ifs(fileName.c_str(), std::ios::binary);
+    if (!ifs.good())
+        return NULL;
+    ifs.seekg(0, std::ios::end);
+    size_t length = static_cast<size_t>(ifs.tellg());
+    ifs.seekg(0, std::ios::beg);
+    if (length <= key.size())
+        return NULL;
+
+    std::vector<char> content(length);
+    ifs.read(&content[0], length);
+    if (!ifs.good() || memcmp(&content[0], key.data(), key.size()) != 0)
+        return NULL;
+
+    const unsigned char *binary = (const unsigned char *)&content[key.size()];
+    size_t binarySize = length - key.size();
+    cl_int binaryStatus = CL_SUCCESS;
+    cl_int error = CL_SUCCESS;
+    cl_program program = clCreateProgramWithBinary(context, 1, &device, &binarySize, &binary, &binaryStatus, &error);
+    if (program != NULL && (error != CL_SUCCESS || binaryStatus != CL_SUCCESS))
+    {
+        clReleaseProgram(program);
+        program = NULL;
+    }
+    return program;
+}
+
+// Failures are not errors, the next run just rebuilds the program
+static void store_cached_program(cl_program program, const std::string &key, const std::string &fileName)
+{
+    size_t binarySize = 0;
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(binarySize), &binarySize, NULL) != CL_SUCCESS || binarySize == 0)
+        return;
+
+    std::vector<unsigned char> binary(binarySize);
+    unsigned char *binaries[] = { &binary[0] };
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(binaries), binaries, NULL) != CL_SUCCESS)
+        return;
+
+    // Write to a file of our own and rename it into place, so that concurrent runs never see a partial entry
+    std::ostringstream tempName;
+#if defined(_WIN32)
+    tempName << fileName << "." << _getpid() << "." << (void *)&binarySize << ".tmp";
+#else
+    tempName << fileName << "." << getpid() << "." << (void *)&binarySize << ".tmp";
+#endif
+    {
+        std::ofstream ofs(tempName.str().c_str(), std::ios::binary);
+        if (!ofs.good())
+        {
+            log_info("Program cache: can't create %s\n", tempName.str().c_str());
+            return;
+        }
+        ofs.write(key.data(), key.size());
+        ofs.write((const char *)&binary[0], binarySize);
+        if (!ofs.good())
+        {
+            ofs.close();
+            remove(tempName.str().c_str());
+            return;
+        }
+    }
+    if (rename(tempName.str().c_str(), fileName.c_str()) != 0)
+        remove(tempName.str().c_str());
+}
+
+// Remove offline-compiler-only build options
+static std::string remove_offline_compiler_options(const char *buildOptions)
+{
+    std::string newBuildOptions;
+    if (buildOptions != NULL)
+    {
+        newBuildOptions = buildOptions;
+        std::string offlineCompierOptions[] = {
+            "-cl-fp16-enable",
+            "-cl-fp64-enable",
+            "-cl-zero-init-local-mem-vars"
+        };
+        for(auto& s : offlineCompierOptions)
+        {
+            std::string::size_type i = newBuildOptions.find(s);
+            if (i != std::string::npos)
+                newBuildOptions.erase(i, s.length());
+        }
+    }
+    return newBuildOptions;
+}
+
+// Programs prefetched for the next tests. Each test writes the names of the cache entries it used to
+// <programCache>/<test name>.programs; before the test runs again, prefetch_test_programs reads that
+// list and calls clBuildProgram with a callback for every entry, so drivers that build asynchronously
+// compile them concurrently while the previous test runs.
+struct PrefetchedProgram
+{
+    cl_context      context;
+    cl_device_id    device;
+    std::string     key;
+    cl_program      program;
+    bool            fromSource;     // built from source because the binary was missing or stale
+    bool            done;           // set once the build finished, under gPrefetchLock
+    cl_int          status;
+};
+
+static std::mutex gPrefetchLock;
+static std::condition_variable gPrefetchDone;       // signalled whenever a prefetched build finishes
+static std::vector<PrefetchedProgram *> gPrefetchedPrograms;
+static std::vector<std::string> gTestPrograms;      // cache entries used by the running test
+
+static void record_test_program(const std::string &fileName)
+{
+    std::string entry = fileName.substr(fileName.find_last_of(slash) + 1);
+    std::lock_guard<std::mutex> lock(gPrefetchLock);
+    if (std::find(gTestPrograms.begin(), gTestPrograms.end(), entry) == gTestPrograms.end())
+        gTestPrograms.push_back(entry);
+}
+
+static void CL_CALLBACK prefetch_build_done(cl_program program, void *user_data)
+{
+    PrefetchedProgram *prefetched = (PrefetchedProgram *)user_data;
+    cl_build_status buildStatus = CL_BUILD_ERROR;
+    clGetProgramBuildInfo(program, prefetched->device, CL_PROGRAM_BUILD_STATUS, sizeof(buildStatus), &buildStatus, NULL);
+    std::lock_guard<std::mutex> lock(gPrefetchLock);
+    prefetched->status = buildStatus == CL_BUILD_SUCCESS ? CL_SUCCESS : CL_BUILD_PROGRAM_FAILURE;
+    prefetched->done = true;
+    gPrefetchDone.notify_all();
+}
+
+static void wait_for_prefetched_program(PrefetchedProgram *prefetched)
+{
+    std::unique_lock<std::mutex> lock(gPrefetchLock);
+    gPrefetchDone.wait(lock, [prefetched] { return prefetched->done; });
+}
+
+static void release_prefetched_program(PrefetchedProgram *prefetched)
+{
+    wait_for_prefetched_program(prefetched);
+    clReleaseProgram(prefetched->program);
+    delete prefetched;
+}
+
+// Returns the prefetched program for key, or NULL if there is none or its build failed
+static cl_program take_prefetched_program(cl_context context, const std::string &key, bool *fromSource)
+{
+    PrefetchedProgram *prefetched = NULL;
+    {
+        std::lock_guard<std::mutex> lock(gPrefetchLock);
+        for (size_t i = 0; i < gPrefetchedPrograms.size(); i++)
+        {
+            if (gPrefetchedPrograms[i]->context == context && gPrefetchedPrograms[i]->key == key)
+            {
+                prefetched = gPrefetchedPrograms[i];
+                gPrefetchedPrograms.erase(gPrefetchedPrograms.begin() + i);
+                break;
+            }
+        }
+    }
+    if (prefetched == NULL)
+        return NULL;
+
+    wait_for_prefetched_program(prefetched);
+    if (prefetched->status != CL_SUCCESS)
+    {
+        release_prefetched_program(prefetched);
+        return NULL;
+    }
+
+    cl_program program = prefetched->program;
+    *fromSource = prefetched->fromSource;
+    delete prefetched;
+    return program;
+}
+
+// Parse the build options and source back out of a cache key written by get_program_cache_entry
+static bool parse_program_cache_key(const std::string &key, std::string &options, std::string &source)
+{
+    std::string::size_type optionsStart = key.find("\noptions: ");
+    if (optionsStart == std::string::npos)
+        return false;
+    optionsStart += strlen("\noptions: ");
+    std::string::size_type optionsEnd = key.find("\nsource: ", optionsStart - 1);
+    if (optionsEnd == std::string::npos)
+        return false;
+    options = key.substr(optionsStart, optionsEnd - optionsStart);
+
+    std::string::size_type sourceStart = key.find('\n', optionsEnd + 1);
+    if (sourceStart == std::string::npos)
+        return false;
+    source = key.substr(sourceStart + 1);
+    return source.size() == strtoul(key.c_str() + optionsEnd + strlen("\nsource: "), NULL, 10);
+}
+
+static void prefetch_program(cl_context context, const std::string &entry)
+{
+    std::vector<char> content = get_file_content(gProgramCachePath + slash + entry);
+    std::string::size_type headerEnd = std::string(content.begin(), content.end()).find('\n');
+    if (headerEnd == std::string::npos)
+        return;
+    std::string header(content.begin(), content.begin() + headerEnd);
+    size_t bodySize = 0;
+    if (sscanf(header.c_str(), "CL program cache 1 %zu", &bodySize) != 1 || headerEnd + 1 + bodySize > content.size())
+        return;
+    std::string storedKey(content.begin(), content.begin() + headerEnd + 1 + bodySize);
+
+    std::string options, source;
+    if (!parse_program_cache_key(storedKey, options, source))
+        return;
+
+    // The stored key no longer matches if the driver was updated, the program then has to be built from source
+    PrefetchedProgram *prefetched = new PrefetchedProgram();
+    const char *sourcePtr = source.c_str();
+    std::string fileName;
+    if (!get_program_cache_entry(context, 1, &sourcePtr, options.empty() ? NULL : options.c_str(),
+                                 &prefetched->device, prefetched->key, fileName))
+    {
+        delete prefetched;
+        return;
+    }
+
+    prefetched->context = context;
+    prefetched->program = NULL;
+    if (prefetched->key == storedKey)
+        prefetched->program = load_cached_program(context, prefetched->device, prefetched->key, fileName);
+    if (prefetched->program == NULL)
+    {
+        cl_int error = CL_SUCCESS;
+        prefetched->fromSource = true;
+        prefetched->program = clCreateProgramWithSource(context, 1, &sourcePtr, NULL, &error);
+        if (prefetched->program == NULL || error != CL_SUCCESS)
+        {
+            delete prefetched;
+            return;
+        }
+    }
+
+    std::string buildOptions = remove_offline_compiler_options(options.c_str());
+    prefetched->done = false;
+    if (clBuildProgram(prefetched->program, 1, &prefetched->device, buildOptions.c_str(), prefetch_build_done, prefetched) != CL_SUCCESS)
+    {
+        // The callback is not called when clBuildProgram fails up front
+        prefetched->status = CL_BUILD_PROGRAM_FAILURE;
+        prefetched->done = true;
+    }
+
+    std::lock_guard<std::mutex> lock(gPrefetchLock);
+    gPrefetchedPrograms.push_back(prefetched);
+}
+
+void prefetch_test_programs(cl_context context, const char *testName)
+{
+    if (gProgramCachePath.empty() || gOfflineCompiler || context == NULL)
+        return;
+
+    std::ifstream ifs((gProgramCachePath + slash + testName + ".programs").c_str());
+    std::string entry;
+    while (std::getline(ifs, entry))
+    {
+        if (!entry.empty())
+            prefetch_program(context, entry);
+    }
+}
+
+void begin_test_programs(void)
+{
+    std::lock_guard<std::mutex> lock(gPrefetchLock);
+    gTestPrograms.clear();
+}
+
+void release_prefetched_programs(cl_context context)
+{
+    std::vector<PrefetchedProgram *> unused;
+    {
+        std::lock_guard<std::mutex> lock(gPrefetchLock);
+        for (size_t i = 0; i < gPrefetchedPrograms.size(); )
+        {
+            if (gPrefetchedPrograms[i]->context == context)
+            {
+                unused.push_back(gPrefetchedPrograms[i]);
+                gPrefetchedPrograms.erase(gPrefetchedPrograms.begin() + i);
+            }
+            else
+                i++;
+        }
+    }
+    for (size_t i = 0; i < unused.size(); i++)
+        release_prefetched_program(unused[i]);
+}
+
+void finish_test_programs(const char *testName)
+{
+    if (gProgramCachePath.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(gPrefetchLock);
+    if (gTestPrograms.empty())
+        return;
+    std::string fileName = gProgramCachePath + slash + testName + ".programs";
+    std::ofstream ofs(fileName.c_str());
+    for (size_t i = 0; i < gTestPrograms.size(); i++)
+        ofs << gTestPrograms[i] << "\n";
+    gTestPrograms.clear();
+}
+
 int create_single_kernel_helper_with_build_options(cl_context context,
                                                    cl_program *outProgram,
                                                    cl_kernel *outKernel,
@@ -491,6 +937,14 @@ int create_single_kernel_helper(cl_context context,
                                 const bool openclCXX)
 {
     int error;
+    std::string newBuildOptions = remove_offline_compiler_options(buildOptions);
+
+    // Look the program up in the program binary cache
+    cl_device_id cacheDevice = NULL;
+    std::string cacheKey, cacheFileName;
+    bool useCache = !openclCXX && !gOfflineCompiler && !gProgramCachePath.empty() &&
+                    get_program_cache_entry(context, numKernelLines, kernelProgram, buildOptions, &cacheDevice, cacheKey, cacheFileName);
+
     // Create OpenCL C++ program
     if(openclCXX)
     {
@@ -525,6 +979,57 @@ int create_single_kernel_helper(cl_context context,
     // Create OpenCL C program
     else
     {
+        if (useCache)
+        {
+            record_test_program(cacheFileName);
+
+            bool fromSource = false;
+            *outProgram = take_prefetched_program(context, cacheKey, &fromSource);
+            if (*outProgram != NULL)
+            {
+                if (fromSource)
+                    store_cached_program(*outProgram, cacheKey, cacheFileName);
+                if (kernelName != NULL)
+                {
+                    *outKernel = clCreateKernel(*outProgram, kernelName, &error);
+                    if (*outKernel == NULL || error != CL_SUCCESS)
+                    {
+                        print_error(error, "Unable to create kernel");
+                        return error;
+                    }
+                }
+                return CL_SUCCESS;
+            }
+
+            *outProgram = load_cached_program(context, cacheDevice, cacheKey, cacheFileName);
+            if (*outProgram != NULL)
+            {
+                cl_int buildError;
+                {
+                    BuildTimer timer;
+                    buildError = clBuildProgram(*outProgram, 0, NULL, newBuildOptions.c_str(), NULL, NULL);
+                }
+                if (buildError == CL_SUCCESS)
+                {
+                    if (kernelName != NULL)
+                    {
+                        *outKernel = clCreateKernel(*outProgram, kernelName, &error);
+                        if (*outKernel == NULL || error != CL_SUCCESS)
+                        {
+                            print_error(error, "Unable to create kernel");
+                            return error;
+                        }
+                    }
+                    return CL_SUCCESS;
+                }
+
+                // The driver no longer accepts this binary, build from source and replace it
+                log_info("Program cache: rebuilding stale entry %s\n", cacheFileName.c_str());
+                clReleaseProgram(*outProgram);
+                *outProgram = NULL;
+            }
+        }
+
         error = create_single_kernel_helper_create_program(
             context, outProgram, numKernelLines, kernelProgram, buildOptions
         );
@@ -534,27 +1039,13 @@ int create_single_kernel_helper(cl_context context,
             return error;
         }
     }
-    // Remove offline-compiler-only build options
-    std::string newBuildOptions;
-    if (buildOptions != NULL)
-    {
-        newBuildOptions = buildOptions;
-        std::string offlineCompierOptions[] = {
-            "-cl-fp16-enable",
-            "-cl-fp64-enable",
-            "-cl-zero-init-local-mem-vars"
-        };
-        for(auto& s : offlineCompierOptions)
-        {
-            std::string::size_type i = newBuildOptions.find(s);
-            if (i != std::string::npos)
-                newBuildOptions.erase(i, s.length());
-        }
-    }
     // Build program and create kernel
-    return build_program_create_kernel_helper(
+    error = build_program_create_kernel_helper(
         context, outProgram, outKernel, numKernelLines, kernelProgram, kernelName, newBuildOptions.c_str()
     );
+    if (error == CL_SUCCESS && useCache)
+        store_cached_program(*outProgram, cacheKey, cacheFileName);
+    return error;
 }
 
 // Creates OpenCL C++ program
@@ -594,7 +1085,10 @@ int build_program_create_kernel_helper(cl_context context,
     /* Compile the program */
     int buildProgramFailed = 0;
     int printedSource = 0;
-    error = clBuildProgram(*outProgram, 0, NULL, buildOptions, NULL, NULL);
+    {
+        BuildTimer timer;
+        error = clBuildProgram(*outProgram, 0, NULL, buildOptions, NULL, NULL);
+    }
     if (error != CL_SUCCESS)
     {
         unsigned int i;
@@ -104,6 +104,20 @@ int build_program_create_kernel_helper(cl_context context,
                                        const char *kernelName,
                                        const char *buildOptions = NULL);
 
+/* Program prefetching, used by the test harness when the program cache is enabled (-programCache).
+   finish_test_programs records which cache entries a test used; prefetch_test_programs starts building
+   the programs recorded for a test in its context, so create_single_kernel_helper finds them ready. It
+   may run on another thread than the test. release_prefetched_programs releases whatever the test did
+   not use and must be called before the context is released. */
+extern void prefetch_test_programs(cl_context context, const char *testName);
+extern void begin_test_programs(void);
+extern void finish_test_programs(const char *testName);
+extern void release_prefetched_programs(cl_context context);
+
+/* Wall-clock seconds so far during which at least one program build started by these helpers was running
+   (clBuildProgram or the offline compiler). Overlapping builds on several threads are counted once. */
+extern double get_program_build_seconds(void);
+
 /* Helper to obtain the biggest fit work group size for all the devices in a given group and for the given global thread size */
 extern int get_max_common_work_group_size( cl_context context, cl_kernel kernel, size_t globalThreadSize, size_t *outSize );
 
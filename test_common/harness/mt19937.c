@@ -46,6 +46,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "mt19937.h"
 #include "mingw_compat.h"
 
@@ -136,104 +137,116 @@ void    free_mtdata( MTdata d )
         align_free(d);
 }
 
-/* generates a random number on [0,0xffffffff]-interval */
-cl_uint genrand_int32( MTdata d)
-{
-    /* mag01[x] = x * MATRIX_A  for x=0,1 */
-    static const cl_uint mag01[2]={0x0UL, MATRIX_A};
+/* mag01[x] = x * MATRIX_A  for x=0,1 */
+static const cl_uint mag01[2]={0x0UL, MATRIX_A};
+
 #ifdef __SSE2__
-    static volatile int init = 0;
-    static union{ __m128i v; cl_uint s[4]; } upper_mask, lower_mask, one, matrix_a, c0, c1;
-#endif
+static volatile int init = 0;
+static union{ __m128i v; cl_uint s[4]; } upper_mask, lower_mask, one, matrix_a, c0, c1;
 
+/* Do the tempering of mt[] ahead of time in vector code */
+static void temper_cache( MTdata d )
+{
+    int kk;
+    for( kk = 0; kk + 4 <= N; kk += 4 )
+    {
+        __m128i vy = _mm_load_si128( (__m128i*)(d->mt + kk ) );                         // y = mt[k];
+        vy = _mm_xor_si128( vy, _mm_srli_epi32( vy, 11 ) );                             // y ^= (y >> 11);
+        vy = _mm_xor_si128( vy, _mm_and_si128( _mm_slli_epi32( vy, 7 ), c0.v) );        // y ^= (y << 7) & (cl_uint) 0x9d2c5680UL;
+        vy = _mm_xor_si128( vy, _mm_and_si128( _mm_slli_epi32( vy, 15 ), c1.v) );       // y ^= (y << 15) & (cl_uint) 0xefc60000UL;
+        vy = _mm_xor_si128( vy, _mm_srli_epi32( vy, 18 ) );                             // y ^= (y >> 18);
+        _mm_store_si128( (__m128i*)(d->cache+kk), vy );
+    }
+}
+#endif
 
+/* generate N words at one time */
+static void next_state( MTdata d )
+{
     cl_uint *mt = d->mt;
     cl_uint y;
-
-    if (d->mti == N)
-    { /* generate N words at one time */
-        int kk;
+    int kk;
 
 #ifdef __SSE2__
-        if( 0 == init )
-        {
-            upper_mask.s[0] = upper_mask.s[1] = upper_mask.s[2] = upper_mask.s[3] = UPPER_MASK;
-            lower_mask.s[0] = lower_mask.s[1] = lower_mask.s[2] = lower_mask.s[3] = LOWER_MASK;
-            one.s[0] = one.s[1] = one.s[2] = one.s[3] = 1;
-            matrix_a.s[0] = matrix_a.s[1] = matrix_a.s[2] = matrix_a.s[3] = MATRIX_A;
-            c0.s[0] = c0.s[1] = c0.s[2] = c0.s[3] = (cl_uint) 0x9d2c5680UL;
-            c1.s[0] = c1.s[1] = c1.s[2] = c1.s[3] = (cl_uint) 0xefc60000UL;
-            init = 1;
-        }
+    if( 0 == init )
+    {
+        upper_mask.s[0] = upper_mask.s[1] = upper_mask.s[2] = upper_mask.s[3] = UPPER_MASK;
+        lower_mask.s[0] = lower_mask.s[1] = lower_mask.s[2] = lower_mask.s[3] = LOWER_MASK;
+        one.s[0] = one.s[1] = one.s[2] = one.s[3] = 1;
+        matrix_a.s[0] = matrix_a.s[1] = matrix_a.s[2] = matrix_a.s[3] = MATRIX_A;
+        c0.s[0] = c0.s[1] = c0.s[2] = c0.s[3] = (cl_uint) 0x9d2c5680UL;
+        c1.s[0] = c1.s[1] = c1.s[2] = c1.s[3] = (cl_uint) 0xefc60000UL;
+        init = 1;
+    }
 #endif
 
-        kk = 0;
+    kk = 0;
 #ifdef __SSE2__
-        // vector loop
-        for( ; kk + 4 <= N-M; kk += 4 )
-        {
-            __m128i vy = _mm_or_si128(  _mm_and_si128( _mm_load_si128( (__m128i*)(mt + kk) ), upper_mask.v ),
-                                        _mm_and_si128( _mm_loadu_si128( (__m128i*)(mt + kk + 1) ), lower_mask.v ));        //  ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK))
-
-            __m128i mask = _mm_cmpeq_epi32( _mm_and_si128( vy, one.v), one.v );                                         // y & 1 ? -1 : 0
-            __m128i vmag01 = _mm_and_si128( mask, matrix_a.v );                                                         // y & 1 ? MATRIX_A, 0    =  mag01[y & (cl_uint) 0x1UL]
-            __m128i vr = _mm_xor_si128( _mm_loadu_si128( (__m128i*)(mt + kk + M)), (__m128i) _mm_srli_epi32( vy, 1 ) );    // mt[kk+M] ^ (y >> 1)
-            vr = _mm_xor_si128( vr, vmag01 );                                                                           // mt[kk+M] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL]
-            _mm_store_si128( (__m128i*) (mt + kk ), vr );
-        }
+    // vector loop
+    for( ; kk + 4 <= N-M; kk += 4 )
+    {
+        __m128i vy = _mm_or_si128(  _mm_and_si128( _mm_load_si128( (__m128i*)(mt + kk) ), upper_mask.v ),
+                                    _mm_and_si128( _mm_loadu_si128( (__m128i*)(mt + kk + 1) ), lower_mask.v ));        //  ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK))
+
+        __m128i mask = _mm_cmpeq_epi32( _mm_and_si128( vy, one.v), one.v );                                         // y & 1 ? -1 : 0
+        __m128i vmag01 = _mm_and_si128( mask, matrix_a.v );                                                         // y & 1 ? MATRIX_A, 0    =  mag01[y & (cl_uint) 0x1UL]
+        __m128i vr = _mm_xor_si128( _mm_loadu_si128( (__m128i*)(mt + kk + M)), (__m128i) _mm_srli_epi32( vy, 1 ) );    // mt[kk+M] ^ (y >> 1)
+        vr = _mm_xor_si128( vr, vmag01 );                                                                           // mt[kk+M] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL]
+        _mm_store_si128( (__m128i*) (mt + kk ), vr );
+    }
 #endif
-        for ( ;kk<N-M;kk++) {
-            y = (cl_uint) ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK));
-            mt[kk] = mt[kk+M] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL];
-        }
+    for ( ;kk<N-M;kk++) {
+        y = (cl_uint) ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK));
+        mt[kk] = mt[kk+M] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL];
+    }
 
 #ifdef __SSE2__
-        // advance to next aligned location
-        for (;kk<N-1 && (kk & 3);kk++) {
-            y = (cl_uint) ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK));
-            mt[kk] = mt[kk+(M-N)] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL];
-        }
+    // advance to next aligned location
+    for (;kk<N-1 && (kk & 3);kk++) {
+        y = (cl_uint) ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK));
+        mt[kk] = mt[kk+(M-N)] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL];
+    }
 
-        // vector loop
-        for( ; kk + 4 <= N-1; kk += 4 )
-        {
-            __m128i vy = _mm_or_si128(  _mm_and_si128( _mm_load_si128( (__m128i*)(mt + kk) ), upper_mask.v ),
-                                        _mm_and_si128( _mm_loadu_si128( (__m128i*)(mt + kk + 1) ), lower_mask.v ));        //  ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK))
-
-            __m128i mask = _mm_cmpeq_epi32( _mm_and_si128( vy, one.v), one.v );                                         // y & 1 ? -1 : 0
-            __m128i vmag01 = _mm_and_si128( mask, matrix_a.v );                                                         // y & 1 ? MATRIX_A, 0    =  mag01[y & (cl_uint) 0x1UL]
-            __m128i vr = _mm_xor_si128( _mm_loadu_si128( (__m128i*)(mt + kk + M - N)), _mm_srli_epi32( vy, 1 ) );          // mt[kk+M-N] ^ (y >> 1)
-            vr = _mm_xor_si128( vr, vmag01 );                                                                           // mt[kk+M] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL]
-            _mm_store_si128( (__m128i*) (mt + kk ), vr );
-        }
+    // vector loop
+    for( ; kk + 4 <= N-1; kk += 4 )
+    {
+        __m128i vy = _mm_or_si128(  _mm_and_si128( _mm_load_si128( (__m128i*)(mt + kk) ), upper_mask.v ),
+                                    _mm_and_si128( _mm_loadu_si128( (__m128i*)(mt + kk + 1) ), lower_mask.v ));        //  ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK))
+
+        __m128i mask = _mm_cmpeq_epi32( _mm_and_si128( vy, one.v), one.v );                                         // y & 1 ? -1 : 0
+        __m128i vmag01 = _mm_and_si128( mask, matrix_a.v );                                                         // y & 1 ? MATRIX_A, 0    =  mag01[y & (cl_uint) 0x1UL]
+        __m128i vr = _mm_xor_si128( _mm_loadu_si128( (__m128i*)(mt + kk + M - N)), _mm_srli_epi32( vy, 1 ) );          // mt[kk+M-N] ^ (y >> 1)
+        vr = _mm_xor_si128( vr, vmag01 );                                                                           // mt[kk+M] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL]
+        _mm_store_si128( (__m128i*) (mt + kk ), vr );
+    }
 #endif
 
-        for (;kk<N-1;kk++) {
-            y = (cl_uint) ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK));
-            mt[kk] = mt[kk+(M-N)] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL];
-        }
-        y = (cl_uint)((mt[N-1]&UPPER_MASK)|(mt[0]&LOWER_MASK));
-        mt[N-1] = mt[M-1] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL];
+    for (;kk<N-1;kk++) {
+        y = (cl_uint) ((mt[kk]&UPPER_MASK)|(mt[kk+1]&LOWER_MASK));
+        mt[kk] = mt[kk+(M-N)] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL];
+    }
+    y = (cl_uint)((mt[N-1]&UPPER_MASK)|(mt[0]&LOWER_MASK));
+    mt[N-1] = mt[M-1] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL];
 
 #ifdef __SSE2__
-        // Do the tempering ahead of time in vector code
-        for( kk = 0; kk + 4 <= N; kk += 4 )
-        {
-            __m128i vy = _mm_load_si128( (__m128i*)(mt + kk ) );                            // y = mt[k];
-            vy = _mm_xor_si128( vy, _mm_srli_epi32( vy, 11 ) );                             // y ^= (y >> 11);
-            vy = _mm_xor_si128( vy, _mm_and_si128( _mm_slli_epi32( vy, 7 ), c0.v) );        // y ^= (y << 7) & (cl_uint) 0x9d2c5680UL;
-            vy = _mm_xor_si128( vy, _mm_and_si128( _mm_slli_epi32( vy, 15 ), c1.v) );       // y ^= (y << 15) & (cl_uint) 0xefc60000UL;
-            vy = _mm_xor_si128( vy, _mm_srli_epi32( vy, 18 ) );                             // y ^= (y >> 18);
-            _mm_store_si128( (__m128i*)(d->cache+kk), vy );
-        }
+    temper_cache( d );
 #endif
 
-        d->mti = 0;
-    }
+    d->mti = 0;
+}
+
+/* generates a random number on [0,0xffffffff]-interval */
+cl_uint genrand_int32( MTdata d)
+{
+    cl_uint y;
+
+    if (d->mti == N)
+        next_state( d );
+
 #ifdef __SSE2__
     y = d->cache[d->mti++];
 #else
-    y = mt[d->mti++];
+    y = d->mt[d->mti++];
 
     /* Tempering */
     y ^= (y >> 11);
@@ -246,6 +259,221 @@ cl_uint genrand_int32( MTdata d)
     return y;
 }
 
+/* fills out[0..count-1] with the next count values of genrand_int32 */
+void genrand_fill_u32( MTdata d, cl_uint *out, size_t count )
+{
+    while( count )
+    {
+        size_t n;
+
+        if (d->mti == N)
+            next_state( d );
+
+        n = N - d->mti;
+        if( n > count )
+            n = count;
+
+#ifdef __SSE2__
+        memcpy( out, d->cache + d->mti, n * sizeof( cl_uint ) );
+#else
+        {
+            const cl_uint *mt = d->mt + d->mti;
+            size_t k;
+            for( k = 0; k < n; k++ )
+            {
+                cl_uint y = mt[k];
+
+                /* Tempering */
+                y ^= (y >> 11);
+                y ^= (y << 7) & (cl_uint) 0x9d2c5680UL;
+                y ^= (y << 15) & (cl_uint) 0xefc60000UL;
+                y ^= (y >> 18);
+                out[k] = y;
+            }
+        }
+#endif
+
+        d->mti += (cl_int) n;
+        out += n;
+        count -= n;
+    }
+}
+
+/*
+ *  Jump ahead
+ *
+ *  The state update is linear over GF(2), so advancing the generator by J steps is the same as
+ *  evaluating q(F) on the state, where F is the one word state transition and q(x) = x^J mod P(x),
+ *  P being the characteristic polynomial of MT19937. See Haramoto et al., "Efficient Jump Ahead for
+ *  F2-Linear Random Number Generators". q(x) for J = 2^64 is precomputed below; bit i of the table
+ *  is the coefficient of x^i.
+ */
+static const cl_uint jump_poly_2_64[N] = {
+    0x4c900f63, 0xe248a4cd, 0x75555aad, 0x02c5e162, 0x775322f2, 0xcc7bdd4b, 0xb071299b, 0xff847763,
+    0x54b43fbf, 0x2dcb3bfb, 0x5fcb8c34, 0xe20b4cef, 0xe2f9e066, 0x53addb77, 0x3fd01081, 0x8b338d5e,
+    0xfe42e658, 0xd91e533a, 0x6795d7ab, 0x67f86694, 0x7ba281b4, 0xb29b5434, 0x669bafb9, 0x994909c5,
+    0x6230ab31, 0x9358444c, 0x14341071, 0xc3a7858f, 0x675b2dd2, 0x2d1e088c, 0x8649eb5e, 0x41bcbedd,
+    0x90116aee, 0x47de650f, 0x8b5a7d3e, 0x08e74650, 0x1d6d8688, 0xf0495cfb, 0x3ffa7ec4, 0xa1fec000,
+    0x303bd030, 0x83d63538, 0x583e3fa3, 0x077fdaef, 0x0bb4f1ef, 0x21f80583, 0xc44df85c, 0x873a5d43,
+    0x4c18f526, 0xe981be93, 0x7bf02815, 0xd95d2fa7, 0xb1ddba06, 0x4f52cb02, 0xae86e7bf, 0x23156bfb,
+    0x15db9670, 0xed5b6b38, 0xe5ffdd1d, 0x6608c09d, 0xb0f29645, 0x87d4b039, 0x7775ae02, 0xb370a1a9,
+    0x47986568, 0xc6a6464c, 0xf304978d, 0xe2b2d815, 0x15cb3159, 0xd89aaa5b, 0x17439b18, 0x37969348,
+    0xe7cd403e, 0xe27dba9b, 0xade001a8, 0x49502803, 0x7d161005, 0x6300bd73, 0x76a4c88b, 0x7ee8b962,
+    0x2647a4c1, 0x77fef87e, 0x7be21372, 0x0f9c923e, 0xa6e0b548, 0x9b618fe8, 0xdae91cf5, 0xa284f483,
+    0x070f14b0, 0xb67b9f26, 0x33809a23, 0x93bece6c, 0x30f58808, 0x65e268f8, 0x25bd5588, 0x94628de0,
+    0xce5b2d08, 0x4eac9219, 0xd5482eb5, 0xbdc27b2f, 0x37cd85ac, 0xa696a9f4, 0x0ba18097, 0x9cfbc28d,
+    0xe2d8d1d2, 0x2de7c4d5, 0x926ef804, 0xf1d29bdd, 0xe8019c4b, 0xc54262b9, 0xbc8f76f7, 0x10033bf8,
+    0xb5966524, 0x6c62cbba, 0xc6598499, 0xf1c9975f, 0xdc52d11d, 0x02295d93, 0x923b6811, 0xa06ea369,
+    0x331d5bad, 0x50dacd95, 0x186e30df, 0x0f2787c9, 0xea1e6941, 0x25ca723a, 0x04764cc9, 0x1b38c599,
+    0x0efaf769, 0x0e882a64, 0x67ab43ff, 0x2c07de2c, 0x4047a8d7, 0x6a4e6204, 0x4b0f81de, 0x9e50e39b,
+    0xbd96c036, 0xce36794f, 0xe84dafd5, 0x3a8d8d7b, 0xc5cba176, 0x30bc102c, 0xce93dbf9, 0x6dcc2704,
+    0x697c8140, 0xa4039ada, 0x957299e8, 0x3edfba6e, 0x721622be, 0x4526e870, 0x2a0cacfe, 0x5bc71910,
+    0xb52142db, 0xb1b32c82, 0x381814d2, 0x816f9d8c, 0xfd6b3731, 0x9f59cc3e, 0xebfd2dfa, 0x6be77cdb,
+    0xd2870108, 0xa21b0fb7, 0x0507c199, 0x88155c26, 0x7d0cf5e3, 0xe0990dc6, 0x415482a7, 0x9842027b,
+    0xf6f21a2e, 0x8ec8063b, 0xa512e19b, 0x0ca3c754, 0x0f37f158, 0xe60b8a5b, 0xc43f6ce4, 0x3d1dbe43,
+    0xf3b1f4bc, 0x853ac8b5, 0xf5849b5c, 0xbc6b9349, 0xb9269ddd, 0xeee13d2a, 0xd4a643d0, 0xec1b7b91,
+    0x71a29981, 0xab378fc9, 0x888b055d, 0x256bd757, 0x6fdfe309, 0x84e868c9, 0x5f9a5801, 0xae118d8b,
+    0xc0e498c3, 0x39c33c41, 0x1645526f, 0x9c8a68df, 0xfad14f7d, 0x93f5ac29, 0x6546e3cb, 0xa62e2fd3,
+    0xd731bb47, 0x89e78998, 0x90d44d69, 0xa43bffaf, 0x72226472, 0x0d95beb0, 0x2fbca613, 0x455441e7,
+    0x02c39885, 0xd56aaed5, 0xa9ffad44, 0x4a8bdece, 0xa2e37cef, 0xa8e0152e, 0x37532471, 0xa55abe6a,
+    0xda2580fd, 0xad89bf65, 0xcc2a3dec, 0x7ec360b1, 0xc1f52676, 0x3c4ae863, 0x088f2b9e, 0xe7c47ea0,
+    0x80101c06, 0x69b35de1, 0x0fb8e1fa, 0xdb62d3f7, 0x475cba2a, 0xb1507762, 0x9b30ad26, 0xe9094581,
+    0xfea6ac93, 0x6def9364, 0xe86cbc87, 0x9462f53f, 0x41907f1e, 0x40e02bba, 0x0bdb91a2, 0x93cc884a,
+    0x399d4499, 0x9e66cba2, 0x1b91f776, 0xfaf29945, 0x04c72d6f, 0x7a599a2f, 0x1c249235, 0x4f0432ce,
+    0x293afeb2, 0x5d41d6d8, 0x7f1e8c00, 0x7677224f, 0x231c2121, 0x6b228fa3, 0xc4a6232d, 0xaa196a04,
+    0xe297285e, 0x5396936f, 0xdb8d384f, 0x78ddefaf, 0x49a235d1, 0x5742fc47, 0xf43212cb, 0x415f3088,
+    0xb73bd17b, 0x15bc30d1, 0x5fc9b71a, 0xc5dcb8bb, 0x05ae1d2c, 0x1460f680, 0xd696d1e0, 0xda2c4681,
+    0x6cf86b69, 0x512d7565, 0x775e98b7, 0x166d0f83, 0x0e55f238, 0x2d3edf2b, 0xf26af179, 0xe839f1f4,
+    0x1a858d2f, 0x6c129576, 0x41dd69ae, 0xf290c59b, 0x9bbc0ba4, 0x504b9c71, 0x87492c1f, 0x5fee67d4,
+    0x90078f7e, 0x4f3d6ae8, 0x461f3a63, 0x5a3ce52b, 0xf0e76abd, 0x65f1a23b, 0x28cca53f, 0xbb141418,
+    0x0add6cb2, 0x5e2bbe79, 0x4dcc0078, 0xb68fc91e, 0xca0013f1, 0xac64ca4f, 0x691fddd7, 0xe7d10431,
+    0xd92c0753, 0xe86a25f7, 0x5a461809, 0xef3320d3, 0x65b41bdf, 0x4e76e28b, 0x59d977dc, 0x4a01d87c,
+    0xfa9fd02d, 0xf29e02d5, 0x1db02d91, 0xb44fbc42, 0x86411ddf, 0x9a6b3f1c, 0xa6cf8c46, 0x35012893,
+    0x8b855699, 0xd3ee76fd, 0x3cbbfbd4, 0x16a5985c, 0x6a0ae8d5, 0x18847417, 0xbfc1110b, 0xf56822cf,
+    0x6d70d28d, 0x10f92574, 0xf18dcd35, 0xa089b795, 0x75dc1450, 0x8516795a, 0x4848e61d, 0x8a635702,
+    0x6f483f4f, 0x4eca3ef1, 0xa4c13207, 0x38b2aca4, 0x5e44190f, 0x9cc2d2e9, 0x7786a96e, 0xe30ebc81,
+    0x44959f76, 0xb5b659af, 0x725f717f, 0x700f6c1f, 0x1b4504bf, 0x75a3b6d1, 0x62dee734, 0x295ac88a,
+    0x20855e36, 0x98963dcb, 0xc9b21ca4, 0xaf120eeb, 0x8c429af4, 0x6a8d016f, 0xd2f60b19, 0x641df9d8,
+    0xf1364e2b, 0xe4305d1f, 0xfeed5c19, 0xfee5b1d0, 0x4ef7a165, 0x3f54b57c, 0x46cf7905, 0xf36669a7,
+    0x68798550, 0x0f6b7150, 0xd237fcae, 0x23615cbb, 0x9a91c20f, 0x3d63ccbe, 0xd68b5562, 0x84fc17df,
+    0x1913e423, 0x231357a9, 0x6fdc5382, 0xeaaed948, 0x4b0881fc, 0x5617e641, 0xee52947d, 0x16d86236,
+    0x8cbc11fc, 0x7fdb870b, 0x50b6f9d4, 0x47491ac6, 0xbb79ca1a, 0x15272d87, 0xd0ca7ec3, 0xbf094ca5,
+    0x93f2ca6c, 0xb99feb61, 0xb3b6122a, 0xe6451411, 0xe708fed4, 0x8ae9ddb8, 0xfae77a3e, 0xb87bc4fc,
+    0x38839d5c, 0x756264e5, 0xbdc43032, 0xa758307f, 0x070adfa6, 0xe6eac433, 0xc5a37f43, 0xcda88b18,
+    0xe4d4cd3a, 0x89253009, 0xaff05ff6, 0xfd0fba0b, 0x4935461b, 0x756d1c49, 0x1367c444, 0xabca2abd,
+    0x21474f38, 0x37949cec, 0xf6323d3d, 0xb7cda569, 0xde01958e, 0x8dd8b80d, 0x00c355b9, 0xab317115,
+    0xf9e5d127, 0x150f3c15, 0xa73a49a8, 0x9a0dbb6f, 0x95080193, 0x4b304002, 0x87749f7a, 0xa6a3653a,
+    0xc1dbf50a, 0x14539309, 0xadf8d6c2, 0xfd743599, 0x0d51bf45, 0x94e2ba74, 0x98624e76, 0xe15c57a3,
+    0x6125aec8, 0xddfa32b9, 0x75b67b0f, 0x469ace66, 0x01abdab4, 0x50b3b5b6, 0x00b0e85b, 0xbb1b7ae1,
+    0xd6b52b08, 0x604f2a45, 0x061081ab, 0xf40cbde5, 0x54eba670, 0xf29c6626, 0x3be4b068, 0x74f2bc55,
+    0x1e31fc36, 0x077e35a6, 0xc92288e1, 0x70c92e17, 0x0f071907, 0xaed3a539, 0x35354b44, 0x116a44fc,
+    0xfb89895e, 0xd8c426ab, 0xefca9c61, 0x6a085ea2, 0x4a905b2c, 0x93583af1, 0xd8e56221, 0x977c1318,
+    0xf118add4, 0x5349a011, 0x8b6c9b1e, 0x6cfccedd, 0xabc7e67f, 0xb15fdb98, 0x5ef3dc9e, 0xa554a816,
+    0x11232427, 0x5fb8dff6, 0x45662685, 0x9b49e507, 0xcd009967, 0x0b955a98, 0x778e01c4, 0x6c9e13a6,
+    0x3167b338, 0x7974a19e, 0x66bceeeb, 0xa8bfcd35, 0x4f89c9d3, 0xe8dee989, 0xf8802348, 0xa61b2e07,
+    0x969a48f2, 0x32d550c2, 0xdc755365, 0x8ef0ab44, 0x50e48f6e, 0x4fc059ca, 0xcf4fbf2e, 0xebe837c5,
+    0x66a955cc, 0x8b33c56b, 0xd78e0a73, 0x90c2604f, 0x71db1d82, 0xde124fff, 0x78f30ba4, 0xa62c6e0e,
+    0xad72dd6a, 0x15c9b8ce, 0x4670f152, 0xaf42ad0f, 0xe6f8a792, 0x7c3eca52, 0x671d8003, 0x27f2396c,
+    0xf369c598, 0xb5511a05, 0xe792aa51, 0x3e40c35d, 0x4fdebf0b, 0x05a8ba07, 0x15d7d9c3, 0x5c75f817,
+    0x6cb1c6e1, 0xf769e5d1, 0xd20d8531, 0xa26b4d0d, 0xa91cdb5f, 0x90532c00, 0x400128bd, 0x70ea2cd4,
+    0x9c9b4320, 0xf6f962e9, 0x8d80ed7e, 0x296d79f9, 0xab8e062e, 0x2863459f, 0xde116573, 0x340ff74a,
+    0x9eb8522e, 0x86912edd, 0xbfddd205, 0x2e2efb3c, 0x3ce0ace4, 0xd8579cbf, 0x5cb1afb1, 0x9886f603,
+    0x23ec32e8, 0x35548503, 0x8b738a7c, 0x87dd0ce1, 0x669d9df9, 0x70330c59, 0x9263e2b7, 0xeb7c539f,
+    0x149893e2, 0x35bc025e, 0x547a177a, 0x72d3ae49, 0x85c4fea0, 0x7ccf0650, 0x710edc8d, 0xf8e109f2,
+    0xc105573c, 0x77a63a3d, 0x80c6b444, 0x78f7d5c0, 0xf741c57b, 0x431a5704, 0x5a3ffa09, 0x2efa4d31,
+    0xd945c460, 0xd4ad0e3e, 0x794d31ad, 0x3085a588, 0xbcfb9832, 0x903ce960, 0x1e66d62d, 0x3fda53bc,
+    0x5bdcf1d6, 0x383c9eb7, 0x411a11f9, 0x9581cebc, 0x8a46dd4c, 0x4f2e925c, 0x57fb207e, 0x126215f8,
+    0xf5ef34fa, 0xd8d98c17, 0x657a3b9c, 0x8bddb9fa, 0x27da1a8f, 0xa63fa026, 0x7b2682d6, 0x6273b291,
+    0x48b3213b, 0xf7ded422, 0x26ba215d, 0x30ec90ea, 0x257a9cf5, 0x0cbdd6c3, 0x29ea26c1, 0x4a542ebc,
+    0x2f70bad6, 0xb1d505fc, 0x77f48b79, 0x7e3c2bda, 0x5b1d3682, 0x669f1520, 0x0ab77d26, 0x71fd8207,
+    0x9d9efbfb, 0x1aaa1bd6, 0x883f5d32, 0x5e9cf61b, 0x03f0b0cb, 0x0e423384, 0x10a7a774, 0x00000000
+};
+
+/* mt[] as a ring buffer with the oldest word at mt[i] */
+typedef struct _MTring
+{
+    cl_uint mt[N];
+    int     i;
+}_MTring;
+
+/* advance the ring by one word */
+static void ring_step( _MTring *r )
+{
+    cl_uint *mt = r->mt;
+    int i = r->i;
+    int i1 = i + 1 < N ? i + 1 : i + 1 - N;
+    int iM = i + M < N ? i + M : i + M - N;
+    cl_uint y = (cl_uint) ((mt[i]&UPPER_MASK)|(mt[i1]&LOWER_MASK));
+    mt[i] = mt[iM] ^ (y >> 1) ^ mag01[y & (cl_uint) 0x1UL];
+    r->i = i1;
+}
+
+/* r ^= mt, where mt is a linear state with the oldest word at mt[0] */
+static void ring_add( _MTring *r, const cl_uint *mt )
+{
+    int k, j = 0;
+    for( k = r->i; k < N; k++ )
+        r->mt[k] ^= mt[j++];
+    for( k = 0; k < r->i; k++ )
+        r->mt[k] ^= mt[j++];
+}
+
+/* advances d by J words, where poly holds x^J mod P(x) */
+static void jump_state( MTdata d, const cl_uint *poly )
+{
+    _MTring *t = (_MTring*) malloc( sizeof( _MTring ) );
+    int k, deg = N * 32 - 1;
+
+    if( NULL == t )
+    {
+        fprintf( stderr, "ERROR: out of memory in MT19937 jump ahead\n" );
+        abort();
+    }
+
+    while( deg > 0 && 0 == (poly[deg >> 5] & (1U << (deg & 31))) )
+        deg--;
+
+    // After next_state, mt[] holds the ring state with the oldest word first and the unused words
+    // at mt[mti..N-1] are its newest. If next_state has not run yet (mti == N), none are pending.
+    // Either way the words pending after the jump are in the same place, so mti does not change.
+    //
+    // Horner's rule: q(F) s = F( ... F( F( q_deg s ) + q_deg-1 s ) ... ) + q_0 s
+    memset( t, 0, sizeof( *t ) );
+    for( k = deg; k >= 0; k-- )
+    {
+        ring_step( t );
+        if( poly[k >> 5] & (1U << (k & 31)) )
+            ring_add( t, d->mt );
+    }
+
+    for( k = 0; k < N; k++ )
+        d->mt[k] = t->mt[ (t->i + k) % N ];
+
+#ifdef __SSE2__
+    if( d->mti < N )
+        temper_cache( d );
+#endif
+
+    free( t );
+}
+
+void genrand_jump( MTdata d )
+{
+    jump_state( d, jump_poly_2_64 );
+}
+
+MTdata init_genrand_substream( MTdata d )
+{
+    MTdata r = (MTdata) align_malloc( sizeof( _MTdata ), 16 );
+    if( NULL != r )
+    {
+        memcpy( r, d, sizeof( _MTdata ) );
+        genrand_jump( r );
+    }
+
+    return r;
+}
+
 cl_ulong genrand_int64( MTdata d)
 {
     return ((cl_ulong) genrand_int32(d) << 32) | (cl_uint) genrand_int32(d);
@@ -55,6 +55,8 @@
     #include <CL/cl_platform.h>
 #endif
 
+#include <stddef.h>
+
 #ifdef __cplusplus
     extern "C" {
 #endif
@@ -76,6 +78,17 @@ void   free_mtdata( MTdata /*data*/ );
 /* generates a random number on [0,0xffffffff]-interval */
 cl_uint genrand_int32( MTdata /*data*/);
 
+/* fills out[0..count-1] with the next count values of genrand_int32, count may be any size */
+void genrand_fill_u32( MTdata /*data*/, cl_uint * /*out*/, size_t /*count*/ );
+
+/* advances the generator by 2^64 numbers, as if genrand_int32 had been called that many times */
+void genrand_jump( MTdata /*data*/ );
+
+/* Create a generator that starts 2^64 numbers after the current position of data, which is left
+   unchanged. Chaining these gives reproducible, non-overlapping per-thread substreams:
+       d[0] = init_genrand( seed ); d[i] = init_genrand_substream( d[i-1] );                     */
+MTdata init_genrand_substream( MTdata /*data*/ );
+
 /* generates a random number on [0,0xffffffffffffffffULL]-interval */
 cl_ulong genrand_int64( MTdata /*data*/);
 
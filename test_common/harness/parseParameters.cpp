@@ -24,6 +24,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <string.h>
+#include <stdlib.h>
 
 using namespace std;
 
@@ -31,6 +32,8 @@ bool             gOfflineCompiler = false;
 bool             gForceSpirVCache = false;
 bool             gForceSpirVGenerate = false;
 std::string      gSpirVPath = ".";
+std::string      gProgramCachePath;
+std::string      gTestReportPath;
 OfflineCompilerOutputType gOfflineCompilerOutputType;
 
 void helpInfo ()
@@ -41,6 +44,10 @@ void helpInfo ()
   log_info("  '                  output_type spir_v <mode:generate|cache> - \"../cl_build_script_spir_v.py\" is invoked, optional modes: generate, cache\n");
   log_info("  '                                     mode generate <path> - force binary generation\n");
   log_info("  '                                     mode cache <path> - force reading binary files from cache\n");
+  log_info("  '-programCache <path>': cache program binaries in <path> and reuse them across runs\n");
+  log_info("  '                  the CL_TEST_PROGRAM_CACHE environment variable may be used instead\n");
+  log_info("  '-testReport <path>': append per-test timing and resource use to <path>, as CSV if it ends in .csv,\n");
+  log_info("  '                  otherwise as one JSON object per line. CL_TEST_REPORT may be used instead\n");
   log_info("\n");
 }
 
@@ -48,6 +55,14 @@ int parseCustomParam (int argc, const char *argv[], const char *ignore)
 {
   int delArg = 0;
 
+  const char *cachePath = getenv("CL_TEST_PROGRAM_CACHE");
+  if (cachePath != NULL && gProgramCachePath.empty())
+      gProgramCachePath = cachePath;
+
+  const char *reportPath = getenv("CL_TEST_REPORT");
+  if (reportPath != NULL && gTestReportPath.empty())
+      gTestReportPath = reportPath;
+
   for (int i=1; i<argc; i++)
   {
     if(ignore != 0)
@@ -119,6 +134,38 @@ int parseCustomParam (int argc, const char *argv[], const char *ignore)
         }
     }
 
+    else if (!strcmp(argv[i], "-programCache"))
+    {
+        delArg = 1;
+        if ((i + 1) < argc)
+        {
+            gProgramCachePath = argv[i + 1];
+            delArg++;
+        }
+        else
+        {
+            log_error(" Program cache parameters are incorrect. Usage:\n");
+            log_error("       -programCache <path>\n");
+            return -1;
+        }
+    }
+
+    else if (!strcmp(argv[i], "-testReport"))
+    {
+        delArg = 1;
+        if ((i + 1) < argc)
+        {
+            gTestReportPath = argv[i + 1];
+            delArg++;
+        }
+        else
+        {
+            log_error(" Test report parameters are incorrect. Usage:\n");
+            log_error("       -testReport <path>\n");
+            return -1;
+        }
+    }
+
     //cleaning parameters from argv tab
 	  for (int j=i; j<argc-delArg; j++)
 		  argv[j] = argv[j+delArg];
@@ -22,6 +22,8 @@ extern bool gOfflineCompiler;
 extern bool gForceSpirVCache;
 extern bool gForceSpirVGenerate;
 extern std::string gSpirVPath;
+extern std::string gProgramCachePath;     // directory of the program binary cache, empty if disabled
+extern std::string gTestReportPath;       // per-test timing and resource report, empty if disabled
 
 enum OfflineCompilerOutputType
 {
@@ -23,12 +23,14 @@
 #include "fpcontrol.h"
 #include "typeWrappers.h"
 #include "parseParameters.h"
+#include "testReport.h"
 
 #if !defined(_WIN32)
 #include <unistd.h>
 #endif
 
 #include <time.h>
+#include <future>
 
 #if !defined (__APPLE__)
 #include <CL/cl.h>
@@ -607,11 +609,40 @@ int parseAndCallCommandLineTests( int argc, const char *argv[], cl_device_id dev
     return ret;
 }
 
+static int callSingleTestFunctionInContext( basefn functionToCall, const char *functionName,
+                                           cl_device_id deviceToUse, int forceNoContextCreation,
+                                           int numElementsToUse, const cl_queue_properties queueProps,
+                                           cl_context context );
+
+// With the program cache enabled, the context of each test is created while the previous test runs and the
+// programs the test built last time are prefetched into it. Returns NULL if prefetching is off.
+static cl_context createPrefetchContext( const char *functionName, cl_device_id deviceToUse, int forceNoContextCreation )
+{
+    cl_int error;
+
+    if( gProgramCachePath.empty() || gOfflineCompiler || forceNoContextCreation )
+        return NULL;
+
+    cl_context context = clCreateContext(NULL, 1, &deviceToUse, notify_callback, NULL, &error );
+    if( context == NULL )
+        return NULL;
+
+    prefetch_test_programs( context, functionName );
+    return context;
+}
+
+// Returns the context of a prefetch started with std::async, waiting for it to finish if needed
+static cl_context takePrefetchContext( std::future<cl_context> &prefetch )
+{
+    return prefetch.valid() ? prefetch.get() : NULL;
+}
+
 int callTestFunctions( basefn functionList[], const char *functionNames[], unsigned char functionsToCall[],
                        int numFunctions, cl_device_id deviceToUse, int forceNoContextCreation,
                        int numElementsToUse, cl_command_queue_properties queueProps )
 {
     int numErrors = 0;
+    std::future<cl_context> nextPrefetch;
 
     for( int i = 0; i < numFunctions; ++i )
     {
@@ -620,8 +651,22 @@ int callTestFunctions( basefn functionList[], const char *functionNames[], unsig
             /* Skip any unimplemented tests. */
             if( functionList[ i ] != NULL )
             {
-                numErrors += callSingleTestFunction( functionList[ i ], functionNames[ i ], deviceToUse,
-                                                     forceNoContextCreation, numElementsToUse, queueProps );
+                cl_context context = nextPrefetch.valid() ? takePrefetchContext( nextPrefetch )
+                                                          : createPrefetchContext( functionNames[ i ], deviceToUse, forceNoContextCreation );
+
+                /* Start on the context and programs of the next test on another thread while this one runs */
+                for( int j = i + 1; j < numFunctions && context != NULL; ++j )
+                {
+                    if( functionsToCall[ j ] && functionList[ j ] != NULL )
+                    {
+                        nextPrefetch = std::async( std::launch::async, createPrefetchContext, functionNames[ j ],
+                                                   deviceToUse, forceNoContextCreation );
+                        break;
+                    }
+                }
+
+                numErrors += callSingleTestFunctionInContext( functionList[ i ], functionNames[ i ], deviceToUse,
+                                                              forceNoContextCreation, numElementsToUse, queueProps, context );
             }
             else
             {
@@ -642,31 +687,17 @@ void CL_CALLBACK notify_callback(const char *errinfo, const void *private_info,
 int callSingleTestFunction( basefn functionToCall, const char *functionName,
                            cl_device_id deviceToUse, int forceNoContextCreation,
                            int numElementsToUse, const cl_queue_properties queueProps )
+{
+    return callSingleTestFunctionInContext( functionToCall, functionName, deviceToUse, forceNoContextCreation,
+                                            numElementsToUse, queueProps, NULL );
+}
+
+// Run the test in context and report its result. Returns the number of errors.
+static int runTestFunction( basefn functionToCall, const char *functionName, cl_device_id deviceToUse,
+                            int numElementsToUse, cl_context context, cl_command_queue queue )
 {
     int numErrors = 0, ret;
     cl_int error;
-    cl_context context = NULL;
-    cl_command_queue queue = NULL;
-    const cl_command_queue_properties cmd_queueProps = (queueProps)?CL_QUEUE_PROPERTIES:0;
-    cl_command_queue_properties queueCreateProps[] = {cmd_queueProps, queueProps, 0};
-
-    /* Create a context to work with, unless we're told not to */
-    if( !forceNoContextCreation )
-    {
-        context = clCreateContext(NULL, 1, &deviceToUse, notify_callback, NULL, &error );
-        if (!context)
-        {
-            print_error( error, "Unable to create testing context" );
-            return 1;
-        }
-
-        queue = clCreateCommandQueueWithProperties( context, deviceToUse, &queueCreateProps[0], &error );
-        if( queue == NULL )
-        {
-            print_error( error, "Unable to create testing command queue" );
-            return 1;
-        }
-    }
 
     /* Run the test and print the result */
     log_info( "%s...\n", functionName );
@@ -678,7 +709,11 @@ int callSingleTestFunction( basefn functionToCall, const char *functionName,
     error = check_functions_for_offline_compiler(functionName, deviceToUse);
     test_missing_support_offline_cmpiler(error, functionName);
 
+    begin_test_programs();
+    beginTestReport( functionName );
     ret = functionToCall( deviceToUse, context, queue, numElementsToUse);        //test_threaded_function( ptr_basefn_list[i], group, context, num_elements);
+    endTestReport( functionName, ret == TEST_NOT_IMPLEMENTED ? "not_implemented" : ret == 0 ? "passed" : "failed", deviceToUse );
+    finish_test_programs( functionName );
     if( ret == TEST_NOT_IMPLEMENTED )
     {
         /* Tests can also let us know they're not implemented yet */
@@ -699,14 +734,54 @@ int callSingleTestFunction( basefn functionToCall, const char *functionName,
         }
     }
 
+    return numErrors;
+}
+
+// As callSingleTestFunction, but takes ownership of a context created ahead of time, if context is not NULL.
+// The context and everything prefetched into it are released on every path.
+static int callSingleTestFunctionInContext( basefn functionToCall, const char *functionName,
+                                           cl_device_id deviceToUse, int forceNoContextCreation,
+                                           int numElementsToUse, const cl_queue_properties queueProps,
+                                           cl_context context )
+{
+    int numErrors = 0;
+    cl_int error = CL_SUCCESS;
+    cl_command_queue queue = NULL;
+    const cl_command_queue_properties cmd_queueProps = (queueProps)?CL_QUEUE_PROPERTIES:0;
+    cl_command_queue_properties queueCreateProps[] = {cmd_queueProps, queueProps, 0};
+
+    /* Create a context to work with, unless we're told not to */
+    if( !forceNoContextCreation )
+    {
+        if( context == NULL )
+            context = clCreateContext(NULL, 1, &deviceToUse, notify_callback, NULL, &error );
+        if (!context)
+        {
+            print_error( error, "Unable to create testing context" );
+            return 1;
+        }
+
+        queue = clCreateCommandQueueWithProperties( context, deviceToUse, &queueCreateProps[0], &error );
+        if( queue == NULL )
+        {
+            print_error( error, "Unable to create testing command queue" );
+            release_prefetched_programs( context );
+            clReleaseContext( context );
+            return 1;
+        }
+    }
+
+    numErrors = runTestFunction( functionToCall, functionName, deviceToUse, numElementsToUse, context, queue );
+
     /* Release the context */
     if( !forceNoContextCreation )
     {
-        int error = clFinish(queue);
+        error = clFinish(queue);
         if (error) {
             log_error("clFinish failed: %d", error);
             numErrors++;
         }
+        release_prefetched_programs( context );
         clReleaseCommandQueue( queue );
         clReleaseContext( context );
     }
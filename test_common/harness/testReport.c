@@ -0,0 +1,186 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "testReport.h"
+#include "errorHelpers.h"
+#include "kernelHelpers.h"
+#include "parseParameters.h"
+#include "clApiTrace.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <sys/resource.h>
+#endif
+
+int              gCountingApiCalls = 0;
+volatile cl_ulong gApiCallCount = 0;
+volatile cl_ulong gBytesMoved = 0;
+
+// The OpenCL API tracing layer (clApiTrace.c), if it was loaded with LD_PRELOAD
+static clApiTraceBeginTestFn gApiTraceBeginTest = NULL;
+static clApiTraceGetTotalsFn gApiTraceGetTotals = NULL;
+
+static void findApiTrace( void )
+{
+#if !defined(_WIN32)
+    static int searched = 0;
+    if( searched )
+        return;
+    searched = 1;
+
+    gApiTraceBeginTest = (clApiTraceBeginTestFn) dlsym( RTLD_DEFAULT, "clApiTraceBeginTest" );
+    gApiTraceGetTotals = (clApiTraceGetTotalsFn) dlsym( RTLD_DEFAULT, "clApiTraceGetTotals" );
+    if( gApiTraceBeginTest && gApiTraceGetTotals )
+        gCountingApiCalls = 1;
+#endif
+}
+
+// Resource use of the process so far, for the per-test report
+typedef struct TestUsage
+{
+    std::chrono::steady_clock::time_point wallTime;
+    double      userSeconds;
+    double      systemSeconds;
+    long        peakRSSKB;              // of the process so far, -1 if unknown
+    double      buildSeconds;           // wall time with a program build running, see get_program_build_seconds
+    cl_ulong    apiCalls;
+    cl_ulong    bytesMoved;
+} TestUsage;
+
+static void getTestUsage( TestUsage *usage )
+{
+    usage->wallTime = std::chrono::steady_clock::now();
+    usage->userSeconds = usage->systemSeconds = 0.0;
+    usage->peakRSSKB = -1;
+#if defined(_WIN32)
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if( GetProcessTimes( GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime ) )
+    {
+        usage->userSeconds = (((cl_ulong) userTime.dwHighDateTime << 32) | userTime.dwLowDateTime) * 1e-7;
+        usage->systemSeconds = (((cl_ulong) kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime) * 1e-7;
+    }
+#else
+    struct rusage r;
+    if( 0 == getrusage( RUSAGE_SELF, &r ) )
+    {
+        usage->userSeconds = r.ru_utime.tv_sec + 1e-6 * r.ru_utime.tv_usec;
+        usage->systemSeconds = r.ru_stime.tv_sec + 1e-6 * r.ru_stime.tv_usec;
+#if defined(__APPLE__)
+        usage->peakRSSKB = r.ru_maxrss / 1024;      // bytes on Mac OS X
+#else
+        usage->peakRSSKB = r.ru_maxrss;
+#endif
+    }
+#endif
+    usage->buildSeconds = get_program_build_seconds();
+    if( gApiTraceGetTotals )
+    {
+        cl_ulong calls, bytes;
+        gApiTraceGetTotals( &calls, &bytes );
+        gApiCallCount = calls;
+        gBytesMoved = bytes;
+    }
+    usage->apiCalls = gApiCallCount;
+    usage->bytesMoved = gBytesMoved;
+}
+
+// Replace the characters that would need escaping in the report
+static void removeReportSeparators( char *s )
+{
+    for( ; *s; s++ )
+        if( *s == '"' || *s == ',' || *s == '\\' )
+            *s = ' ';
+}
+
+// Append one line for the test to the report: CSV if the file name ends in .csv, otherwise a JSON object
+static void writeTestReport( const char *testName, const char *result, cl_device_id device,
+                             const TestUsage *start, const TestUsage *end )
+{
+    if( gTestReportPath.empty() )
+        return;
+
+    char deviceName[256] = "", driverVersion[256] = "";
+    clGetDeviceInfo( device, CL_DEVICE_NAME, sizeof( deviceName ) - 1, deviceName, NULL );
+    clGetDeviceInfo( device, CL_DRIVER_VERSION, sizeof( driverVersion ) - 1, driverVersion, NULL );
+    removeReportSeparators( deviceName );
+    removeReportSeparators( driverVersion );
+
+    double wallSeconds = std::chrono::duration<double>( end->wallTime - start->wallTime ).count();
+    double buildSeconds = end->buildSeconds - start->buildSeconds;
+    double executeSeconds = wallSeconds > buildSeconds ? wallSeconds - buildSeconds : 0.0;
+    long peakRSSGrowthKB = end->peakRSSKB >= 0 && start->peakRSSKB >= 0 ? end->peakRSSKB - start->peakRSSKB : -1;
+
+    char apiCalls[32] = "", bytesMoved[32] = "";
+    if( gCountingApiCalls )
+    {
+        sprintf( apiCalls, "%llu", (unsigned long long) ( end->apiCalls - start->apiCalls ) );
+        sprintf( bytesMoved, "%llu", (unsigned long long) ( end->bytesMoved - start->bytesMoved ) );
+    }
+
+    FILE *f = fopen( gTestReportPath.c_str(), "a" );
+    if( NULL == f )
+    {
+        log_error( "Unable to open test report %s\n", gTestReportPath.c_str() );
+        return;
+    }
+
+    size_t pathLength = gTestReportPath.size();
+    if( pathLength > 4 && 0 == strcmp( gTestReportPath.c_str() + pathLength - 4, ".csv" ) )
+    {
+        fseek( f, 0, SEEK_END );
+        if( 0 == ftell( f ) )
+            fprintf( f, "test,result,device,driver_version,wall_seconds,user_seconds,system_seconds,process_peak_rss_kb,"
+                        "peak_rss_growth_kb,compile_seconds,execute_seconds,api_calls,bytes_moved\n" );
+        fprintf( f, "%s,%s,%s,%s,%.6f,%.6f,%.6f,%ld,%ld,%.6f,%.6f,%s,%s\n", testName, result, deviceName, driverVersion,
+                 wallSeconds, end->userSeconds - start->userSeconds, end->systemSeconds - start->systemSeconds,
+                 end->peakRSSKB, peakRSSGrowthKB, buildSeconds, executeSeconds, apiCalls, bytesMoved );
+    }
+    else
+    {
+        fprintf( f, "{\"test\": \"%s\", \"result\": \"%s\", \"device\": \"%s\", \"driver_version\": \"%s\", "
+                    "\"wall_seconds\": %.6f, \"user_seconds\": %.6f, \"system_seconds\": %.6f, "
+                    "\"process_peak_rss_kb\": %ld, \"peak_rss_growth_kb\": %ld, \"compile_seconds\": %.6f, \"execute_seconds\": %.6f",
+                 testName, result, deviceName, driverVersion,
+                 wallSeconds, end->userSeconds - start->userSeconds, end->systemSeconds - start->systemSeconds,
+                 end->peakRSSKB, peakRSSGrowthKB, buildSeconds, executeSeconds );
+        if( gCountingApiCalls )
+            fprintf( f, ", \"api_calls\": %s, \"bytes_moved\": %s", apiCalls, bytesMoved );
+        fprintf( f, "}\n" );
+    }
+    fclose( f );
+}
+
+static TestUsage gReportStart;
+
+void beginTestReport( const char *testName )
+{
+    findApiTrace();
+    if( gApiTraceBeginTest )
+        gApiTraceBeginTest( testName );
+    getTestUsage( &gReportStart );
+}
+
+void endTestReport( const char *testName, const char *result, cl_device_id device )
+{
+    TestUsage end;
+    getTestUsage( &end );
+    writeTestReport( testName, result, device, &gReportStart, &end );
+}
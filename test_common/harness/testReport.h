@@ -0,0 +1,55 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef _testReport_h
+#define _testReport_h
+
+#ifdef __APPLE__
+    #include <OpenCL/opencl.h>
+#else
+    #include <CL/opencl.h>
+#endif
+
+/*
+ *  Per-test timing and resource report, written when -testReport <path> or CL_TEST_REPORT=<path> is given.
+ *  Each test appends one record to <path>: CSV if it ends in .csv, otherwise one JSON object per line.
+ *
+ *  compile_seconds is the wall-clock time during which at least one program build made by the kernelHelpers.h
+ *  build helpers was running, see get_program_build_seconds; builds on several threads at once are counted
+ *  once. execute_seconds is the rest of the wall time. process_peak_rss_kb is the peak resident set
+ *  of the whole process up to the end of the test, peak_rss_growth_kb how much the test raised it.
+ *
+ *  callSingleTestFunction reports every test it runs. Suites with their own test loop call beginTestReport
+ *  and endTestReport around each test; only one test may be measured at a time.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern void beginTestReport( const char *testName );
+extern void endTestReport( const char *testName, const char *result, cl_device_id device );
+
+// OpenCL API call and host <-> device transfer counters for the report. They are only maintained when the
+// API tracing layer (clApiTrace.h) is loaded, which sets gCountingApiCalls; otherwise the report leaves them out.
+extern int              gCountingApiCalls;
+extern volatile cl_ulong gApiCallCount;
+extern volatile cl_ulong gBytesMoved;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _testReport_h
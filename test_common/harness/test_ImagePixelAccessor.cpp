@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Checks that ImagePixelAccessor::ReadPixel is bitwise identical to read_image_pixel_float for every
+// channel order and channel type, inside the image, on its border and at every mip level.
+// Build it together with imageHelpers.cpp and the harness sources it depends on.
+//
+#include "imageHelpers.h"
+#include "mt19937.h"
+#include <stdio.h>
+#include <string.h>
+
+extern void read_image_pixel_float( void *imageData, image_descriptor *imageInfo,
+                                    int x, int y, int z, float *outData, int lod );
+
+bool gTestRounding = false;
+
+static const cl_channel_order orders[] = { CL_R, CL_A, CL_RG, CL_RA, CL_RGB, CL_RGBA, CL_BGRA, CL_ARGB,
+                                           CL_INTENSITY, CL_LUMINANCE, CL_Rx, CL_RGx, CL_RGBx, CL_DEPTH,
+                                           CL_sRGB, CL_sRGBx, CL_sRGBA, CL_sBGRA };
+
+static const cl_channel_type types[] = { CL_SNORM_INT8, CL_SNORM_INT16, CL_UNORM_INT8, CL_UNORM_INT16,
+                                         CL_UNORM_SHORT_565, CL_UNORM_SHORT_555, CL_UNORM_INT_101010,
+                                         CL_SIGNED_INT8, CL_SIGNED_INT16, CL_SIGNED_INT32,
+                                         CL_UNSIGNED_INT8, CL_UNSIGNED_INT16, CL_UNSIGNED_INT32,
+                                         CL_HALF_FLOAT, CL_FLOAT };
+
+static bool is_valid_format( cl_channel_order order, cl_channel_type type )
+{
+    bool packed = type == CL_UNORM_SHORT_565 || type == CL_UNORM_SHORT_555 || type == CL_UNORM_INT_101010;
+
+    if( packed )
+        return order == CL_RGB || order == CL_RGBx;
+    if( order == CL_RGB || order == CL_RGBx )
+        return false;
+    if( is_sRGBA_order( order ) )
+        return type == CL_UNORM_INT8;
+    if( order == CL_DEPTH )
+        return type == CL_FLOAT || type == CL_UNORM_INT16;
+    return true;
+}
+
+// Compares every pixel of every mip level of the image, plus a one pixel border around each level
+static int compare_image( image_descriptor *imageInfo, MTdata d )
+{
+    size_t size = (size_t) compute_mipmapped_image_size( *imageInfo );
+    if( imageInfo->num_mip_levels <= 1 )
+        size = imageInfo->slicePitch * ( imageInfo->depth ? imageInfo->depth : imageInfo->arraySize ? imageInfo->arraySize : 1 );
+    cl_uint *data = (cl_uint *) malloc( size + sizeof( cl_uint ) );
+    int errors = 0;
+
+    for( size_t i = 0; i <= size / sizeof( cl_uint ); i++ )
+        data[ i ] = genrand_int32( d );
+
+    for( int lod = 0; lod < (int) ( imageInfo->num_mip_levels ? imageInfo->num_mip_levels : 1 ); lod++ )
+    {
+        ImagePixelAccessor accessor( imageInfo, lod );
+        char *levelData = (char *) data + ( imageInfo->num_mip_levels > 1 ? compute_mip_level_offset( imageInfo, lod ) : 0 );
+        int width = (int) imageInfo->width, height = (int) imageInfo->height, depth = (int) imageInfo->depth;
+
+        if( imageInfo->num_mip_levels > 1 )
+        {
+            width = width >> lod ? width >> lod : 1;
+            height = height >> lod ? height >> lod : 1;
+            depth = depth >> lod ? depth >> lod : 1;
+        }
+        if( imageInfo->type == CL_MEM_OBJECT_IMAGE2D_ARRAY )
+            depth = (int) imageInfo->arraySize;
+        if( imageInfo->type == CL_MEM_OBJECT_IMAGE1D_ARRAY )
+            height = (int) imageInfo->arraySize;
+
+        // z past the end of a 2D image is not on its border, so only go there for 3D images and arrays
+        for( int z = -1; z <= depth; z++ )
+            for( int y = -1; y <= height; y++ )
+                for( int x = -1; x <= width; x++ )
+                {
+                    float expected[ 4 ], actual[ 4 ];
+
+                    // The border color of CL_DEPTH only sets the first channel
+                    memset( expected, 0xa5, sizeof( expected ) );
+                    memset( actual, 0xa5, sizeof( actual ) );
+                    read_image_pixel_float( levelData, imageInfo, x, y, z, expected, lod );
+                    accessor.ReadPixel( levelData, x, y, z, actual );
+                    if( memcmp( expected, actual, sizeof( expected ) ) && errors++ < 4 )
+                        log_error( "ERROR: %s lod %d ( %d, %d, %d ): expected { %a, %a, %a, %a }, got { %a, %a, %a, %a }\n",
+                                   GetChannelOrderName( imageInfo->format->image_channel_order ), lod, x, y, z,
+                                   expected[ 0 ], expected[ 1 ], expected[ 2 ], expected[ 3 ],
+                                   actual[ 0 ], actual[ 1 ], actual[ 2 ], actual[ 3 ] );
+                }
+    }
+
+    free( data );
+    return errors;
+}
+
+int main( void )
+{
+    MTdata d = init_genrand( 42 );
+    int errcount = 0, formats = 0;
+
+    for( size_t o = 0; o < sizeof( orders ) / sizeof( orders[ 0 ] ); o++ )
+        for( size_t t = 0; t < sizeof( types ) / sizeof( types[ 0 ] ); t++ )
+        {
+            cl_image_format format = { orders[ o ], types[ t ] };
+            if( !is_valid_format( format.image_channel_order, format.image_channel_data_type ) )
+                continue;
+            formats++;
+
+            // A 2D image with padded rows, a 3D image and a mipmapped 2D array
+            image_descriptor imageInfo = { 0 };
+            imageInfo.format = &format;
+            imageInfo.type = CL_MEM_OBJECT_IMAGE2D;
+            imageInfo.width = 13;
+            imageInfo.height = 7;
+            imageInfo.rowPitch = imageInfo.width * get_pixel_size( &format ) + 16;
+            imageInfo.slicePitch = imageInfo.rowPitch * imageInfo.height;
+            errcount += compare_image( &imageInfo, d );
+
+            imageInfo.type = CL_MEM_OBJECT_IMAGE3D;
+            imageInfo.depth = 5;
+            imageInfo.rowPitch = imageInfo.width * get_pixel_size( &format );
+            imageInfo.slicePitch = imageInfo.rowPitch * imageInfo.height;
+            errcount += compare_image( &imageInfo, d );
+
+            imageInfo.type = CL_MEM_OBJECT_IMAGE2D_ARRAY;
+            imageInfo.width = 16;
+            imageInfo.height = 8;
+            imageInfo.depth = 0;
+            imageInfo.arraySize = 3;
+            imageInfo.num_mip_levels = 4;
+            imageInfo.rowPitch = imageInfo.width * get_pixel_size( &format );
+            imageInfo.slicePitch = imageInfo.rowPitch * imageInfo.height;
+            errcount += compare_image( &imageInfo, d );
+        }
+
+    free_mtdata( d );
+
+    if( errcount )
+        printf( "ImagePixelAccessor test failed.\n" );
+    else
+        printf( "ImagePixelAccessor test passed for %d formats.\n", formats );
+
+    return errcount != 0;
+}
@@ -0,0 +1,226 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Checks that nested ThreadPool_Do calls and ThreadPool_Submit jobs run on the pool
+// workers with valid thread ids, every job exactly once. Build it together with ThreadPool.c.
+//
+#include "ThreadPool.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define OUTER_JOBS      64
+#define INNER_JOBS      256
+#define SUBMIT_JOBS     4096
+#define MAX_THREADS     1024
+
+typedef struct
+{
+    volatile cl_int runs[ OUTER_JOBS * INNER_JOBS ];
+    volatile cl_int busy[ MAX_THREADS ];      // inner jobs running with each thread_id right now
+    volatile cl_int badThreadID;
+    volatile cl_int overlap;                  // two jobs ran at the same time with the same thread_id
+    volatile cl_int innerThreads[ MAX_THREADS ];
+}NestedInfo;
+
+static cl_int CheckThreadID( NestedInfo *info, cl_uint thread_id )
+{
+    if( thread_id >= GetThreadCount() || thread_id >= MAX_THREADS )
+    {
+        ThreadPool_AtomicAdd( &info->badThreadID, 1 );
+        return -1;
+    }
+    return 0;
+}
+
+typedef struct
+{
+    NestedInfo  *info;
+    cl_uint     outer;
+}InnerInfo;
+
+static cl_int InnerJob( cl_uint job_id, cl_uint thread_id, void *p )
+{
+    InnerInfo *inner = (InnerInfo*) p;
+    NestedInfo *info = inner->info;
+    volatile int spin;
+
+    if( CheckThreadID( info, thread_id ) )
+        return -1;
+
+    // No other inner job may be running with our thread_id
+    if( ThreadPool_AtomicAdd( &info->busy[ thread_id ], 1 ) > 0 )
+        ThreadPool_AtomicAdd( &info->overlap, 1 );
+    ThreadPool_AtomicAdd( &info->runs[ inner->outer * INNER_JOBS + job_id ], 1 );
+    ThreadPool_AtomicAdd( &info->innerThreads[ thread_id ], 1 );
+    for( spin = 0; spin < 2000; spin++ )
+        ;
+    ThreadPool_AtomicAdd( &info->busy[ thread_id ], -1 );
+
+    return CL_SUCCESS;
+}
+
+static cl_int OuterJob( cl_uint job_id, cl_uint thread_id, void *p )
+{
+    InnerInfo inner;
+    cl_int err;
+
+    if( CheckThreadID( (NestedInfo*) p, thread_id ) )
+        return -1;
+
+    inner.info = (NestedInfo*) p;
+    inner.outer = job_id;
+    err = ThreadPool_Do( InnerJob, INNER_JOBS, &inner );
+
+    return err;
+}
+
+typedef struct
+{
+    volatile cl_int runs[ SUBMIT_JOBS ];
+    volatile cl_int badThreadID;
+    cl_uint         failJob;                  // job that returns an error, or SUBMIT_JOBS for none
+}SubmitInfo;
+
+static cl_int SubmitJob( cl_uint job_id, cl_uint thread_id, void *p )
+{
+    SubmitInfo *info = (SubmitInfo*) p;
+
+    if( thread_id >= GetThreadCount() )
+        ThreadPool_AtomicAdd( &info->badThreadID, 1 );
+    ThreadPool_AtomicAdd( &info->runs[ job_id ], 1 );
+
+    return job_id == info->failJob ? -42 : CL_SUCCESS;
+}
+
+static cl_int SubmitFromJob( cl_uint job_id, cl_uint thread_id, void *p )
+{
+    ThreadPoolJobHandle handle = ThreadPool_Submit( SubmitJob, SUBMIT_JOBS, p );
+    return ThreadPool_Wait( handle );
+}
+
+static int CountRuns( const char *name, volatile cl_int *runs, cl_uint count )
+{
+    cl_uint i;
+    int errcount = 0;
+
+    for( i = 0; i < count; i++ )
+        if( 1 != runs[i] )
+        {
+            if( errcount < 10 )
+                printf( "ERROR: %s job %u ran %d times\n", name, i, runs[i] );
+            errcount++;
+        }
+
+    return errcount;
+}
+
+static int TestNested( void )
+{
+    NestedInfo *info = (NestedInfo*) calloc( 1, sizeof( *info ) );
+    cl_uint i, threads = 0;
+    cl_int err;
+    int errcount = 0;
+
+    err = ThreadPool_Do( OuterJob, OUTER_JOBS, info );
+    if( err )
+    {
+        printf( "ERROR: nested ThreadPool_Do returned %d\n", err );
+        errcount++;
+    }
+
+    errcount += CountRuns( "nested", info->runs, OUTER_JOBS * INNER_JOBS );
+    if( info->badThreadID || info->overlap )
+    {
+        printf( "ERROR: %d jobs got a bad thread_id, %d shared one with a running job\n", info->badThreadID, info->overlap );
+        errcount++;
+    }
+
+    // The nested jobs must spread over the pool, not run on the thread of their outer job only
+    for( i = 0; i < MAX_THREADS; i++ )
+        threads += 0 != info->innerThreads[i];
+    if( GetThreadCount() > 1 && threads < 2 )
+    {
+        printf( "ERROR: nested jobs ran on %u threads\n", threads );
+        errcount++;
+    }
+
+    free( info );
+    return errcount;
+}
+
+static int TestSubmit( cl_uint failJob, int fromJob )
+{
+    SubmitInfo *info = (SubmitInfo*) calloc( 1, sizeof( *info ) );
+    NestedInfo *nested = (NestedInfo*) calloc( 1, sizeof( *nested ) );
+    ThreadPoolJobHandle handle = NULL;
+    cl_int err, expected = failJob < SUBMIT_JOBS ? -42 : CL_SUCCESS;
+    int errcount = 0;
+
+    info->failJob = failJob;
+
+    // Submitted jobs run alongside a ThreadPool_Do call
+    if( fromJob )
+        err = ThreadPool_Do( SubmitFromJob, 1, info );
+    else
+    {
+        handle = ThreadPool_Submit( SubmitJob, SUBMIT_JOBS, info );
+        if( ThreadPool_Do( OuterJob, OUTER_JOBS, nested ) )
+        {
+            printf( "ERROR: ThreadPool_Do failed while jobs were submitted\n" );
+            errcount++;
+        }
+        errcount += CountRuns( "concurrent", nested->runs, OUTER_JOBS * INNER_JOBS );
+        err = ThreadPool_Wait( handle );
+    }
+
+    if( err != expected )
+    {
+        printf( "ERROR: submitted jobs returned %d, expected %d\n", err, expected );
+        errcount++;
+    }
+    if( info->badThreadID )
+    {
+        printf( "ERROR: %d submitted jobs got a bad thread_id\n", info->badThreadID );
+        errcount++;
+    }
+    if( CL_SUCCESS == expected )
+        errcount += CountRuns( "submitted", info->runs, SUBMIT_JOBS );
+
+    free( nested );
+    free( info );
+    return errcount;
+}
+
+int main( void )
+{
+    int errcount = 0;
+    int i;
+
+    for( i = 0; i < 2; i++ )
+    {
+        ThreadPool_SetScheduler( i ? kThreadPoolWorkStealing : kThreadPoolGlobalCounter );
+        errcount += TestNested();
+        errcount += TestSubmit( SUBMIT_JOBS, 0 );
+        errcount += TestSubmit( SUBMIT_JOBS / 2, 0 );
+        errcount += TestSubmit( SUBMIT_JOBS, 1 );
+    }
+
+    if( errcount )
+        printf("ThreadPool test failed.\n");
+    else
+        printf("ThreadPool test passed.\n");
+
+    return errcount != 0;
+}
@@ -0,0 +1,129 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Checks that the OpenCL API tracing layer intercepts calls and writes its summary at exit. Link it against
+// test_clApiTrace_stub.c in place of the OpenCL library and run it with libcl_api_trace in LD_PRELOAD.
+// The calls are made in a child process, so that the summary it writes at exit can be checked here.
+//
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE         // RTLD_DEFAULT
+#endif
+#ifndef CL_USE_DEPRECATED_OPENCL_1_2_APIS
+    #define CL_USE_DEPRECATED_OPENCL_1_2_APIS   1
+#endif
+
+#include "clApiTrace.h"
+
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BUFFER_SIZE     4096
+
+// The calls of the child, and what the summary must say about them
+static const char *gExpectedLines[] = {
+    "OpenCL API trace: 9 calls, 8192 bytes moved",
+    "clCreateContext ",
+    "clCreateCommandQueue ",
+    "clEnqueueWriteBuffer ",
+    "clEnqueueReadBuffer ",
+    "Test api_trace_smoke:",
+};
+
+static void MakeCalls( void )
+{
+    char data[ BUFFER_SIZE ] = { 0 };
+    clApiTraceBeginTestFn beginTest = (clApiTraceBeginTestFn) dlsym( RTLD_DEFAULT, "clApiTraceBeginTest" );
+    cl_context context;
+    cl_command_queue queue;
+    cl_mem buffer;
+    cl_int error;
+
+    beginTest( "api_trace_smoke" );
+    context = clCreateContext( NULL, 0, NULL, NULL, NULL, &error );
+    queue = clCreateCommandQueue( context, NULL, 0, &error );
+    buffer = clCreateBuffer( context, CL_MEM_READ_WRITE, sizeof( data ), NULL, &error );
+    clEnqueueWriteBuffer( queue, buffer, CL_TRUE, 0, sizeof( data ), data, 0, NULL, NULL );
+    clEnqueueReadBuffer( queue, buffer, CL_TRUE, 0, sizeof( data ), data, 0, NULL, NULL );
+    clFinish( queue );
+    clReleaseMemObject( buffer );
+    clReleaseCommandQueue( queue );
+    clReleaseContext( context );
+}
+
+int main( void )
+{
+    char path[] = "/tmp/cl_api_trace_XXXXXX";
+    char summary[ 16384 ];
+    size_t i, length;
+    int fd, status, errcount = 0;
+    pid_t child;
+    FILE *f;
+
+    if( NULL == dlsym( RTLD_DEFAULT, "clApiTraceGetTotals" ) )
+    {
+        printf( "ERROR: the tracing layer is not loaded, run with LD_PRELOAD=libcl_api_trace.so\n" );
+        return 1;
+    }
+
+    fd = mkstemp( path );
+    if( fd < 0 )
+    {
+        printf( "ERROR: unable to create a temporary file\n" );
+        return 1;
+    }
+    close( fd );
+
+    fflush( stdout );
+    child = fork();
+    if( 0 == child )
+    {
+        setenv( "CL_API_TRACE_OUTPUT", path, 1 );
+        MakeCalls();
+        exit( 0 );
+    }
+    // Our own summary is of no interest
+    setenv( "CL_API_TRACE_OUTPUT", "/dev/null", 1 );
+    if( child < 0 || waitpid( child, &status, 0 ) != child || !WIFEXITED( status ) || WEXITSTATUS( status ) != 0 )
+    {
+        printf( "ERROR: the traced process failed\n" );
+        unlink( path );
+        return 1;
+    }
+
+    f = fopen( path, "r" );
+    length = f ? fread( summary, 1, sizeof( summary ) - 1, f ) : 0;
+    summary[ length ] = '\0';
+    if( f )
+        fclose( f );
+    unlink( path );
+
+    for( i = 0; i < sizeof( gExpectedLines ) / sizeof( gExpectedLines[0] ); i++ )
+        if( NULL == strstr( summary, gExpectedLines[i] ) )
+        {
+            printf( "ERROR: \"%s\" is missing from the trace summary\n", gExpectedLines[i] );
+            errcount++;
+        }
+
+    if( errcount )
+        printf( "API trace test failed. The summary was:\n%s\n", summary );
+    else
+        printf( "API trace test passed.\n" );
+
+    return errcount != 0;
+}
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Stand-in for the OpenCL library in the API tracing layer test, see test_clApiTrace.c.
+// It implements only the entry points the test calls, and they do nothing but hand out dummy objects.
+//
+#ifndef CL_USE_DEPRECATED_OPENCL_1_2_APIS
+    #define CL_USE_DEPRECATED_OPENCL_1_2_APIS   1
+#endif
+
+#ifdef __APPLE__
+    #include <OpenCL/opencl.h>
+#else
+    #include <CL/opencl.h>
+#endif
+
+#include <string.h>
+
+static char gStubObjects[ 3 ];
+
+CL_API_ENTRY cl_context CL_API_CALL clCreateContext( const cl_context_properties *properties, cl_uint num_devices, const cl_device_id *devices,
+                                                     void (CL_CALLBACK *pfn_notify)( const char *, const void *, size_t, void * ),
+                                                     void *user_data, cl_int *errcode_ret )
+{
+    if( errcode_ret )
+        *errcode_ret = CL_SUCCESS;
+    return (cl_context) &gStubObjects[ 0 ];
+}
+
+CL_API_ENTRY cl_command_queue CL_API_CALL clCreateCommandQueue( cl_context context, cl_device_id device,
+                                                                cl_command_queue_properties properties, cl_int *errcode_ret )
+{
+    if( errcode_ret )
+        *errcode_ret = CL_SUCCESS;
+    return (cl_command_queue) &gStubObjects[ 1 ];
+}
+
+CL_API_ENTRY cl_mem CL_API_CALL clCreateBuffer( cl_context context, cl_mem_flags flags, size_t size, void *host_ptr, cl_int *errcode_ret )
+{
+    if( errcode_ret )
+        *errcode_ret = CL_SUCCESS;
+    return (cl_mem) &gStubObjects[ 2 ];
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueWriteBuffer( cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_write,
+                                                      size_t offset, size_t size, const void *ptr, cl_uint num_events_in_wait_list,
+                                                      const cl_event *event_wait_list, cl_event *event )
+{
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clEnqueueReadBuffer( cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_read,
+                                                     size_t offset, size_t size, void *ptr, cl_uint num_events_in_wait_list,
+                                                     const cl_event *event_wait_list, cl_event *event )
+{
+    memset( ptr, 0, size );
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clFinish( cl_command_queue command_queue )
+{
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseMemObject( cl_mem memobj )
+{
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseCommandQueue( cl_command_queue command_queue )
+{
+    return CL_SUCCESS;
+}
+
+CL_API_ENTRY cl_int CL_API_CALL clReleaseContext( cl_context context )
+{
+    return CL_SUCCESS;
+}
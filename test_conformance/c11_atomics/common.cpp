@@ -206,3 +206,79 @@ template<> cl_long AtomicTypeExtendedInfo<cl_long>::MaxValue() {return CL_LONG_M
 template<> cl_ulong AtomicTypeExtendedInfo<cl_ulong>::MaxValue() {return CL_ULONG_MAX;}
 template<> cl_float AtomicTypeExtendedInfo<cl_float>::MaxValue() {return CL_FLT_MAX;}
 template<> cl_double AtomicTypeExtendedInfo<cl_double>::MaxValue() {return CL_DBL_MAX;}
+
+void CProgramBatch::Add(const std::string &source)
+{
+  _index.insert(std::make_pair(source, _sources.size()));
+  _sources.push_back(source);
+}
+
+bool CProgramBatch::Build(cl_context context, const std::string &pragmaHeader, const char *options)
+{
+  // each permutation declares the same names, so they are renamed with a suffix
+  static const char *names[] = {"test_atomic_kernel", "test_atomic_function", "finishedThreads", "destMemory"};
+  std::string programSource = pragmaHeader;
+  const char *programLine;
+
+  _collecting = false;
+  if(_sources.empty())
+    return true;
+  for(size_t i = 0; i < _sources.size(); i++)
+  {
+    std::stringstream suffix;
+    suffix << "_" << i;
+    for(size_t n = 0; n < sizeof(names)/sizeof(names[0]); n++)
+      programSource += std::string("#define ")+names[n]+" "+names[n]+suffix.str()+"\n";
+    programSource += _sources[i];
+    for(size_t n = 0; n < sizeof(names)/sizeof(names[0]); n++)
+      programSource += std::string("#undef ")+names[n]+"\n";
+  }
+  programLine = programSource.c_str();
+  if(create_single_kernel_helper_with_build_options(context, &_program, NULL, 1, &programLine, NULL, options))
+  {
+    log_info("\tBuilding %u permutations at once failed, building them one by one\n", (cl_uint)_sources.size());
+    Release();
+    return false;
+  }
+  for(size_t i = 0; i < _sources.size(); i++)
+  {
+    std::stringstream kernelName;
+    kernelName << names[0] << "_" << i;
+    int error;
+    cl_kernel kernel = clCreateKernel(_program, kernelName.str().c_str(), &error);
+    if(error != CL_SUCCESS)
+    {
+      log_info("\tUnable to create kernel %s (%s), building the permutations one by one\n", kernelName.str().c_str(), IGetErrorString(error));
+      Release();
+      return false;
+    }
+    _kernels.push_back(kernel);
+  }
+  log_info("\tBuilt %u permutations in one program\n", (cl_uint)_sources.size());
+  return true;
+}
+
+cl_kernel CProgramBatch::Kernel(const std::string &source)
+{
+  std::multimap<std::string, size_t>::iterator it = _index.lower_bound(source);
+  if(it == _index.end() || it->first != source || it->second >= _kernels.size())
+    return NULL;
+  cl_kernel kernel = _kernels[it->second];
+  _kernels[it->second] = NULL;
+  _index.erase(it);
+  return kernel;
+}
+
+void CProgramBatch::Release()
+{
+  for(size_t i = 0; i < _kernels.size(); i++)
+    if(_kernels[i])
+      clReleaseKernel(_kernels[i]);
+  _kernels.clear();
+  _sources.clear();
+  _index.clear();
+  if(_program)
+    clReleaseProgram(_program);
+  _program = NULL;
+  _collecting = false;
+}
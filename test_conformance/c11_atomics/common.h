@@ -23,6 +23,7 @@
 #include "host_atomics.h"
 
 #include <vector>
+#include <map>
 #include <sstream>
 
 #define MAX_DEVICE_THREADS (gHost ? 0U : gMaxDeviceThreads)
@@ -65,6 +66,10 @@ extern bool gUseHostPtr; // use malloc/free instead of clSVMAlloc/clSVMFree
 extern bool gDebug; // print OpenCL kernel code
 extern int gInternalIterations; // internal test iterations for atomic operation, sufficient to verify atomicity
 extern int gMaxDeviceThreads; // maximum number of threads executed on OCL device
+extern bool gBatchPrograms; // build the kernels of all permutations of a test in one program
+extern bool gHostStress; // run the host atomics stress (atomic_host_stress)
+extern int gHostStressThreads; // maximum number of stress threads, 0 for one per CPU
+extern int gHostStressIterations; // operations per stress thread and measurement
 
 extern cl_uint gRandomSeed;
 
@@ -113,6 +118,30 @@ public:
   virtual int Execute(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements) = 0;
 };
 
+// Kernels of all the permutations of a test, built as a single program (-batch)
+class CProgramBatch
+{
+public:
+  CProgramBatch() : _collecting(false), _program(NULL) {}
+  ~CProgramBatch() {Release();}
+  void StartCollecting() {Release(); _collecting = true;}
+  bool Collecting() {return _collecting;}
+  // source of one permutation, without the pragma header
+  void Add(const std::string &source);
+  // builds the collected permutations, on failure they are built one by one
+  bool Build(cl_context context, const std::string &pragmaHeader, const char *options);
+  // hands a kernel built for the given source over to the caller, NULL if there is none
+  // (each kernel is used once, so that program scope variables start from their initializers)
+  cl_kernel Kernel(const std::string &source);
+  void Release();
+private:
+  bool _collecting;
+  std::multimap<std::string, size_t> _index;
+  std::vector<std::string> _sources;
+  std::vector<cl_kernel> _kernels;
+  cl_program _program;
+};
+
 template<typename HostAtomicType, typename HostDataType>
 class CBasicTest : CTest
 {
@@ -265,7 +294,16 @@ public:
     }
     if(_maxDeviceThreads+MaxHostThreads() == 0)
       return 0;
-    return ExecuteForEachParameterSet(deviceID, context, queue);
+    if(gBatchPrograms && !gOldAPI && _maxDeviceThreads > 0)
+    {
+      // dry run to collect the programs of all permutations, which are then built at once
+      _batch.StartCollecting();
+      ExecuteForEachParameterSet(deviceID, context, queue);
+      _batch.Build(context, PragmaHeader(deviceID), "-cl-std=CL2.0");
+    }
+    int error = ExecuteForEachParameterSet(deviceID, context, queue);
+    _batch.Release();
+    return error;
   }
   virtual void HostFunction(cl_uint tid, cl_uint threadCount, volatile HostAtomicType *destMemory, HostDataType *oldValues)
   {
@@ -333,6 +371,7 @@ private:
   cl_uint _currentGroupSize;
   cl_uint _passCount;
   const cl_int _iterations;
+  CProgramBatch _batch;
 };
 
 template<typename HostAtomicType, typename HostDataType>
@@ -820,16 +859,19 @@ int CBasicTest<HostAtomicType, HostDataType>::ExecuteSingleTest(cl_device_id dev
   threadCount = deviceThreadCount+hostThreadCount;
 
   //log_info("\t%s %s%s...\n", local ? "local" : "global", DataType().AtomicTypeName(), memoryOrderScope.c_str());
-  log_info("\t%s...\n", SingleTestName().c_str());
+  if(!_batch.Collecting())
+    log_info("\t%s...\n", SingleTestName().c_str());
 
   if(!LocalMemory() && DeclaredInProgram() && gNoGlobalVariables) // no support for program scope global variables
   {
-    log_info("\t\tTest disabled\n");
+    if(!_batch.Collecting())
+      log_info("\t\tTest disabled\n");
     return 0;
   }
   if(UsedInFunction() && GenericAddrSpace() && gNoGenericAddressSpace)
   {
-    log_info("\t\tTest disabled\n");
+    if(!_batch.Collecting())
+      log_info("\t\tTest disabled\n");
     return 0;
   }
 
@@ -848,6 +890,14 @@ int CBasicTest<HostAtomicType, HostDataType>::ExecuteSingleTest(cl_device_id dev
   // - needed for program source code generation (arrays of atomics declared in program)
   cl_uint numDestItems = NumResults(threadCount, deviceID);
 
+  if(_batch.Collecting())
+  {
+    // dry run of -batch, only the program is needed
+    if(deviceThreadCount > 0)
+      _batch.Add(ProgramHeader(numDestItems)+FunctionCode()+KernelCode(numDestItems));
+    return 0;
+  }
+
   if(deviceThreadCount > 0)
   {
     cl_ulong usedLocalMemory;
@@ -855,9 +905,11 @@ int CBasicTest<HostAtomicType, HostDataType>::ExecuteSingleTest(cl_device_id dev
     cl_uint maxWorkGroupSize;
 
     // Set up the kernel code
-    programSource = PragmaHeader(deviceID)+ProgramHeader(numDestItems)+FunctionCode()+KernelCode(numDestItems);
+    programSource = ProgramHeader(numDestItems)+FunctionCode()+KernelCode(numDestItems);
+    kernel = _batch.Kernel(programSource);
+    programSource = PragmaHeader(deviceID)+programSource;
     programLine = programSource.c_str();
-    if(create_single_kernel_helper_with_build_options(context, &program, &kernel, 1, &programLine, "test_atomic_kernel",
+    if(kernel == NULL && create_single_kernel_helper_with_build_options(context, &program, &kernel, 1, &programLine, "test_atomic_kernel",
       gOldAPI ? "" : "-cl-std=CL2.0"))
     {
       return -1;
@@ -0,0 +1,516 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "../../test_common/harness/testHarness.h"
+#include "../../test_common/harness/kernelHelpers.h"
+
+#include "common.h"
+#include "host_atomics.h"
+
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <unistd.h>
+#include <mach/mach_time.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+
+// Host atomics stress (-hostStress): pinned host threads hammer atomics in SVM (or host memory
+// with -useHostPtr) and the throughput of every operation and memory order is reported.
+
+// Counters of different threads are this far apart in the spread pattern. Two lines, so that
+// adjacent line prefetching does not pair them up.
+#define STRESS_LINE_SPACING 128
+
+enum TStressOperation
+{
+  STRESS_LOAD,
+  STRESS_STORE,
+  STRESS_EXCHANGE,
+  STRESS_COMPARE_EXCHANGE,
+  STRESS_FETCH_ADD,
+  STRESS_FETCH_SUB,
+  STRESS_FETCH_OR,
+  STRESS_FETCH_XOR,
+  STRESS_FETCH_AND,
+  STRESS_FETCH_MIN,
+  STRESS_FETCH_MAX
+};
+
+enum TStressPattern
+{
+  STRESS_ONE_LINE, // all threads use the same counter
+  STRESS_FALSE_SHARING, // each thread has its own counter, next to those of the other threads
+  STRESS_SPREAD // each thread has its own counter, on a line of its own
+};
+
+static const char *get_stress_operation_name(TStressOperation operation)
+{
+  switch(operation)
+  {
+  case STRESS_LOAD: return "atomic_load";
+  case STRESS_STORE: return "atomic_store";
+  case STRESS_EXCHANGE: return "atomic_exchange";
+  case STRESS_COMPARE_EXCHANGE: return "atomic_compare_exchange";
+  case STRESS_FETCH_ADD: return "atomic_fetch_add";
+  case STRESS_FETCH_SUB: return "atomic_fetch_sub";
+  case STRESS_FETCH_OR: return "atomic_fetch_or";
+  case STRESS_FETCH_XOR: return "atomic_fetch_xor";
+  case STRESS_FETCH_AND: return "atomic_fetch_and";
+  case STRESS_FETCH_MIN: return "atomic_fetch_min";
+  case STRESS_FETCH_MAX: return "atomic_fetch_max";
+  default: return 0;
+  }
+}
+
+static const char *get_stress_pattern_name(TStressPattern pattern)
+{
+  switch(pattern)
+  {
+  case STRESS_ONE_LINE: return "one line";
+  case STRESS_FALSE_SHARING: return "false sharing";
+  case STRESS_SPREAD: return "spread";
+  default: return 0;
+  }
+}
+
+static HOST_UINT StressStartValue(TStressOperation operation)
+{
+  return operation == STRESS_FETCH_AND || operation == STRESS_FETCH_MIN ? CL_UINT_MAX : 0;
+}
+
+// operand of thread tid
+static HOST_UINT StressArgument(TStressOperation operation, cl_uint tid)
+{
+  switch(operation)
+  {
+  case STRESS_FETCH_OR:
+  case STRESS_FETCH_XOR:
+    return 1U << (tid % 32);
+  case STRESS_FETCH_AND:
+    return ~(1U << (tid % 32));
+  default:
+    return tid+1;
+  }
+}
+
+static bool StressOrderApplicable(TStressOperation operation, TExplicitMemoryOrderType order)
+{
+  if(operation == STRESS_LOAD)
+    return order != MEMORY_ORDER_RELEASE && order != MEMORY_ORDER_ACQ_REL;
+  if(operation == STRESS_STORE)
+    return order != MEMORY_ORDER_ACQUIRE && order != MEMORY_ORDER_ACQ_REL;
+  return true;
+}
+
+static double StressNow()
+{
+#if defined(_WIN32)
+  LARGE_INTEGER count, frequency;
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&frequency);
+  return (double)count.QuadPart/(double)frequency.QuadPart;
+#elif defined(__APPLE__)
+  static mach_timebase_info_data_t info;
+  if(info.denom == 0)
+    mach_timebase_info(&info);
+  return (double)mach_absolute_time()*info.numer/info.denom*1e-9;
+#else
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec+t.tv_nsec*1e-9;
+#endif
+}
+
+// counter number index of the given pattern
+static volatile HOST_ATOMIC_UINT *StressCounter(char *memory, TStressPattern pattern, cl_uint index)
+{
+  size_t offset = pattern == STRESS_SPREAD ? index*STRESS_LINE_SPACING : index*sizeof(HOST_ATOMIC_UINT);
+  return (volatile HOST_ATOMIC_UINT*)(memory+offset);
+}
+
+// CPUs the test may run on, in the order threads are pinned to them
+static std::vector<cl_uint> StressCpus()
+{
+  std::vector<cl_uint> cpus;
+#if defined(_WIN32)
+  DWORD_PTR processMask, systemMask;
+  if(GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+    for(cl_uint i = 0; i < sizeof(processMask)*8; i++)
+      if(processMask & ((DWORD_PTR)1 << i))
+        cpus.push_back(i);
+#elif defined(__linux__) && !defined(__ANDROID__)
+  cpu_set_t affinity;
+  if(sched_getaffinity(0, sizeof(affinity), &affinity) == 0)
+    for(cl_uint i = 0; i < CPU_SETSIZE; i++)
+      if(CPU_ISSET(i, &affinity))
+        cpus.push_back(i);
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  for(long i = 0; i < count; i++)
+    cpus.push_back((cl_uint)i);
+#endif
+  if(cpus.empty())
+    cpus.push_back(0);
+  return cpus;
+}
+
+// returns false if the calling thread could not be pinned to the given CPU
+static bool StressPinThread(cl_uint cpu)
+{
+#if defined(_WIN32)
+  return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__) && !defined(__ANDROID__)
+  cpu_set_t affinity;
+  CPU_ZERO(&affinity);
+  CPU_SET(cpu, &affinity);
+  return pthread_setaffinity_np(pthread_self(), sizeof(affinity), &affinity) == 0;
+#else
+  // no way to pin a thread to a CPU
+  return false;
+#endif
+}
+
+struct TStressRun
+{
+  TStressOperation operation;
+  TExplicitMemoryOrderType order;
+  cl_uint iterations;
+  volatile cl_int ready;
+  volatile cl_int go;
+  volatile cl_int notPinned;
+};
+
+struct TStressThread
+{
+  TStressRun *run;
+  cl_uint cpu;
+  volatile HOST_ATOMIC_UINT *counter;
+  HOST_UINT argument;
+  HOST_UINT sink; // keeps loaded values alive
+#if defined(_WIN32)
+  HANDLE handle;
+#else
+  pthread_t handle;
+#endif
+};
+
+static void StressLoop(TStressThread *thread)
+{
+  TStressRun *run = thread->run;
+  volatile HOST_ATOMIC_UINT *a = thread->counter;
+  HOST_UINT c = thread->argument;
+  HOST_UINT sink = 0;
+  TExplicitMemoryOrderType order = run->order;
+  cl_uint n = run->iterations;
+
+  switch(run->operation)
+  {
+  case STRESS_LOAD:
+    for(cl_uint i = 0; i < n; i++)
+      sink += host_atomic_load<HOST_ATOMIC_UINT, HOST_UINT>(a, order);
+    break;
+  case STRESS_STORE:
+    for(cl_uint i = 0; i < n; i++)
+      host_atomic_store(a, c, order);
+    break;
+  case STRESS_EXCHANGE:
+    for(cl_uint i = 0; i < n; i++)
+      sink += host_atomic_exchange(a, c, order);
+    break;
+  case STRESS_COMPARE_EXCHANGE:
+    // increment, so that every operation is a successful exchange
+    for(cl_uint i = 0; i < n; i++)
+    {
+      HOST_UINT expected = host_atomic_load<HOST_ATOMIC_UINT, HOST_UINT>(a, MEMORY_ORDER_RELAXED);
+      while(!host_atomic_compare_exchange(a, &expected, (HOST_UINT)(expected+1), order, MEMORY_ORDER_RELAXED))
+        ;
+    }
+    break;
+  case STRESS_FETCH_ADD:
+    for(cl_uint i = 0; i < n; i++)
+      sink += host_atomic_fetch_add(a, (HOST_UINT)1, order);
+    break;
+  case STRESS_FETCH_SUB:
+    for(cl_uint i = 0; i < n; i++)
+      sink += host_atomic_fetch_sub(a, (HOST_UINT)1, order);
+    break;
+  case STRESS_FETCH_OR:
+    for(cl_uint i = 0; i < n; i++)
+      sink += host_atomic_fetch_or(a, c, order);
+    break;
+  case STRESS_FETCH_XOR:
+    for(cl_uint i = 0; i < n; i++)
+      sink += host_atomic_fetch_xor(a, c, order);
+    break;
+  case STRESS_FETCH_AND:
+    for(cl_uint i = 0; i < n; i++)
+      sink += host_atomic_fetch_and(a, c, order);
+    break;
+  case STRESS_FETCH_MIN:
+    for(cl_uint i = 0; i < n; i++)
+      sink += host_atomic_fetch_min(a, c, order);
+    break;
+  case STRESS_FETCH_MAX:
+    for(cl_uint i = 0; i < n; i++)
+      sink += host_atomic_fetch_max(a, c, order);
+    break;
+  }
+  thread->sink = sink;
+}
+
+#if defined(_WIN32)
+static unsigned __stdcall StressThreadFunction(void *userInfo)
+#else
+static void *StressThreadFunction(void *userInfo)
+#endif
+{
+  TStressThread *thread = (TStressThread*)userInfo;
+  TStressRun *run = thread->run;
+
+  if(!StressPinThread(thread->cpu))
+    ThreadPool_AtomicAdd(&run->notPinned, 1);
+  // wait for all the threads, so that thread creation is not timed
+  ThreadPool_AtomicAdd(&run->ready, 1);
+  while(!run->go)
+    ;
+  StressLoop(thread);
+  return 0;
+}
+
+// Value the counter must have after the given threads ran the operation on it
+static bool StressVerify(TStressOperation operation, cl_uint iterations, HOST_UINT value, const std::vector<cl_uint> &tids)
+{
+  HOST_UINT expected = StressStartValue(operation);
+  HOST_UINT count = (HOST_UINT)tids.size()*iterations;
+
+  if(tids.empty())
+    return value == expected;
+  switch(operation)
+  {
+  case STRESS_STORE:
+  case STRESS_EXCHANGE:
+    // the last one wins
+    for(size_t i = 0; i < tids.size(); i++)
+      if(value == StressArgument(operation, tids[i]))
+        return true;
+    return false;
+  case STRESS_COMPARE_EXCHANGE:
+  case STRESS_FETCH_ADD:
+    return value == (HOST_UINT)(expected+count);
+  case STRESS_FETCH_SUB:
+    return value == (HOST_UINT)(expected-count);
+  default:
+    break;
+  }
+  for(size_t i = 0; i < tids.size(); i++)
+  {
+    HOST_UINT c = StressArgument(operation, tids[i]);
+    switch(operation)
+    {
+    case STRESS_FETCH_OR: expected |= c; break;
+    case STRESS_FETCH_XOR: expected ^= (iterations & 1) ? c : 0; break;
+    case STRESS_FETCH_AND: expected &= c; break;
+    case STRESS_FETCH_MIN: expected = c < expected ? c : expected; break;
+    case STRESS_FETCH_MAX: expected = c > expected ? c : expected; break;
+    default: break;
+    }
+  }
+  return value == expected;
+}
+
+// Runs one operation with threadCount threads, returns operations per second or a negative value on error
+static double StressRun(TStressOperation operation, TExplicitMemoryOrderType order, TStressPattern pattern,
+                        cl_uint threadCount, const std::vector<cl_uint> &cpus, char *memory, bool &pinned)
+{
+  TStressRun run;
+  std::vector<TStressThread> threads(threadCount);
+  std::vector<std::vector<cl_uint> > users(threadCount);
+  cl_uint started;
+  double start, end;
+  bool correct = true;
+
+  run.operation = operation;
+  run.order = order;
+  run.iterations = gHostStressIterations;
+  run.ready = 0;
+  run.go = 0;
+  run.notPinned = 0;
+
+  for(cl_uint index = 0; index < threadCount; index++)
+    host_atomic_init(StressCounter(memory, pattern, index), StressStartValue(operation));
+  for(cl_uint tid = 0; tid < threadCount; tid++)
+  {
+    cl_uint index = pattern == STRESS_ONE_LINE ? 0 : tid;
+
+    threads[tid].run = &run;
+    threads[tid].cpu = cpus[tid % cpus.size()];
+    threads[tid].counter = StressCounter(memory, pattern, index);
+    threads[tid].argument = StressArgument(operation, tid);
+    users[index].push_back(tid);
+  }
+
+  for(started = 0; started < threadCount; started++)
+  {
+#if defined(_WIN32)
+    threads[started].handle = (HANDLE)_beginthreadex(NULL, 0, StressThreadFunction, &threads[started], 0, NULL);
+    if(threads[started].handle == 0)
+      break;
+#else
+    if(pthread_create(&threads[started].handle, NULL, StressThreadFunction, &threads[started]))
+      break;
+#endif
+  }
+  if(started < threadCount)
+    log_error("ERROR: Unable to create stress thread %u\n", started);
+
+  while((cl_uint)run.ready < started)
+    ;
+  start = StressNow();
+  ThreadPool_AtomicAdd(&run.go, 1);
+  for(cl_uint tid = 0; tid < started; tid++)
+  {
+#if defined(_WIN32)
+    WaitForSingleObject(threads[tid].handle, INFINITE);
+    CloseHandle(threads[tid].handle);
+#else
+    pthread_join(threads[tid].handle, NULL);
+#endif
+  }
+  end = StressNow();
+  pinned = run.notPinned == 0;
+  if(started < threadCount)
+    return -1;
+
+  for(cl_uint index = 0; index < threadCount; index++)
+  {
+    HOST_UINT value = host_atomic_load<HOST_ATOMIC_UINT, HOST_UINT>(StressCounter(memory, pattern, index), MEMORY_ORDER_SEQ_CST);
+    if(!StressVerify(operation, run.iterations, value, users[index]))
+    {
+      log_error("ERROR: %s, %s, %s, %u threads: counter %u has unexpected value %u\n",
+        get_stress_operation_name(operation), get_memory_order_type_name(order), get_stress_pattern_name(pattern),
+        threadCount, index, (cl_uint)value);
+      correct = false;
+    }
+  }
+  if(!correct)
+    return -1;
+  return (double)threadCount*run.iterations/(end > start ? end-start : 1e-9);
+}
+
+int test_atomic_host_stress(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements)
+{
+  const TStressOperation operations[] = {
+    STRESS_LOAD, STRESS_STORE, STRESS_EXCHANGE, STRESS_COMPARE_EXCHANGE, STRESS_FETCH_ADD, STRESS_FETCH_SUB,
+    STRESS_FETCH_OR, STRESS_FETCH_XOR, STRESS_FETCH_AND, STRESS_FETCH_MIN, STRESS_FETCH_MAX
+  };
+  const TExplicitMemoryOrderType orders[] = {
+    MEMORY_ORDER_RELAXED, MEMORY_ORDER_ACQUIRE, MEMORY_ORDER_RELEASE, MEMORY_ORDER_ACQ_REL, MEMORY_ORDER_SEQ_CST
+  };
+  const TStressPattern patterns[] = {STRESS_ONE_LINE, STRESS_FALSE_SHARING, STRESS_SPREAD};
+  std::vector<cl_uint> cpus = StressCpus();
+  std::vector<cl_uint> threadCounts;
+  cl_uint maxThreads = gHostStressThreads > 0 ? (cl_uint)gHostStressThreads : (cl_uint)cpus.size();
+  bool useSVM = !gUseHostPtr;
+  bool allPinned = true;
+  char *memory;
+  int error = 0;
+
+  if(!gHostStress)
+  {
+    log_info("\tSkipped, use -hostStress to run it\n");
+    return 0;
+  }
+
+  if(useSVM)
+  {
+    cl_device_svm_capabilities caps;
+    cl_int err = clGetDeviceInfo(deviceID, CL_DEVICE_SVM_CAPABILITIES, sizeof(caps), &caps, 0);
+    test_error(err, "clGetDeviceInfo failed");
+    if((caps & CL_DEVICE_SVM_FINE_GRAIN_BUFFER) == 0 || (caps & CL_DEVICE_SVM_ATOMICS) == 0)
+    {
+      log_info("\tFine grain SVM with atomics not supported, using host memory\n");
+      useSVM = false;
+    }
+  }
+  if(useSVM)
+    memory = (char*)clSVMAlloc(context, CL_MEM_SVM_FINE_GRAIN_BUFFER | CL_MEM_SVM_ATOMICS, STRESS_LINE_SPACING*maxThreads, STRESS_LINE_SPACING);
+  else
+    memory = (char*)align_malloc(STRESS_LINE_SPACING*maxThreads, STRESS_LINE_SPACING);
+  if(!memory)
+  {
+    log_error("ERROR: Unable to allocate %u bytes for the stress counters\n", STRESS_LINE_SPACING*maxThreads);
+    return -1;
+  }
+
+  // 1, 2, 4, ... threads and then all of them
+  for(cl_uint threadCount = 1; threadCount < maxThreads; threadCount *= 2)
+    threadCounts.push_back(threadCount);
+  threadCounts.push_back(maxThreads);
+
+  log_info("\t%u CPUs, up to %u threads, %d operations per thread, counters in %s\n", (cl_uint)cpus.size(), maxThreads,
+    gHostStressIterations, useSVM ? "fine grain SVM" : "host memory");
+  log_info("\t%-24s %-21s %-14s %8s %16s\n", "operation", "memory order", "pattern", "threads", "ops/s");
+  for(size_t oi = 0; oi < sizeof(operations)/sizeof(operations[0]); oi++)
+  {
+    for(size_t mi = 0; mi < sizeof(orders)/sizeof(orders[0]); mi++)
+    {
+      if(!StressOrderApplicable(operations[oi], orders[mi]))
+        continue;
+      for(size_t pi = 0; pi < sizeof(patterns)/sizeof(patterns[0]); pi++)
+      {
+        for(size_t ti = 0; ti < threadCounts.size(); ti++)
+        {
+          bool pinned;
+          // a single thread behaves the same for all patterns
+          if(threadCounts[ti] == 1 && patterns[pi] != STRESS_ONE_LINE)
+            continue;
+          double opsPerSecond = StressRun(operations[oi], orders[mi], patterns[pi], threadCounts[ti], cpus, memory, pinned);
+          allPinned = allPinned && pinned;
+          if(opsPerSecond < 0)
+          {
+            error = -1;
+            if(!gContinueOnError)
+              break;
+            continue;
+          }
+          log_info("\t%-24s %-21s %-14s %8u %16.0f\n", get_stress_operation_name(operations[oi]),
+            get_memory_order_type_name(orders[mi]), get_stress_pattern_name(patterns[pi]), threadCounts[ti], opsPerSecond);
+        }
+        if(error && !gContinueOnError)
+          break;
+      }
+      if(error && !gContinueOnError)
+        break;
+    }
+    if(error && !gContinueOnError)
+      break;
+  }
+  if(!allPinned)
+    log_info("\tWARNING: Some threads could not be pinned to a CPU\n");
+
+  if(useSVM)
+    clSVMFree(context, memory);
+  else
+    align_free(memory);
+  return error;
+}
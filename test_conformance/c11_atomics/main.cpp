@@ -26,6 +26,10 @@ bool gUseHostPtr = false; // use malloc/free with CL_MEM_USE_HOST_PTR instead of
 bool gDebug = false; // always print OpenCL kernel code
 int gInternalIterations = 10000; // internal test iterations for atomic operation, sufficient to verify atomicity
 int gMaxDeviceThreads = 1024; // maximum number of threads executed on OCL device
+bool gBatchPrograms = false; // build the kernels of all permutations of a test in one program
+bool gHostStress = false; // run the host atomics stress (atomic_host_stress)
+int gHostStressThreads = 0; // maximum number of stress threads, 0 for one per CPU
+int gHostStressIterations = 100000; // operations per stress thread and measurement
 
 extern int test_atomic_init(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements);
 extern int test_atomic_store(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements);
@@ -65,6 +69,8 @@ extern int test_atomic_fetch_max_svm(cl_device_id deviceID, cl_context context,
 extern int test_atomic_flag_svm(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements);
 extern int test_atomic_fence_svm(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements);
 
+extern int test_atomic_host_stress(cl_device_id deviceID, cl_context context, cl_command_queue queue, int num_elements);
+
 basefn    basefn_list[] = {
   test_atomic_init,
   test_atomic_store,
@@ -100,7 +106,9 @@ basefn    basefn_list[] = {
   test_atomic_fetch_min_svm,
   test_atomic_fetch_max_svm,
   test_atomic_flag_svm,
-  test_atomic_fence_svm
+  test_atomic_fence_svm,
+
+  test_atomic_host_stress
 };
 
 const char    *basefn_names[] = {
@@ -139,6 +147,8 @@ const char    *basefn_names[] = {
   "svm_atomic_fetch_max",
   "svm_atomic_flag",
   "svm_atomic_fence",
+
+  "atomic_host_stress",
 };
 
 ct_assert((sizeof(basefn_names) / sizeof(basefn_names[0])) == (sizeof(basefn_list) / sizeof(basefn_list[0])));
@@ -160,8 +170,12 @@ int main(int argc, const char *argv[])
       log_info("  '-noGenericAddressSpace'   disable cases with generic address space\n");
       log_info("  '-useHostPtr'              use malloc/free with CL_MEM_USE_HOST_PTR instead of clSVMAlloc/clSVMFree\n");
       log_info("  '-debug'                   always print OpenCL kernel code\n");
+      log_info("  '-batch'                   build the kernels of all memory order/scope permutations of a test in one program\n");
       log_info("  '-internalIterations <X>'  internal test iterations for atomic operation, sufficient to verify atomicity\n");
-      log_info("  '-maxDeviceThreads <X>'    maximum number of threads executed on OCL device");
+      log_info("  '-maxDeviceThreads <X>'    maximum number of threads executed on OCL device\n");
+      log_info("  '-hostStress'              run atomic_host_stress: throughput of host atomics under contention from pinned threads\n");
+      log_info("  '-hostStressThreads <X>'   maximum number of stress threads (default: one per CPU)\n");
+      log_info("  '-hostStressIterations <X>' operations per stress thread and measurement");
 
       break;
     }
@@ -197,6 +211,8 @@ int main(int argc, const char *argv[])
     }
     else if(std::string(argv[argc-1]) == "-debug") // print OpenCL kernel code
       gDebug = true;
+    else if(std::string(argv[argc-1]) == "-batch") // build the kernels of all permutations of a test in one program
+      gBatchPrograms = true;
     else if(argc > 2 && std::string(argv[argc-2]) == "-internalIterations") // internal test iterations for atomic operation, sufficient to verify atomicity
     {
       gInternalIterations = atoi(argv[argc-1]);
@@ -214,6 +230,28 @@ int main(int argc, const char *argv[])
       argc--;
       noCert = true;
     }
+    else if(std::string(argv[argc-1]) == "-hostStress") // run the host atomics stress
+      gHostStress = true;
+    else if(argc > 2 && std::string(argv[argc-2]) == "-hostStressThreads") // maximum number of stress threads
+    {
+      gHostStressThreads = atoi(argv[argc-1]);
+      if(gHostStressThreads < 0)
+      {
+        log_info("Invalid value: Number of stress threads (%d) must be >= 0\n", gHostStressThreads);
+        return -1;
+      }
+      argc--;
+    }
+    else if(argc > 2 && std::string(argv[argc-2]) == "-hostStressIterations") // operations per stress thread and measurement
+    {
+      gHostStressIterations = atoi(argv[argc-1]);
+      if(gHostStressIterations < 1)
+      {
+        log_info("Invalid value: Number of stress iterations (%d) must be > 0\n", gHostStressIterations);
+        return -1;
+      }
+      argc--;
+    }
     else
       break;
     argc--;
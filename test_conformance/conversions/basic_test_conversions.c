@@ -45,6 +45,14 @@ static inline cl_ulong random64( MTdata d );
 #endif
 #endif // _WIN32
 
+// With SSE2 the float and double to integer conversions round whole blocks at a time (see ROUNDED_MANY)
+// and the per-element versions of them are not needed.
+#if defined( __SSE2__ ) && !defined( _MSC_VER )
+    #define ROUND_CONVERSIONS_IN_BLOCKS     1
+#else
+    #define ROUND_CONVERSIONS_IN_BLOCKS     0
+#endif
+
 const char *gTypeNames[ kTypeCount ] = {
                                             "uchar", "char",
                                             "ushort", "short",
@@ -298,13 +306,15 @@ static void int2float( void *, void *);
 static void int2double( void *, void *);
 static void int2ulong( void *, void *);
 static void int2long( void *, void *);
+static void float2double( void *, void *);
+static void double2float( void *, void *);
+#if !ROUND_CONVERSIONS_IN_BLOCKS
 static void float2uchar( void *, void *);
 static void float2char( void *, void *);
 static void float2ushort( void *, void *);
 static void float2short( void *, void *);
 static void float2uint( void *, void *);
 static void float2int( void *, void *);
-static void float2double( void *, void *);
 static void float2ulong( void *, void *);
 static void float2long( void *, void *);
 static void double2uchar( void *, void *);
@@ -313,9 +323,9 @@ static void double2ushort( void *, void *);
 static void double2short( void *, void *);
 static void double2uint( void *, void *);
 static void double2int( void *, void *);
-static void double2float( void *, void *);
 static void double2ulong( void *, void *);
 static void double2long( void *, void *);
+#endif
 static void ulong2uchar( void *, void *);
 static void ulong2char( void *, void *);
 static void ulong2ushort( void *, void *);
@@ -436,13 +446,15 @@ static void int2float_sat( void *, void *);
 static void int2double_sat( void *, void *);
 static void int2ulong_sat( void *, void *);
 static void int2long_sat( void *, void *);
+static void float2double_sat( void *, void *);
+static void double2float_sat( void *, void *);
+#if !ROUND_CONVERSIONS_IN_BLOCKS
 static void float2uchar_sat( void *, void *);
 static void float2char_sat( void *, void *);
 static void float2ushort_sat( void *, void *);
 static void float2short_sat( void *, void *);
 static void float2uint_sat( void *, void *);
 static void float2int_sat( void *, void *);
-static void float2double_sat( void *, void *);
 static void float2ulong_sat( void *, void *);
 static void float2long_sat( void *, void *);
 static void double2uchar_sat( void *, void *);
@@ -451,9 +463,9 @@ static void double2ushort_sat( void *, void *);
 static void double2short_sat( void *, void *);
 static void double2uint_sat( void *, void *);
 static void double2int_sat( void *, void *);
-static void double2float_sat( void *, void *);
 static void double2ulong_sat( void *, void *);
 static void double2long_sat( void *, void *);
+#endif
 static void ulong2uchar_sat( void *, void *);
 static void ulong2char_sat( void *, void *);
 static void ulong2ushort_sat( void *, void *);
@@ -705,13 +717,15 @@ static void int2double( void *out, void *in)
 }
 static void int2ulong( void *out, void *in){ ((cl_ulong*) out)[0] = ((cl_int*) in)[0]; }
 static void int2long( void *out, void *in){ ((cl_long*) out)[0] = ((cl_int*) in)[0]; }
+static void float2double( void *out, void *in){ ((cl_double*) out)[0] = ((cl_float*) in)[0]; }
+static void double2float( void *out, void *in){ ((cl_float*) out)[0] = (float) ((cl_double*) in)[0]; }
+#if !ROUND_CONVERSIONS_IN_BLOCKS
 static void float2uchar( void *out, void *in){ ((cl_uchar*) out)[0] = my_rintf(((cl_float*) in)[0]); }
 static void float2char( void *out, void *in){ ((cl_char*) out)[0] = my_rintf(((cl_float*) in)[0]); }
 static void float2ushort( void *out, void *in){ ((cl_ushort*) out)[0] = my_rintf(((cl_float*) in)[0]); }
 static void float2short( void *out, void *in){ ((cl_short*) out)[0] = my_rintf(((cl_float*) in)[0]); }
 static void float2uint( void *out, void *in){ ((cl_uint*) out)[0] = my_rintf(((cl_float*) in)[0]); }
 static void float2int( void *out, void *in){ ((cl_int*) out)[0] = my_rintf(((cl_float*) in)[0]); }
-static void float2double( void *out, void *in){ ((cl_double*) out)[0] = ((cl_float*) in)[0]; }
 static void float2ulong( void *out, void *in)
 {
 #if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
@@ -740,9 +754,9 @@ static void double2ushort( void *out, void *in){ ((cl_ushort*) out)[0] = rint(((
 static void double2short( void *out, void *in){ ((cl_short*) out)[0] = rint(((cl_double*) in)[0]); }
 static void double2uint( void *out, void *in){ ((cl_uint*) out)[0] = (cl_uint) rint(((cl_double*) in)[0]); }
 static void double2int( void *out, void *in){ ((cl_int*) out)[0] = (int) rint(((cl_double*) in)[0]); }
-static void double2float( void *out, void *in){ ((cl_float*) out)[0] = (float) ((cl_double*) in)[0]; }
 static void double2ulong( void *out, void *in){ ((cl_ulong*) out)[0] = (cl_ulong) rint(((cl_double*) in)[0]); }
 static void double2long( void *out, void *in){ ((cl_long*) out)[0] = (cl_long) rint(((cl_double*) in)[0]); }
+#endif
 static void ulong2uchar( void *out, void *in){ ((cl_uchar*) out)[0] = (cl_uchar) ((cl_ulong*) in)[0]; }
 static void ulong2char( void *out, void *in){ ((cl_char*) out)[0] = (cl_char) ((cl_ulong*) in)[0]; }
 static void ulong2ushort( void *out, void *in){ ((cl_ushort*) out)[0] = (cl_ushort) ((cl_ulong*) in)[0]; }
@@ -895,13 +909,15 @@ static void int2float_sat( void *out, void *in){ ((cl_float*) out)[0] = ((cl_int
 static void int2double_sat( void *out, void *in){ ((cl_double*) out)[0] = ((cl_int*) in)[0]; }
 static void int2ulong_sat( void *out, void *in){ cl_int i = ((cl_int*) in)[0]; ((cl_ulong*) out)[0] = i < 0 ? 0 : i; }
 static void int2long_sat( void *out, void *in){ ((cl_long*) out)[0] = ((cl_int*) in)[0]; }
+static void float2double_sat( void *out, void *in){ ((cl_double*) out)[0] = ((cl_float*) in)[0]; }
+static void double2float_sat( void *out, void *in){ ((cl_float*) out)[0] = (cl_float) ((double*) in)[0]; }
+#if !ROUND_CONVERSIONS_IN_BLOCKS
 static void float2uchar_sat( void *out, void *in){ ((cl_uchar*) out)[0] = CLAMP( 0, lrintf_clamped(((cl_float*) in)[0]), CL_UCHAR_MAX ); }
 static void float2char_sat( void *out, void *in){ ((cl_char*) out)[0] = CLAMP( CL_CHAR_MIN, lrintf_clamped(((cl_float*) in)[0]), CL_CHAR_MAX); }
 static void float2ushort_sat( void *out, void *in){ ((cl_ushort*) out)[0] = CLAMP( 0, lrintf_clamped(((cl_float*) in)[0]), CL_USHRT_MAX ); }
 static void float2short_sat( void *out, void *in){ ((cl_short*) out)[0] = CLAMP( CL_SHRT_MIN, lrintf_clamped(((cl_float*) in)[0]), CL_SHRT_MAX ); }
 static void float2uint_sat( void *out, void *in){ ((cl_uint*) out)[0] = (cl_uint) CLAMP( 0, llrintf_clamped(((cl_float*) in)[0]), CL_UINT_MAX ); }
 static void float2int_sat( void *out, void *in){ ((cl_int*) out)[0] = (cl_int) CLAMP( CL_INT_MIN, lrintf_clamped(((cl_float*) in)[0]), CL_INT_MAX ); }
-static void float2double_sat( void *out, void *in){ ((cl_double*) out)[0] = ((cl_float*) in)[0]; }
 static void float2ulong_sat( void *out, void *in)
 {
 #if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
@@ -936,9 +952,9 @@ static void double2ushort_sat( void *out, void *in){ ((cl_ushort*) out)[0] = CLA
 static void double2short_sat( void *out, void *in){ ((cl_short*) out)[0] = CLAMP( CL_SHRT_MIN, lrint_clamped(((cl_double*) in)[0]), CL_SHRT_MAX ); }
 static void double2uint_sat( void *out, void *in){ ((cl_uint*) out)[0] = (cl_uint) CLAMP( 0, llrint_clamped(((cl_double*) in)[0]), CL_UINT_MAX ); }
 static void double2int_sat( void *out, void *in){ ((cl_int*) out)[0] = (cl_int) CLAMP( CL_INT_MIN, lrint_clamped(((cl_double*) in)[0]), CL_INT_MAX ); }
-static void double2float_sat( void *out, void *in){ ((cl_float*) out)[0] = (cl_float) ((double*) in)[0]; }
 static void double2ulong_sat( void *out, void *in){ double f = rint(((double*) in)[0]); ((cl_ulong*) out)[0] = f >= MAKE_HEX_DOUBLE(0x1.0p64, 0x1LL, 64) ? 0xFFFFFFFFFFFFFFFFULL : f < 0 ? 0 : (cl_ulong) f; }
 static void double2long_sat( void *out, void *in){ double f = rint(((double*) in)[0]); ((cl_long*) out)[0] = f >= MAKE_HEX_DOUBLE(0x1.0p63, 0x1LL, 63) ? 0x7FFFFFFFFFFFFFFFULL : f < MAKE_HEX_DOUBLE(-0x1.0p63, -0x1LL, 63) ? 0x8000000000000000LL : (cl_long) f; }
+#endif
 static void ulong2uchar_sat( void *out, void *in){ cl_ulong u = ((cl_ulong*) in)[0]; ((cl_uchar*) out)[0] = CLAMP( 0, u, CL_UCHAR_MAX ); }
 static void ulong2char_sat( void *out, void *in){ cl_ulong u = ((cl_ulong*) in)[0]; ((cl_char*) out)[0] = CLAMP( 0, u, CL_CHAR_MAX ); }
 static void ulong2ushort_sat( void *out, void *in){ cl_ulong u = ((cl_ulong*) in)[0]; ((cl_ushort*) out)[0] = CLAMP( 0, u, CL_USHRT_MAX ); }
@@ -2030,10 +2046,6 @@ void uint2uchar_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n
 void uint2uchar_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ uint2uchar_sat( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_uint)); }}
 void int2uchar_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2uchar( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_int)); }}
 void int2uchar_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2uchar_sat( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_int)); }}
-void float2uchar_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2uchar( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_float)); }}
-void float2uchar_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2uchar_sat( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_float)); }}
-void double2uchar_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2uchar( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_double)); }}
-void double2uchar_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2uchar_sat( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_double)); }}
 void ulong2uchar_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2uchar( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_ulong)); }}
 void ulong2uchar_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2uchar_sat( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_ulong)); }}
 void long2uchar_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ long2uchar( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_long)); }}
@@ -2050,10 +2062,6 @@ void uint2char_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n;
 void uint2char_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ uint2char_sat( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_uint)); }}
 void int2char_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2char( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_int)); }}
 void int2char_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2char_sat( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_int)); }}
-void float2char_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2char( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_float)); }}
-void float2char_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2char_sat( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_float)); }}
-void double2char_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2char( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_double)); }}
-void double2char_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2char_sat( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_double)); }}
 void ulong2char_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2char( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_ulong)); }}
 void ulong2char_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2char_sat( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_ulong)); }}
 void long2char_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ long2char( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_long)); }}
@@ -2070,10 +2078,6 @@ void uint2ushort_many( void *out, void *in, size_t n){size_t i; for( i = 0; i <
 void uint2ushort_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ uint2ushort_sat( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_uint)); }}
 void int2ushort_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2ushort( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_int)); }}
 void int2ushort_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2ushort_sat( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_int)); }}
-void float2ushort_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2ushort( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_float)); }}
-void float2ushort_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2ushort_sat( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_float)); }}
-void double2ushort_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2ushort( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_double)); }}
-void double2ushort_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2ushort_sat( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_double)); }}
 void ulong2ushort_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2ushort( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_ulong)); }}
 void ulong2ushort_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2ushort_sat( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_ulong)); }}
 void long2ushort_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ long2ushort( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_long)); }}
@@ -2090,10 +2094,6 @@ void uint2short_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n
 void uint2short_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ uint2short_sat( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_uint)); }}
 void int2short_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2short( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_int)); }}
 void int2short_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2short_sat( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_int)); }}
-void float2short_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2short( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_float)); }}
-void float2short_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2short_sat( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_float)); }}
-void double2short_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2short( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_double)); }}
-void double2short_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2short_sat( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_double)); }}
 void ulong2short_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2short( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_ulong)); }}
 void ulong2short_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2short_sat( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_ulong)); }}
 void long2short_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ long2short( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_long)); }}
@@ -2110,10 +2110,6 @@ void uint2uint_many( void *out, void *in, size_t n){ memcpy( out, in, n * sizeof
 void uint2uint_sat_many( void *out, void *in, size_t n){ memcpy( out, in, n * sizeof( cl_uint )); }
 void int2uint_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2uint( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_int)); }}
 void int2uint_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2uint_sat( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_int)); }}
-void float2uint_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2uint( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_float)); }}
-void float2uint_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2uint_sat( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_float)); }}
-void double2uint_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2uint( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_double)); }}
-void double2uint_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2uint_sat( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_double)); }}
 void ulong2uint_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2uint( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_ulong)); }}
 void ulong2uint_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2uint_sat( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_ulong)); }}
 void long2uint_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ long2uint( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_long)); }}
@@ -2130,10 +2126,6 @@ void uint2int_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n;
 void uint2int_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ uint2int_sat( (char*) out + i * sizeof(cl_int), (char*) in + i * sizeof(cl_uint)); }}
 void int2int_many( void *out, void *in, size_t n){ memcpy( out, in, n * sizeof( cl_int )); }
 void int2int_sat_many( void *out, void *in, size_t n){ memcpy( out, in, n * sizeof( cl_int )); }
-void float2int_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2int( (char*) out + i * sizeof(cl_int), (char*) in + i * sizeof(cl_float)); }}
-void float2int_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2int_sat( (char*) out + i * sizeof(cl_int), (char*) in + i * sizeof(cl_float)); }}
-void double2int_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2int( (char*) out + i * sizeof(cl_int), (char*) in + i * sizeof(cl_double)); }}
-void double2int_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2int_sat( (char*) out + i * sizeof(cl_int), (char*) in + i * sizeof(cl_double)); }}
 void ulong2int_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2int( (char*) out + i * sizeof(cl_int), (char*) in + i * sizeof(cl_ulong)); }}
 void ulong2int_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2int_sat( (char*) out + i * sizeof(cl_int), (char*) in + i * sizeof(cl_ulong)); }}
 void long2int_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ long2int( (char*) out + i * sizeof(cl_int), (char*) in + i * sizeof(cl_long)); }}
@@ -2190,10 +2182,6 @@ void uint2ulong_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n
 void uint2ulong_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ uint2ulong_sat( (char*) out + i * sizeof(cl_ulong), (char*) in + i * sizeof(cl_uint)); }}
 void int2ulong_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2ulong( (char*) out + i * sizeof(cl_ulong), (char*) in + i * sizeof(cl_int)); }}
 void int2ulong_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2ulong_sat( (char*) out + i * sizeof(cl_ulong), (char*) in + i * sizeof(cl_int)); }}
-void float2ulong_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2ulong( (char*) out + i * sizeof(cl_ulong), (char*) in + i * sizeof(cl_float)); }}
-void float2ulong_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2ulong_sat( (char*) out + i * sizeof(cl_ulong), (char*) in + i * sizeof(cl_float)); }}
-void double2ulong_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2ulong( (char*) out + i * sizeof(cl_ulong), (char*) in + i * sizeof(cl_double)); }}
-void double2ulong_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2ulong_sat( (char*) out + i * sizeof(cl_ulong), (char*) in + i * sizeof(cl_double)); }}
 void ulong2ulong_many( void *out, void *in, size_t n){ memcpy( out, in, n * sizeof( cl_ulong )); }
 void ulong2ulong_sat_many( void *out, void *in, size_t n){ memcpy( out, in, n * sizeof( cl_ulong )); }
 void long2ulong_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ long2ulong( (char*) out + i * sizeof(cl_ulong), (char*) in + i * sizeof(cl_long)); }}
@@ -2210,15 +2198,187 @@ void uint2long_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n;
 void uint2long_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ uint2long_sat( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_uint)); }}
 void int2long_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2long( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_int)); }}
 void int2long_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ int2long_sat( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_int)); }}
-void float2long_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2long( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_float)); }}
-void float2long_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2long_sat( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_float)); }}
-void double2long_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2long( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_double)); }}
-void double2long_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2long_sat( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_double)); }}
 void ulong2long_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2long( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_ulong)); }}
 void ulong2long_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ ulong2long_sat( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_ulong)); }}
 void long2long_many( void *out, void *in, size_t n){ memcpy( out, in, n * sizeof( cl_long )); }
 void long2long_sat_many( void *out, void *in, size_t n){ memcpy( out, in, n * sizeof( cl_long )); }
 
+#if ROUND_CONVERSIONS_IN_BLOCKS
+// Round whole blocks to integral values in the current rounding mode with the same magic number addition
+// as my_rintf and lrint_clamped, four (two) lanes at a time, then apply the per-type clamp and cast to each
+// element. The results are the same as calling the per-element conversions above.
+#define kRoundBlockSize     256
+
+static void my_rintf_many( float *out, const float *in, size_t n )
+{
+    const __m128 limit = _mm_set1_ps( MAKE_HEX_FLOAT( 0x1.0p23f, 0x1, 23) );
+    const __m128 signMask = _mm_set1_ps( -0.0f );
+    const __m128 zero = _mm_setzero_ps();
+    size_t i = 0;
+    for( ; i + 4 <= n; i += 4 )
+    {
+        __m128 v = _mm_loadu_ps( in + i );
+        __m128 isSmall = _mm_cmplt_ps( _mm_andnot_ps( signMask, v ), limit );
+        __m128 magic = _mm_or_ps( limit, _mm_and_ps( _mm_cmplt_ps( v, zero ), signMask ) );
+        __m128 r = _mm_sub_ps( _mm_add_ps( v, magic ), magic );
+        _mm_storeu_ps( out + i, _mm_or_ps( _mm_and_ps( isSmall, r ), _mm_andnot_ps( isSmall, v ) ) );
+    }
+    for( ; i < n; i++ )
+        out[ i ] = my_rintf( in[ i ] );
+}
+
+static void my_rint_many( double *out, const double *in, size_t n )
+{
+    const __m128d limit = _mm_set1_pd( MAKE_HEX_DOUBLE(0x1.0p52, 0x1LL, 52) );
+    const __m128d signMask = _mm_set1_pd( -0.0 );
+    const __m128d zero = _mm_setzero_pd();
+    size_t i = 0;
+    for( ; i + 2 <= n; i += 2 )
+    {
+        __m128d v = _mm_loadu_pd( in + i );
+        __m128d isSmall = _mm_cmplt_pd( _mm_andnot_pd( signMask, v ), limit );
+        __m128d magic = _mm_or_pd( limit, _mm_and_pd( _mm_cmplt_pd( v, zero ), signMask ) );
+        __m128d r = _mm_sub_pd( _mm_add_pd( v, magic ), magic );
+        _mm_storeu_pd( out + i, _mm_or_pd( _mm_and_pd( isSmall, r ), _mm_andnot_pd( isSmall, v ) ) );
+    }
+    for( ; i < n; i++ )
+        out[ i ] = rint( in[ i ] );
+}
+
+// lrintf_clamped( f ) and friends, given r = f rounded to integral
+static inline long lrintf_clamped_r( float f, float r )
+{
+    if( f >= -(float) LONG_MIN )
+        return LONG_MAX;
+    if( f <= (float) LONG_MIN )
+        return LONG_MIN;
+    return (long) r;
+}
+
+static inline long long llrintf_clamped_r( float f, float r )
+{
+    if( f >= -(float) LLONG_MIN )
+        return LLONG_MAX;
+    if( f <= (float) LLONG_MIN )
+        return LLONG_MIN;
+    return (long long) r;
+}
+
+static inline long lrint_clamped_r( double f, double r )
+{
+    if( sizeof( long ) > 4 )
+    {
+        if( f >= -(double) LONG_MIN )
+            return LONG_MAX;
+    }
+    else
+    {
+        if( f >= LONG_MAX )
+            return LONG_MAX;
+    }
+    if( f <= (double) LONG_MIN )
+        return LONG_MIN;
+    return (long) r;
+}
+
+static inline long long llrint_clamped_r( double f, double r )
+{
+    if( f >= -(double) LLONG_MIN )
+        return LLONG_MAX;
+    if( f <= (double) LLONG_MIN )
+        return LLONG_MIN;
+    return (long long) r;
+}
+
+#define ROUNDED_MANY( _name, _inType, _outType, _round, _expr )                         \
+void _name( void *out, void *in, size_t n )                                             \
+{                                                                                       \
+    const _inType *src = (const _inType*) in;                                           \
+    _outType *dest = (_outType*) out;                                                   \
+    _inType rounded[ kRoundBlockSize ];                                                 \
+    size_t i, j, count;                                                                 \
+    for( i = 0; i < n; i += count )                                                     \
+    {                                                                                   \
+        count = n - i < kRoundBlockSize ? n - i : kRoundBlockSize;                      \
+        _round( rounded, src + i, count );                                              \
+        for( j = 0; j < count; j++ )                                                    \
+        {                                                                               \
+            _inType f = src[ i + j ], r = rounded[ j ];                                 \
+            (void) f;                                                                   \
+            dest[ i + j ] = _expr;                                                      \
+        }                                                                               \
+    }                                                                                   \
+}
+#define FLOAT_ROUNDED_MANY( _name, _outType, _expr )    ROUNDED_MANY( _name, float, _outType, my_rintf_many, _expr )
+#define DOUBLE_ROUNDED_MANY( _name, _outType, _expr )   ROUNDED_MANY( _name, double, _outType, my_rint_many, _expr )
+
+FLOAT_ROUNDED_MANY( float2uchar_many, cl_uchar, (cl_uchar) r )
+FLOAT_ROUNDED_MANY( float2uchar_sat_many, cl_uchar, CLAMP( 0, lrintf_clamped_r( f, r ), CL_UCHAR_MAX ) )
+DOUBLE_ROUNDED_MANY( double2uchar_many, cl_uchar, (cl_uchar) r )
+DOUBLE_ROUNDED_MANY( double2uchar_sat_many, cl_uchar, CLAMP( 0, lrint_clamped_r( f, r ), CL_UCHAR_MAX ) )
+FLOAT_ROUNDED_MANY( float2char_many, cl_char, (cl_char) r )
+FLOAT_ROUNDED_MANY( float2char_sat_many, cl_char, CLAMP( CL_CHAR_MIN, lrintf_clamped_r( f, r ), CL_CHAR_MAX ) )
+DOUBLE_ROUNDED_MANY( double2char_many, cl_char, (cl_char) r )
+DOUBLE_ROUNDED_MANY( double2char_sat_many, cl_char, CLAMP( CL_CHAR_MIN, lrint_clamped_r( f, r ), CL_CHAR_MAX ) )
+FLOAT_ROUNDED_MANY( float2ushort_many, cl_ushort, (cl_ushort) r )
+FLOAT_ROUNDED_MANY( float2ushort_sat_many, cl_ushort, CLAMP( 0, lrintf_clamped_r( f, r ), CL_USHRT_MAX ) )
+DOUBLE_ROUNDED_MANY( double2ushort_many, cl_ushort, (cl_ushort) r )
+DOUBLE_ROUNDED_MANY( double2ushort_sat_many, cl_ushort, CLAMP( 0, lrint_clamped_r( f, r ), CL_USHRT_MAX ) )
+FLOAT_ROUNDED_MANY( float2short_many, cl_short, (cl_short) r )
+FLOAT_ROUNDED_MANY( float2short_sat_many, cl_short, CLAMP( CL_SHRT_MIN, lrintf_clamped_r( f, r ), CL_SHRT_MAX ) )
+DOUBLE_ROUNDED_MANY( double2short_many, cl_short, (cl_short) r )
+DOUBLE_ROUNDED_MANY( double2short_sat_many, cl_short, CLAMP( CL_SHRT_MIN, lrint_clamped_r( f, r ), CL_SHRT_MAX ) )
+FLOAT_ROUNDED_MANY( float2uint_many, cl_uint, (cl_uint) r )
+FLOAT_ROUNDED_MANY( float2uint_sat_many, cl_uint, (cl_uint) CLAMP( 0, llrintf_clamped_r( f, r ), CL_UINT_MAX ) )
+DOUBLE_ROUNDED_MANY( double2uint_many, cl_uint, (cl_uint) r )
+DOUBLE_ROUNDED_MANY( double2uint_sat_many, cl_uint, (cl_uint) CLAMP( 0, llrint_clamped_r( f, r ), CL_UINT_MAX ) )
+FLOAT_ROUNDED_MANY( float2int_many, cl_int, (cl_int) r )
+FLOAT_ROUNDED_MANY( float2int_sat_many, cl_int, (cl_int) CLAMP( CL_INT_MIN, lrintf_clamped_r( f, r ), CL_INT_MAX ) )
+DOUBLE_ROUNDED_MANY( double2int_many, cl_int, (cl_int) r )
+DOUBLE_ROUNDED_MANY( double2int_sat_many, cl_int, (cl_int) CLAMP( CL_INT_MIN, lrint_clamped_r( f, r ), CL_INT_MAX ) )
+FLOAT_ROUNDED_MANY( float2ulong_many, cl_ulong, (cl_ulong) r )
+FLOAT_ROUNDED_MANY( float2ulong_sat_many, cl_ulong, r >= MAKE_HEX_DOUBLE(0x1.0p64, 0x1LL, 64) ? 0xFFFFFFFFFFFFFFFFULL : r < 0 ? 0 : (cl_ulong) r )
+DOUBLE_ROUNDED_MANY( double2ulong_many, cl_ulong, (cl_ulong) r )
+DOUBLE_ROUNDED_MANY( double2ulong_sat_many, cl_ulong, r >= MAKE_HEX_DOUBLE(0x1.0p64, 0x1LL, 64) ? 0xFFFFFFFFFFFFFFFFULL : r < 0 ? 0 : (cl_ulong) r )
+FLOAT_ROUNDED_MANY( float2long_many, cl_long, llrintf_clamped_r( f, r ) )
+FLOAT_ROUNDED_MANY( float2long_sat_many, cl_long, r >= MAKE_HEX_DOUBLE(0x1.0p63, 0x1LL, 63) ? 0x7FFFFFFFFFFFFFFFULL : r < MAKE_HEX_DOUBLE(-0x1.0p63, -0x1LL, 63) ? 0x8000000000000000LL : (cl_long) r )
+DOUBLE_ROUNDED_MANY( double2long_many, cl_long, (cl_long) r )
+DOUBLE_ROUNDED_MANY( double2long_sat_many, cl_long, r >= MAKE_HEX_DOUBLE(0x1.0p63, 0x1LL, 63) ? 0x7FFFFFFFFFFFFFFFULL : r < MAKE_HEX_DOUBLE(-0x1.0p63, -0x1LL, 63) ? 0x8000000000000000LL : (cl_long) r )
+#else
+void float2uchar_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2uchar( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_float)); }}
+void float2uchar_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2uchar_sat( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_float)); }}
+void double2uchar_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2uchar( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_double)); }}
+void double2uchar_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2uchar_sat( (char*) out + i * sizeof(cl_uchar), (char*) in + i * sizeof(cl_double)); }}
+void float2char_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2char( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_float)); }}
+void float2char_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2char_sat( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_float)); }}
+void double2char_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2char( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_double)); }}
+void double2char_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2char_sat( (char*) out + i * sizeof(cl_char), (char*) in + i * sizeof(cl_double)); }}
+void float2ushort_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2ushort( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_float)); }}
+void float2ushort_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2ushort_sat( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_float)); }}
+void double2ushort_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2ushort( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_double)); }}
+void double2ushort_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2ushort_sat( (char*) out + i * sizeof(cl_ushort), (char*) in + i * sizeof(cl_double)); }}
+void float2short_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2short( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_float)); }}
+void float2short_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2short_sat( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_float)); }}
+void double2short_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2short( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_double)); }}
+void double2short_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2short_sat( (char*) out + i * sizeof(cl_short), (char*) in + i * sizeof(cl_double)); }}
+void float2uint_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2uint( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_float)); }}
+void float2uint_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2uint_sat( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_float)); }}
+void double2uint_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2uint( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_double)); }}
+void double2uint_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2uint_sat( (char*) out + i * sizeof(cl_uint), (char*) in + i * sizeof(cl_double)); }}
+void float2int_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2int( (char*) out + i * sizeof(cl_int), (char*) in + i * sizeof(cl_float)); }}
+void float2int_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2int_sat( (char*) out + i * sizeof(cl_int), (char*) in + i * sizeof(cl_float)); }}
+void double2int_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2int( (char*) out + i * sizeof(cl_int), (char*) in + i * sizeof(cl_double)); }}
+void double2int_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2int_sat( (char*) out + i * sizeof(cl_int), (char*) in + i * sizeof(cl_double)); }}
+void float2ulong_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2ulong( (char*) out + i * sizeof(cl_ulong), (char*) in + i * sizeof(cl_float)); }}
+void float2ulong_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2ulong_sat( (char*) out + i * sizeof(cl_ulong), (char*) in + i * sizeof(cl_float)); }}
+void double2ulong_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2ulong( (char*) out + i * sizeof(cl_ulong), (char*) in + i * sizeof(cl_double)); }}
+void double2ulong_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2ulong_sat( (char*) out + i * sizeof(cl_ulong), (char*) in + i * sizeof(cl_double)); }}
+void float2long_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2long( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_float)); }}
+void float2long_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ float2long_sat( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_float)); }}
+void double2long_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2long( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_double)); }}
+void double2long_sat_many( void *out, void *in, size_t n){size_t i; for( i = 0; i < n; i++){ double2long_sat( (char*) out + i * sizeof(cl_long), (char*) in + i * sizeof(cl_double)); }}
+#endif
+
 Convert gSaturatedConversions[kTypeCount][kTypeCount] = {
     {    uchar2uchar_sat_many,    char2uchar_sat_many,    ushort2uchar_sat_many,    short2uchar_sat_many,    uint2uchar_sat_many,    int2uchar_sat_many,    float2uchar_sat_many,    double2uchar_sat_many,    ulong2uchar_sat_many,    long2uchar_sat_many,     },
     {    uchar2char_sat_many,    char2char_sat_many,    ushort2char_sat_many,    short2char_sat_many,    uint2char_sat_many,    int2char_sat_many,    float2char_sat_many,    double2char_sat_many,    ulong2char_sat_many, long2char_sat_many,     },
@@ -63,6 +63,7 @@
 #define kPageSize       4096
 #define EMBEDDED_REDUCTION_FACTOR 16
 #define PERF_LOOP_COUNT 100
+#define kMaxPipelineDepth   8
 
 #define      kCallStyleCount (kVectorSizeCount + 1 /* for implicit scalar */)
 
@@ -89,12 +90,14 @@ int             gTimeResults = 1;
 int             gTimeResults = 0;
 #endif
 int             gReportAverageTimes = 0;
-void            *gIn = NULL;
-void            *gRef = NULL;
-void        *gAllowZ = NULL;
+// Each block in flight gets its own input, reference and output buffers, indexed by pipeline slot
+void            *gIn[ kMaxPipelineDepth ] = { NULL };
+void            *gRef[ kMaxPipelineDepth ] = { NULL };
+void            *gAllowZ[ kMaxPipelineDepth ] = { NULL };
 void            *gOut[ kCallStyleCount ] = { NULL };
-cl_mem          gInBuffer;
-cl_mem          gOutBuffers[ kCallStyleCount ];
+cl_mem          gInBuffer[ kMaxPipelineDepth ] = { NULL };
+cl_mem          gOutBuffers[ kMaxPipelineDepth ][ kCallStyleCount ];
+int             gPipelineDepth = 2;
 size_t          gComputeDevices = 0;
 uint32_t        gDeviceFrequency = 0;
 int             gWimpyMode = 0;
@@ -160,7 +163,7 @@ static inline void Force64BitFPUPrecision(void)
 
 int main (int argc, const char **argv )
 {
-    int error, i, testNumber = -1;
+    int error, i, slot, testNumber = -1;
     Type inType, outType;
     RoundingMode round;
     SaturationMode sat;
@@ -317,10 +320,13 @@ exit:
         vlog_error("FAILED %d of %d tests.\n", gFailCount, gTestCount);
     }
 
-    clReleaseMemObject(gInBuffer);
+    for( slot = 0; slot < gPipelineDepth; slot++ )
+    {
+        clReleaseMemObject(gInBuffer[slot]);
 
-    for( i = 0; i < kCallStyleCount; i++ ) {
-        clReleaseMemObject(gOutBuffers[i]);
+        for( i = 0; i < kCallStyleCount; i++ ) {
+            clReleaseMemObject(gOutBuffers[slot][i]);
+        }
     }
     clReleaseCommandQueue(gQueue);
     clReleaseContext(gContext);
@@ -427,6 +433,19 @@ static int ParseArgs( int argc, const char **argv )
                     case 'a':
                         gReportAverageTimes ^= 1;
                         break;
+                    case 'p':
+                        if( arg[1] >= '1' && arg[1] <= '0' + kMaxPipelineDepth )
+                        {
+                            gPipelineDepth = arg[1] - '0';
+                            arg++;
+                        }
+                        else
+                        {
+                            vlog( " <-- pipeline depth must be between 1 and %d\n", kMaxPipelineDepth );
+                            PrintUsage();
+                            return -1;
+                        }
+                        break;
                     case '1':
                         if( arg[1] == '6' )
                         {
@@ -547,6 +566,7 @@ static void PrintUsage( void )
     vlog( "\t\t-m\tToggle Multithreading. (On by default.)\n" );
     vlog( "\t\t-w\tToggle wimpy mode. When wimpy mode is on, we run a very small subset of the tests for each fn. NOT A VALID TEST! (Off by default.)\n" );
     vlog( "\t\t-z\tToggle flush to zero mode  (Default: per device)\n" );
+    vlog( "\t\t-p#\tKeep # blocks in flight, so that the next block is generated while the current one is verified. # is 1 to %d. (Default: 2)\n", kMaxPipelineDepth );
     vlog( "\t\t-#\tTest just vector size given by #, where # is an element of the set {1,2,3,4,8,16}\n" );
     vlog( "\n" );
     vlog( "You may also pass the number of the test on which to start.\nA second number can be then passed to indicate how many tests to run\n\n" );
@@ -684,7 +704,7 @@ static void CL_CALLBACK notify_callback(const char *errinfo, const void *private
 
 static int InitCL( void )
 {
-    int error, i;
+    int error, i, slot;
     size_t configSize = sizeof( gComputeDevices );
 
     cl_platform_id     platform = NULL;
@@ -799,9 +819,14 @@ static int InitCL( void )
 
     //Allocate buffers
     //FIXME: use clProtectedArray for guarded allocations?
-    gIn   = malloc( BUFFER_SIZE + 2 * kPageSize );
-    gAllowZ = malloc( BUFFER_SIZE + 2 * kPageSize );
-    gRef  = malloc( BUFFER_SIZE + 2 * kPageSize );
+    for( slot = 0; slot < gPipelineDepth; slot++ )
+    {
+        gIn[slot]   = malloc( BUFFER_SIZE + 2 * kPageSize );
+        gAllowZ[slot] = malloc( BUFFER_SIZE + 2 * kPageSize );
+        gRef[slot]  = malloc( BUFFER_SIZE + 2 * kPageSize );
+        if( NULL == gIn[slot] || NULL == gAllowZ[slot] || NULL == gRef[slot] )
+            return -3;
+    }
     for( i = 0; i < kCallStyleCount; i++ )
     {
         gOut[i] = malloc( BUFFER_SIZE + 2 * kPageSize );
@@ -809,23 +834,26 @@ static int InitCL( void )
             return -3;
     }
 
-    // setup input buffers
-    gInBuffer = clCreateBuffer(gContext, CL_MEM_READ_ONLY | CL_MEM_ALLOC_HOST_PTR, BUFFER_SIZE, NULL, &error);
-    if( gInBuffer == NULL || error)
+    for( slot = 0; slot < gPipelineDepth; slot++ )
     {
-        vlog_error( "clCreateBuffer failed for input (%d)\n", error );
-        return error;
-    }
-
-    // setup output buffers
-    for( i = 0; i < kCallStyleCount; i++ )
-    {
-        gOutBuffers[i] = clCreateBuffer(  gContext, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, BUFFER_SIZE, NULL, &error );
-        if( gOutBuffers[i] == NULL || error )
+        // setup input buffers
+        gInBuffer[slot] = clCreateBuffer(gContext, CL_MEM_READ_ONLY | CL_MEM_ALLOC_HOST_PTR, BUFFER_SIZE, NULL, &error);
+        if( gInBuffer[slot] == NULL || error)
         {
-            vlog_error( "clCreateArray failed for output (%d)\n", error );
+            vlog_error( "clCreateBuffer failed for input (%d)\n", error );
             return error;
         }
+
+        // setup output buffers
+        for( i = 0; i < kCallStyleCount; i++ )
+        {
+            gOutBuffers[slot][i] = clCreateBuffer(  gContext, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, BUFFER_SIZE, NULL, &error );
+            if( gOutBuffers[slot][i] == NULL || error )
+            {
+                vlog_error( "clCreateArray failed for output (%d)\n", error );
+                return error;
+            }
+        }
     }
 
 #if defined( __APPLE__ )
@@ -998,6 +1026,7 @@ typedef struct WriteInputBufferInfo
     volatile cl_event           calcReferenceValues;   // user event which signals when main thread is done calculating reference values
     volatile cl_event           doneBarrier;     // user event which signals when worker threads are done
     cl_uint                     count;           // the number of elements in the array
+    cl_uint                     slot;            // the pipeline slot whose buffers this block uses
     Type                        outType;         // the data type of the conversion result
     Type                        inType;          // the data type of the conversion input
     volatile int                barrierCount;
@@ -1027,6 +1056,7 @@ typedef struct DataInitInfo
     SaturationMode  sat;
     RoundingMode    round;
     MTdata          *d;
+    cl_uint         slot;       // the pipeline slot whose buffers are filled
 }DataInitInfo;
 
 cl_int InitData( cl_uint job_id, cl_uint thread_id, void *p );
@@ -1034,7 +1064,7 @@ cl_int InitData( cl_uint job_id, cl_uint thread_id, void *p )
 {
     DataInitInfo *info = (DataInitInfo*) p;
 
-    gInitFunctions[ info->inType ]( (char*)gIn + job_id * info->size * gTypeSizes[info->inType], info->sat, info->round,
+    gInitFunctions[ info->inType ]( (char*)gIn[info->slot] + job_id * info->size * gTypeSizes[info->inType], info->sat, info->round,
                                    info->outType, info->start + job_id * info->size, info->size, info->d[thread_id] );
     return CL_SUCCESS;
 }
@@ -1058,9 +1088,9 @@ cl_int PrepareReference( cl_uint job_id, cl_uint thread_id, void *p )
 
     Force64BitFPUPrecision();
 
-    void *s = (cl_uchar*) gIn + job_id * count * gTypeSizes[info->inType];
-    void *a = (cl_uchar*) gAllowZ + job_id * count;
-    void *d = (cl_uchar*) gRef + job_id * count * gTypeSizes[info->outType];
+    void *s = (cl_uchar*) gIn[info->slot] + job_id * count * gTypeSizes[info->inType];
+    void *a = (cl_uchar*) gAllowZ[info->slot] + job_id * count;
+    void *d = (cl_uchar*) gRef[info->slot] + job_id * count * gTypeSizes[info->outType];
 
     if (outType != inType)
     {
@@ -1168,26 +1198,163 @@ cl_int PrepareReference( cl_uint job_id, cl_uint thread_id, void *p )
     return CL_SUCCESS;
 }
 
+// Generate the inputs and reference values for one block in the given pipeline slot and start
+// the device work for it. The callbacks verify the results and set info->doneBarrier when done.
+static int IssueBlock( WriteInputBufferInfo *info, DataInitInfo *init_info, uint64_t start, cl_uint count, cl_uint threads )
+{
+    int vectorSize;
+    int error = 0;
+    cl_event writeInputBuffer = NULL;
+
+    info->count = count;
+
+    // Crate a user event to represent the status of the reference value computation completion
+    info->calcReferenceValues = clCreateUserEvent( gContext, &error);
+    if( error || NULL == info->calcReferenceValues )
+    {
+        vlog_error( "ERROR: Unable to create user event. (%d)\n", error );
+        return error ? error : -1;
+    }
+
+    // retain for consumption by MapOutputBufferComplete
+    for( vectorSize = gMinVectorSize; vectorSize < gMaxVectorSize; vectorSize++)
+    {
+        if( (error = clRetainEvent(info->calcReferenceValues) ))
+        {
+            vlog_error( "ERROR: Unable to retain user event. (%d)\n", error );
+            return error;
+        }
+    }
+
+    // Crate a user event to represent when the callbacks are done verifying correctness
+    info->doneBarrier = clCreateUserEvent( gContext, &error);
+    if( error || NULL == info->doneBarrier )
+    {
+        vlog_error( "ERROR: Unable to create user event for barrier. (%d)\n", error );
+        return error ? error : -1;
+    }
+
+    // retain for use by the callback that calls this
+    if( (error = clRetainEvent(info->doneBarrier) ))
+    {
+        vlog_error( "ERROR: Unable to retain user event doneBarrier. (%d)\n", error );
+        return error;
+    }
+
+    //      Call this in a multithreaded manner
+    //      gInitFunctions[ inType ]( gIn[slot], sat, round, outType, start, count, d );
+    cl_uint chunks = RoundUpToNextPowerOfTwo(threads) * 2;
+    init_info->start = start;
+    init_info->slot = info->slot;
+    init_info->size = count / chunks;
+    if( init_info->size < 16384 )
+    {
+        chunks = RoundUpToNextPowerOfTwo(threads);
+        init_info->size = count / chunks;
+        if( init_info->size < 16384 )
+        {
+            init_info->size = count;
+            chunks = 1;
+        }
+    }
+    ThreadPool_Do(InitData, chunks, init_info);
+
+    // Copy the results to the device
+    if( (error = clEnqueueWriteBuffer(gQueue, gInBuffer[info->slot], CL_FALSE, 0, count * gTypeSizes[info->inType], gIn[info->slot], 0, NULL, &writeInputBuffer )))
+    {
+        vlog_error( "ERROR: clEnqueueWriteBuffer failed. (%d)\n", error );
+        return error;
+    }
+
+    // Setup completion callback for the write, which will enqueue the rest of the work
+    // This is somewhat gratuitous.  Because this is an in order queue, we didn't really need to
+    // do this work in a callback. We could have done it from the main thread.  Here we are
+    // verifying that the implementation can enqueue work from a callback, while at the same time
+    // also checking to make sure that the conversions work.
+    //
+    // Because the verification code is also moved to a callback, it is hoped that implementations will
+    // achieve a test performance improvement because they can verify the results in parallel.  If the
+    // implementation serializes callbacks however, that won't happen.   Consider it some motivation
+    // to do the right thing! :-)
+    if( (error = clSetEventCallback( writeInputBuffer, CL_COMPLETE, WriteInputBufferComplete, info)) )
+    {
+        vlog_error( "ERROR: clSetEventCallback failed. (%d)\n", error );
+        return error;
+    }
+
+    // The event can't be destroyed until the callback is called, so we can release it now.
+    if( (error = clReleaseEvent(writeInputBuffer) ))
+    {
+        vlog_error( "ERROR: clReleaseEvent failed. (%d)\n", error );
+        return error;
+    }
+
+    // Make sure the work is actually running, so we don't deadlock
+    if( (error = clFlush( gQueue ) ) )
+    {
+        vlog_error( "clFlush failed with error %d\n", error );
+        return error;
+    }
+
+    ThreadPool_Do(PrepareReference, chunks, init_info);
+
+    // signal we are done calculating the reference results
+    if( (error = clSetUserEventStatus( info->calcReferenceValues, CL_COMPLETE ) ) )
+    {
+        vlog_error( "Error:  Failed to set user event status to CL_COMPLETE:  %d\n", error );
+        return error;
+    }
+
+    return 0;
+}
+
+// Wait for the callbacks of a block issued by IssueBlock to finish verifying correctness.
+static int RetireBlock( WriteInputBufferInfo *info )
+{
+    int error;
+
+    if( (error = clWaitForEvents( 1, (cl_event*) &info->doneBarrier ) ))
+    {
+        vlog_error( "Error:  Failed to wait for barrier:  %d\n", error );
+        return error;
+    }
+
+    if( (error = clReleaseEvent(info->calcReferenceValues ) ))
+    {
+        vlog_error( "Error:  Failed to release calcReferenceValues:  %d\n", error );
+        return error;
+    }
+
+    if( (error = clReleaseEvent(info->doneBarrier ) ))
+    {
+        vlog_error( "Error:  Failed to release done barrier:  %d\n", error );
+        return error;
+    }
+
+    return 0;
+}
+
 static int DoTest( Type outType, Type inType, SaturationMode sat, RoundingMode round, MTdata d )
 {
 #ifdef __APPLE__
     cl_ulong wall_start = mach_absolute_time();
 #endif
 
-    DataInitInfo  init_info = { 0, 0, outType, inType, sat, round, NULL };
-    WriteInputBufferInfo writeInputBufferInfo;
+    DataInitInfo  init_info = { 0, 0, outType, inType, sat, round, NULL, 0 };
+    WriteInputBufferInfo writeInputBufferInfo[ kMaxPipelineDepth ];
     int vectorSize;
     int error = 0;
     cl_uint threads = GetThreadCount();
     uint64_t i;
+    int slot;
 
     gTestCount++;
     size_t blockCount = BUFFER_SIZE / MAX( gTypeSizes[ inType ], gTypeSizes[ outType ] );
     size_t step = blockCount;
     uint64_t lastCase = 1ULL << (8*gTypeSizes[ inType ]);
-    cl_event writeInputBuffer = NULL;
+    uint64_t issued = 0, retired = 0;
 
-    memset( &writeInputBufferInfo, 0, sizeof( writeInputBufferInfo ) );
+    memset( writeInputBufferInfo, 0, sizeof( writeInputBufferInfo ) );
     init_info.d = (MTdata*)malloc( threads * sizeof( MTdata ) );
     if( NULL == init_info.d )
     {
@@ -1204,28 +1371,58 @@ static int DoTest( Type outType, Type inType, SaturationMode sat, RoundingMode r
         }
     }
 
-    writeInputBufferInfo.outType = outType;
-    writeInputBufferInfo.inType = inType;
+    for( slot = 0; slot < gPipelineDepth; slot++ )
+    {
+        writeInputBufferInfo[slot].outType = outType;
+        writeInputBufferInfo[slot].inType = inType;
+        writeInputBufferInfo[slot].slot = slot;
+    }
 
     for( vectorSize = gMinVectorSize; vectorSize < gMaxVectorSize; vectorSize++)
     {
-        writeInputBufferInfo.calcInfo[vectorSize].program = MakeProgram( outType, inType, sat, round, vectorSize,
-                                                                        &writeInputBufferInfo.calcInfo[vectorSize].kernel );
-        if( NULL == writeInputBufferInfo.calcInfo[vectorSize].program )
+        writeInputBufferInfo[0].calcInfo[vectorSize].program = MakeProgram( outType, inType, sat, round, vectorSize,
+                                                                           &writeInputBufferInfo[0].calcInfo[vectorSize].kernel );
+        if( NULL == writeInputBufferInfo[0].calcInfo[vectorSize].program )
         {
             gFailCount++;
             return -1;
         }
-        if( NULL == writeInputBufferInfo.calcInfo[vectorSize].kernel )
+        if( NULL == writeInputBufferInfo[0].calcInfo[vectorSize].kernel )
         {
             gFailCount++;
             vlog_error( "\t\tFAILED -- Failed to create kernel.\n" );
             return -2;
         }
 
-        writeInputBufferInfo.calcInfo[vectorSize].parent = &writeInputBufferInfo;
-        writeInputBufferInfo.calcInfo[vectorSize].vectorSize = vectorSize;
-        writeInputBufferInfo.calcInfo[vectorSize].result = -1;
+        // Blocks in flight may run their kernels from different callbacks at the same time, so each
+        // slot gets its own kernel object to avoid racing on clSetKernelArg. They share the program.
+        if( gPipelineDepth > 1 )
+        {
+            char kernelName[256];
+            if( (error = clGetKernelInfo( writeInputBufferInfo[0].calcInfo[vectorSize].kernel, CL_KERNEL_FUNCTION_NAME, sizeof( kernelName ), kernelName, NULL ) ) )
+            {
+                gFailCount++;
+                vlog_error( "\t\tFAILED -- clGetKernelInfo failed. (%d)\n", error );
+                goto exit;
+            }
+            for( slot = 1; slot < gPipelineDepth; slot++ )
+            {
+                writeInputBufferInfo[slot].calcInfo[vectorSize].kernel = clCreateKernel( writeInputBufferInfo[0].calcInfo[vectorSize].program, kernelName, &error );
+                if( NULL == writeInputBufferInfo[slot].calcInfo[vectorSize].kernel || error )
+                {
+                    gFailCount++;
+                    vlog_error( "\t\tFAILED -- Failed to create kernel. (%d)\n", error );
+                    goto exit;
+                }
+            }
+        }
+
+        for( slot = 0; slot < gPipelineDepth; slot++ )
+        {
+            writeInputBufferInfo[slot].calcInfo[vectorSize].parent = &writeInputBufferInfo[slot];
+            writeInputBufferInfo[slot].calcInfo[vectorSize].vectorSize = vectorSize;
+            writeInputBufferInfo[slot].calcInfo[vectorSize].result = -1;
+        }
     }
 
     if( gSkipTesting )
@@ -1247,179 +1444,77 @@ static int DoTest( Type outType, Type inType, SaturationMode sat, RoundingMode r
 
     vlog( "Testing... " );
     fflush(stdout);
-    for( i = 0; i < (uint64_t)lastCase; i += step )
+    i = 0;
+    for( ;; )
     {
-        if (gWimpyMode) {
-            uint64_t blockIndex = (i / blockCount) & 0xFF;
-            if (blockIndex != 0 && blockIndex != 0xFF)
-                continue;
-        }
-
-        if( 0 == ( i & ((lastCase >> 3) -1))) {
-            vlog(".");
-            fflush(stdout);
-        }
-
-        cl_uint count = (uint32_t) MIN( blockCount, lastCase - i );
-        writeInputBufferInfo.count = count;
-
-        // Crate a user event to represent the status of the reference value computation completion
-        writeInputBufferInfo.calcReferenceValues = clCreateUserEvent( gContext, &error);
-        if( error || NULL == writeInputBufferInfo.calcReferenceValues )
+        // Keep up to gPipelineDepth blocks in flight. The inputs and reference values for the
+        // next block are computed here while the callbacks are still verifying the earlier ones.
+        while( issued - retired < (uint64_t) gPipelineDepth && i < (uint64_t)lastCase )
         {
-            vlog_error( "ERROR: Unable to create user event. (%d)\n", error );
-            gFailCount++;
-            goto exit;
-        }
+            uint64_t start = i;
+            i += step;
 
-        // retain for consumption by MapOutputBufferComplete
-        for( vectorSize = gMinVectorSize; vectorSize < gMaxVectorSize; vectorSize++)
-        {
-            if( (error = clRetainEvent(writeInputBufferInfo.calcReferenceValues) ))
-            {
-                vlog_error( "ERROR: Unable to retain user event. (%d)\n", error );
-                gFailCount++;
-                goto exit;
+            if (gWimpyMode) {
+                uint64_t blockIndex = (start / blockCount) & 0xFF;
+                if (blockIndex != 0 && blockIndex != 0xFF)
+                    continue;
             }
-        }
 
-        // Crate a user event to represent when the callbacks are done verifying correctness
-        writeInputBufferInfo.doneBarrier = clCreateUserEvent( gContext, &error);
-        if( error || NULL == writeInputBufferInfo.calcReferenceValues )
-        {
-            vlog_error( "ERROR: Unable to create user event for barrier. (%d)\n", error );
-            gFailCount++;
-            goto exit;
-        }
-
-        // retain for use by the callback that calls this
-        if( (error = clRetainEvent(writeInputBufferInfo.doneBarrier) ))
-        {
-            vlog_error( "ERROR: Unable to retain user event doneBarrier. (%d)\n", error );
-            gFailCount++;
-            goto exit;
-        }
+            if( 0 == ( start & ((lastCase >> 3) -1))) {
+                vlog(".");
+                fflush(stdout);
+            }
 
-        //      Call this in a multithreaded manner
-        //      gInitFunctions[ inType ]( gIn, sat, round, outType, i, count, d );
-        cl_uint chunks = RoundUpToNextPowerOfTwo(threads) * 2;
-        init_info.start = i;
-        init_info.size = count / chunks;
-        if( init_info.size < 16384 )
-        {
-            chunks = RoundUpToNextPowerOfTwo(threads);
-            init_info.size = count / chunks;
-            if( init_info.size < 16384 )
+            cl_uint count = (uint32_t) MIN( blockCount, lastCase - start );
+            if( (error = IssueBlock( &writeInputBufferInfo[ issued % gPipelineDepth ], &init_info, start, count, threads ) ) )
             {
-                init_info.size = count;
-                chunks = 1;
+                gFailCount++;
+                goto exit;
             }
-        }
-        ThreadPool_Do(InitData, chunks, &init_info);
-
-        // Copy the results to the device
-        writeInputBuffer = NULL;
-        if( (error = clEnqueueWriteBuffer(gQueue, gInBuffer, CL_FALSE, 0, count * gTypeSizes[inType], gIn, 0, NULL, &writeInputBuffer )))
-        {
-            vlog_error( "ERROR: clEnqueueWriteBuffer failed. (%d)\n", error );
-            gFailCount++;
-            goto exit;
+            issued++;
         }
 
-        // Setup completion callback for the write, which will enqueue the rest of the work
-        // This is somewhat gratuitous.  Because this is an in order queue, we didn't really need to
-        // do this work in a callback. We could have done it from the main thread.  Here we are
-        // verifying that the implementation can enqueue work from a callback, while at the same time
-        // also checking to make sure that the conversions work.
-        //
-        // Because the verification code is also moved to a callback, it is hoped that implementations will
-        // achieve a test performance improvement because they can verify the results in parallel.  If the
-        // implementation serializes callbacks however, that won't happen.   Consider it some motivation
-        // to do the right thing! :-)
-        if( (error = clSetEventCallback( writeInputBuffer, CL_COMPLETE, WriteInputBufferComplete, &writeInputBufferInfo)) )
-        {
-            vlog_error( "ERROR: clSetEventCallback failed. (%d)\n", error );
-            gFailCount++;
-            goto exit;
-        }
-
-        // The event can't be destroyed until the callback is called, so we can release it now.
-        if( (error = clReleaseEvent(writeInputBuffer) ))
-        {
-            vlog_error( "ERROR: clReleaseEvent failed. (%d)\n", error );
-            gFailCount++;
-            goto exit;
-        }
-
-        // Make sure the work is actually running, so we don't deadlock
-        if( (error = clFlush( gQueue ) ) )
-        {
-            vlog_error( "clFlush failed with error %d\n", error );
-            gFailCount++;
-            goto exit;
-        }
-
-        ThreadPool_Do(PrepareReference, chunks, &init_info);
-
-        // signal we are done calculating the reference results
-        if( (error = clSetUserEventStatus( writeInputBufferInfo.calcReferenceValues, CL_COMPLETE ) ) )
-        {
-            vlog_error( "Error:  Failed to set user event status to CL_COMPLETE:  %d\n", error );
-            gFailCount++;
-            goto exit;
-        }
-
-        // Wait for the event callbacks to finish verifying correctness.
-        if( (error = clWaitForEvents( 1, (cl_event*) &writeInputBufferInfo.doneBarrier ) ))
-        {
-            vlog_error( "Error:  Failed to wait for barrier:  %d\n", error );
-            gFailCount++;
-            goto exit;
-        }
-
-        if( (error = clReleaseEvent(writeInputBufferInfo.calcReferenceValues ) ))
-        {
-            vlog_error( "Error:  Failed to release calcReferenceValues:  %d\n", error );
-            gFailCount++;
-            goto exit;
-        }
+        if( retired == issued )
+            break;
 
-        if( (error = clReleaseEvent(writeInputBufferInfo.doneBarrier ) ))
+        // Blocks are retired in the order they were issued, so failures are reported in order.
+        WriteInputBufferInfo *info = &writeInputBufferInfo[ retired % gPipelineDepth ];
+        retired++;
+        if( (error = RetireBlock( info ) ) )
         {
-            vlog_error( "Error:  Failed to release done barrier:  %d\n", error );
             gFailCount++;
             goto exit;
         }
 
-
         for( vectorSize = gMinVectorSize; vectorSize < gMaxVectorSize; vectorSize++)
         {
-            if( ( error = writeInputBufferInfo.calcInfo[ vectorSize ].result ))
+            if( ( error = info->calcInfo[ vectorSize ].result ))
             {
+                void *in = gIn[ info->slot ];
                 switch( inType )
                 {
                     case kuchar:
                     case kchar:
-                        vlog( "Input value: 0x%2.2x ", ((unsigned char*)gIn)[error - 1] );
+                        vlog( "Input value: 0x%2.2x ", ((unsigned char*)in)[error - 1] );
                         break;
                     case kushort:
                     case kshort:
-                        vlog( "Input value: 0x%4.4x ", ((unsigned short*)gIn)[error - 1] );
+                        vlog( "Input value: 0x%4.4x ", ((unsigned short*)in)[error - 1] );
                         break;
                     case kuint:
                     case kint:
-                        vlog( "Input value: 0x%8.8x ", ((unsigned int*)gIn)[error - 1] );
+                        vlog( "Input value: 0x%8.8x ", ((unsigned int*)in)[error - 1] );
                         break;
                     case kfloat:
-                        vlog( "Input value: %a ", ((float*)gIn)[error - 1] );
+                        vlog( "Input value: %a ", ((float*)in)[error - 1] );
                         break;
                         break;
                     case kulong:
                     case klong:
-                        vlog( "Input value: 0x%16.16llx ", ((unsigned long long*)gIn)[error - 1] );
+                        vlog( "Input value: 0x%16.16llx ", ((unsigned long long*)in)[error - 1] );
                         break;
                     case kdouble:
-                        vlog( "Input value: %a ", ((double*)gIn)[error - 1]);
+                        vlog( "Input value: %a ", ((double*)in)[error - 1]);
                         break;
                     default:
                         vlog_error( "Internal error at %s: %d\n", __FILE__, __LINE__ );
@@ -1457,7 +1552,7 @@ static int DoTest( Type outType, Type inType, SaturationMode sat, RoundingMode r
             for( k = 0; k < PERF_LOOP_COUNT; k++ )
             {
                 uint64_t startTime = GetTime();
-                if( (error = RunKernel( writeInputBufferInfo.calcInfo[vectorSize].kernel, gInBuffer, gOutBuffers[ vectorSize ], workItemCount )) )
+                if( (error = RunKernel( writeInputBufferInfo[0].calcInfo[vectorSize].kernel, gInBuffer[0], gOutBuffers[0][ vectorSize ], workItemCount )) )
                 {
                     gFailCount++;
                     goto exit;
@@ -1502,11 +1597,20 @@ static int DoTest( Type outType, Type inType, SaturationMode sat, RoundingMode r
 
 
 exit:
+    // The callbacks of any blocks still in flight reference writeInputBufferInfo and the slot
+    // buffers, so let them finish before we return.
+    while( retired < issued )
+        RetireBlock( &writeInputBufferInfo[ retired++ % gPipelineDepth ] );
+
     //clean up
     for( vectorSize = gMinVectorSize; vectorSize < gMaxVectorSize; vectorSize++)
     {
-        clReleaseProgram( writeInputBufferInfo.calcInfo[vectorSize].program );
-        clReleaseKernel( writeInputBufferInfo.calcInfo[vectorSize].kernel );
+        clReleaseProgram( writeInputBufferInfo[0].calcInfo[vectorSize].program );
+        for( slot = 0; slot < gPipelineDepth; slot++ )
+        {
+            if( writeInputBufferInfo[slot].calcInfo[vectorSize].kernel )
+                clReleaseKernel( writeInputBufferInfo[slot].calcInfo[vectorSize].kernel );
+        }
     }
 
     if( init_info.d )
@@ -1544,13 +1648,13 @@ void CL_CALLBACK WriteInputBufferComplete( cl_event e, cl_int status, void *data
         size_t workItemCount = (count + vectorSizes[vectorSize] - 1) / ( vectorSizes[vectorSize]);
         cl_event mapComplete = NULL;
 
-        if( (status = RunKernel( info->calcInfo[ vectorSize ].kernel, gInBuffer, gOutBuffers[ vectorSize ], workItemCount )) )
+        if( (status = RunKernel( info->calcInfo[ vectorSize ].kernel, gInBuffer[ info->slot ], gOutBuffers[ info->slot ][ vectorSize ], workItemCount )) )
         {
             gFailCount++;
             return;
         }
 
-        info->calcInfo[vectorSize].p = clEnqueueMapBuffer( gQueue, gOutBuffers[ vectorSize ], CL_FALSE, CL_MAP_READ | CL_MAP_WRITE,
+        info->calcInfo[vectorSize].p = clEnqueueMapBuffer( gQueue, gOutBuffers[ info->slot ][ vectorSize ], CL_FALSE, CL_MAP_READ | CL_MAP_WRITE,
                                                           0, count * gTypeSizes[ info->outType ], 0, NULL, &mapComplete, &status);
         {
             if( status )
@@ -1633,6 +1737,7 @@ void CL_CALLBACK CalcReferenceValuesComplete( cl_event e, cl_int status, void *d
     size_t                      j;
     cl_int                      error;
     cl_event                    doneBarrier = info->parent->doneBarrier;
+    cl_uint                     slot = info->parent->slot;
 
     // report spurious error condition
     if( CL_SUCCESS != status )
@@ -1654,7 +1759,7 @@ void CL_CALLBACK CalcReferenceValuesComplete( cl_event e, cl_int status, void *d
     {
         if( inType == kfloat )
         {
-            float *inp = (float*) gIn;
+            float *inp = (float*) gIn[ slot ];
             for( j = 0; j < count; j++ )
             {
                 if( isnan( inp[j] ) )
@@ -1663,7 +1768,7 @@ void CL_CALLBACK CalcReferenceValuesComplete( cl_event e, cl_int status, void *d
         }
         if( inType == kdouble )
         {
-            double *inp = (double*) gIn;
+            double *inp = (double*) gIn[ slot ];
             for( j = 0; j < count; j++ )
             {
                 if( isnan( inp[j] ) )
@@ -1675,7 +1780,7 @@ void CL_CALLBACK CalcReferenceValuesComplete( cl_event e, cl_int status, void *d
     {  // outtype and intype is float or double.  NaN conversions for float <-> double can be any NaN
         if( inType == kfloat && outType == kdouble )
         {
-            float *inp = (float*) gIn;
+            float *inp = (float*) gIn[ slot ];
             double *outp = (double*) mapped;
             for( j = 0; j < count; j++ )
             {
@@ -1685,7 +1790,7 @@ void CL_CALLBACK CalcReferenceValuesComplete( cl_event e, cl_int status, void *d
         }
         if( inType == kdouble && outType == kfloat )
         {
-            double *inp = (double*) gIn;
+            double *inp = (double*) gIn[ slot ];
             float *outp = (float*) mapped;
             for( j = 0; j < count; j++ )
             {
@@ -1695,8 +1800,8 @@ void CL_CALLBACK CalcReferenceValuesComplete( cl_event e, cl_int status, void *d
         }
     }
 
-    if( memcmp( mapped, gRef, count * gTypeSizes[ outType ] ) )
-        info->result = gCheckResults[outType]( mapped, gRef, gAllowZ, count, vectorSizes[vectorSize] );
+    if( memcmp( mapped, gRef[ slot ], count * gTypeSizes[ outType ] ) )
+        info->result = gCheckResults[outType]( mapped, gRef[ slot ], gAllowZ[ slot ], count, vectorSizes[vectorSize] );
     else
         info->result = 0;
 
@@ -1704,7 +1809,7 @@ void CL_CALLBACK CalcReferenceValuesComplete( cl_event e, cl_int status, void *d
     {
         cl_uint pattern =  0xffffdead;
         memset_pattern4(mapped, &pattern, count * gTypeSizes[outType]);
-        if((error = clEnqueueUnmapMemObject(gQueue, gOutBuffers[ vectorSize ], mapped, 0, NULL, NULL)))
+        if((error = clEnqueueUnmapMemObject(gQueue, gOutBuffers[ slot ][ vectorSize ], mapped, 0, NULL, NULL)))
         {
             vlog_error( "ERROR: clEnqueueUnmapMemObject failed in CalcReferenceValuesComplete  (%d)\n", error );
             gFailCount++;
@@ -20,13 +20,46 @@
 #include "cl_utils.h"
 #include "tests.h"
 
+#if defined( __SSE2__ )
+    #include <emmintrin.h>
+#endif
+
 extern const char *addressSpaceNames[];
 
+// Table driven reference for the conversions to half. There is one entry for each sign and exponent
+// of the input. A finite input below the overflow threshold converts to
+//
+//      base + (m >> shift) + roundUp
+//
+// where m is the input mantissa (with the implicit bit when the result is a half denormal), and roundUp
+// is set when the discarded bits m & ((1 << shift) - 1) are above threshold, or equal to it when roundTie
+// is set and m >> shift is odd. Overflow entries have a constant base. NaN and infinity entries fall back
+// to the scalar reference. Double mantissas are first reduced to 30 bits, with the bits shifted out
+// ORed into the lowest one, which doesn't change how they round to the 10 bits of a half.
+typedef struct HalfRoundingEntry_
+{
+    cl_uint implicitBit;
+    cl_uint threshold;
+    cl_ushort base;
+    cl_uchar shift;
+    cl_uchar roundTie;
+    cl_uint special;
+} HalfRoundingEntry;
+
+typedef enum
+{
+    kHalfRoundToNearestEven = 0,
+    kHalfRoundTowardZero,
+    kHalfRoundUp,
+    kHalfRoundDown
+} HalfRoundingMode;
+
 typedef struct ComputeReferenceInfoF_
 {
     float *x;
     cl_ushort *r;
     f2h f;
+    const HalfRoundingEntry *table;
     cl_ulong i;
     cl_uint lim;
     cl_uint count;
@@ -37,6 +70,7 @@ typedef struct ComputeReferenceInfoD_
     double *x;
     cl_ushort *r;
     d2h f;
+    const HalfRoundingEntry *table;
     cl_ulong i;
     cl_uint lim;
     cl_uint count;
@@ -66,6 +100,66 @@ typedef struct CheckResultInfoD_
     int vsz;
 } CheckResultInfoD;
 
+#if defined( __SSE2__ )
+typedef struct HalfRoundingVectors_
+{
+    __m128i shift;
+    __m128i implicitBit;
+    __m128i mask;
+    __m128i threshold;
+    __m128i roundTie;
+    __m128i one;
+    __m128i base;
+    __m128i sign;
+} HalfRoundingVectors;
+
+static inline void
+InitHalfRoundingVectors(HalfRoundingVectors *v, const HalfRoundingEntry *e)
+{
+    v->shift = _mm_cvtsi32_si128(e->shift);
+    v->implicitBit = _mm_set1_epi32((int) e->implicitBit);
+    v->mask = _mm_set1_epi32((int) ((1U << e->shift) - 1U));
+    v->threshold = _mm_set1_epi32((int) e->threshold);
+    v->roundTie = _mm_set1_epi32(e->roundTie);
+    v->one = _mm_set1_epi32(1);
+    v->base = _mm_set1_epi32(e->base & 0x7fff);
+    v->sign = _mm_set1_epi16((short) (e->base & 0x8000));
+}
+
+// base + (m >> shift) + roundUp for four mantissas, without the sign. The discarded bits and the
+// threshold are below 2**31, so the signed compare is fine.
+static inline __m128i
+HalfRound4(__m128i m, const HalfRoundingVectors *v)
+{
+    __m128i q, rem, up;
+
+    m = _mm_or_si128(m, v->implicitBit);
+    q = _mm_srl_epi32(m, v->shift);
+    rem = _mm_and_si128(m, v->mask);
+    up = _mm_or_si128(_mm_and_si128(_mm_cmpgt_epi32(rem, v->threshold), v->one),
+                      _mm_and_si128(_mm_cmpeq_epi32(rem, v->threshold), _mm_and_si128(q, v->roundTie)));
+    return _mm_add_epi32(_mm_add_epi32(v->base, q), up);
+}
+
+// Pack eight results from HalfRound4 to half, adding the sign back in
+static inline void
+StoreHalf8(cl_ushort *r, __m128i lo, __m128i hi, const HalfRoundingVectors *v)
+{
+    _mm_storeu_si128((__m128i*) r, _mm_or_si128(_mm_packs_epi32(lo, hi), v->sign));
+}
+#endif
+
+static inline cl_ushort
+HalfRound(cl_uint m, const HalfRoundingEntry *e)
+{
+    cl_uint q, rem;
+
+    m |= e->implicitBit;
+    q = m >> e->shift;
+    rem = m & ((1U << e->shift) - 1U);
+    return (cl_ushort)(e->base + q + ((rem > e->threshold) | ((rem == e->threshold) & q & e->roundTie)));
+}
+
 static cl_int
 ReferenceF(cl_uint jid, cl_uint tid, void *userInfo)
 {
@@ -77,14 +171,51 @@ ReferenceF(cl_uint jid, cl_uint tid, void *userInfo)
     cl_ushort *r = cri->r + off;
     f2h f = cri->f;
     cl_ulong i = cri->i + off;
-    cl_uint j, rr;
+    cl_uint j, k;
 
     if (off + count > lim)
         count = lim - off;
 
-    for (j = 0; j < count; ++j) {
-        x[j] = as_float((cl_uint)(i + j));
-        r[j] = f(x[j]);
+    // The inputs are consecutive, so the sign and exponent only change every 2**23 values
+    for (j = 0; j < count; j += k) {
+        cl_uint u = (cl_uint)(i + j);
+        const HalfRoundingEntry *e = cri->table + (u >> 23);
+        cl_uint run = 0x800000U - (u & 0x7fffffU);
+        if (run > count - j)
+            run = count - j;
+
+        k = 0;
+        if (e->special) {
+            for (; k < run; ++k) {
+                x[j+k] = as_float(u + k);
+                r[j+k] = f(x[j+k]);
+            }
+            continue;
+        }
+
+#if defined( __SSE2__ )
+        {
+            HalfRoundingVectors v;
+            __m128i mantissa = _mm_set1_epi32(0x7fffff);
+            __m128i eight = _mm_set1_epi32(8);
+            __m128i u0 = _mm_add_epi32(_mm_set1_epi32((int) u), _mm_setr_epi32(0, 1, 2, 3));
+            __m128i u1 = _mm_add_epi32(_mm_set1_epi32((int) u), _mm_setr_epi32(4, 5, 6, 7));
+
+            InitHalfRoundingVectors(&v, e);
+            for (; k + 8 <= run; k += 8) {
+                _mm_storeu_si128((__m128i*)(x + j + k), u0);
+                _mm_storeu_si128((__m128i*)(x + j + k + 4), u1);
+                StoreHalf8(r + j + k, HalfRound4(_mm_and_si128(u0, mantissa), &v),
+                                      HalfRound4(_mm_and_si128(u1, mantissa), &v), &v);
+                u0 = _mm_add_epi32(u0, eight);
+                u1 = _mm_add_epi32(u1, eight);
+            }
+        }
+#endif
+        for (; k < run; ++k) {
+            x[j+k] = as_float(u + k);
+            r[j+k] = HalfRound((u + k) & 0x7fffffU, e);
+        }
     }
 
     return 0;
@@ -150,13 +281,67 @@ ReferenceD(cl_uint jid, cl_uint tid, void *userInfo)
     d2h f = cri->f;
     cl_uint j;
     cl_ulong i = cri->i + off;
+#if defined( __SSE2__ )
+    const HalfRoundingEntry *vectorEntry = NULL;
+    HalfRoundingVectors v;
+    __m128i lowMask = _mm_set1_epi32(0xffffff00);
+    __m128i highMantissa = _mm_set1_epi32(0xfffff);
+    __m128i stickyMask = _mm_set1_epi32(0x3fffff);
+    __m128i zero = _mm_setzero_si128();
+#endif
 
     if (off + count > lim)
         count = lim - off;
 
-    for (j = 0; j < count; ++j) {
-        x[j] = as_double(DoubleFromUInt((cl_uint)(i + j)));
-        r[j] = f(x[j]);
+    for (j = 0; j < count; ) {
+        cl_uint u = (cl_uint)(i + j);
+#if defined( __SSE2__ )
+        // DoubleFromUInt puts bits 8-31 of u at the top of the double and sign extends bits 0-7 into the
+        // rest, which borrows from the top when bit 7 is set. That can only change the sign and exponent
+        // when bits 8-19 of u are all zero, so otherwise groups of 8 inputs share one table entry.
+        if (0 == (u & 7) && count - j >= 8 && 0 != (u & 0xfff00)) {
+            const HalfRoundingEntry *e = cri->table + (u >> 20);
+            if (!e->special) {
+                __m128i h[2];
+                int n;
+
+                if (e != vectorEntry) {
+                    InitHalfRoundingVectors(&v, e);
+                    vectorEntry = e;
+                }
+
+                for (n = 0; n < 2; n++) {
+                    __m128i vu = _mm_add_epi32(_mm_set1_epi32((int)(u + 4 * n)), _mm_setr_epi32(0, 1, 2, 3));
+                    __m128i lo = _mm_srai_epi32(_mm_slli_epi32(vu, 24), 24);                  // low 32 bits of the double
+                    __m128i hi = _mm_add_epi32(_mm_and_si128(vu, lowMask), _mm_srai_epi32(lo, 31));   // high 32 bits
+                    __m128i sticky = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_and_si128(lo, stickyMask), zero), v.one);
+                    __m128i m = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(hi, highMantissa), 10),
+                                                          _mm_srli_epi32(lo, 22)), sticky);
+
+                    _mm_storeu_si128((__m128i*)(x + j + 4 * n), _mm_unpacklo_epi32(lo, hi));
+                    _mm_storeu_si128((__m128i*)(x + j + 4 * n + 2), _mm_unpackhi_epi32(lo, hi));
+                    h[n] = HalfRound4(m, &v);
+                }
+                StoreHalf8(r + j, h[0], h[1], &v);
+                j += 8;
+                continue;
+            }
+        }
+#endif
+        {
+            cl_ulong d = DoubleFromUInt(u);
+            const HalfRoundingEntry *e = cri->table + (d >> 52);
+            x[j] = as_double(d);
+
+            if (e->special) {
+                r[j] = f(x[j]);
+            } else {
+                // reduce the mantissa to 30 bits, keeping a sticky bit
+                cl_ulong mantissa = d & 0x000fffffffffffffULL;
+                r[j] = HalfRound((cl_uint)(mantissa >> 22) | (cl_uint)((mantissa & 0x3fffff) != 0), e);
+            }
+            ++j;
+        }
     }
 
     return 0;
@@ -611,6 +796,111 @@ double2half_rtn( double f )
     return (u.u >> (53-11)) | sign;
 }
 
+// Fill in the 2 << expBits entries of a HalfRoundingEntry table for a binary floating point type
+// with the given number of exponent and explicit mantissa bits (at most 30)
+static void InitHalfRoundingTable( HalfRoundingEntry *table, int expBits, int mantBits, HalfRoundingMode mode )
+{
+    int bias = (1 << (expBits - 1)) - 1;
+    int maxExp = (1 << expBits) - 1;
+    int sign, e;
+
+    for( sign = 0; sign < 2; sign++ )
+    {
+        for( e = 0; e <= maxExp; e++ )
+        {
+            HalfRoundingEntry *t = table + (sign << expBits) + e;
+            int exponent = (e ? e : 1) - bias;
+            int shift, tiny;
+            cl_uint mask;
+
+            memset( t, 0, sizeof( *t ) );
+            if( e == maxExp )
+            {
+                t->special = 1;
+                continue;
+            }
+
+            if( exponent >= 16 )
+            {
+                // overflow: infinity or the largest finite half, depending on the rounding direction
+                int toInfinity = mode == kHalfRoundToNearestEven ||
+                                 (mode == kHalfRoundUp && !sign) || (mode == kHalfRoundDown && sign);
+                t->base = (cl_ushort)((sign << 15) | (toInfinity ? 0x7c00 : 0x7bff));
+                t->shift = (cl_uchar)(mantBits + 1);
+                t->threshold = (1U << (mantBits + 1)) - 1U;
+                continue;
+            }
+
+            t->base = (cl_ushort)(sign << 15);
+            if( exponent >= -14 )
+            {
+                // normal half
+                t->base |= (cl_ushort)((exponent + 15) << 10);
+                shift = mantBits - 10;
+            }
+            else
+            {
+                // half denormal, in units of 2**-24
+                if( e )
+                    t->implicitBit = 1U << mantBits;
+                shift = mantBits - 24 - exponent;
+            }
+
+            // Inputs below half of the smallest half denormal only matter for their sign and for
+            // whether they are zero, so the whole mantissa can be treated as discarded bits.
+            tiny = shift > mantBits + 1;
+            if( tiny )
+                shift = mantBits + 1;
+            t->shift = (cl_uchar) shift;
+            mask = (1U << shift) - 1U;
+
+            switch( mode )
+            {
+                case kHalfRoundToNearestEven:
+                    if( tiny )
+                        t->threshold = mask;
+                    else
+                    {
+                        t->threshold = 1U << (shift - 1);
+                        t->roundTie = 1;
+                    }
+                    break;
+                case kHalfRoundTowardZero:
+                    t->threshold = mask;
+                    break;
+                case kHalfRoundUp:
+                    t->threshold = sign ? mask : 0;
+                    break;
+                case kHalfRoundDown:
+                    t->threshold = sign ? 0 : mask;
+                    break;
+            }
+        }
+    }
+}
+
+static HalfRoundingMode GetHalfRoundingModeF( f2h f )
+{
+    if( f == float2half_rtz )
+        return kHalfRoundTowardZero;
+    if( f == float2half_rtp )
+        return kHalfRoundUp;
+    if( f == float2half_rtn )
+        return kHalfRoundDown;
+    return kHalfRoundToNearestEven;
+}
+
+static HalfRoundingMode GetHalfRoundingModeD( d2h f )
+{
+    if( f == double2half_rtz )
+        return kHalfRoundTowardZero;
+    if( f == double2half_rtp )
+        return kHalfRoundUp;
+    if( f == double2half_rtn )
+        return kHalfRoundDown;
+    return kHalfRoundToNearestEven;
+}
+
 int Test_vstore_half( void )
 {
     switch (get_default_rounding_mode(gDevice))
@@ -1058,10 +1348,18 @@ int Test_vStoreHalf_private( f2h referenceFunc, d2h doubleReferenceFunc, const c
     size_t loopCount;
     cl_uint threadCount = GetThreadCount();
 
+    // The reference results are computed once per block from these tables and shared by
+    // all of the vector sizes and address spaces below
+    static HalfRoundingEntry floatTable[2 << 8];
+    static HalfRoundingEntry doubleTable[2 << 11];
+    InitHalfRoundingTable( floatTable, 8, 23, GetHalfRoundingModeF( referenceFunc ) );
+    InitHalfRoundingTable( doubleTable, 11, 30, GetHalfRoundingModeD( doubleReferenceFunc ) );
+
     ComputeReferenceInfoF fref;
     fref.x = (float *)gIn_single;
     fref.r = (cl_ushort *)gOut_half_reference;
     fref.f = referenceFunc;
+    fref.table = floatTable;
     fref.lim = blockCount;
     fref.count = (blockCount + threadCount - 1) / threadCount;
 
@@ -1077,6 +1375,7 @@ int Test_vStoreHalf_private( f2h referenceFunc, d2h doubleReferenceFunc, const c
     dref.x = (double *)gIn_double;
     dref.r = (cl_ushort *)gOut_half_reference_double;
     dref.f = doubleReferenceFunc;
+    dref.table = doubleTable;
     dref.lim = blockCount;
     dref.count = (blockCount + threadCount - 1) / threadCount;
 
@@ -1667,10 +1966,18 @@ int Test_vStoreaHalf_private( f2h referenceFunc, d2h doubleReferenceFunc, const
     size_t loopCount;
     cl_uint threadCount = GetThreadCount();
 
+    // The reference results are computed once per block from these tables and shared by
+    // all of the vector sizes and address spaces below
+    static HalfRoundingEntry floatTable[2 << 8];
+    static HalfRoundingEntry doubleTable[2 << 11];
+    InitHalfRoundingTable( floatTable, 8, 23, GetHalfRoundingModeF( referenceFunc ) );
+    InitHalfRoundingTable( doubleTable, 11, 30, GetHalfRoundingModeD( doubleReferenceFunc ) );
+
     ComputeReferenceInfoF fref;
     fref.x = (float *)gIn_single;
     fref.r = (cl_ushort *)gOut_half_reference;
     fref.f = referenceFunc;
+    fref.table = floatTable;
     fref.lim = blockCount;
     fref.count = (blockCount + threadCount - 1) / threadCount;
 
@@ -1686,6 +1993,7 @@ int Test_vStoreaHalf_private( f2h referenceFunc, d2h doubleReferenceFunc, const
     dref.x = (double *)gIn_double;
     dref.r = (cl_ushort *)gOut_half_reference_double;
     dref.f = doubleReferenceFunc;
+    dref.table = doubleTable;
     dref.lim = blockCount;
     dref.count = (blockCount + threadCount - 1) / threadCount;
 
@@ -418,6 +418,7 @@ int validate_image_2D_depth_results(void *imageValues, void *resultValues, doubl
     // Validate results element by element
     size_t width_lod = (imageInfo->width >> lod ) ?(imageInfo->width >> lod ) : 1;
     size_t height_lod = (imageInfo->height >> lod ) ?(imageInfo->height >> lod ) : 1;
+    ImagePixelAccessor accessor( imageInfo, 0 );
     /*
      * FLOAT output type
      */
@@ -427,63 +428,27 @@ int validate_image_2D_depth_results(void *imageValues, void *resultValues, doubl
         float *resultPtr = (float *)(char *)resultValues;
         float expected[4], error=0.0f;
         float maxErr = get_max_relative_error( imageInfo->format, imageSampler, 0 /*not 3D*/, CL_FILTER_LINEAR == imageSampler->filter_mode );
+        // Step 1: go through and see if the results verify for the pixel
+        // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
+        // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
+        // This is done for all pixels up front, in tiles on the thread pool.
+        float offset = get_float_norm_offset( imageSampler );
+        auto findPixel = [&]( size_t j ) -> int
+        {
+            return find_float_pixel_2D( imageValues, imageInfo, imageSampler, 0, &accessor,
+                                        xOffsetValues[ j ], yOffsetValues[ j ], offset, (float *)(char *)resultValues + 4 * j,
+                                        1, maxErr, formatAbsoluteError );
+        };
+        std::vector<char> foundPixels;
+        if( find_pixels_in_parallel( foundPixels, width_lod * height_lod, findPixel ) )
+            return 1;
+
         for( size_t y = 0, j = 0; y < height_lod; y++ )
         {
             for( size_t x = 0; x < width_lod; x++, j++ )
             {
-                // Step 1: go through and see if the results verify for the pixel
-                // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
-                // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
                 int checkOnlyOnePixel = 0;
-                int found_pixel = 0;
-                float offset = NORM_OFFSET;
-                if (!imageSampler->normalized_coords ||  imageSampler->filter_mode != CL_FILTER_NEAREST || NORM_OFFSET == 0
-#if defined( __APPLE__ )
-                    // Apple requires its CPU implementation to do correctly rounded address arithmetic in all modes
-                    || gDeviceType != CL_DEVICE_TYPE_GPU
-#endif
-                    )
-                    offset = 0.0f;          // Loop only once
-
-                for (float norm_offset_x = -offset; norm_offset_x <= offset && !found_pixel; norm_offset_x += NORM_OFFSET) {
-                    for (float norm_offset_y = -offset; norm_offset_y <= offset && !found_pixel; norm_offset_y += NORM_OFFSET) {
-
-                        // Try sampling the pixel, without flushing denormals.
-                        int containsDenormals = 0;
-                        FloatPixel maxPixel;
-                        maxPixel = sample_image_pixel_float_offset( imageValues, imageInfo,
-                                                                    xOffsetValues[ j ], yOffsetValues[ j ], 0.0f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                    imageSampler, expected, 0, &containsDenormals );
-
-                        float err1 = fabsf( resultPtr[0] - expected[0] );
-                        // Clamp to the minimum absolute error for the format
-                        if (err1 > 0 && err1 < formatAbsoluteError) { err1 = 0.0f; }
-                        float maxErr1 = MAX( maxErr * maxPixel.p[0], FLT_MIN );
-
-                        // Check if the result matches.
-                        if( ! (err1 <= maxErr1) )
-                        {
-                            //try flushing the denormals, if there is a failure.
-                            if( containsDenormals )
-                            {
-                                // If implementation decide to flush subnormals to zero,
-                                // max error needs to be adjusted
-                                maxErr1 += 4 * FLT_MIN;
-
-                                maxPixel = sample_image_pixel_float_offset( imageValues, imageInfo,
-                                                                             xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                             imageSampler, expected, 0, NULL );
-
-                                err1 = fabsf( resultPtr[0] - expected[0] );
-                            }
-                        }
-
-                        // If the final result DOES match, then we've found a valid result and we're done with this pixel.
-                        found_pixel = (err1 <= maxErr1);
-                    }//norm_offset_x
-                }//norm_offset_y
-
-
+                int found_pixel = foundPixels[ j ];
                 // Step 2: If we did not find a match, then print out debugging info.
                 if (!found_pixel) {
                     // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
@@ -505,7 +470,7 @@ int validate_image_2D_depth_results(void *imageValues, void *resultValues, doubl
                             FloatPixel maxPixel;
                             maxPixel = sample_image_pixel_float_offset( imageValues, imageInfo,
                                                                                     xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                    imageSampler, expected, 0, &containsDenormals );
+                                                                                    imageSampler, expected, 0, &containsDenormals, 0, &accessor );
 
                             float err1 = fabsf( resultPtr[0] - expected[0] );
                             float maxErr1 = MAX( maxErr * maxPixel.p[0], FLT_MIN );
@@ -520,7 +485,7 @@ int validate_image_2D_depth_results(void *imageValues, void *resultValues, doubl
 
                                     maxPixel = sample_image_pixel_float_offset( imageValues, imageInfo,
                                                                                  xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                 imageSampler, expected, 0, NULL );
+                                                                                 imageSampler, expected, 0, NULL, 0, &accessor );
 
                                     err1 = fabsf( resultPtr[0] - expected[0] );
                                 }
@@ -537,7 +502,7 @@ int validate_image_2D_depth_results(void *imageValues, void *resultValues, doubl
                                 FloatPixel temp;
                                 temp = sample_image_pixel_float_offset( imageValues, imageInfo,
                                                                                xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                               imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/ );
+                                                                               imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, 0, &accessor );
                                 log_error( "\tulps: %2.2f  (max allowed: %2.2f)\n\n",
                                                     Ulp_Error( resultPtr[0], expected[0] ),
                                                     Ulp_Error( MAKE_HEX_FLOAT(0x1.000002p0f, 0x1000002L, -24) + maxErr, MAKE_HEX_FLOAT(0x1.000002p0f, 0x1000002L, -24) ) );
@@ -570,6 +535,7 @@ int validate_image_2D_results(void *imageValues, void *resultValues, double form
     // Validate results element by element
     size_t width_lod = (imageInfo->width >> lod ) ?(imageInfo->width >> lod ) : 1;
     size_t height_lod = (imageInfo->height >> lod ) ?(imageInfo->height >> lod ) : 1;
+    ImagePixelAccessor accessor( imageInfo, gTestMipmaps ? (int)lod : 0 );
     /*
      * FLOAT output type
      */
@@ -579,90 +545,27 @@ int validate_image_2D_results(void *imageValues, void *resultValues, double form
         float *resultPtr = (float *)(char *)resultValues;
         float expected[4], error=0.0f;
         float maxErr = get_max_relative_error( imageInfo->format, imageSampler, 0 /*not 3D*/, CL_FILTER_LINEAR == imageSampler->filter_mode );
+        // Step 1: go through and see if the results verify for the pixel
+        // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
+        // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
+        // This is done for all pixels up front, in tiles on the thread pool.
+        float offset = get_float_norm_offset( imageSampler );
+        auto findPixel = [&]( size_t j ) -> int
+        {
+            return find_float_pixel_2D( imagePtr, imageInfo, imageSampler, gTestMipmaps ? (int)lod : 0, &accessor,
+                                        xOffsetValues[ j ], yOffsetValues[ j ], offset, (float *)(char *)resultValues + 4 * j,
+                                        4, maxErr, formatAbsoluteError );
+        };
+        std::vector<char> foundPixels;
+        if( find_pixels_in_parallel( foundPixels, width_lod * height_lod, findPixel ) )
+            return 1;
+
         for( size_t y = 0, j = 0; y < height_lod; y++ )
         {
             for( size_t x = 0; x < width_lod; x++, j++ )
             {
-                // Step 1: go through and see if the results verify for the pixel
-                // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
-                // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
                 int checkOnlyOnePixel = 0;
-                int found_pixel = 0;
-                float offset = NORM_OFFSET;
-                if (!imageSampler->normalized_coords ||  imageSampler->filter_mode != CL_FILTER_NEAREST || NORM_OFFSET == 0
-#if defined( __APPLE__ )
-                    // Apple requires its CPU implementation to do correctly rounded address arithmetic in all modes
-                    || gDeviceType != CL_DEVICE_TYPE_GPU
-#endif
-                    )
-                    offset = 0.0f;          // Loop only once
-
-                for (float norm_offset_x = -offset; norm_offset_x <= offset && !found_pixel; norm_offset_x += NORM_OFFSET) {
-                    for (float norm_offset_y = -offset; norm_offset_y <= offset && !found_pixel; norm_offset_y += NORM_OFFSET) {
-
-
-                        // Try sampling the pixel, without flushing denormals.
-                        int containsDenormals = 0;
-                        FloatPixel maxPixel;
-                        if ( gTestMipmaps )
-                            maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
-                                                                        xOffsetValues[ j ], yOffsetValues[ j ], 0.0f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                        imageSampler, expected, 0, &containsDenormals, lod );
-                        else
-                            maxPixel = sample_image_pixel_float_offset( imageValues, imageInfo,
-                                                                        xOffsetValues[ j ], yOffsetValues[ j ], 0.0f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                        imageSampler, expected, 0, &containsDenormals );
-
-                        float err1 = fabsf( resultPtr[0] - expected[0] );
-                        float err2 = fabsf( resultPtr[1] - expected[1] );
-                        float err3 = fabsf( resultPtr[2] - expected[2] );
-                        float err4 = fabsf( resultPtr[3] - expected[3] );
-                        // Clamp to the minimum absolute error for the format
-                        if (err1 > 0 && err1 < formatAbsoluteError) { err1 = 0.0f; }
-                        if (err2 > 0 && err2 < formatAbsoluteError) { err2 = 0.0f; }
-                        if (err3 > 0 && err3 < formatAbsoluteError) { err3 = 0.0f; }
-                        if (err4 > 0 && err4 < formatAbsoluteError) { err4 = 0.0f; }
-                        float maxErr1 = MAX( maxErr * maxPixel.p[0], FLT_MIN );
-                        float maxErr2 = MAX( maxErr * maxPixel.p[1], FLT_MIN );
-                        float maxErr3 = MAX( maxErr * maxPixel.p[2], FLT_MIN );
-                        float maxErr4 = MAX( maxErr * maxPixel.p[3], FLT_MIN );
-
-                        // Check if the result matches.
-                        if( ! (err1 <= maxErr1) || ! (err2 <= maxErr2)    ||
-                           ! (err3 <= maxErr3) || ! (err4 <= maxErr4)    )
-                        {
-                            //try flushing the denormals, if there is a failure.
-                            if( containsDenormals )
-                            {
-                               // If implementation decide to flush subnormals to zero,
-                               // max error needs to be adjusted
-                                maxErr1 += 4 * FLT_MIN;
-                                maxErr2 += 4 * FLT_MIN;
-                                maxErr3 += 4 * FLT_MIN;
-                                maxErr4 += 4 * FLT_MIN;
-
-                                if(gTestMipmaps)
-                                    maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
-                                                                                 xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                 imageSampler, expected, 0, NULL,lod );
-                                else
-                                    maxPixel = sample_image_pixel_float_offset( imageValues, imageInfo,
-                                                                                 xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                 imageSampler, expected, 0, NULL );
-
-                                err1 = fabsf( resultPtr[0] - expected[0] );
-                                err2 = fabsf( resultPtr[1] - expected[1] );
-                                err3 = fabsf( resultPtr[2] - expected[2] );
-                                err4 = fabsf( resultPtr[3] - expected[3] );
-                            }
-                        }
-
-                        // If the final result DOES match, then we've found a valid result and we're done with this pixel.
-                        found_pixel = (err1 <= maxErr1) && (err2 <= maxErr2)  && (err3 <= maxErr3) && (err4 <= maxErr4);
-                    }//norm_offset_x
-                }//norm_offset_y
-
-
+                int found_pixel = foundPixels[ j ];
                 // Step 2: If we did not find a match, then print out debugging info.
                 if (!found_pixel) {
                     // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
@@ -685,11 +588,11 @@ int validate_image_2D_results(void *imageValues, void *resultValues, double form
                             if(gTestMipmaps)
                                 maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                         xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                        imageSampler, expected, 0, &containsDenormals, lod );
+                                                                                        imageSampler, expected, 0, &containsDenormals, lod, &accessor );
                             else
                                 maxPixel = sample_image_pixel_float_offset( imageValues, imageInfo,
                                                                                         xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                        imageSampler, expected, 0, &containsDenormals );
+                                                                                        imageSampler, expected, 0, &containsDenormals, 0, &accessor );
 
                             float err1 = fabsf( resultPtr[0] - expected[0] );
                             float err2 = fabsf( resultPtr[1] - expected[1] );
@@ -715,11 +618,11 @@ int validate_image_2D_results(void *imageValues, void *resultValues, double form
                                     if(gTestMipmaps)
                                         maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                      xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                     imageSampler, expected, 0, NULL, lod );
+                                                                                     imageSampler, expected, 0, NULL, lod, &accessor );
                                     else
                                         maxPixel = sample_image_pixel_float_offset( imageValues, imageInfo,
                                                                                      xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                     imageSampler, expected, 0, NULL );
+                                                                                     imageSampler, expected, 0, NULL, 0, &accessor );
 
                                     err1 = fabsf( resultPtr[0] - expected[0] );
                                     err2 = fabsf( resultPtr[1] - expected[1] );
@@ -741,11 +644,11 @@ int validate_image_2D_results(void *imageValues, void *resultValues, double form
                                 if( gTestMipmaps )
                                      temp = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                     xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                    imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, lod );
+                                                                                    imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, lod, &accessor );
                                  else
                                      temp = sample_image_pixel_float_offset( imageValues, imageInfo,
                                                                                     xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                    imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/ );
+                                                                                    imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, 0, &accessor );
                                 log_error( "\tulps: %2.2f, %2.2f, %2.2f, %2.2f  (max allowed: %2.2f)\n\n",
                                                     Ulp_Error( resultPtr[0], expected[0] ),
                                                     Ulp_Error( resultPtr[1], expected[1] ),
@@ -776,43 +679,25 @@ int validate_image_2D_results(void *imageValues, void *resultValues, double form
         unsigned int *resultPtr = (unsigned int *)(char *)resultValues;
         unsigned int expected[4];
         float error;
+        // Step 1: go through and see if the results verify for the pixel
+        // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
+        // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
+        // This is done for all pixels up front, in tiles on the thread pool.
+        auto findPixel = [&]( size_t j ) -> int
+        {
+            return find_int_pixel_2D<unsigned int>( imagePtr, imageInfo, imageSampler, gTestMipmaps ? (int)lod : 0,
+                                                     xOffsetValues[ j ], yOffsetValues[ j ], (unsigned int *)(char *)resultValues + 4 * j, MAX_ERR );
+        };
+        std::vector<char> foundPixels;
+        if( find_pixels_in_parallel( foundPixels, width_lod * height_lod, findPixel ) )
+            return 1;
+
         for( size_t y = 0, j = 0; y < height_lod ; y++ )
         {
             for( size_t x = 0; x < width_lod ; x++, j++ )
             {
-                // Step 1: go through and see if the results verify for the pixel
-                // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
-                // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
                 int checkOnlyOnePixel = 0;
-                int found_pixel = 0;
-                for (float norm_offset_x = -NORM_OFFSET; norm_offset_x <= NORM_OFFSET && !found_pixel && !checkOnlyOnePixel; norm_offset_x += NORM_OFFSET) {
-                    for (float norm_offset_y = -NORM_OFFSET; norm_offset_y <= NORM_OFFSET && !found_pixel && !checkOnlyOnePixel; norm_offset_y += NORM_OFFSET) {
-
-                        // If we are not on a GPU, or we are not normalized, then only test with offsets (0.0, 0.0)
-                        // E.g., test one pixel.
-                        if (!imageSampler->normalized_coords || gDeviceType != CL_DEVICE_TYPE_GPU || NORM_OFFSET == 0) {
-                            norm_offset_x = 0.0f;
-                            norm_offset_y = 0.0f;
-                            checkOnlyOnePixel = 1;
-                        }
-
-                        if ( gTestMipmaps )
-                            sample_image_pixel_offset<unsigned int>( (char*)imagePtr, imageInfo,
-                                                                                             xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                             imageSampler, expected, lod );
-                        else
-                            sample_image_pixel_offset<unsigned int>( imagePtr, imageInfo,
-                                                                                             xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                             imageSampler, expected);
-
-
-                        error = errMax( errMax( abs_diff_uint(expected[ 0 ], resultPtr[ 0 ]), abs_diff_uint(expected[ 1 ], resultPtr[ 1 ]) ),
-                                       errMax( abs_diff_uint(expected[ 2 ], resultPtr[ 2 ]), abs_diff_uint(expected[ 3 ], resultPtr[ 3 ]) ) );
-
-                        if (error <= MAX_ERR)
-                            found_pixel = 1;
-                    }//norm_offset_x
-                }//norm_offset_y
+                int found_pixel = foundPixels[ j ];
 
                 // Step 2: If we did not find a match, then print out debugging info.
                 if (!found_pixel) {
@@ -872,43 +757,25 @@ int validate_image_2D_results(void *imageValues, void *resultValues, double form
         int *resultPtr = (int *)(char *)resultValues;
         int expected[4];
         float error;
+        // Step 1: go through and see if the results verify for the pixel
+        // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
+        // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
+        // This is done for all pixels up front, in tiles on the thread pool.
+        auto findPixel = [&]( size_t j ) -> int
+        {
+            return find_int_pixel_2D<int>( imagePtr, imageInfo, imageSampler, gTestMipmaps ? (int)lod : 0,
+                                            xOffsetValues[ j ], yOffsetValues[ j ], (int *)(char *)resultValues + 4 * j, MAX_ERR );
+        };
+        std::vector<char> foundPixels;
+        if( find_pixels_in_parallel( foundPixels, width_lod * height_lod, findPixel ) )
+            return 1;
+
         for( size_t y = 0, j = 0; y < height_lod ; y++ )
         {
             for( size_t x = 0; x < width_lod; x++, j++ )
             {
-                // Step 1: go through and see if the results verify for the pixel
-                // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
-                // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
                 int checkOnlyOnePixel = 0;
-                int found_pixel = 0;
-                for (float norm_offset_x = -NORM_OFFSET; norm_offset_x <= NORM_OFFSET && !found_pixel && !checkOnlyOnePixel; norm_offset_x += NORM_OFFSET) {
-                    for (float norm_offset_y = -NORM_OFFSET; norm_offset_y <= NORM_OFFSET && !found_pixel && !checkOnlyOnePixel; norm_offset_y += NORM_OFFSET) {
-
-                        // If we are not on a GPU, or we are not normalized, then only test with offsets (0.0, 0.0)
-                        // E.g., test one pixel.
-                        if (!imageSampler->normalized_coords || gDeviceType != CL_DEVICE_TYPE_GPU || NORM_OFFSET == 0) {
-                            norm_offset_x = 0.0f;
-                            norm_offset_y = 0.0f;
-                            checkOnlyOnePixel = 1;
-                        }
-
-                        if ( gTestMipmaps )
-                            sample_image_pixel_offset<int>( imagePtr, imageInfo,
-                                                            xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                            imageSampler, expected , lod);
-                        else
-                            sample_image_pixel_offset<int>( imageValues, imageInfo,
-                                                            xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                            imageSampler, expected );
-
-
-                        error = errMax( errMax( abs_diff_int(expected[ 0 ], resultPtr[ 0 ]), abs_diff_int(expected[ 1 ], resultPtr[ 1 ]) ),
-                                       errMax( abs_diff_int(expected[ 2 ], resultPtr[ 2 ]), abs_diff_int(expected[ 3 ], resultPtr[ 3 ]) ) );
-
-                        if (error <= MAX_ERR)
-                            found_pixel = 1;
-                    }//norm_offset_x
-                }//norm_offset_y
+                int found_pixel = foundPixels[ j ];
 
                 // Step 2: If we did not find a match, then print out debugging info.
                 if (!found_pixel) {
@@ -968,6 +835,7 @@ int validate_image_2D_sRGB_results(void *imageValues, void *resultValues, double
     // Validate results element by element
     size_t width_lod = (imageInfo->width >> lod ) ?(imageInfo->width >> lod ) : 1;
     size_t height_lod = (imageInfo->height >> lod ) ?(imageInfo->height >> lod ) : 1;
+    ImagePixelAccessor accessor( imageInfo, gTestMipmaps ? (int)lod : 0 );
     /*
      * FLOAT output type
      */
@@ -977,78 +845,26 @@ int validate_image_2D_sRGB_results(void *imageValues, void *resultValues, double
         float *resultPtr = (float *)(char *)resultValues;
         float expected[4], error=0.0f;
         float maxErr = get_max_relative_error( imageInfo->format, imageSampler, 0 /*not 3D*/, CL_FILTER_LINEAR == imageSampler->filter_mode );
+        // Step 1: go through and see if the results verify for the pixel
+        // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
+        // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
+        // This is done for all pixels up front, in tiles on the thread pool.
+        float offset = get_float_norm_offset( imageSampler );
+        auto findPixel = [&]( size_t j ) -> int
+        {
+            return find_sRGB_pixel_2D( imagePtr, imageInfo, imageSampler, gTestMipmaps ? (int)lod : 0, &accessor,
+                                       xOffsetValues[ j ], yOffsetValues[ j ], offset, (float *)(char *)resultValues + 4 * j );
+        };
+        std::vector<char> foundPixels;
+        if( find_pixels_in_parallel( foundPixels, width_lod * height_lod, findPixel ) )
+            return 1;
+
         for( size_t y = 0, j = 0; y < height_lod; y++ )
         {
             for( size_t x = 0; x < width_lod; x++, j++ )
             {
-                // Step 1: go through and see if the results verify for the pixel
-                // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
-                // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
                 int checkOnlyOnePixel = 0;
-                int found_pixel = 0;
-                float offset = NORM_OFFSET;
-                if (!imageSampler->normalized_coords ||  imageSampler->filter_mode != CL_FILTER_NEAREST || NORM_OFFSET == 0
-#if defined( __APPLE__ )
-                    // Apple requires its CPU implementation to do correctly rounded address arithmetic in all modes
-                    || gDeviceType != CL_DEVICE_TYPE_GPU
-#endif
-                    )
-                    offset = 0.0f;          // Loop only once
-
-                for (float norm_offset_x = -offset; norm_offset_x <= offset && !found_pixel; norm_offset_x += NORM_OFFSET) {
-                    for (float norm_offset_y = -offset; norm_offset_y <= offset && !found_pixel; norm_offset_y += NORM_OFFSET) {
-
-
-                        // Try sampling the pixel, without flushing denormals.
-                        int containsDenormals = 0;
-                        FloatPixel maxPixel;
-                        if ( gTestMipmaps )
-                            maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
-                                                                        xOffsetValues[ j ], yOffsetValues[ j ], 0.0f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                        imageSampler, expected, 0, &containsDenormals, lod );
-                        else
-                            maxPixel = sample_image_pixel_float_offset( imageValues, imageInfo,
-                                                                        xOffsetValues[ j ], yOffsetValues[ j ], 0.0f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                        imageSampler, expected, 0, &containsDenormals );
-                        float err1 = fabsf( sRGBmap( resultPtr[0] ) - sRGBmap( expected[0] ) );
-                        float err2 = fabsf( sRGBmap( resultPtr[1] ) - sRGBmap( expected[1] ) );
-                        float err3 = fabsf( sRGBmap( resultPtr[2] ) - sRGBmap( expected[2] ) );
-                        float err4 = fabsf( resultPtr[3] - expected[3] );
-                        float maxErr = 0.5;
-
-                        // Check if the result matches.
-                        if( ! (err1 <= maxErr) || ! (err2 <= maxErr)    ||
-                           ! (err3 <= maxErr) || ! (err4 <= maxErr)    )
-                        {
-                            //try flushing the denormals, if there is a failure.
-                            if( containsDenormals )
-                            {
-                                // If implementation decide to flush subnormals to zero,
-                                // max error needs to be adjusted
-                                maxErr += 4 * FLT_MIN;
-
-                                if(gTestMipmaps)
-                                    maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
-                                                                                 xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                 imageSampler, expected, 0, NULL,lod );
-                                else
-                                    maxPixel = sample_image_pixel_float_offset( imageValues, imageInfo,
-                                                                                 xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                 imageSampler, expected, 0, NULL );
-
-                                err1 = fabsf( sRGBmap( resultPtr[0] ) - sRGBmap( expected[0] ) );
-                                err2 = fabsf( sRGBmap( resultPtr[1] ) - sRGBmap( expected[1] ) );
-                                err3 = fabsf( sRGBmap( resultPtr[2] ) - sRGBmap( expected[2] ) );
-                                err4 = fabsf( resultPtr[3] - expected[3] );
-                            }
-                        }
-
-                        // If the final result DOES match, then we've found a valid result and we're done with this pixel.
-                        found_pixel = (err1 <= maxErr) && (err2 <= maxErr)  && (err3 <= maxErr) && (err4 <= maxErr);
-                    }//norm_offset_x
-                }//norm_offset_y
-
-
+                int found_pixel = foundPixels[ j ];
                 // Step 2: If we did not find a match, then print out debugging info.
                 if (!found_pixel) {
                     // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
@@ -1071,11 +887,11 @@ int validate_image_2D_sRGB_results(void *imageValues, void *resultValues, double
                             if(gTestMipmaps)
                                 maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                         xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                        imageSampler, expected, 0, &containsDenormals, lod );
+                                                                                        imageSampler, expected, 0, &containsDenormals, lod, &accessor );
                             else
                                 maxPixel = sample_image_pixel_float_offset( imageValues, imageInfo,
                                                                                         xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                        imageSampler, expected, 0, &containsDenormals );
+                                                                                        imageSampler, expected, 0, &containsDenormals, 0, &accessor );
 
                             float err1 = fabsf( sRGBmap( resultPtr[0] ) - sRGBmap( expected[0] ) );
                             float err2 = fabsf( sRGBmap( resultPtr[1] ) - sRGBmap( expected[1] ) );
@@ -1095,11 +911,11 @@ int validate_image_2D_sRGB_results(void *imageValues, void *resultValues, double
                                     if(gTestMipmaps)
                                         maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                      xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                     imageSampler, expected, 0, NULL, lod );
+                                                                                     imageSampler, expected, 0, NULL, lod, &accessor );
                                     else
                                         maxPixel = sample_image_pixel_float_offset( imageValues, imageInfo,
                                                                                      xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                     imageSampler, expected, 0, NULL );
+                                                                                     imageSampler, expected, 0, NULL, 0, &accessor );
 
                                     err1 = fabsf( sRGBmap( resultPtr[0] ) - sRGBmap( expected[0] ) );
                                     err2 = fabsf( sRGBmap( resultPtr[1] ) - sRGBmap( expected[1] ) );
@@ -1121,11 +937,11 @@ int validate_image_2D_sRGB_results(void *imageValues, void *resultValues, double
                                 if( gTestMipmaps )
                                      temp = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                     xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                    imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, lod );
+                                                                                    imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, lod, &accessor );
                                  else
                                      temp = sample_image_pixel_float_offset( imageValues, imageInfo,
                                                                                     xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                    imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/ );
+                                                                                    imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, 0, &accessor );
                                 log_error( "\tulps: %2.2f, %2.2f, %2.2f, %2.2f  (max allowed: %2.2f)\n\n",
                                                     Ulp_Error( resultPtr[0], expected[0] ),
                                                     Ulp_Error( resultPtr[1], expected[1] ),
@@ -457,6 +457,7 @@ int test_read_image_1D( cl_device_id device, cl_context context, cl_command_queu
     for(int lod = 0; (gTestMipmaps && lod < imageInfo->num_mip_levels) || (!gTestMipmaps && lod < 1); lod++)
     {
         float lod_float = (float)lod;
+        ImagePixelAccessor accessor( imageInfo, (int)lod );
         size_t resultValuesSize = width_lod * get_explicit_type_size( outputType ) * 4;
         BufferOwningPtr<char> resultValues(malloc(resultValuesSize));
         char *imagePtr = (char*)imageValues + nextLevelOffset;
@@ -530,7 +531,7 @@ int test_read_image_1D( cl_device_id device, cl_context context, cl_command_queu
                             int containsDenormals = 0;
                             FloatPixel maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                             xOffsetValues[ j ], 0.0f, 0.0f, norm_offset_x, 0.0f, 0.0f,
-                                                                            imageSampler, expected, 0, &containsDenormals, lod );
+                                                                            imageSampler, expected, 0, &containsDenormals, lod, &accessor );
 
                             float err1 = fabsf( sRGBmap( resultPtr[0] ) - sRGBmap( expected[0] ) );
                             float err2 = fabsf( sRGBmap( resultPtr[1] ) - sRGBmap( expected[1] ) );
@@ -552,7 +553,7 @@ int test_read_image_1D( cl_device_id device, cl_context context, cl_command_queu
 
                                     maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                  xOffsetValues[ j ], 0.0f, 0.0f, norm_offset_x, 0.0f, 0.0f,
-                                                                                 imageSampler, expected, 0, NULL, lod );
+                                                                                 imageSampler, expected, 0, NULL, lod, &accessor );
 
                                     err1 = fabsf( sRGBmap( resultPtr[0] ) - sRGBmap( expected[0] ) );
                                     err2 = fabsf( sRGBmap( resultPtr[1] ) - sRGBmap( expected[1] ) );
@@ -584,7 +585,7 @@ int test_read_image_1D( cl_device_id device, cl_context context, cl_command_queu
                                 int containsDenormals = 0;
                                 FloatPixel maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                         xOffsetValues[ j ], 0.0f, 0.0f, norm_offset_x, 0.0f, 0.0f,
-                                                                                        imageSampler, expected, 0, &containsDenormals, lod );
+                                                                                        imageSampler, expected, 0, &containsDenormals, lod, &accessor );
 
                                 float err1 = fabsf( sRGBmap( resultPtr[0] ) - sRGBmap( expected[0] ) );
                                 float err2 = fabsf( sRGBmap( resultPtr[1] ) - sRGBmap( expected[1] ) );
@@ -605,7 +606,7 @@ int test_read_image_1D( cl_device_id device, cl_context context, cl_command_queu
 
                                         maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                      xOffsetValues[ j ], 0.0f, 0.0f, norm_offset_x, 0.0f, 0.0f,
-                                                                                     imageSampler, expected, 0, NULL, lod );
+                                                                                     imageSampler, expected, 0, NULL, lod, &accessor );
 
                                         err1 = fabsf( sRGBmap( resultPtr[0] ) - sRGBmap( expected[0] ) );
                                         err2 = fabsf( sRGBmap( resultPtr[1] ) - sRGBmap( expected[1] ) );
@@ -625,7 +626,7 @@ int test_read_image_1D( cl_device_id device, cl_context context, cl_command_queu
                                     log_error( "Step by step:\n" );
                                     FloatPixel temp = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                         xOffsetValues[ j ], 0.0f, 0.0f, norm_offset_x, 0.0f, 0.0f,
-                                                                                        imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, lod );
+                                                                                        imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, lod, &accessor );
                                     log_error( "\tulps: %2.2f, %2.2f, %2.2f, %2.2f  (max allowed: %2.2f)\n\n",
                                                         Ulp_Error( resultPtr[0], expected[0] ),
                                                         Ulp_Error( resultPtr[1], expected[1] ),
@@ -675,7 +676,7 @@ int test_read_image_1D( cl_device_id device, cl_context context, cl_command_queu
                             int containsDenormals = 0;
                             FloatPixel maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                             xOffsetValues[ j ], 0.0f, 0.0f, norm_offset_x, 0.0f, 0.0f,
-                                                                            imageSampler, expected, 0, &containsDenormals, lod );
+                                                                            imageSampler, expected, 0, &containsDenormals, lod, &accessor );
 
                             float err1 = fabsf( resultPtr[0] - expected[0] );
                             float err2 = fabsf( resultPtr[1] - expected[1] );
@@ -707,7 +708,7 @@ int test_read_image_1D( cl_device_id device, cl_context context, cl_command_queu
 
                                     maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                  xOffsetValues[ j ], 0.0f, 0.0f, norm_offset_x, 0.0f, 0.0f,
-                                                                                 imageSampler, expected, 0, NULL, lod );
+                                                                                 imageSampler, expected, 0, NULL, lod, &accessor );
 
                                     err1 = fabsf( resultPtr[0] - expected[0] );
                                     err2 = fabsf( resultPtr[1] - expected[1] );
@@ -739,7 +740,7 @@ int test_read_image_1D( cl_device_id device, cl_context context, cl_command_queu
                                 int containsDenormals = 0;
                                 FloatPixel maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                         xOffsetValues[ j ], 0.0f, 0.0f, norm_offset_x, 0.0f, 0.0f,
-                                                                                        imageSampler, expected, 0, &containsDenormals, lod );
+                                                                                        imageSampler, expected, 0, &containsDenormals, lod, &accessor );
 
                                 float err1 = fabsf( resultPtr[0] - expected[0] );
                                 float err2 = fabsf( resultPtr[1] - expected[1] );
@@ -764,7 +765,7 @@ int test_read_image_1D( cl_device_id device, cl_context context, cl_command_queu
 
                                         maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                      xOffsetValues[ j ], 0.0f, 0.0f, norm_offset_x, 0.0f, 0.0f,
-                                                                                     imageSampler, expected, 0, NULL, lod );
+                                                                                     imageSampler, expected, 0, NULL, lod, &accessor );
 
                                         err1 = fabsf( resultPtr[0] - expected[0] );
                                         err2 = fabsf( resultPtr[1] - expected[1] );
@@ -784,7 +785,7 @@ int test_read_image_1D( cl_device_id device, cl_context context, cl_command_queu
                                     log_error( "Step by step:\n" );
                                     FloatPixel temp = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                         xOffsetValues[ j ], 0.0f, 0.0f, norm_offset_x, 0.0f, 0.0f,
-                                                                                        imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, lod );
+                                                                                        imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, lod, &accessor );
                                     log_error( "\tulps: %2.2f, %2.2f, %2.2f, %2.2f  (max allowed: %2.2f)\n\n",
                                                         Ulp_Error( resultPtr[0], expected[0] ),
                                                         Ulp_Error( resultPtr[1], expected[1] ),
@@ -550,6 +550,7 @@ int test_read_image_1D_array( cl_device_id device, cl_context context, cl_comman
         size_t resultValuesSize = width_lod * imageInfo->arraySize * get_explicit_type_size( outputType ) * 4;
         BufferOwningPtr<char> resultValues(malloc(resultValuesSize));
         float lod_float = (float)lod;
+        ImagePixelAccessor accessor( imageInfo, (int)lod );
         if (gTestMipmaps) {
             //Set the lod kernel arg
             if(gDebugTrace)
@@ -601,68 +602,26 @@ int test_read_image_1D_array( cl_device_id device, cl_context context, cl_comman
             float *resultPtr = (float *)(char *)resultValues;
             float expected[4], error=0.0f;
             float maxErr = get_max_relative_error( imageInfo->format, imageSampler, 0 /*not 3D*/, CL_FILTER_LINEAR == imageSampler->filter_mode );
+            // Step 1: go through and see if the results verify for the pixel
+            // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
+            // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
+            // This is done for all pixels up front, in tiles on the thread pool.
+            float offset = get_float_norm_offset( imageSampler );
+            auto findPixel = [&]( size_t j ) -> int
+            {
+                return find_sRGB_pixel_2D( imagePtr, imageInfo, imageSampler, lod, &accessor,
+                                           xOffsetValues[ j ], yOffsetValues[ j ], offset, (float *)(char *)resultValues + 4 * j );
+            };
+            std::vector<char> foundPixels;
+            if( find_pixels_in_parallel( foundPixels, width_lod * imageInfo->arraySize, findPixel ) )
+                return 1;
+
             for( size_t y = 0, j = 0; y < imageInfo->arraySize; y++ )
             {
                 for( size_t x = 0; x < width_lod; x++, j++ )
                 {
-                    // Step 1: go through and see if the results verify for the pixel
-                    // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
-                    // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
                     int checkOnlyOnePixel = 0;
-                    int found_pixel = 0;
-                    float offset = NORM_OFFSET;
-                    if (!imageSampler->normalized_coords ||  imageSampler->filter_mode != CL_FILTER_NEAREST || NORM_OFFSET == 0
-#if defined( __APPLE__ )
-                        // Apple requires its CPU implementation to do correctly rounded address arithmetic in all modes
-                        || gDeviceType != CL_DEVICE_TYPE_GPU
-#endif
-                        )
-                        offset = 0.0f;          // Loop only once
-
-                    for (float norm_offset_x = -offset; norm_offset_x <= offset && !found_pixel; norm_offset_x += NORM_OFFSET) {
-                        for (float norm_offset_y = -offset; norm_offset_y <= offset && !found_pixel; norm_offset_y += NORM_OFFSET) {
-
-
-                            // Try sampling the pixel, without flushing denormals.
-                            int containsDenormals = 0;
-                            FloatPixel maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
-                                xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                imageSampler, expected, 0, &containsDenormals, lod );
-
-                            float err1 = fabsf( sRGBmap( resultPtr[0] ) - sRGBmap( expected[0] ) );
-                            float err2 = fabsf( sRGBmap( resultPtr[1] ) - sRGBmap( expected[1] ) );
-                            float err3 = fabsf( sRGBmap( resultPtr[2] ) - sRGBmap( expected[2] ) );
-                            float err4 = fabsf( resultPtr[3] - expected[3] );
-                            float maxErr = 0.5;
-
-                            // Check if the result matches.
-                            if( ! (err1 <= maxErr) || ! (err2 <= maxErr)    ||
-                               ! (err3 <= maxErr) || ! (err4 <= maxErr)    )
-                            {
-                                //try flushing the denormals, if there is a failure.
-                                if( containsDenormals )
-                                {
-                                    // If implementation decide to flush subnormals to zero,
-                                    // max error needs to be adjusted
-                                    maxErr += 4 * FLT_MIN;
-
-                                    maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
-                                                                               xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                               imageSampler, expected, 0, NULL, lod );
-
-                                    err1 = fabsf( sRGBmap( resultPtr[0] ) - sRGBmap( expected[0] ) );
-                                    err2 = fabsf( sRGBmap( resultPtr[1] ) - sRGBmap( expected[1] ) );
-                                    err3 = fabsf( sRGBmap( resultPtr[2] ) - sRGBmap( expected[2] ) );
-                                    err4 = fabsf( resultPtr[3] - expected[3] );
-                                }
-                            }
-
-                            // If the final result DOES match, then we've found a valid result and we're done with this pixel.
-                            found_pixel = (err1 <= maxErr) && (err2 <= maxErr)  && (err3 <= maxErr) && (err4 <= maxErr);
-                        }//norm_offset_x
-                    }//norm_offset_y
-
-
+                    int found_pixel = foundPixels[ j ];
                     // Step 2: If we did not find a match, then print out debugging info.
                     if (!found_pixel) {
                         // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
@@ -683,7 +642,7 @@ int test_read_image_1D_array( cl_device_id device, cl_context context, cl_comman
                                 int containsDenormals = 0;
                                 FloatPixel maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                       xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                      imageSampler, expected, 0, &containsDenormals, lod );
+                                                                                      imageSampler, expected, 0, &containsDenormals, lod, &accessor );
 
                                 float err1 = fabsf( sRGBmap( resultPtr[0] ) - sRGBmap( expected[0] ) );
                                 float err2 = fabsf( sRGBmap( resultPtr[1] ) - sRGBmap( expected[1] ) );
@@ -704,7 +663,7 @@ int test_read_image_1D_array( cl_device_id device, cl_context context, cl_comman
 
                                         maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                    xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                   imageSampler, expected, 0, NULL, lod );
+                                                                                   imageSampler, expected, 0, NULL, lod, &accessor );
 
                                         err1 = fabsf( sRGBmap( resultPtr[0] ) - sRGBmap( expected[0] ) );
                                         err2 = fabsf( sRGBmap( resultPtr[1] ) - sRGBmap( expected[1] ) );
@@ -724,7 +683,7 @@ int test_read_image_1D_array( cl_device_id device, cl_context context, cl_comman
                                     log_error( "Step by step:\n" );
                                     FloatPixel temp = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                       xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                      imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, lod );
+                                                                                      imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, lod, &accessor );
                                     log_error( "\tulps: %2.2f, %2.2f, %2.2f, %2.2f  (max allowed: %2.2f)\n\n",
                                               Ulp_Error( resultPtr[0], expected[0] ),
                                               Ulp_Error( resultPtr[1], expected[1] ),
@@ -755,79 +714,27 @@ int test_read_image_1D_array( cl_device_id device, cl_context context, cl_comman
             float *resultPtr = (float *)(char *)resultValues;
             float expected[4], error=0.0f;
             float maxErr = get_max_relative_error( imageInfo->format, imageSampler, 0 /*not 3D*/, CL_FILTER_LINEAR == imageSampler->filter_mode );
+            // Step 1: go through and see if the results verify for the pixel
+            // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
+            // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
+            // This is done for all pixels up front, in tiles on the thread pool.
+            float offset = get_float_norm_offset( imageSampler );
+            auto findPixel = [&]( size_t j ) -> int
+            {
+                return find_float_pixel_2D( imagePtr, imageInfo, imageSampler, lod, &accessor,
+                                            xOffsetValues[ j ], yOffsetValues[ j ], offset, (float *)(char *)resultValues + 4 * j,
+                                            4, maxErr, formatAbsoluteError );
+            };
+            std::vector<char> foundPixels;
+            if( find_pixels_in_parallel( foundPixels, width_lod * imageInfo->arraySize, findPixel ) )
+                return 1;
+
             for( size_t y = 0, j = 0; y < imageInfo->arraySize; y++ )
             {
                 for( size_t x = 0; x < width_lod; x++, j++ )
                 {
-                    // Step 1: go through and see if the results verify for the pixel
-                    // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
-                    // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
                     int checkOnlyOnePixel = 0;
-                    int found_pixel = 0;
-                    float offset = NORM_OFFSET;
-                    if (!imageSampler->normalized_coords ||  imageSampler->filter_mode != CL_FILTER_NEAREST || NORM_OFFSET == 0
-#if defined( __APPLE__ )
-                        // Apple requires its CPU implementation to do correctly rounded address arithmetic in all modes
-                        || gDeviceType != CL_DEVICE_TYPE_GPU
-#endif
-                        )
-                        offset = 0.0f;          // Loop only once
-
-                    for (float norm_offset_x = -offset; norm_offset_x <= offset && !found_pixel; norm_offset_x += NORM_OFFSET) {
-                        for (float norm_offset_y = -offset; norm_offset_y <= offset && !found_pixel; norm_offset_y += NORM_OFFSET) {
-
-
-                            // Try sampling the pixel, without flushing denormals.
-                            int containsDenormals = 0;
-                            FloatPixel maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
-                                xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                imageSampler, expected, 0, &containsDenormals, lod );
-
-                            float err1 = fabsf( resultPtr[0] - expected[0] );
-                            float err2 = fabsf( resultPtr[1] - expected[1] );
-                            float err3 = fabsf( resultPtr[2] - expected[2] );
-                            float err4 = fabsf( resultPtr[3] - expected[3] );
-                            // Clamp to the minimum absolute error for the format
-                            if (err1 > 0 && err1 < formatAbsoluteError) { err1 = 0.0f; }
-                            if (err2 > 0 && err2 < formatAbsoluteError) { err2 = 0.0f; }
-                            if (err3 > 0 && err3 < formatAbsoluteError) { err3 = 0.0f; }
-                            if (err4 > 0 && err4 < formatAbsoluteError) { err4 = 0.0f; }
-                            float maxErr1 = MAX( maxErr * maxPixel.p[0], FLT_MIN );
-                            float maxErr2 = MAX( maxErr * maxPixel.p[1], FLT_MIN );
-                            float maxErr3 = MAX( maxErr * maxPixel.p[2], FLT_MIN );
-                            float maxErr4 = MAX( maxErr * maxPixel.p[3], FLT_MIN );
-
-                            // Check if the result matches.
-                            if( ! (err1 <= maxErr1) || ! (err2 <= maxErr2)    ||
-                               ! (err3 <= maxErr3) || ! (err4 <= maxErr4)    )
-                            {
-                                //try flushing the denormals, if there is a failure.
-                                if( containsDenormals )
-                                {
-                                    // If implementation decide to flush subnormals to zero,
-                                    // max error needs to be adjusted
-                                    maxErr1 += 4 * FLT_MIN;
-                                    maxErr2 += 4 * FLT_MIN;
-                                    maxErr3 += 4 * FLT_MIN;
-                                    maxErr4 += 4 * FLT_MIN;
-
-                                    maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
-                                                                               xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                               imageSampler, expected, 0, NULL, lod );
-
-                                    err1 = fabsf( resultPtr[0] - expected[0] );
-                                    err2 = fabsf( resultPtr[1] - expected[1] );
-                                    err3 = fabsf( resultPtr[2] - expected[2] );
-                                    err4 = fabsf( resultPtr[3] - expected[3] );
-                                }
-                            }
-
-                            // If the final result DOES match, then we've found a valid result and we're done with this pixel.
-                            found_pixel = (err1 <= maxErr1) && (err2 <= maxErr2)  && (err3 <= maxErr3) && (err4 <= maxErr4);
-                        }//norm_offset_x
-                    }//norm_offset_y
-
-
+                    int found_pixel = foundPixels[ j ];
                     // Step 2: If we did not find a match, then print out debugging info.
                     if (!found_pixel) {
                         // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
@@ -848,7 +755,7 @@ int test_read_image_1D_array( cl_device_id device, cl_context context, cl_comman
                                 int containsDenormals = 0;
                                 FloatPixel maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                       xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                      imageSampler, expected, 0, &containsDenormals, lod );
+                                                                                      imageSampler, expected, 0, &containsDenormals, lod, &accessor );
 
                                 float err1 = fabsf( resultPtr[0] - expected[0] );
                                 float err2 = fabsf( resultPtr[1] - expected[1] );
@@ -873,7 +780,7 @@ int test_read_image_1D_array( cl_device_id device, cl_context context, cl_comman
 
                                         maxPixel = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                    xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                   imageSampler, expected, 0, NULL, lod );
+                                                                                   imageSampler, expected, 0, NULL, lod, &accessor );
 
                                         err1 = fabsf( resultPtr[0] - expected[0] );
                                         err2 = fabsf( resultPtr[1] - expected[1] );
@@ -893,7 +800,7 @@ int test_read_image_1D_array( cl_device_id device, cl_context context, cl_comman
                                     log_error( "Step by step:\n" );
                                     FloatPixel temp = sample_image_pixel_float_offset( imagePtr, imageInfo,
                                                                                       xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                                      imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, lod );
+                                                                                      imageSampler, tempOut, 1 /* verbose */, &containsDenormals /*dont flush while error reporting*/, lod, &accessor );
                                     log_error( "\tulps: %2.2f, %2.2f, %2.2f, %2.2f  (max allowed: %2.2f)\n\n",
                                               Ulp_Error( resultPtr[0], expected[0] ),
                                               Ulp_Error( resultPtr[1], expected[1] ),
@@ -924,38 +831,25 @@ int test_read_image_1D_array( cl_device_id device, cl_context context, cl_comman
             unsigned int *resultPtr = (unsigned int *)(char *)resultValues;
             unsigned int expected[4];
             float error;
+            // Step 1: go through and see if the results verify for the pixel
+            // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
+            // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
+            // This is done for all pixels up front, in tiles on the thread pool.
+            auto findPixel = [&]( size_t j ) -> int
+            {
+                return find_int_pixel_2D<unsigned int>( imagePtr, imageInfo, imageSampler, lod,
+                                                         xOffsetValues[ j ], yOffsetValues[ j ], (unsigned int *)(char *)resultValues + 4 * j, MAX_ERR );
+            };
+            std::vector<char> foundPixels;
+            if( find_pixels_in_parallel( foundPixels, width_lod * imageInfo->arraySize, findPixel ) )
+                return 1;
+
             for( size_t y = 0, j = 0; y < imageInfo->arraySize; y++ )
             {
                 for( size_t x = 0; x < width_lod; x++, j++ )
                 {
-                    // Step 1: go through and see if the results verify for the pixel
-                    // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
-                    // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
                     int checkOnlyOnePixel = 0;
-                    int found_pixel = 0;
-                    for (float norm_offset_x = -NORM_OFFSET; norm_offset_x <= NORM_OFFSET && !found_pixel && !checkOnlyOnePixel; norm_offset_x += NORM_OFFSET) {
-                        for (float norm_offset_y = -NORM_OFFSET; norm_offset_y <= NORM_OFFSET && !found_pixel && !checkOnlyOnePixel; norm_offset_y += NORM_OFFSET) {
-
-                            // If we are not on a GPU, or we are not normalized, then only test with offsets (0.0, 0.0)
-                            // E.g., test one pixel.
-                            if (!imageSampler->normalized_coords || gDeviceType != CL_DEVICE_TYPE_GPU || NORM_OFFSET == 0) {
-                                norm_offset_x = 0.0f;
-                                norm_offset_y = 0.0f;
-                                checkOnlyOnePixel = 1;
-                            }
-
-                            sample_image_pixel_offset<unsigned int>( imagePtr, imageInfo,
-                                                                    xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                                    imageSampler, expected, lod );
-
-
-                            error = errMax( errMax( abs_diff_uint(expected[ 0 ], resultPtr[ 0 ]), abs_diff_uint(expected[ 1 ], resultPtr[ 1 ]) ),
-                                           errMax( abs_diff_uint(expected[ 2 ], resultPtr[ 2 ]), abs_diff_uint(expected[ 3 ], resultPtr[ 3 ]) ) );
-
-                            if (error <= MAX_ERR)
-                                found_pixel = 1;
-                        }//norm_offset_x
-                    }//norm_offset_y
+                    int found_pixel = foundPixels[ j ];
 
                     // Step 2: If we did not find a match, then print out debugging info.
                     if (!found_pixel) {
@@ -1010,38 +904,25 @@ int test_read_image_1D_array( cl_device_id device, cl_context context, cl_comman
             int *resultPtr = (int *)(char *)resultValues;
             int expected[4];
             float error;
+            // Step 1: go through and see if the results verify for the pixel
+            // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
+            // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
+            // This is done for all pixels up front, in tiles on the thread pool.
+            auto findPixel = [&]( size_t j ) -> int
+            {
+                return find_int_pixel_2D<int>( imagePtr, imageInfo, imageSampler, lod,
+                                                xOffsetValues[ j ], yOffsetValues[ j ], (int *)(char *)resultValues + 4 * j, MAX_ERR );
+            };
+            std::vector<char> foundPixels;
+            if( find_pixels_in_parallel( foundPixels, width_lod * imageInfo->arraySize, findPixel ) )
+                return 1;
+
             for( size_t y = 0, j = 0; y < imageInfo->arraySize; y++ )
             {
                 for( size_t x = 0; x < width_lod; x++, j++ )
                 {
-                    // Step 1: go through and see if the results verify for the pixel
-                    // For the normalized case on a GPU we put in offsets to the X and Y to see if we land on the
-                    // right pixel. This addresses the significant inaccuracy in GPU normalization in OpenCL 1.0.
                     int checkOnlyOnePixel = 0;
-                    int found_pixel = 0;
-                    for (float norm_offset_x = -NORM_OFFSET; norm_offset_x <= NORM_OFFSET && !found_pixel && !checkOnlyOnePixel; norm_offset_x += NORM_OFFSET) {
-                        for (float norm_offset_y = -NORM_OFFSET; norm_offset_y <= NORM_OFFSET && !found_pixel && !checkOnlyOnePixel; norm_offset_y += NORM_OFFSET) {
-
-                            // If we are not on a GPU, or we are not normalized, then only test with offsets (0.0, 0.0)
-                            // E.g., test one pixel.
-                            if (!imageSampler->normalized_coords || gDeviceType != CL_DEVICE_TYPE_GPU || NORM_OFFSET == 0) {
-                                norm_offset_x = 0.0f;
-                                norm_offset_y = 0.0f;
-                                checkOnlyOnePixel = 1;
-                            }
-
-                            sample_image_pixel_offset<int>( imagePtr, imageInfo,
-                                                           xOffsetValues[ j ], yOffsetValues[ j ], 0.f, norm_offset_x, norm_offset_y, 0.0f,
-                                                           imageSampler, expected, lod );
-
-
-                            error = errMax( errMax( abs_diff_int(expected[ 0 ], resultPtr[ 0 ]), abs_diff_int(expected[ 1 ], resultPtr[ 1 ]) ),
-                                           errMax( abs_diff_int(expected[ 2 ], resultPtr[ 2 ]), abs_diff_int(expected[ 3 ], resultPtr[ 3 ]) ) );
-
-                            if (error <= MAX_ERR)
-                                found_pixel = 1;
-                        }//norm_offset_x
-                    }//norm_offset_y
+                    int found_pixel = foundPixels[ j ];
 
                     // Step 2: If we did not find a match, then print out debugging info.
                     if (!found_pixel) {
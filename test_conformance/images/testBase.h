@@ -21,6 +21,12 @@
 #include "../../test_common/harness/kernelHelpers.h"
 #include "../../test_common/harness/clImageHelper.h"
 #include "../../test_common/harness/imageHelpers.h"
+#include "../../test_common/harness/ThreadPool.h"
+#include "../../test_common/harness/fpcontrol.h"
+
+#include <vector>
+#include <float.h>
+#include <math.h>
 
 // Amount to offset pixels for checking normalized reads
 #define NORM_OFFSET 0.1f
@@ -72,6 +78,187 @@ extern int test_write_image_formats( cl_device_id device,
   image_sampler_data *imageSampler, ExplicitType outputType,
   cl_mem_object_type imageType );
 
+// Number of consecutive pixels checked by one thread pool job in find_pixels_in_parallel
+#define PIXEL_TILE_SIZE 4096
+
+template <class F> struct PixelTileInfo
+{
+    F       *findPixel;
+    char    *found;
+    size_t  count;
+};
+
+template <class F> cl_int find_pixels_in_tile( cl_uint job_id, cl_uint thread_id, void *userInfo )
+{
+    PixelTileInfo<F> *info = (PixelTileInfo<F> *)userInfo;
+    size_t start = (size_t)job_id * PIXEL_TILE_SIZE;
+    size_t end = start + PIXEL_TILE_SIZE < info->count ? start + PIXEL_TILE_SIZE : info->count;
+
+    // The reference must not flush denormals on the pool threads either, see main()
+    FPU_mode_type oldMode;
+    DisableFTZ( &oldMode );
+
+    for( size_t j = start; j < end; j++ )
+        info->found[ j ] = (char)( (*info->findPixel)( j ) != 0 );
+
+    RestoreFPState( &oldMode );
+    return CL_SUCCESS;
+}
+
+// Sets found[ j ] = findPixel( j ) != 0 for every pixel j in [0, count). The pixels are
+// split into tiles of consecutive indices, which run on the harness thread pool. findPixel
+// must not log or write shared state. Callers report the failures afterwards by walking
+// found[] in pixel order, so the output is the same as that of a single threaded loop.
+// Returns the ThreadPool_Do error, in which case found[] is not valid.
+template <class F> cl_int find_pixels_in_parallel( std::vector<char> &found, size_t count, F &findPixel )
+{
+    found.assign( count, 0 );
+    if( count == 0 )
+        return CL_SUCCESS;
+
+    PixelTileInfo<F> info = { &findPixel, &found[ 0 ], count };
+    cl_int error = ThreadPool_Do( find_pixels_in_tile<F>, (cl_uint)( ( count + PIXEL_TILE_SIZE - 1 ) / PIXEL_TILE_SIZE ), &info );
+    if( error != CL_SUCCESS )
+        log_error( "ERROR: Unable to check the results on the thread pool (%d)\n", error );
+    return error;
+}
+
+// Largest offset, in steps of NORM_OFFSET, that the float result checks move the sampled coordinates by.
+// Only normalized nearest reads are retried around the pixel, to allow for GPU normalization error.
+inline float get_float_norm_offset( const image_sampler_data *imageSampler )
+{
+    if (!imageSampler->normalized_coords ||  imageSampler->filter_mode != CL_FILTER_NEAREST || NORM_OFFSET == 0
+#if defined( __APPLE__ )
+        // Apple requires its CPU implementation to do correctly rounded address arithmetic in all modes
+        || gDeviceType != CL_DEVICE_TYPE_GPU
+#endif
+        )
+        return 0.0f;          // Loop only once
+    return NORM_OFFSET;
+}
+
+/*
+ * findPixel helpers for the images addressed by x and y only (2D and 1D array). Each returns nonzero
+ * if the result of one read matches the reference sampled at ( x, y ) moved by up to offset in x and y.
+ */
+
+// Compares the first channelCount channels within maxErr relative error, ignoring errors below the format
+// absolute error. Retries with denormals flushed if the reference contains any.
+inline int find_float_pixel_2D( void *imageData, image_descriptor *imageInfo, image_sampler_data *imageSampler, int lod,
+                                const ImagePixelAccessor *accessor, float x, float y, float offset, const float *result,
+                                int channelCount, float maxErr, double formatAbsoluteError )
+{
+    for (float norm_offset_x = -offset; norm_offset_x <= offset; norm_offset_x += NORM_OFFSET) {
+        for (float norm_offset_y = -offset; norm_offset_y <= offset; norm_offset_y += NORM_OFFSET) {
+
+            // Try sampling the pixel, without flushing denormals.
+            int containsDenormals = 0;
+            float expected[4], err[4], maxErrs[4];
+            FloatPixel maxPixel = sample_image_pixel_float_offset( imageData, imageInfo,
+                                                                   x, y, 0.0f, norm_offset_x, norm_offset_y, 0.0f,
+                                                                   imageSampler, expected, 0, &containsDenormals, lod, accessor );
+            int matches = 1;
+            for( int c = 0; c < channelCount; c++ )
+            {
+                err[c] = fabsf( result[c] - expected[c] );
+                // Clamp to the minimum absolute error for the format
+                if (err[c] > 0 && err[c] < formatAbsoluteError) { err[c] = 0.0f; }
+                maxErrs[c] = MAX( maxErr * maxPixel.p[c], FLT_MIN );
+                matches &= err[c] <= maxErrs[c];
+            }
+
+            //try flushing the denormals, if there is a failure.
+            if( !matches && containsDenormals )
+            {
+                sample_image_pixel_float_offset( imageData, imageInfo,
+                                                 x, y, 0.0f, norm_offset_x, norm_offset_y, 0.0f,
+                                                 imageSampler, expected, 0, NULL, lod, accessor );
+                matches = 1;
+                for( int c = 0; c < channelCount; c++ )
+                {
+                    // If implementation decide to flush subnormals to zero,
+                    // max error needs to be adjusted
+                    err[c] = fabsf( result[c] - expected[c] );
+                    matches &= err[c] <= maxErrs[c] + 4 * FLT_MIN;
+                }
+            }
+
+            if( matches )
+                return 1;
+        }//norm_offset_y
+    }//norm_offset_x
+    return 0;
+}
+
+// Compares the color channels of an sRGB read after sRGBmap within 0.5, and alpha within 0.5.
+inline int find_sRGB_pixel_2D( void *imageData, image_descriptor *imageInfo, image_sampler_data *imageSampler, int lod,
+                               const ImagePixelAccessor *accessor, float x, float y, float offset, const float *result )
+{
+    for (float norm_offset_x = -offset; norm_offset_x <= offset; norm_offset_x += NORM_OFFSET) {
+        for (float norm_offset_y = -offset; norm_offset_y <= offset; norm_offset_y += NORM_OFFSET) {
+
+            // Try sampling the pixel, without flushing denormals.
+            int containsDenormals = 0;
+            float expected[4], err[4];
+            float maxErr = 0.5;
+            sample_image_pixel_float_offset( imageData, imageInfo,
+                                             x, y, 0.0f, norm_offset_x, norm_offset_y, 0.0f,
+                                             imageSampler, expected, 0, &containsDenormals, lod, accessor );
+            for( int pass = 0; pass < 2; pass++ )
+            {
+                for( int c = 0; c < 3; c++ )
+                    err[c] = fabsf( sRGBmap( result[c] ) - sRGBmap( expected[c] ) );
+                err[3] = fabsf( result[3] - expected[3] );
+
+                if( (err[0] <= maxErr) && (err[1] <= maxErr) && (err[2] <= maxErr) && (err[3] <= maxErr) )
+                    return 1;
+
+                //try flushing the denormals, if there is a failure.
+                if( !containsDenormals )
+                    break;
+                // If implementation decide to flush subnormals to zero,
+                // max error needs to be adjusted
+                maxErr += 4 * FLT_MIN;
+                containsDenormals = 0;
+                sample_image_pixel_float_offset( imageData, imageInfo,
+                                                 x, y, 0.0f, norm_offset_x, norm_offset_y, 0.0f,
+                                                 imageSampler, expected, 0, NULL, lod, accessor );
+            }
+        }//norm_offset_y
+    }//norm_offset_x
+    return 0;
+}
+
+inline cl_uint abs_diff( cl_uint x, cl_uint y ) { return abs_diff_uint( x, y ); }
+inline cl_uint abs_diff( cl_int x, cl_int y ) { return abs_diff_int( x, y ); }
+
+// Compares the four channels of an integer read within maxErr. Reads are only retried around the
+// pixel for normalized coordinates on a GPU.
+template <class T> int find_int_pixel_2D( void *imageData, image_descriptor *imageInfo, image_sampler_data *imageSampler, int lod,
+                                          float x, float y, const T *result, float maxErr )
+{
+    float offset = NORM_OFFSET;
+    // If we are not on a GPU, or we are not normalized, then only test with offsets (0.0, 0.0)
+    // E.g., test one pixel.
+    if (!imageSampler->normalized_coords || gDeviceType != CL_DEVICE_TYPE_GPU || NORM_OFFSET == 0)
+        offset = 0.0f;
+
+    for (float norm_offset_x = -offset; norm_offset_x <= offset; norm_offset_x += NORM_OFFSET) {
+        for (float norm_offset_y = -offset; norm_offset_y <= offset; norm_offset_y += NORM_OFFSET) {
+            T expected[4];
+            sample_image_pixel_offset<T>( imageData, imageInfo,
+                                          x, y, 0.f, norm_offset_x, norm_offset_y, 0.0f,
+                                          imageSampler, expected, lod );
+
+            float error = errMax( errMax( abs_diff(expected[ 0 ], result[ 0 ]), abs_diff(expected[ 1 ], result[ 1 ]) ),
+                                  errMax( abs_diff(expected[ 2 ], result[ 2 ]), abs_diff(expected[ 3 ], result[ 3 ]) ) );
+            if (error <= maxErr)
+                return 1;
+        }//norm_offset_y
+    }//norm_offset_x
+    return 0;
+}
+
 #endif // _testBase_h
 
 
@@ -0,0 +1,413 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "ReferenceStore.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined( _WIN32 )
+    #include <windows.h>
+    #include <process.h>
+    #define getpid  _getpid
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+#define kReferenceStoreVersion      2
+#define kReferenceStoreAlignment    65536       // the results start at a multiple of this
+
+// File layout: the header, the key, the metadata, the chunk checksums and, at dataOffset, the results
+typedef struct ReferenceStoreHeader
+{
+    char        magic[8];               // "CLREFSTR"
+    cl_uint     version;
+    cl_uint     byteOrder;              // 0x01020304 as written by the host
+    cl_ulong    count;                  // number of results
+    cl_ulong    elementSize;            // size of each result in bytes
+    cl_ulong    keySize;
+    cl_ulong    metadataSize;
+    cl_ulong    dataOffset;
+    cl_ulong    headerChecksum;         // of the key, the metadata and the chunk checksums
+}ReferenceStoreHeader;
+
+struct ReferenceStore
+{
+    char            *name;
+    char            *fileName;
+    char            *tempName;          // non-NULL while the store is being built
+    unsigned char   *map;
+    size_t          mapSize;
+    cl_ulong        *checksums;
+    unsigned char   *data;
+    size_t          count;
+    size_t          elementSize;
+    size_t          chunkCount;
+    volatile cl_int chunksCommitted;
+    volatile cl_int badChunks;
+#if defined( _WIN32 )
+    HANDLE          file;
+    HANDLE          mapping;
+#else
+    int             fd;
+#endif
+};
+
+cl_ulong ReferenceStore_Hash( const void *data, size_t size, cl_ulong hash )
+{
+    const unsigned char *p = (const unsigned char *) data;
+    size_t i;
+
+    for( i = 0; i < size; i++ )
+    {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Fletcher style checksum of size bytes, size a multiple of 4. The seed makes a block moved to another
+// place in the file fail its check.
+static cl_ulong Checksum( const void *data, size_t size, cl_ulong seed )
+{
+    const cl_uint *p = (const cl_uint *) data;
+    cl_ulong a = seed + 1;
+    cl_ulong b = 0;
+    size_t i;
+
+    for( i = 0; i < size / sizeof( cl_uint ); i++ )
+    {
+        a += p[i];
+        b += a;
+    }
+    return a ^ (b << 32) ^ (b >> 32);
+}
+
+static cl_ulong HeaderChecksum( const ReferenceStore *store )
+{
+    const ReferenceStoreHeader *header = (const ReferenceStoreHeader *) store->map;
+    cl_ulong hash = ReferenceStore_Hash( store->map + sizeof( *header ), (size_t)( header->keySize + header->metadataSize ),
+                                         kReferenceStoreHashSeed );
+    return hash ^ Checksum( store->checksums, store->chunkCount * sizeof( cl_ulong ), 0 );
+}
+
+static size_t AlignUp( size_t x, size_t alignment )
+{
+    return (x + alignment - 1) / alignment * alignment;
+}
+
+#pragma mark -
+
+// Map fileName. If writable, the file is created with the given size, otherwise size is set to its size.
+static int MapFile( ReferenceStore *store, const char *fileName, int writable, size_t *size )
+{
+#if defined( _WIN32 )
+    LARGE_INTEGER fileSize;
+
+    store->file = CreateFileA( fileName, writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, NULL,
+                               writable ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( INVALID_HANDLE_VALUE == store->file )
+    {
+        store->file = NULL;
+        return -1;
+    }
+    if( writable )
+        fileSize.QuadPart = (LONGLONG) *size;
+    else if( ! GetFileSizeEx( store->file, &fileSize ) || 0 == fileSize.QuadPart || (cl_ulong)(size_t) fileSize.QuadPart != (cl_ulong) fileSize.QuadPart )
+        return -1;
+
+    // For a writable store this also extends the file to its final size
+    store->mapping = CreateFileMappingA( store->file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                         (DWORD)(fileSize.QuadPart >> 32), (DWORD) fileSize.QuadPart, NULL );
+    if( NULL == store->mapping )
+        return -1;
+    store->map = (unsigned char *) MapViewOfFile( store->mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, (SIZE_T) fileSize.QuadPart );
+    if( NULL == store->map )
+        return -1;
+    *size = (size_t) fileSize.QuadPart;
+#else
+    struct stat st;
+    void *map;
+
+    store->fd = writable ? open( fileName, O_RDWR | O_CREAT | O_TRUNC, 0644 ) : open( fileName, O_RDONLY );
+    if( -1 == store->fd )
+        return -1;
+    if( writable )
+    {
+#if defined( __linux__ )
+        // Reserve the space now. Running out of it later would fault while writing to the map.
+        if( posix_fallocate( store->fd, 0, (off_t) *size ) )
+            return -1;
+#else
+        if( ftruncate( store->fd, (off_t) *size ) )
+            return -1;
+#endif
+    }
+    else
+    {
+        if( fstat( store->fd, &st ) || 0 == st.st_size || (cl_ulong)(size_t) st.st_size != (cl_ulong) st.st_size )
+            return -1;
+        *size = (size_t) st.st_size;
+    }
+
+    map = mmap( NULL, *size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, store->fd, 0 );
+    if( MAP_FAILED == map )
+        return -1;
+    store->map = (unsigned char *) map;
+#endif
+    store->mapSize = *size;
+    return 0;
+}
+
+// If flush, write the results to disk before returning
+static void UnmapFile( ReferenceStore *store, int flush )
+{
+#if defined( _WIN32 )
+    if( store->map )
+    {
+        if( flush )
+            FlushViewOfFile( store->map, 0 );
+        UnmapViewOfFile( store->map );
+    }
+    if( store->mapping )
+        CloseHandle( store->mapping );
+    if( store->file )
+        CloseHandle( store->file );
+    store->mapping = NULL;
+    store->file = NULL;
+#else
+    if( store->map )
+    {
+        if( flush )
+            msync( store->map, store->mapSize, MS_SYNC );
+        munmap( store->map, store->mapSize );
+    }
+    if( -1 != store->fd )
+        close( store->fd );
+    store->fd = -1;
+#endif
+    store->map = NULL;
+    store->mapSize = 0;
+}
+
+static int ReplaceFile( const char *from, const char *to )
+{
+#if defined( _WIN32 )
+    return MoveFileExA( from, to, MOVEFILE_REPLACE_EXISTING ) ? 0 : -1;
+#else
+    return rename( from, to );
+#endif
+}
+
+static void FreeStore( ReferenceStore *store )
+{
+    UnmapFile( store, 0 );
+    if( store->tempName )
+        remove( store->tempName );
+    free( store->name );
+    free( store->fileName );
+    free( store->tempName );
+    free( store );
+}
+
+// Returns non-zero if the store at fileName was built for key. The metadata is not compared.
+static int OpenExisting( ReferenceStore *store, const char *key )
+{
+    size_t keySize = strlen( key );
+    size_t size = 0;
+    size_t checksumOffset;
+    const ReferenceStoreHeader *header;
+
+    if( MapFile( store, store->fileName, 0, &size ) )
+        return 0;
+
+    header = (const ReferenceStoreHeader *) store->map;
+    if( size < sizeof( *header ) + keySize                      ||
+        memcmp( header->magic, "CLREFSTR", sizeof( header->magic ) ) ||
+        header->version != kReferenceStoreVersion               ||
+        header->byteOrder != 0x01020304                         ||
+        header->count != store->count                           ||
+        header->elementSize != store->elementSize               ||
+        header->keySize != keySize                              ||
+        memcmp( store->map + sizeof( *header ), key, keySize )  ||
+        header->metadataSize > size - sizeof( *header ) - keySize ||
+        header->dataOffset > size                               ||
+        size - header->dataOffset != store->count * store->elementSize )
+    {
+        vlog( "Reference store: %s does not match this run, rebuilding it\n", store->fileName );
+        return 0;
+    }
+
+    checksumOffset = AlignUp( sizeof( *header ) + keySize + (size_t) header->metadataSize, sizeof( cl_ulong ) );
+    store->checksums = (cl_ulong *)(store->map + checksumOffset);
+    store->data = store->map + header->dataOffset;
+    if( checksumOffset + store->chunkCount * sizeof( cl_ulong ) > header->dataOffset || HeaderChecksum( store ) != header->headerChecksum )
+    {
+        vlog( "Reference store: %s is corrupt, rebuilding it\n", store->fileName );
+        return 0;
+    }
+
+    return 1;
+}
+
+ReferenceStore *ReferenceStore_Open( const char *name, const char *key, const char *metadata, size_t count, size_t elementSize )
+{
+    ReferenceStore *store;
+    ReferenceStoreHeader *header;
+    size_t keySize = strlen( key );
+    size_t metadataSize = metadata ? strlen( metadata ) : 0;
+    size_t checksumOffset = AlignUp( sizeof( *header ) + keySize + metadataSize, sizeof( cl_ulong ) );
+    size_t dataOffset;
+    size_t pathLength;
+    size_t size;
+
+    if( NULL == gReferenceStorePath || 0 == count || count % kReferenceStoreChunk )
+        return NULL;
+
+    store = (ReferenceStore *) calloc( 1, sizeof( *store ) );
+    if( NULL == store )
+        return NULL;
+#if ! defined( _WIN32 )
+    store->fd = -1;
+#endif
+    store->count = count;
+    store->elementSize = elementSize;
+    store->chunkCount = count / kReferenceStoreChunk;
+    dataOffset = AlignUp( checksumOffset + store->chunkCount * sizeof( cl_ulong ), kReferenceStoreAlignment );
+
+    // <path>/<name>_<hash of key>.ref
+    pathLength = strlen( gReferenceStorePath ) + strlen( name ) + 64;
+    store->name = (char *) malloc( strlen( name ) + 1 );
+    store->fileName = (char *) malloc( pathLength );
+    if( NULL == store->name || NULL == store->fileName )
+        goto fail;
+    strcpy( store->name, name );
+    sprintf( store->fileName, "%s/%s_%016llx.ref", gReferenceStorePath, name,
+             (unsigned long long) ReferenceStore_Hash( key, keySize, kReferenceStoreHashSeed ) );
+
+    // The results must fit in our address space
+    if( (SIZE_MAX - dataOffset) / elementSize < count )
+    {
+        vlog( "Reference store: %s results are too large to map on this host\n", name );
+        goto fail;
+    }
+
+    // Use the store of a previous run if there is one
+    if( OpenExisting( store, key ) )
+        return store;
+    UnmapFile( store, 0 );
+
+    // Otherwise build a new one in a file of our own and rename it into place once it is complete,
+    // so that concurrent runs never see a partial store
+    store->tempName = (char *) malloc( strlen( store->fileName ) + 32 );
+    if( NULL == store->tempName )
+        goto fail;
+    sprintf( store->tempName, "%s.%d.tmp", store->fileName, (int) getpid() );
+
+    size = dataOffset + count * elementSize;
+    if( MapFile( store, store->tempName, 1, &size ) )
+    {
+        vlog( "Reference store: can't create %s\n", store->tempName );
+        goto fail;
+    }
+
+    header = (ReferenceStoreHeader *) store->map;
+    memcpy( header->magic, "CLREFSTR", sizeof( header->magic ) );
+    header->version = kReferenceStoreVersion;
+    header->byteOrder = 0x01020304;
+    header->count = count;
+    header->elementSize = elementSize;
+    header->keySize = keySize;
+    header->metadataSize = metadataSize;
+    header->dataOffset = dataOffset;
+    header->headerChecksum = 0;
+    memcpy( store->map + sizeof( *header ), key, keySize );
+    if( metadataSize )
+        memcpy( store->map + sizeof( *header ) + keySize, metadata, metadataSize );
+    store->checksums = (cl_ulong *)(store->map + checksumOffset);
+    store->data = store->map + dataOffset;
+
+    return store;
+
+fail:
+    FreeStore( store );
+    return NULL;
+}
+
+const void *ReferenceStore_Lookup( ReferenceStore *store, size_t first, size_t count )
+{
+    size_t chunkBytes = kReferenceStoreChunk * store->elementSize;
+    size_t i;
+
+    if( store->tempName || first % kReferenceStoreChunk || count % kReferenceStoreChunk || first + count > store->count )
+        return NULL;
+
+    for( i = first / kReferenceStoreChunk; i < (first + count) / kReferenceStoreChunk; i++ )
+    {
+        if( Checksum( store->data + i * chunkBytes, chunkBytes, i ) != store->checksums[i] )
+        {
+            // Report the first one only, the caller recomputes the results
+            if( 0 == ThreadPool_AtomicAdd( &store->badChunks, 1 ) )
+                vlog( "\nReference store: checksum mismatch in %s, recomputing the damaged results\n", store->fileName );
+            return NULL;
+        }
+    }
+
+    return store->data + first * store->elementSize;
+}
+
+void *ReferenceStore_Reserve( ReferenceStore *store, size_t first, size_t count )
+{
+    if( NULL == store->tempName || first % kReferenceStoreChunk || count % kReferenceStoreChunk || first + count > store->count )
+        return NULL;
+
+    return store->data + first * store->elementSize;
+}
+
+void ReferenceStore_Commit( ReferenceStore *store, size_t first, size_t count )
+{
+    size_t chunkBytes = kReferenceStoreChunk * store->elementSize;
+    size_t i;
+
+    for( i = first / kReferenceStoreChunk; i < (first + count) / kReferenceStoreChunk; i++ )
+        store->checksums[i] = Checksum( store->data + i * chunkBytes, chunkBytes, i );
+
+    ThreadPool_AtomicAdd( &store->chunksCommitted, (cl_int)(count / kReferenceStoreChunk) );
+}
+
+void ReferenceStore_Close( ReferenceStore *store )
+{
+    if( NULL == store )
+        return;
+
+    // Keep a store that is being built only if every result made it in
+    if( store->tempName && (size_t) store->chunksCommitted == store->chunkCount )
+    {
+        ((ReferenceStoreHeader *) store->map)->headerChecksum = HeaderChecksum( store );
+        UnmapFile( store, 1 );
+        if( 0 == ReplaceFile( store->tempName, store->fileName ) )
+        {
+            free( store->tempName );
+            store->tempName = NULL;
+            vlog( "\nReference store: saved %s\n", store->fileName );
+        }
+    }
+
+    FreeStore( store );
+}
@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef REFERENCE_STORE_H
+#define REFERENCE_STORE_H
+
+#include "Utility.h"
+
+/*
+ *  On-disk store of reference results.
+ *
+ *  The reference results only depend on the function, the reference code, the inputs and the mode, so a
+ *  store keyed on those can be reused by every later run, e.g. against new driver builds. The reference
+ *  code is identified by kReferenceMathVersion in reference_math.h. A store is a file in the directory
+ *  named by CL_MATH_REFERENCE_STORE holding count results of elementSize bytes, a checksum for every
+ *  kReferenceStoreChunk results, the key it was built for and metadata that is recorded but never
+ *  compared, e.g. the ulp bound of the test.
+ *
+ *  If the file exists and its key and header checksum match, the store is opened read only and
+ *  ReferenceStore_Lookup returns pointers straight into the mapped file. Otherwise a new store is built
+ *  in a temporary file: the test computes its results straight into the memory ReferenceStore_Reserve
+ *  returns and then calls ReferenceStore_Commit. ReferenceStore_Close renames the file into place once
+ *  every result has been committed, and removes it if not.
+ */
+
+#define kReferenceStoreChunk        1024        // results per checksum
+
+typedef struct ReferenceStore ReferenceStore;
+
+// Directory of the reference stores, NULL if they are disabled
+extern const char *gReferenceStorePath;
+
+// Returns NULL if the store is disabled or can't be used. name is used in the file name and messages.
+// metadata may be NULL.
+ReferenceStore *ReferenceStore_Open( const char *name, const char *key, const char *metadata, size_t count, size_t elementSize );
+
+// Returns results [first, first + count) if the store is read only and their checksums are valid, otherwise NULL
+const void *ReferenceStore_Lookup( ReferenceStore *store, size_t first, size_t count );
+
+// Returns where to put results [first, first + count) if the store is being built, otherwise NULL.
+// first and count must be multiples of kReferenceStoreChunk.
+void *ReferenceStore_Reserve( ReferenceStore *store, size_t first, size_t count );
+void ReferenceStore_Commit( ReferenceStore *store, size_t first, size_t count );
+
+void ReferenceStore_Close( ReferenceStore *store );
+
+// 64-bit FNV-1a, for building keys
+cl_ulong ReferenceStore_Hash( const void *data, size_t size, cl_ulong hash );
+#define kReferenceStoreHashSeed     0xcbf29ce484222325ULL
+
+#endif /* REFERENCE_STORE_H */
@@ -0,0 +1,244 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "StratifiedSampling.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "../../test_common/harness/mt19937.h"
+
+#if defined( _WIN32 )
+    #include <windows.h>
+    #include <process.h>
+    #define getpid  _getpid
+#else
+    #include <unistd.h>
+#endif
+
+#define kStratifiedMaxWeight    16.0    // weight of a bucket whose error reached the bound, relative to one without errors
+#define kStratifiedDecay        0.5     // older errors count for this much less with every run
+
+struct StratifiedSampler
+{
+    char        *historyName;                           // NULL if there is no history
+    float       ulps;
+    cl_uint     seed;
+    cl_uint     *coverage;
+    size_t      coverageCount;
+    float       history[ kStratifiedBucketCount ];      // largest error in each bucket, in ulps
+    cl_ulong    cdf[ kStratifiedBucketCount ];          // cumulative bucket weights, scaled to 2**32
+};
+
+// Special values, subnormals, binade boundaries and kStratifiedSamplesPerBinade values in every binade, for both signs
+static size_t BuildCoverageFloat( cl_uint *out, MTdata d )
+{
+    static const cl_uint specials[] = { 0, 0x7f800000, 0x7fc00000, 0x7f800001, 0x7fa00000, 0x7fffffff };
+    static const cl_uint edges[] = { 0, 1, 2, 3, 0x400000, 0x7ffffd, 0x7ffffe, 0x7fffff };
+    size_t n = 0;
+    cl_uint sign, exponent, i;
+
+    for( sign = 0; sign < 2; sign++ )
+    {
+        cl_uint s = sign << 31;
+
+        for( i = 0; i < sizeof( specials ) / sizeof( specials[0] ); i++ )
+            out[n++] = s | specials[i];
+
+        // exponent 0 holds the subnormals, whose edge value 0 is already in the specials
+        for( exponent = 0; exponent < 255; exponent++ )
+        {
+            for( i = 0 == exponent; i < sizeof( edges ) / sizeof( edges[0] ); i++ )
+                out[n++] = s | (exponent << 23) | edges[i];
+            for( i = 0; i < kStratifiedSamplesPerBinade; i++ )
+                out[n++] = s | (exponent << 23) | (genrand_int32( d ) & 0x7fffff);
+        }
+    }
+
+    return n;
+}
+
+static void ComputeWeights( StratifiedSampler *sampler )
+{
+    double weight[ kStratifiedBucketCount ];
+    double total = 0.0, sum = 0.0;
+    cl_uint b;
+
+    for( b = 0; b < kStratifiedBucketCount; b++ )
+    {
+        double e = sampler->history[b];
+        e = sampler->ulps > 0.0f ? e / sampler->ulps : (e > 0.0);
+        weight[b] = 1.0 + (kStratifiedMaxWeight - 1.0) * (e < 1.0 ? e : 1.0);
+        total += weight[b];
+    }
+
+    for( b = 0; b < kStratifiedBucketCount; b++ )
+    {
+        sum += weight[b];
+        sampler->cdf[b] = (cl_ulong)( sum / total * 4294967296.0 );
+    }
+    sampler->cdf[ kStratifiedBucketCount - 1 ] = 1ULL << 32;
+}
+
+static void LoadHistory( StratifiedSampler *sampler )
+{
+    char line[256];
+    FILE *f = fopen( sampler->historyName, "r" );
+    if( NULL == f )
+        return;
+
+    while( fgets( line, sizeof( line ), f ) )
+    {
+        unsigned int bucket;
+        float error;
+        if( '#' != line[0] && 2 == sscanf( line, "%x %f", &bucket, &error ) && bucket < kStratifiedBucketCount && error > 0.0f )
+            sampler->history[bucket] = error;
+    }
+    fclose( f );
+}
+
+StratifiedSampler *StratifiedSampler_CreateFloat( const char *name, float ulps, cl_uint seed )
+{
+    StratifiedSampler *sampler = (StratifiedSampler *) calloc( 1, sizeof( *sampler ) );
+    MTdata d;
+
+    if( NULL == sampler )
+        return NULL;
+    sampler->ulps = ulps;
+    sampler->seed = seed;
+
+    sampler->coverage = (cl_uint *) malloc( 2 * (6 + 255 * (8 + kStratifiedSamplesPerBinade)) * sizeof( cl_uint ) );
+    d = init_genrand( seed );
+    if( NULL == sampler->coverage || NULL == d )
+    {
+        free_mtdata( d );
+        StratifiedSampler_Release( sampler );
+        return NULL;
+    }
+    sampler->coverageCount = BuildCoverageFloat( sampler->coverage, d );
+    free_mtdata( d );
+
+    if( gStratifiedHistoryPath )
+    {
+        sampler->historyName = (char *) malloc( strlen( gStratifiedHistoryPath ) + strlen( name ) + 16 );
+        if( sampler->historyName )
+        {
+            sprintf( sampler->historyName, "%s/%s_float.hist", gStratifiedHistoryPath, name );
+            LoadHistory( sampler );
+        }
+    }
+    ComputeWeights( sampler );
+
+    return sampler;
+}
+
+void StratifiedSampler_Release( StratifiedSampler *sampler )
+{
+    if( NULL == sampler )
+        return;
+    free( sampler->historyName );
+    free( sampler->coverage );
+    free( sampler );
+}
+
+cl_uint StratifiedSampler_CoverageJobs( const StratifiedSampler *sampler, size_t count )
+{
+    return (cl_uint)( (sampler->coverageCount + count - 1) / count );
+}
+
+void StratifiedSampler_Fill( const StratifiedSampler *sampler, cl_uint job_id, cl_uint *p, size_t count )
+{
+    size_t first = (size_t) job_id * count;
+    size_t j;
+    MTdata d;
+
+    // The coverage set, padded with its first values in the last job
+    if( first < sampler->coverageCount )
+    {
+        for( j = 0; j < count; j++ )
+            p[j] = sampler->coverage[ (first + j) % sampler->coverageCount ];
+        return;
+    }
+
+    // Random inputs: pick a bucket by weight, then a value in it
+    d = init_genrand( sampler->seed ^ (job_id * 0x9e3779b9U) );
+    if( NULL == d )
+    {
+        // Out of memory, fall back to a fixed scatter over all inputs
+        for( j = 0; j < count; j++ )
+            p[j] = (cl_uint)( first + j ) * 0x9e3779b9U;
+        return;
+    }
+    for( j = 0; j < count; j++ )
+    {
+        cl_ulong r = genrand_int32( d );
+        cl_uint lo = 0, hi = kStratifiedBucketCount - 1;
+
+        // find the first bucket with r < cdf[bucket]
+        while( lo < hi )
+        {
+            cl_uint mid = (lo + hi) / 2;
+            if( r < sampler->cdf[mid] )
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        p[j] = (lo << 20) | (genrand_int32( d ) & 0xfffff);
+    }
+    free_mtdata( d );
+}
+
+void StratifiedSampler_Record( StratifiedSampler *sampler, const float *bucketError )
+{
+    char *tempName;
+    FILE *f;
+    cl_uint b;
+
+    for( b = 0; b < kStratifiedBucketCount; b++ )
+    {
+        float decayed = sampler->history[b] * (float) kStratifiedDecay;
+        sampler->history[b] = bucketError[b] > decayed ? bucketError[b] : decayed;
+    }
+
+    if( NULL == sampler->historyName )
+        return;
+
+    // Write to a file of our own and rename it into place, so that concurrent runs never see a partial history
+    tempName = (char *) malloc( strlen( sampler->historyName ) + 32 );
+    if( NULL == tempName )
+        return;
+    sprintf( tempName, "%s.%d.tmp", sampler->historyName, (int) getpid() );
+    f = fopen( tempName, "w" );
+    if( NULL == f )
+    {
+        vlog( "\nCan't write the error history %s\n", tempName );
+        free( tempName );
+        return;
+    }
+
+    fprintf( f, "# bucket (sign, exponent and top 3 mantissa bits) and the largest error seen there, in ulps\n" );
+    for( b = 0; b < kStratifiedBucketCount; b++ )
+        if( sampler->history[b] >= 0.01f )
+            fprintf( f, "0x%03x %.9g\n", b, sampler->history[b] );
+
+    if( fclose( f ) )
+        remove( tempName );
+#if defined( _WIN32 )
+    else if( ! MoveFileExA( tempName, sampler->historyName, MOVEFILE_REPLACE_EXISTING ) )
+#else
+    else if( rename( tempName, sampler->historyName ) )
+#endif
+        remove( tempName );
+    free( tempName );
+}
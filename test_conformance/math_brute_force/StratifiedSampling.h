@@ -0,0 +1,58 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef STRATIFIED_SAMPLING_H
+#define STRATIFIED_SAMPLING_H
+
+#include "Utility.h"
+
+/*
+ *  Stratified sampling of the float inputs (-S), a time boxed alternative to striding over them in wimpy mode.
+ *
+ *  Each test first runs a fixed coverage set: special values, subnormals, the first and last few values of
+ *  every binade and kStratifiedSamplesPerBinade random values in each binade. It then runs random inputs
+ *  until gStratifiedBudget seconds have passed. The random inputs are drawn from kStratifiedBucketCount
+ *  buckets, given by the sign, the exponent and the top 3 bits of the mantissa, with extra weight on the
+ *  buckets where this or an earlier run saw the largest errors. The largest error seen in each bucket is
+ *  kept in <name>_float.hist in the directory named by CL_STRATIFIED_HISTORY, so that later runs look
+ *  harder there. Older errors decay with every run so that fixed problems stop drawing samples.
+ *
+ *  The inputs of each job only depend on the seed and the job id, so a failure can be reproduced.
+ */
+
+#define kStratifiedBucketCount          4096
+#define kStratifiedSamplesPerBinade     256
+#define StratifiedBucketFloat( _u )     ((_u) >> 20)
+
+extern int          gStratifiedSampling;        // non-zero to sample the inputs of the unary float functions
+extern double       gStratifiedBudget;          // seconds of random inputs per function
+extern const char   *gStratifiedHistoryPath;    // directory of the error history, NULL if none
+
+typedef struct StratifiedSampler StratifiedSampler;
+
+// ulps is the error bound of the function, used to scale the errors in the history
+StratifiedSampler *StratifiedSampler_CreateFloat( const char *name, float ulps, cl_uint seed );
+void StratifiedSampler_Release( StratifiedSampler *sampler );
+
+// Number of jobs of count inputs that are needed for the coverage set. They must all run.
+cl_uint StratifiedSampler_CoverageJobs( const StratifiedSampler *sampler, size_t count );
+
+// Write the count inputs of job job_id to p
+void StratifiedSampler_Fill( const StratifiedSampler *sampler, cl_uint job_id, cl_uint *p, size_t count );
+
+// Merge the largest error seen in each bucket by this run into the history and save it
+void StratifiedSampler_Record( StratifiedSampler *sampler, const float *bucketError );
+
+#endif /* STRATIFIED_SAMPLING_H */
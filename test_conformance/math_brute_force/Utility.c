@@ -15,6 +15,11 @@
 //
 #include "Utility.h"
 
+#if defined( __SSE2__ ) || (defined( _MSC_VER ) && (defined(_M_IX86) || defined(_M_X64)))
+    #include <emmintrin.h>
+    #define USE_SSE2_COMPARE 1
+#endif
+
 #if defined(__PPC__)
 // Global varaiable used to hold the FPU control register state. The FPSCR register can not
 // be used because not all Power implementations retain or observed the NI (non-IEEE
@@ -167,3 +172,70 @@ void logFunctionInfo(const char *fname, unsigned int float_size, unsigned int is
     vlog("%15s %4s %4s",fname, fpSizeStr, fpFastRelaxedStr);
 }
 
+
+size_t FindMismatch32( const cl_uint *ref, cl_uint * const *out, int minIndex, int maxIndex, size_t start, size_t count )
+{
+    size_t i = start;
+    int k;
+
+#if defined( USE_SSE2_COMPARE )
+    // Compare 8 elements per vector size at a time. A block with a difference falls
+    // through to the scalar loop below, which finds the exact index.
+    for( ; i + 8 <= count; i += 8 )
+    {
+        __m128i r0 = _mm_loadu_si128( (const __m128i*) (ref + i) );
+        __m128i r1 = _mm_loadu_si128( (const __m128i*) (ref + i + 4) );
+        __m128i eq = _mm_cmpeq_epi32( r0, r0 );
+
+        for( k = minIndex; k < maxIndex; k++ )
+        {
+            __m128i q0 = _mm_loadu_si128( (const __m128i*) (out[k] + i) );
+            __m128i q1 = _mm_loadu_si128( (const __m128i*) (out[k] + i + 4) );
+            eq = _mm_and_si128( eq, _mm_and_si128( _mm_cmpeq_epi32( r0, q0 ), _mm_cmpeq_epi32( r1, q1 ) ) );
+        }
+
+        if( _mm_movemask_epi8( eq ) != 0xffff )
+            break;
+    }
+#endif
+
+    for( ; i < count; i++ )
+        for( k = minIndex; k < maxIndex; k++ )
+            if( out[k][i] != ref[i] )
+                return i;
+
+    return count;
+}
+
+size_t FindMismatch64( const cl_ulong *ref, cl_ulong * const *out, int minIndex, int maxIndex, size_t start, size_t count )
+{
+    size_t i = start;
+    int k;
+
+#if defined( USE_SSE2_COMPARE )
+    // SSE2 has no 64-bit compare, but two values are bitwise equal iff both 32-bit halves are.
+    for( ; i + 4 <= count; i += 4 )
+    {
+        __m128i r0 = _mm_loadu_si128( (const __m128i*) (ref + i) );
+        __m128i r1 = _mm_loadu_si128( (const __m128i*) (ref + i + 2) );
+        __m128i eq = _mm_cmpeq_epi32( r0, r0 );
+
+        for( k = minIndex; k < maxIndex; k++ )
+        {
+            __m128i q0 = _mm_loadu_si128( (const __m128i*) (out[k] + i) );
+            __m128i q1 = _mm_loadu_si128( (const __m128i*) (out[k] + i + 2) );
+            eq = _mm_and_si128( eq, _mm_and_si128( _mm_cmpeq_epi32( r0, q0 ), _mm_cmpeq_epi32( r1, q1 ) ) );
+        }
+
+        if( _mm_movemask_epi8( eq ) != 0xffff )
+            break;
+    }
+#endif
+
+    for( ; i < count; i++ )
+        for( k = minIndex; k < maxIndex; k++ )
+            if( out[k][i] != ref[i] )
+                return i;
+
+    return count;
+}
@@ -77,12 +77,21 @@ extern int              gIsInRTZMode;
 extern int              gInfNanSupport;
 extern int              gIsEmbedded;
 extern int              gVerboseBruteForce;
+extern int              gOverlapVerification;
+extern int              gKernelInputs;
 extern uint32_t         gMaxVectorSizeIndex;
 extern uint32_t         gMinVectorSizeIndex;
 extern uint32_t         gDeviceFrequency;
 extern cl_device_fp_config gFloatCapabilities;
 extern cl_device_fp_config gDoubleCapabilities;
 
+// The test main() runs after the current one, so that its kernels can be built in the background.
+// gNextTestFunc is NULL if there is none.
+struct Func;
+extern const struct Func *gNextTestFunc;
+extern int              gNextTestIsDouble;
+extern int              gNextTestRelaxed;          // the value gTestFastRelaxed will have
+
 #define LOWER_IS_BETTER     0
 #define HIGHER_IS_BETTER    1
 
@@ -121,6 +130,10 @@ uint64_t GetTime( void );
 double SubtractTime( uint64_t endTime, uint64_t startTime );
 int MakeKernel( const char **c, cl_uint count, const char *name, cl_kernel *k, cl_program *p );
 int MakeKernels( const char **c, cl_uint count, const char *name, cl_uint kernel_count, cl_kernel *k, cl_program *p );
+// As MakeKernels, but with the fast relaxed math setting passed in, for builds that run while gTestFastRelaxed changes
+int MakeKernelsRelaxed( const char **c, cl_uint count, const char *name, cl_uint kernel_count, cl_kernel *k, cl_program *p, int relaxed );
+// Waits for and releases kernels binary.c is building in the background for the next test
+void ReleasePrefetchedKernels( void );
 
 // used to convert a bucket of bits into a search pattern through double
 static inline double DoubleFromUInt32( uint32_t bits );
@@ -273,6 +286,12 @@ void DivideDD(double *chi, double *clo, double a, double b);
 int compareFloats(float x, float y);
 int compareDoubles(double x, double y);
 
+// Return the first index in [start, count) at which any of out[minIndex] ... out[maxIndex-1]
+// differs bit for bit from ref, or count if all of them match. Verification loops use these
+// to skip the (usually very long) runs of correctly rounded results ahead of the ulp checks.
+size_t FindMismatch32( const cl_uint *ref, cl_uint * const *out, int minIndex, int maxIndex, size_t start, size_t count );
+size_t FindMismatch64( const cl_ulong *ref, cl_ulong * const *out, int minIndex, int maxIndex, size_t start, size_t count );
+
 void logFunctionInfo(const char *fname, unsigned int float_size, unsigned int isFastRelaxed);
 
 #endif /* UTILITY_H */
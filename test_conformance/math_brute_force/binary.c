@@ -38,9 +38,9 @@ const vtbl _binary = { "binary", TestFunc_Float_Float_Float, TestFunc_Double_Dou
 #endif
 const vtbl _binary_nextafter = { "binary_nextafter", TestFunc_Float_Float_Float_nextafter, TestFunc_Double_Double_Double_nextafter };
 
-static int BuildKernel( const char *name, int vectorSize, cl_uint kernel_count, cl_kernel *k, cl_program *p );
+static int BuildKernel( const char *name, int vectorSize, cl_uint kernel_count, cl_kernel *k, cl_program *p, int relaxed );
 
-static int BuildKernel( const char *name, int vectorSize, cl_uint kernel_count, cl_kernel *k, cl_program *p )
+static int BuildKernel( const char *name, int vectorSize, cl_uint kernel_count, cl_kernel *k, cl_program *p, int relaxed )
 {
     const char *c[] = {     "__kernel void math_kernel", sizeNames[vectorSize], "( __global float", sizeNames[vectorSize], "* out, __global float", sizeNames[vectorSize], "* in1, __global float", sizeNames[vectorSize], "* in2 )\n"
                             "{\n"
@@ -100,10 +100,10 @@ static int BuildKernel( const char *name, int vectorSize, cl_uint kernel_count,
     char testName[32];
     snprintf( testName, sizeof( testName ) -1, "math_kernel%s", sizeNames[vectorSize] );
 
-    return MakeKernels(kern, (cl_uint) kernSize, testName, kernel_count, k, p);
+    return MakeKernelsRelaxed(kern, (cl_uint) kernSize, testName, kernel_count, k, p, relaxed);
 }
 
-static int BuildKernelDouble( const char *name, int vectorSize, cl_uint kernel_count, cl_kernel *k, cl_program *p )
+static int BuildKernelDouble( const char *name, int vectorSize, cl_uint kernel_count, cl_kernel *k, cl_program *p, int relaxed )
 {
     const char *c[] = {     "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n",
                             "__kernel void math_kernel", sizeNames[vectorSize], "( __global double", sizeNames[vectorSize], "* out, __global double", sizeNames[vectorSize], "* in1, __global double", sizeNames[vectorSize], "* in2 )\n"
@@ -165,7 +165,7 @@ static int BuildKernelDouble( const char *name, int vectorSize, cl_uint kernel_c
     char testName[32];
     snprintf( testName, sizeof( testName ) -1, "math_kernel%s", sizeNames[vectorSize] );
 
-    return MakeKernels(kern, (cl_uint) kernSize, testName, kernel_count, k, p);
+    return MakeKernelsRelaxed(kern, (cl_uint) kernSize, testName, kernel_count, k, p, relaxed);
 }
 
 // A table of more difficult cases to get right
@@ -194,6 +194,7 @@ typedef struct BuildKernelInfo
     cl_kernel   **kernels;
     cl_program  *programs;
     const char  *nameInCode;
+    int         relaxed;           // build with -cl-fast-relaxed-math
 }BuildKernelInfo;
 
 static cl_int BuildKernel_FloatFn( cl_uint job_id, cl_uint thread_id UNUSED, void *p );
@@ -201,7 +202,7 @@ static cl_int BuildKernel_FloatFn( cl_uint job_id, cl_uint thread_id UNUSED, voi
 {
     BuildKernelInfo *info = (BuildKernelInfo*) p;
     cl_uint i = info->offset + job_id;
-    return BuildKernel( info->nameInCode, i, info->kernel_count, info->kernels[i], info->programs + i );
+    return BuildKernel( info->nameInCode, i, info->kernel_count, info->kernels[i], info->programs + i, info->relaxed );
 }
 
 static cl_int BuildKernel_DoubleFn( cl_uint job_id, cl_uint thread_id UNUSED, void *p );
@@ -209,10 +210,10 @@ static cl_int BuildKernel_DoubleFn( cl_uint job_id, cl_uint thread_id UNUSED, vo
 {
     BuildKernelInfo *info = (BuildKernelInfo*) p;
     cl_uint i = info->offset + job_id;
-    return BuildKernelDouble( info->nameInCode, i, info->kernel_count, info->kernels[i], info->programs + i );
+    return BuildKernelDouble( info->nameInCode, i, info->kernel_count, info->kernels[i], info->programs + i, info->relaxed );
 }
 
-//Thread specific data for a worker thread
+//Thread specific data for a worker thread. In overlapped mode each worker thread owns two of these.
 typedef struct ThreadInfo
 {
     cl_mem      inBuf;                              // input buffer for the thread
@@ -223,6 +224,10 @@ typedef struct ThreadInfo
     double      maxErrorValue2;                     // position of the max error value (param 2).  Init to 0.
     MTdata      d;
     cl_command_queue tQueue;                        // per thread command queue to improve performance
+    void        *out[ VECTOR_SIZE_COUNT ];          // mapped results of the job in flight
+    cl_event    readEvent;                          // signaled once out[] may be read
+    cl_uint     jobID;                              // job_id of the job in flight
+    int         pending;                            // non-zero if the job in flight has not been verified yet
 }ThreadInfo;
 
 typedef struct TestInfo
@@ -233,6 +238,7 @@ typedef struct TestInfo
     cl_kernel   *k[VECTOR_SIZE_COUNT ];             // arrays of thread-specific kernels for each worker thread:  k[vector_size][thread_id]
     ThreadInfo  *tinfo;                             // An array of thread specific information for each worker thread
     cl_uint     threadCount;                        // Number of worker threads
+    cl_uint     bufferSets;                         // ThreadInfos per worker thread: 2 in overlapped mode, otherwise 1
     cl_uint     step;                               // step between each chunk and the next.
     cl_uint     scale;                              // stride between individual test values
     float       ulps;                               // max_allowed ulps
@@ -243,13 +249,110 @@ typedef struct TestInfo
     int         isNextafter;
 }TestInfo;
 
+// Kernels for the next test, built by a ThreadPool_Submit job while the current test runs
+typedef struct PrefetchedKernels
+{
+    const Func          *f;                                 // function the kernels are for. NULL if none.
+    int                 isDouble;
+    ThreadPoolJobHandle job;                                // the build job, NULL once waited on
+    cl_program          programs[ VECTOR_SIZE_COUNT ];
+    cl_kernel           *k[ VECTOR_SIZE_COUNT ];
+    BuildKernelInfo     build_info;
+}PrefetchedKernels;
+
+static PrefetchedKernels gPrefetch;
+
+void ReleasePrefetchedKernels( void )
+{
+    size_t i, j;
+
+    if( gPrefetch.job )
+        ThreadPool_Wait( gPrefetch.job );
+
+    for( i = gMinVectorSizeIndex; i < gMaxVectorSizeIndex; i++ )
+    {
+        if( gPrefetch.programs[i] )
+            clReleaseProgram( gPrefetch.programs[i] );
+        if( gPrefetch.k[i] )
+        {
+            for( j = 0; j < gPrefetch.build_info.kernel_count; j++ )
+                if( gPrefetch.k[i][j] )
+                    clReleaseKernel( gPrefetch.k[i][j] );
+
+            free( gPrefetch.k[i] );
+        }
+    }
+    memset( &gPrefetch, 0, sizeof( gPrefetch ) );
+}
+
+// Start building the kernels for the next test in the background, if it is a binary test too
+static void PrefetchNextKernels( void )
+{
+    const Func *f = gNextTestFunc;
+    cl_uint threadCount = GetThreadCount();
+    size_t i;
+
+    if( NULL == f || ( f->vtbl != &_binary && f->vtbl != &_binary_nextafter ) )
+        return;
+
+    ReleasePrefetchedKernels();
+    for( i = gMinVectorSizeIndex; i < gMaxVectorSizeIndex; i++ )
+    {
+        gPrefetch.k[i] = (cl_kernel*) calloc( threadCount, sizeof( cl_kernel ) );
+        if( NULL == gPrefetch.k[i] )
+        {
+            ReleasePrefetchedKernels();
+            return;
+        }
+    }
+
+    BuildKernelInfo build_info = { gMinVectorSizeIndex, threadCount, gPrefetch.k, gPrefetch.programs, f->nameInCode, gNextTestRelaxed };
+    gPrefetch.f = f;
+    gPrefetch.isDouble = gNextTestIsDouble;
+    gPrefetch.build_info = build_info;
+    gPrefetch.job = ThreadPool_Submit( gNextTestIsDouble ? BuildKernel_DoubleFn : BuildKernel_FloatFn,
+                                       gMaxVectorSizeIndex - gMinVectorSizeIndex, &gPrefetch.build_info );
+}
+
+// Fill in test_info->programs and test_info->k, using the kernels prefetched by the previous test if they match
+static cl_int GetKernels( const Func *f, int isDouble, TestInfo *test_info )
+{
+    size_t i;
+
+    if( gPrefetch.job )
+    {
+        cl_int error = ThreadPool_Wait( gPrefetch.job );
+        gPrefetch.job = NULL;
+
+        if( CL_SUCCESS == error && f == gPrefetch.f && isDouble == gPrefetch.isDouble &&
+            gTestFastRelaxed == gPrefetch.build_info.relaxed && test_info->threadCount == gPrefetch.build_info.kernel_count )
+        {
+            for( i = gMinVectorSizeIndex; i < gMaxVectorSizeIndex; i++ )
+            {
+                test_info->programs[i] = gPrefetch.programs[i];
+                memcpy( test_info->k[i], gPrefetch.k[i], test_info->threadCount * sizeof( cl_kernel ) );
+                free( gPrefetch.k[i] );
+            }
+            memset( &gPrefetch, 0, sizeof( gPrefetch ) );
+            return CL_SUCCESS;
+        }
+    }
+    ReleasePrefetchedKernels();
+
+    BuildKernelInfo build_info = { gMinVectorSizeIndex, test_info->threadCount, test_info->k, test_info->programs, f->nameInCode, gTestFastRelaxed };
+    return ThreadPool_Do( isDouble ? BuildKernel_DoubleFn : BuildKernel_FloatFn, gMaxVectorSizeIndex - gMinVectorSizeIndex, &build_info );
+}
+
 static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *p );
+static cl_int FinishFloat( cl_uint job_id, cl_uint thread_id, void *p );
+static cl_int UnmapResults( ThreadInfo *tinfo );
 
 int TestFunc_Float_Float_Float_common(const Func *f, MTdata d, int isNextafter)
 {
     TestInfo    test_info;
     cl_int      error;
     size_t      i, j;
+    cl_uint     setCount;
     float       maxError = 0.0f;
     double      maxErrorVal = 0.0;
     double      maxErrorVal2 = 0.0;
@@ -260,11 +363,13 @@ int TestFunc_Float_Float_Float_common(const Func *f, MTdata d, int isNextafter)
     // Init test_info
     memset( &test_info, 0, sizeof( test_info ) );
     test_info.threadCount = GetThreadCount();
-    test_info.subBufferSize = BUFFER_SIZE / (sizeof( cl_float) * RoundUpToNextPowerOfTwo(test_info.threadCount));
+    test_info.bufferSets = gOverlapVerification ? 2 : 1;
+    setCount = test_info.threadCount * test_info.bufferSets;
+    test_info.subBufferSize = BUFFER_SIZE / (sizeof( cl_float) * RoundUpToNextPowerOfTwo(setCount));
     test_info.scale = 1;
 
     if (gWimpyMode){
-        test_info.subBufferSize = gWimpyBufferSize / (sizeof( cl_float) * RoundUpToNextPowerOfTwo(test_info.threadCount));
+        test_info.subBufferSize = gWimpyBufferSize / (sizeof( cl_float) * RoundUpToNextPowerOfTwo(setCount));
         test_info.scale =  (cl_uint) sizeof(cl_float) * 2 * gWimpyReductionFactor;
     }
     test_info.step = (cl_uint) test_info.subBufferSize * test_info.scale;
@@ -288,15 +393,15 @@ int TestFunc_Float_Float_Float_common(const Func *f, MTdata d, int isNextafter)
         }
         memset( test_info.k[i], 0, array_size );
     }
-    test_info.tinfo = (ThreadInfo*)malloc( test_info.threadCount * sizeof(*test_info.tinfo) );
+    test_info.tinfo = (ThreadInfo*)malloc( setCount * sizeof(*test_info.tinfo) );
     if( NULL == test_info.tinfo )
     {
         vlog_error( "Error: Unable to allocate storage for thread specific data.\n" );
         error = CL_OUT_OF_HOST_MEMORY;
         goto exit;
     }
-    memset( test_info.tinfo, 0, test_info.threadCount * sizeof(*test_info.tinfo) );
-    for( i = 0; i < test_info.threadCount; i++ )
+    memset( test_info.tinfo, 0, setCount * sizeof(*test_info.tinfo) );
+    for( i = 0; i < setCount; i++ )
     {
         cl_buffer_region region = { i * test_info.subBufferSize * sizeof( cl_float), test_info.subBufferSize * sizeof( cl_float) };
         test_info.tinfo[i].inBuf = clCreateSubBuffer( gInBuffer, CL_MEM_READ_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &region, &error);
@@ -321,11 +426,20 @@ int TestFunc_Float_Float_Float_common(const Func *f, MTdata d, int isNextafter)
                 goto exit;
             }
         }
-        test_info.tinfo[i].tQueue = clCreateCommandQueueWithProperties(gContext, gDevice, 0, &error);
-        if( NULL == test_info.tinfo[i].tQueue || error )
+        // The buffer sets of a thread share its queue, so that they execute in order
+        if( i % test_info.bufferSets )
         {
-            vlog_error( "clCreateCommandQueue failed. (%d)\n", error );
-            goto exit;
+            test_info.tinfo[i].tQueue = test_info.tinfo[i - 1].tQueue;
+            clRetainCommandQueue( test_info.tinfo[i].tQueue );
+        }
+        else
+        {
+            test_info.tinfo[i].tQueue = clCreateCommandQueueWithProperties(gContext, gDevice, 0, &error);
+            if( NULL == test_info.tinfo[i].tQueue || error )
+            {
+                vlog_error( "clCreateCommandQueue failed. (%d)\n", error );
+                goto exit;
+            }
         }
 
         test_info.tinfo[i].d = init_genrand(genrand_int32(d));
@@ -333,9 +447,9 @@ int TestFunc_Float_Float_Float_common(const Func *f, MTdata d, int isNextafter)
 
     // Init the kernels
     {
-        BuildKernelInfo build_info = { gMinVectorSizeIndex, test_info.threadCount, test_info.k, test_info.programs, f->nameInCode };
-        if( (error = ThreadPool_Do( BuildKernel_FloatFn, gMaxVectorSizeIndex - gMinVectorSizeIndex, &build_info ) ))
+        if( (error = GetKernels( f, 0, &test_info ) ))
             goto exit;
+        PrefetchNextKernels();
     }
 
     // Run the kernels
@@ -343,8 +457,12 @@ int TestFunc_Float_Float_Float_common(const Func *f, MTdata d, int isNextafter)
     {
         error = ThreadPool_Do( TestFloat, (cl_uint) ((1ULL<<32) / test_info.step), &test_info );
 
+        // Verify the jobs still in flight after the last one was launched
+        if( CL_SUCCESS == error && test_info.bufferSets > 1 )
+            error = ThreadPool_Do( FinishFloat, test_info.threadCount, &test_info );
+
         // Accumulate the arithmetic errors
-        for( i = 0; i < test_info.threadCount; i++ )
+        for( i = 0; i < setCount; i++ )
         {
             if( test_info.tinfo[i].maxError > maxError )
             {
@@ -447,8 +565,10 @@ exit:
     }
     if( test_info.tinfo )
     {
-        for( i = 0; i < test_info.threadCount; i++ )
+        for( i = 0; i < setCount; i++ )
         {
+            if( test_info.tinfo[i].pending )
+                UnmapResults( test_info.tinfo + i );
             free_mtdata( test_info.tinfo[i].d );
             clReleaseMemObject(test_info.tinfo[i].inBuf);
             clReleaseMemObject(test_info.tinfo[i].inBuf2);
@@ -463,43 +583,84 @@ exit:
     return error;
 }
 
+static cl_int EnqueueFloat( const TestInfo *job, cl_uint job_id, cl_uint thread_id, ThreadInfo *tinfo );
+static cl_int VerifyFloat( const TestInfo *job, ThreadInfo *tinfo );
+
 static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data  )
 {
     const TestInfo *job = (const TestInfo *) data;
-    size_t      buffer_elements = job->subBufferSize;
-    size_t      buffer_size = buffer_elements * sizeof( cl_float );
-    cl_uint     base = job_id * (cl_uint) job->step;
-    ThreadInfo  *tinfo = job->tinfo + thread_id;
-    float       ulps = job->ulps;
-    fptr        func = job->f->func;
-    int         ftz = job->ftz;
-    MTdata      d = tinfo->d;
-    cl_uint     j, k;
+    ThreadInfo  *tinfo = job->tinfo + thread_id * job->bufferSets;
+    ThreadInfo  *prev = NULL;
     cl_int      error;
-    cl_uchar    *overflow = (cl_uchar*)malloc(buffer_size);
-    const char  *name = job->f->name;
-    int         isFDim = job->isFDim;
-    int         skipNanInf = job->skipNanInf;
-    int         isNextafter = job->isNextafter;
-    cl_uint     *t = 0;
-    float       *r=0,*s=0,*s2=0;
-    cl_int copysign_test = 0;
-    RoundingMode oldRoundMode;
-    int skipVerification = 0;
 
-    if(gTestFastRelaxed)
+    // In overlapped mode, launch this job in whichever buffer set is free and
+    // verify the job left in flight in the other one by the previous call
+    // while the device works on this one.
+    if( job->bufferSets > 1 )
     {
-      if (strcmp(name,"pow")==0 && gFastRelaxedDerived)
-      {
-        func = job->f->rfunc;
-        ulps = INFINITY;
-        skipVerification = 1;
-      }else
-      {
-        func = job->f->rfunc;
-        ulps = job->f->relaxed_error;
-      }
+        if( tinfo->pending )
+            prev = tinfo++;
+        else if( tinfo[1].pending )
+            prev = tinfo + 1;
+    }
+
+    if( (error = EnqueueFloat( job, job_id, thread_id, tinfo )) )
+        return error;
+
+    if( job->bufferSets > 1 )
+        return prev ? VerifyFloat( job, prev ) : CL_SUCCESS;
+
+    return VerifyFloat( job, tinfo );
+}
+
+// Verify the jobs TestFloat left in flight in overlapped mode. job_id is the worker thread that owns them.
+static cl_int FinishFloat( cl_uint job_id, cl_uint thread_id UNUSED, void *data )
+{
+    const TestInfo *job = (const TestInfo *) data;
+    ThreadInfo  *tinfo = job->tinfo + job_id * job->bufferSets;
+    cl_uint     i;
+    cl_int      error;
+
+    for( i = 0; i < job->bufferSets; i++ )
+        if( tinfo[i].pending && (error = VerifyFloat( job, tinfo + i )) )
+            return error;
+
+    return CL_SUCCESS;
+}
+
+static cl_int UnmapResults( ThreadInfo *tinfo )
+{
+    cl_uint     j;
+    cl_int      error;
+
+    for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
+    {
+        if( (error = clEnqueueUnmapMemObject( tinfo->tQueue, tinfo->outBuf[j], tinfo->out[j], 0, NULL, NULL)) )
+        {
+            vlog_error( "Error: clEnqueueUnmapMemObject %d failed 2! err: %d\n", j, error );
+            return error;
+        }
+    }
+
+    if( tinfo->readEvent )
+    {
+        clReleaseEvent( tinfo->readEvent );
+        tinfo->readEvent = NULL;
     }
+    tinfo->pending = 0;
+
+    return CL_SUCCESS;
+}
+
+// Fill the input buffers of tinfo for job_id, run the kernels and start reading back the results
+static cl_int EnqueueFloat( const TestInfo *job, cl_uint job_id, cl_uint thread_id, ThreadInfo *tinfo )
+{
+    size_t      buffer_elements = job->subBufferSize;
+    size_t      buffer_size = buffer_elements * sizeof( cl_float );
+    size_t      set = tinfo - job->tinfo;
+    MTdata      d = tinfo->d;
+    cl_uint     j;
+    cl_int      error;
 
     // start the map of the output arrays
     cl_event e[ VECTOR_SIZE_COUNT ];
@@ -519,8 +680,8 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data  )
         vlog( "clFlush failed\n" );
 
     //Init input array
-    cl_uint *p = (cl_uint *)gIn + thread_id * buffer_elements;
-    cl_uint *p2 = (cl_uint *)gIn2 + thread_id * buffer_elements;
+    cl_uint *p = (cl_uint *)gIn + set * buffer_elements;
+    cl_uint *p2 = (cl_uint *)gIn2 + set * buffer_elements;
     j = 0;
 
     int totalSpecialValueCount = specialValuesFloatCount * specialValuesFloatCount;
@@ -559,13 +720,13 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data  )
     if( (error = clEnqueueWriteBuffer( tinfo->tQueue, tinfo->inBuf, CL_FALSE, 0, buffer_size, p, 0, NULL, NULL) ))
     {
         vlog_error( "Error: clEnqueueWriteBuffer failed! err: %d\n", error );
-        goto exit;
+        return error;
     }
 
     if( (error = clEnqueueWriteBuffer( tinfo->tQueue, tinfo->inBuf2, CL_FALSE, 0, buffer_size, p2, 0, NULL, NULL) ))
     {
         vlog_error( "Error: clEnqueueWriteBuffer failed! err: %d\n", error );
-        goto exit;
+        return error;
     }
 
     for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
@@ -574,12 +735,12 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data  )
         if( (error = clWaitForEvents(1, e + j) ))
         {
             vlog_error( "Error: clWaitForEvents failed! err: %d\n", error );
-            goto exit;
+            return error;
         }
         if( (error = clReleaseEvent( e[j] ) ))
         {
             vlog_error( "Error: clReleaseEvent failed! err: %d\n", error );
-            goto exit;
+            return error;
         }
 
         // Fill the result buffer with garbage, so that old results don't carry over
@@ -588,7 +749,7 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data  )
         if( (error = clEnqueueUnmapMemObject( tinfo->tQueue, tinfo->outBuf[j], out[j], 0, NULL, NULL) ))
         {
             vlog_error( "Error: clEnqueueMapBuffer failed! err: %d\n", error );
-            goto exit;
+            return error;
         }
 
         // run the kernel
@@ -603,16 +764,74 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data  )
         if( (error = clEnqueueNDRangeKernel(tinfo->tQueue, kernel, 1, NULL, &vectorCount, NULL, 0, NULL, NULL)))
         {
             vlog_error( "FAILED -- could not execute kernel\n" );
-            goto exit;
+            return error;
+        }
+    }
+
+    // Read the data back -- no need to wait for the first N-1 buffers. This is an in order queue.
+    // The map of the last one signals readEvent once everything is done.
+    for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
+    {
+        cl_event *readEvent = j + 1 < gMaxVectorSizeIndex ? NULL : &tinfo->readEvent;
+        tinfo->out[j] = clEnqueueMapBuffer( tinfo->tQueue, tinfo->outBuf[j], CL_FALSE, CL_MAP_READ, 0, buffer_size, 0, NULL, readEvent, &error);
+        if( error || NULL == tinfo->out[j] )
+        {
+            vlog_error( "Error: clEnqueueMapBuffer %d failed! err: %d\n", j, error );
+            return error;
         }
     }
+    tinfo->jobID = job_id;
+    tinfo->pending = 1;
 
     // Get that moving
     if( (error = clFlush(tinfo->tQueue) ))
         vlog( "clFlush 2 failed\n" );
 
+    return CL_SUCCESS;
+}
+
+// Compute the reference results for the job in flight in tinfo and check the device results against them
+static cl_int VerifyFloat( const TestInfo *job, ThreadInfo *tinfo )
+{
+    size_t      buffer_elements = job->subBufferSize;
+    size_t      buffer_size = buffer_elements * sizeof( cl_float );
+    size_t      set = tinfo - job->tinfo;
+    cl_uint     base = tinfo->jobID * (cl_uint) job->step;
+    float       ulps = job->ulps;
+    fptr        func = job->f->func;
+    int         ftz = job->ftz;
+    cl_uint     j, k;
+    cl_int      error = CL_SUCCESS;
+    cl_uchar    *overflow = (cl_uchar*)malloc(buffer_size);
+    const char  *name = job->f->name;
+    int         isFDim = job->isFDim;
+    int         skipNanInf = job->skipNanInf;
+    int         isNextafter = job->isNextafter;
+    cl_uint     **out = (cl_uint **) tinfo->out;
+    cl_uint     *t = 0;
+    float       *r=0,*s=0,*s2=0;
+    cl_int copysign_test = 0;
+    RoundingMode oldRoundMode;
+    int skipVerification = 0;
+
+    if(gTestFastRelaxed)
+    {
+      if (strcmp(name,"pow")==0 && gFastRelaxedDerived)
+      {
+        func = job->f->rfunc;
+        ulps = INFINITY;
+        skipVerification = 1;
+      }else
+      {
+        func = job->f->rfunc;
+        ulps = job->f->relaxed_error;
+      }
+    }
+
     if( gSkipCorrectnessTesting )
     {
+        if( (error = UnmapResults( tinfo )) )
+            goto exit;
         if( (error = clFinish(tinfo->tQueue)) )
         {
           vlog_error( "Error: clFinish failed! err: %d\n", error );
@@ -642,9 +861,9 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data  )
 #define ref_func(s, s2) (copysign_test ? func.f_ff_f( s, s2 ) : func.f_ff( s, s2 ))
 
     //Calculate the correctly rounded reference result
-    r = (float *)gOut_Ref  + thread_id * buffer_elements;
-    s = (float *)gIn  + thread_id * buffer_elements;
-    s2 = (float *)gIn2  + thread_id * buffer_elements;
+    r = (float *)gOut_Ref  + set * buffer_elements;
+    s = (float *)gIn  + set * buffer_elements;
+    s2 = (float *)gIn2  + set * buffer_elements;
     if( skipNanInf )
     {
         for( j = 0; j < buffer_elements; j++ )
@@ -663,22 +882,10 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data  )
     if( isFDim && ftz )
         RestoreFPState( &oldMode );
 
-    // Read the data back -- no need to wait for the first N-1 buffers. This is an in order queue.
-    for( j = gMinVectorSizeIndex; j + 1 < gMaxVectorSizeIndex; j++ )
-    {
-        out[j] = (cl_uint*) clEnqueueMapBuffer( tinfo->tQueue, tinfo->outBuf[j], CL_FALSE, CL_MAP_READ, 0, buffer_size, 0, NULL, NULL, &error);
-        if( error || NULL == out[j] )
-        {
-            vlog_error( "Error: clEnqueueMapBuffer %d failed! err: %d\n", j, error );
-            goto exit;
-        }
-    }
-
     // Wait for the last buffer
-    out[j] = (cl_uint*) clEnqueueMapBuffer( tinfo->tQueue, tinfo->outBuf[j], CL_TRUE, CL_MAP_READ, 0, buffer_size, 0, NULL, NULL, &error);
-    if( error || NULL == out[j] )
+    if( (error = clWaitForEvents( 1, &tinfo->readEvent ) ))
     {
-        vlog_error( "Error: clEnqueueMapBuffer %d failed! err: %d\n", j, error );
+        vlog_error( "Error: clWaitForEvents failed! err: %d\n", error );
         goto exit;
     }
 
@@ -687,6 +894,11 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data  )
         t = (cl_uint *)r;
         for( j = 0; j < buffer_elements; j++ )
         {
+            // Skip ahead to the next result that is not bitwise identical to the reference
+            j = (cl_uint) FindMismatch32( t, out, gMinVectorSizeIndex, gMaxVectorSizeIndex, j, buffer_elements );
+            if( j == buffer_elements )
+                break;
+
             for( k = gMinVectorSizeIndex; k < gMaxVectorSizeIndex; k++ )
             {
                 cl_uint *q = out[k];
@@ -911,14 +1123,8 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data  )
     if (isFDim && gIsInRTZMode)
         (void)set_round(oldRoundMode, kfloat);
 
-    for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
-    {
-        if( (error = clEnqueueUnmapMemObject( tinfo->tQueue, tinfo->outBuf[j], out[j], 0, NULL, NULL)) )
-        {
-            vlog_error( "Error: clEnqueueUnmapMemObject %d failed 2! err: %d\n", j, error );
-            return error;
-        }
-    }
+    if( (error = UnmapResults( tinfo )) )
+        goto exit;
 
     if( (error = clFlush(tinfo->tQueue) ))
         vlog( "clFlush 3 failed\n" );
@@ -967,12 +1173,14 @@ static const double specialValuesDouble[] = {
 static size_t specialValuesDoubleCount = sizeof( specialValuesDouble ) / sizeof( specialValuesDouble[0] );
 
 static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *p );
+static cl_int FinishDouble( cl_uint job_id, cl_uint thread_id, void *p );
 
 int TestFunc_Double_Double_Double_common(const Func *f, MTdata d, int isNextafter)
 {
     TestInfo    test_info;
     cl_int      error;
     size_t      i, j;
+    cl_uint     setCount;
     float       maxError = 0.0f;
     double      maxErrorVal = 0.0;
     double      maxErrorVal2 = 0.0;
@@ -982,12 +1190,14 @@ int TestFunc_Double_Double_Double_common(const Func *f, MTdata d, int isNextafte
     // Init test_info
     memset( &test_info, 0, sizeof( test_info ) );
     test_info.threadCount = GetThreadCount();
-    test_info.subBufferSize = BUFFER_SIZE / (sizeof( cl_double) * RoundUpToNextPowerOfTwo(test_info.threadCount));
+    test_info.bufferSets = gOverlapVerification ? 2 : 1;
+    setCount = test_info.threadCount * test_info.bufferSets;
+    test_info.subBufferSize = BUFFER_SIZE / (sizeof( cl_double) * RoundUpToNextPowerOfTwo(setCount));
     test_info.scale = 1;
 
 
     if (gWimpyMode){
-        test_info.subBufferSize = gWimpyBufferSize / (sizeof( cl_double) * RoundUpToNextPowerOfTwo(test_info.threadCount));
+        test_info.subBufferSize = gWimpyBufferSize / (sizeof( cl_double) * RoundUpToNextPowerOfTwo(setCount));
         test_info.scale =  (cl_uint) sizeof(cl_double) * 2 * gWimpyReductionFactor;
     }
     test_info.step = (cl_uint) test_info.subBufferSize * test_info.scale;
@@ -1011,15 +1221,15 @@ int TestFunc_Double_Double_Double_common(const Func *f, MTdata d, int isNextafte
         }
         memset( test_info.k[i], 0, array_size );
     }
-    test_info.tinfo = (ThreadInfo*)malloc( test_info.threadCount * sizeof(*test_info.tinfo) );
+    test_info.tinfo = (ThreadInfo*)malloc( setCount * sizeof(*test_info.tinfo) );
     if( NULL == test_info.tinfo )
     {
         vlog_error( "Error: Unable to allocate storage for thread specific data.\n" );
         error = CL_OUT_OF_HOST_MEMORY;
         goto exit;
     }
-    memset( test_info.tinfo, 0, test_info.threadCount * sizeof(*test_info.tinfo) );
-    for( i = 0; i < test_info.threadCount; i++ )
+    memset( test_info.tinfo, 0, setCount * sizeof(*test_info.tinfo) );
+    for( i = 0; i < setCount; i++ )
     {
         cl_buffer_region region = { i * test_info.subBufferSize * sizeof( cl_double), test_info.subBufferSize * sizeof( cl_double) };
         test_info.tinfo[i].inBuf = clCreateSubBuffer( gInBuffer, CL_MEM_READ_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &region, &error);
@@ -1044,11 +1254,20 @@ int TestFunc_Double_Double_Double_common(const Func *f, MTdata d, int isNextafte
                 goto exit;
             }
         }
-        test_info.tinfo[i].tQueue = clCreateCommandQueueWithProperties(gContext, gDevice, 0, &error);
-        if( NULL == test_info.tinfo[i].tQueue || error )
+        // The buffer sets of a thread share its queue, so that they execute in order
+        if( i % test_info.bufferSets )
         {
-            vlog_error( "clCreateCommandQueue failed. (%d)\n", error );
-            goto exit;
+            test_info.tinfo[i].tQueue = test_info.tinfo[i - 1].tQueue;
+            clRetainCommandQueue( test_info.tinfo[i].tQueue );
+        }
+        else
+        {
+            test_info.tinfo[i].tQueue = clCreateCommandQueueWithProperties(gContext, gDevice, 0, &error);
+            if( NULL == test_info.tinfo[i].tQueue || error )
+            {
+                vlog_error( "clCreateCommandQueue failed. (%d)\n", error );
+                goto exit;
+            }
         }
         test_info.tinfo[i].d = init_genrand(genrand_int32(d));
     }
@@ -1056,17 +1275,21 @@ int TestFunc_Double_Double_Double_common(const Func *f, MTdata d, int isNextafte
 
     // Init the kernels
     {
-        BuildKernelInfo build_info = { gMinVectorSizeIndex, test_info.threadCount, test_info.k, test_info.programs, f->nameInCode };
-        if( (error = ThreadPool_Do( BuildKernel_DoubleFn, gMaxVectorSizeIndex - gMinVectorSizeIndex, &build_info ) ))
+        if( (error = GetKernels( f, 1, &test_info ) ))
             goto exit;
+        PrefetchNextKernels();
     }
 
     if( !gSkipCorrectnessTesting )
     {
         error = ThreadPool_Do( TestDouble, (cl_uint) ((1ULL<<32) / test_info.step), &test_info );
 
+        // Verify the jobs still in flight after the last one was launched
+        if( CL_SUCCESS == error && test_info.bufferSets > 1 )
+            error = ThreadPool_Do( FinishDouble, test_info.threadCount, &test_info );
+
         // Accumulate the arithmetic errors
-        for( i = 0; i < test_info.threadCount; i++ )
+        for( i = 0; i < setCount; i++ )
         {
             if( test_info.tinfo[i].maxError > maxError )
             {
@@ -1171,8 +1394,10 @@ exit:
     }
     if( test_info.tinfo )
     {
-        for( i = 0; i < test_info.threadCount; i++ )
+        for( i = 0; i < setCount; i++ )
         {
+            if( test_info.tinfo[i].pending )
+                UnmapResults( test_info.tinfo + i );
             free_mtdata( test_info.tinfo[i].d );
             clReleaseMemObject(test_info.tinfo[i].inBuf);
             clReleaseMemObject(test_info.tinfo[i].inBuf2);
@@ -1187,26 +1412,56 @@ exit:
     return error;
 }
 
+static cl_int EnqueueDouble( const TestInfo *job, cl_uint job_id, cl_uint thread_id, ThreadInfo *tinfo );
+static cl_int VerifyDouble( const TestInfo *job, ThreadInfo *tinfo );
+
 static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
 {
     const TestInfo *job = (const TestInfo *) data;
+    ThreadInfo  *tinfo = job->tinfo + thread_id * job->bufferSets;
+    ThreadInfo  *prev = NULL;
+    cl_int      error;
+
+    // See TestFloat
+    if( job->bufferSets > 1 )
+    {
+        if( tinfo->pending )
+            prev = tinfo++;
+        else if( tinfo[1].pending )
+            prev = tinfo + 1;
+    }
+
+    if( (error = EnqueueDouble( job, job_id, thread_id, tinfo )) )
+        return error;
+
+    if( job->bufferSets > 1 )
+        return prev ? VerifyDouble( job, prev ) : CL_SUCCESS;
+
+    return VerifyDouble( job, tinfo );
+}
+
+static cl_int FinishDouble( cl_uint job_id, cl_uint thread_id UNUSED, void *data )
+{
+    const TestInfo *job = (const TestInfo *) data;
+    ThreadInfo  *tinfo = job->tinfo + job_id * job->bufferSets;
+    cl_uint     i;
+    cl_int      error;
+
+    for( i = 0; i < job->bufferSets; i++ )
+        if( tinfo[i].pending && (error = VerifyDouble( job, tinfo + i )) )
+            return error;
+
+    return CL_SUCCESS;
+}
+
+static cl_int EnqueueDouble( const TestInfo *job, cl_uint job_id, cl_uint thread_id, ThreadInfo *tinfo )
+{
     size_t      buffer_elements = job->subBufferSize;
     size_t      buffer_size = buffer_elements * sizeof( cl_double );
-    cl_uint     base = job_id * (cl_uint) job->step;
-    ThreadInfo  *tinfo = job->tinfo + thread_id;
-    float       ulps = job->ulps;
-    dptr        func = job->f->dfunc;
-    int         ftz = job->ftz;
+    size_t      set = tinfo - job->tinfo;
     MTdata      d = tinfo->d;
-    cl_uint     j, k;
+    cl_uint     j;
     cl_int      error;
-    const char  *name = job->f->name;
-
-    int         isNextafter = job->isNextafter;
-    cl_ulong    *t;
-    cl_double   *r,*s,*s2;
-
-    Force64BitFPUPrecision();
 
     // start the map of the output arrays
     cl_event e[ VECTOR_SIZE_COUNT ];
@@ -1226,8 +1481,8 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
         vlog( "clFlush failed\n" );
 
     //Init input array
-    cl_ulong *p = (cl_ulong *)gIn + thread_id * buffer_elements;
-    cl_ulong *p2 = (cl_ulong *)gIn2 + thread_id * buffer_elements;
+    cl_ulong *p = (cl_ulong *)gIn + set * buffer_elements;
+    cl_ulong *p2 = (cl_ulong *)gIn2 + set * buffer_elements;
     j = 0;
     int totalSpecialValueCount = specialValuesDoubleCount * specialValuesDoubleCount;
     int indx = (totalSpecialValueCount - 1) / buffer_elements;
@@ -1265,13 +1520,13 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
     if( (error = clEnqueueWriteBuffer( tinfo->tQueue, tinfo->inBuf, CL_FALSE, 0, buffer_size, p, 0, NULL, NULL) ))
     {
         vlog_error( "Error: clEnqueueWriteBuffer failed! err: %d\n", error );
-        goto exit;
+        return error;
     }
 
     if( (error = clEnqueueWriteBuffer( tinfo->tQueue, tinfo->inBuf2, CL_FALSE, 0, buffer_size, p2, 0, NULL, NULL) ))
     {
         vlog_error( "Error: clEnqueueWriteBuffer failed! err: %d\n", error );
-        goto exit;
+        return error;
     }
 
     for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
@@ -1280,12 +1535,12 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
         if( (error = clWaitForEvents(1, e + j) ))
         {
             vlog_error( "Error: clWaitForEvents failed! err: %d\n", error );
-            goto exit;
+            return error;
         }
         if( (error = clReleaseEvent( e[j] ) ))
         {
             vlog_error( "Error: clReleaseEvent failed! err: %d\n", error );
-            goto exit;
+            return error;
         }
 
         // Fill the result buffer with garbage, so that old results don't carry over
@@ -1294,7 +1549,7 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
         if( (error = clEnqueueUnmapMemObject( tinfo->tQueue, tinfo->outBuf[j], out[j], 0, NULL, NULL) ))
         {
             vlog_error( "Error: clEnqueueMapBuffer failed! err: %d\n", error );
-            goto exit;
+            return error;
         }
 
         // run the kernel
@@ -1309,40 +1564,71 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
         if( (error = clEnqueueNDRangeKernel(tinfo->tQueue, kernel, 1, NULL, &vectorCount, NULL, 0, NULL, NULL)))
         {
             vlog_error( "FAILED -- could not execute kernel\n" );
-            goto exit;
+            return error;
         }
     }
 
+    // Read the data back -- no need to wait for the first N-1 buffers. This is an in order queue.
+    // The map of the last one signals readEvent once everything is done.
+    for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
+    {
+        cl_event *readEvent = j + 1 < gMaxVectorSizeIndex ? NULL : &tinfo->readEvent;
+        tinfo->out[j] = clEnqueueMapBuffer( tinfo->tQueue, tinfo->outBuf[j], CL_FALSE, CL_MAP_READ, 0, buffer_size, 0, NULL, readEvent, &error);
+        if( error || NULL == tinfo->out[j] )
+        {
+            vlog_error( "Error: clEnqueueMapBuffer %d failed! err: %d\n", j, error );
+            return error;
+        }
+    }
+    tinfo->jobID = job_id;
+    tinfo->pending = 1;
+
     // Get that moving
     if( (error = clFlush(tinfo->tQueue) ))
         vlog( "clFlush 2 failed\n" );
 
+    return CL_SUCCESS;
+}
+
+static cl_int VerifyDouble( const TestInfo *job, ThreadInfo *tinfo )
+{
+    size_t      buffer_elements = job->subBufferSize;
+    size_t      set = tinfo - job->tinfo;
+    cl_uint     base = tinfo->jobID * (cl_uint) job->step;
+    float       ulps = job->ulps;
+    dptr        func = job->f->dfunc;
+    int         ftz = job->ftz;
+    cl_uint     j, k;
+    cl_int      error;
+    const char  *name = job->f->name;
+
+    int         isNextafter = job->isNextafter;
+    cl_ulong    **out = (cl_ulong **) tinfo->out;
+    cl_ulong    *t;
+    cl_double   *r,*s,*s2;
+
+    Force64BitFPUPrecision();
+
     if( gSkipCorrectnessTesting )
-        return CL_SUCCESS;
+    {
+        if( (error = UnmapResults( tinfo )) )
+            return error;
+        if( (error = clFinish(tinfo->tQueue)) )
+            vlog_error( "Error: clFinish failed! err: %d\n", error );
+        return error;
+    }
 
     //Calculate the correctly rounded reference result
-    r = (cl_double *)gOut_Ref  + thread_id * buffer_elements;
-    s = (cl_double *)gIn  + thread_id * buffer_elements;
-    s2 = (cl_double *)gIn2  + thread_id * buffer_elements;
+    r = (cl_double *)gOut_Ref  + set * buffer_elements;
+    s = (cl_double *)gIn  + set * buffer_elements;
+    s2 = (cl_double *)gIn2  + set * buffer_elements;
     for( j = 0; j < buffer_elements; j++ )
         r[j] = (cl_double) func.f_ff( s[j], s2[j] );
 
-    // Read the data back -- no need to wait for the first N-1 buffers. This is an in order queue.
-    for( j = gMinVectorSizeIndex; j + 1 < gMaxVectorSizeIndex; j++ )
-    {
-        out[j] = (cl_ulong*) clEnqueueMapBuffer( tinfo->tQueue, tinfo->outBuf[j], CL_FALSE, CL_MAP_READ, 0, buffer_size, 0, NULL, NULL, &error);
-        if( error || NULL == out[j] )
-        {
-            vlog_error( "Error: clEnqueueMapBuffer %d failed! err: %d\n", j, error );
-            goto exit;
-        }
-    }
-
     // Wait for the last buffer
-    out[j] = (cl_ulong*) clEnqueueMapBuffer( tinfo->tQueue, tinfo->outBuf[j], CL_TRUE, CL_MAP_READ, 0, buffer_size, 0, NULL, NULL, &error);
-    if( error || NULL == out[j] )
+    if( (error = clWaitForEvents( 1, &tinfo->readEvent ) ))
     {
-        vlog_error( "Error: clEnqueueMapBuffer %d failed! err: %d\n", j, error );
+        vlog_error( "Error: clWaitForEvents failed! err: %d\n", error );
         goto exit;
     }
 
@@ -1350,6 +1636,11 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
     t = (cl_ulong *)r;
     for( j = 0; j < buffer_elements; j++ )
     {
+        // Skip ahead to the next result that is not bitwise identical to the reference
+        j = (cl_uint) FindMismatch64( t, out, gMinVectorSizeIndex, gMaxVectorSizeIndex, j, buffer_elements );
+        if( j == buffer_elements )
+            break;
+
         for( k = gMinVectorSizeIndex; k < gMaxVectorSizeIndex; k++ )
         {
             cl_ulong *q = out[k];
@@ -1486,14 +1777,8 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
         }
     }
 
-    for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
-    {
-        if( (error = clEnqueueUnmapMemObject( tinfo->tQueue, tinfo->outBuf[j], out[j], 0, NULL, NULL)) )
-        {
-            vlog_error( "Error: clEnqueueUnmapMemObject %d failed 2! err: %d\n", j, error );
-            return error;
-        }
-    }
+    if( (error = UnmapResults( tinfo )) )
+        return error;
 
     if( (error = clFlush(tinfo->tQueue) ))
         vlog( "clFlush 3 failed\n" );
@@ -17,6 +17,7 @@
 
 #include <string.h>
 #include "FunctionList.h"
+#include "reference_math.h"
 
 int TestFunc_Float_Float_Float_Operator(const Func *f, MTdata);
 int TestFunc_Double_Double_Double_Operator(const Func *f, MTdata);
@@ -638,8 +639,12 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data )
     s2 = (float *)gIn2  + thread_id * buffer_elements;
     if( gInfNanSupport )
     {
-        for( j = 0; j < buffer_elements; j++ )
-            r[j] = (float) func.f_ff( s[j], s2[j] );
+        reference_batch_dd_d batch = reference_batch_for_dd_d( func.f_ff );
+        if( batch )
+            reference_batch_float_dd_d( batch, s, s2, r, buffer_elements );
+        else
+            for( j = 0; j < buffer_elements; j++ )
+                r[j] = (float) func.f_ff( s[j], s2[j] );
     }
     else
     {
@@ -680,6 +685,11 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data )
     t = (cl_uint *)r;
     for( j = 0; j < buffer_elements; j++ )
     {
+        // Skip ahead to the next result that is not bitwise identical to the reference
+        j = (cl_uint) FindMismatch32( t, out, gMinVectorSizeIndex, gMaxVectorSizeIndex, j, buffer_elements );
+        if( j == buffer_elements )
+            break;
+
         for( k = gMinVectorSizeIndex; k < gMaxVectorSizeIndex; k++ )
         {
             cl_uint *q = out[k];
@@ -1306,6 +1316,11 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
     t = (cl_ulong *)r;
     for( j = 0; j < buffer_elements; j++ )
     {
+        // Skip ahead to the next result that is not bitwise identical to the reference
+        j = (cl_uint) FindMismatch64( t, out, gMinVectorSizeIndex, gMaxVectorSizeIndex, j, buffer_elements );
+        if( j == buffer_elements )
+            break;
+
         for( k = gMinVectorSizeIndex; k < gMaxVectorSizeIndex; k++ )
         {
             cl_ulong *q = out[k];
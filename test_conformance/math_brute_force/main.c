@@ -22,9 +22,13 @@
 #include <time.h>
 #include "FunctionList.h"
 #include "Sleep.h"
+#include "reference_math.h"
+#include "ReferenceStore.h"
+#include "StratifiedSampling.h"
 #include "../../test_common/harness/errorHelpers.h"
 #include "../../test_common/harness/kernelHelpers.h"
 #include "../../test_common/harness/parseParameters.h"
+#include "../../test_common/harness/testReport.h"
 
 #if defined( __APPLE__ )
     #include <sys/sysctl.h>
@@ -109,6 +113,17 @@ cl_device_fp_config gDoubleCapabilities = 0;
 int             gWimpyReductionFactor = 32;
 int             gWimpyBufferSize = BUFFER_SIZE;
 int             gVerboseBruteForce = 0;
+int             gOverlapVerification = 0;
+int             gKernelInputs = 0;
+const char      *gReferenceStorePath = NULL;
+int             gStratifiedSampling = 0;
+double          gStratifiedBudget = 2.0;
+const char      *gStratifiedHistoryPath = NULL;
+const Func      *gNextTestFunc = NULL;
+int             gNextTestIsDouble = 0;
+int             gNextTestRelaxed = 0;
+static int      gCheckReferenceBatch = 0;
+static int      gBenchmarkThreadPool = 0;
 #if defined( __APPLE__ )
 int             gHasBasicDouble = 0;
 char*           gBasicDoubleFuncs[] = {
@@ -132,6 +147,11 @@ static int ParseArgs( int argc, const char **argv );
 static void PrintArch( void );
 static void PrintUsage( void );
 static void PrintFunctions( void );
+static int CheckReferenceBatch( void );
+static int BenchmarkThreadPool( void );
+static int IsFunctionSelected( const Func *f );
+static void SetNextTest( uint32_t i, int phase, uint32_t stop );
+static int RunTest( int (*test)( const struct Func *, MTdata ), const Func *f, MTdata d, const char *type );
 static int InitCL( void );
 static void ReleaseCL( void );
 static int InitILogbConstants( void );
@@ -143,7 +163,7 @@ static void TestFinishAtExit(void);
 
 int main (int argc, const char * argv[])
 {
-    unsigned int i, j, error = 0;
+    unsigned int i, error = 0;
 
     test_start();
     argc = parseCustomParam(argc, argv);
@@ -163,6 +183,13 @@ int main (int argc, const char * argv[])
     if( error )
         return error;
 
+    // The batch references run on the host only, so no device is needed
+    if( gCheckReferenceBatch )
+        return CheckReferenceBatch();
+
+    if( gBenchmarkThreadPool )
+        return BenchmarkThreadPool();
+
     // Init OpenCL
     error = InitCL();
     if( error )
@@ -220,26 +247,8 @@ int main (int argc, const char * argv[])
     {
         const Func *f = functionList + i;
 
-        // If the user passed a list of functions to run, make sure we are in that list
-        if( gTestNameCount )
-        {
-            for( j = 0; j < gTestNameCount; j++ )
-                if( 0 == strcmp(gTestNames[j], f->name ) )
-                    break;
-
-            // If this function doesn't match any on the list skip to the next function
-            if( j == gTestNameCount )
-                continue;
-        }
-
-        // if correctly rounded divide & sqrt are supported by the implementation
-        // then test it; otherwise skip the test
-        if (!strcmp(f->name, "sqrt_cr") || !strcmp(f->name, "divide_cr"))
-        {
-            if(( gFloatCapabilities & CL_FP_CORRECTLY_ROUNDED_DIVIDE_SQRT ) == 0 )
-                continue;
-
-        }
+        if( ! IsFunctionSelected( f ) )
+            continue;
 
 
         {
@@ -251,9 +260,10 @@ int main (int argc, const char * argv[])
             {
                 if( f->relaxed )
                 {
+                    SetNextTest( i, 0, stop );
                     gTestCount++;
                     vlog( "%3d: ", gTestCount );
-                    if( f->vtbl->TestFunc( f, d )  )
+                    if( RunTest( f->vtbl->TestFunc, f, d, "relaxed" ) )
                     {
                         gFailCount++;
                         error++;
@@ -265,11 +275,12 @@ int main (int argc, const char * argv[])
 
             if( gTestFloat )
             {
+                SetNextTest( i, 1, stop );
                 int testFastRelaxedTmp = gTestFastRelaxed;
                 gTestFastRelaxed = 0;
                 gTestCount++;
                 vlog( "%3d: ", gTestCount );
-                if( f->vtbl->TestFunc( f, d )  )
+                if( RunTest( f->vtbl->TestFunc, f, d, "float" ) )
                 {
                     gFailCount++;
                     error++;
@@ -284,13 +295,15 @@ int main (int argc, const char * argv[])
 
             if( gHasDouble && NULL != f->vtbl->DoubleTestFunc && NULL != f->dfunc.p )
             {
+                SetNextTest( i, 2, stop );
+
                 //Disable fast-relaxed-math for double precision floating-point
                 int testFastRelaxedTmp = gTestFastRelaxed;
                 gTestFastRelaxed = 0;
 
                 gTestCount++;
                 vlog( "%3d: ", gTestCount );
-                if( f->vtbl->DoubleTestFunc( f, d )  )
+                if( RunTest( f->vtbl->DoubleTestFunc, f, d, "double" ) )
                 {
                     gFailCount++;
                     error++;
@@ -311,6 +324,7 @@ int main (int argc, const char * argv[])
                     gTestFastRelaxed = 0;
 
                     int isBasicTest = 0;
+                    unsigned int j;
                     for( j = 0; j < gNumBasicDoubleFuncs; j++ ) {
                         if( 0 == strcmp(gBasicDoubleFuncs[j], f->name ) ) {
                             isBasicTest = 1;
@@ -321,7 +335,7 @@ int main (int argc, const char * argv[])
                         gTestCount++;
                         if( gTestFloat )
                             vlog( "    " );
-                        if( f->vtbl->DoubleTestFunc( f, d )  )
+                        if( RunTest( f->vtbl->DoubleTestFunc, f, d, "basic_double" ) )
                         {
                             gFailCount++;
                             error++;
@@ -362,6 +376,7 @@ int main (int argc, const char * argv[])
             vlog_error("FAILED test.\n");
     }
 
+    ReleasePrefetchedKernels();
     ReleaseCL();
 
 #if defined( __APPLE__ )
@@ -384,6 +399,7 @@ static int ParseArgs( int argc, const char **argv )
     gTestNames = (const char**) calloc( argc - 1, sizeof( char*) );
     gTestNameCount = 0;
     int singleThreaded = 0;
+    int toggleScheduler = 0;
 
     // Parse arg list
     if( NULL == gTestNames && argc > 1 )
@@ -446,6 +462,10 @@ static int ParseArgs( int argc, const char **argv )
                         gReportAverageTimes ^= 1;
                         break;
 
+                    case 'b':
+                        gCheckReferenceBatch ^= 1;
+                        break;
+
                     case 'c':
                         gToggleCorrectlyRoundedDivideSqrt ^= 1;
                         break;
@@ -462,10 +482,22 @@ static int ParseArgs( int argc, const char **argv )
                         gTestFloat ^= 1;
                         break;
 
+                    case 'G':
+                        gKernelInputs ^= 1;
+                        break;
+
                     case 'h':
                         PrintUsage();
                         return -1;
 
+                    case 'j':
+                        gBenchmarkThreadPool ^= 1;
+                        break;
+
+                    case 'k':
+                        toggleScheduler ^= 1;
+                        break;
+
                     case 'p':
                       PrintFunctions();
                       return -1;
@@ -478,10 +510,18 @@ static int ParseArgs( int argc, const char **argv )
                         singleThreaded ^= 1;
                         break;
 
+                    case 'o':
+                        gOverlapVerification ^= 1;
+                        break;
+
                     case 'r':
                         gTestFastRelaxed ^= 1;
                         break;
 
+                    case 'S':
+                        gStratifiedSampling ^= 1;
+                        break;
+
                     case 's':
                         gStopOnError ^= 1;
                         break;
@@ -631,6 +671,25 @@ static int ParseArgs( int argc, const char **argv )
       gWimpyMode = 1;
     }
 
+    // Stratified sampling settings, see StratifiedSampling.h
+    {
+        const char *budget = getenv( "CL_STRATIFIED_BUDGET" );
+        if( budget )
+        {
+            gStratifiedBudget = atof( budget );
+            if( gStratifiedBudget < 0.0 )
+                gStratifiedBudget = 0.0;
+        }
+        gStratifiedHistoryPath = getenv( "CL_STRATIFIED_HISTORY" );
+        if( gStratifiedHistoryPath && '\0' == gStratifiedHistoryPath[0] )
+            gStratifiedHistoryPath = NULL;
+    }
+
+    // Reuse reference results across runs, see ReferenceStore.h
+    gReferenceStorePath = getenv( "CL_MATH_REFERENCE_STORE" );
+    if( gReferenceStorePath && '\0' == gReferenceStorePath[0] )
+        gReferenceStorePath = NULL;
+
 #if defined( __APPLE__ )
     #if defined( __i386__ ) || defined( __x86_64__ )
         #define    kHasSSE3                0x00000008
@@ -669,6 +728,14 @@ static int ParseArgs( int argc, const char **argv )
 
     PrintArch();
 
+    if( gStratifiedSampling )
+    {
+        vlog( "\n" );
+        vlog( "*** WARNING: Sampling the unary float inputs!           ***\n" );
+        vlog( "*** Stratified mode is not sufficient to verify         ***\n" );
+        vlog( "*** correctness. Random inputs: %-8g s per function ***\n\n", gStratifiedBudget );
+    }
+
     if( gWimpyMode )
     {
         vlog( "\n" );
@@ -680,6 +747,9 @@ static int ParseArgs( int argc, const char **argv )
     if( singleThreaded )
         SetThreadCount(1);
 
+    if( toggleScheduler )
+        ThreadPool_SetScheduler( kThreadPoolGlobalCounter == ThreadPool_GetScheduler() ? kThreadPoolWorkStealing : kThreadPoolGlobalCounter );
+
     return 0;
 }
 
@@ -748,21 +818,266 @@ static void PrintFunctions ( void )
   }
 }
 
+// Compare the batch references against the scalar ones bit for bit over random float inputs
+static int CheckReferenceBatch( void )
+{
+    static const struct { const char *name; double (*f)( double ); } unaryFuncs[] = {
+        { "sin", reference_sin }, { "cos", reference_cos }, { "exp", reference_exp }, { "log", reference_log },
+        { "sqrt", reference_sqrt }, { "rsqrt", reference_rsqrt } };
+    static const struct { const char *name; double (*f)( double, double ); } binaryFuncs[] = {
+        { "pow", reference_pow }, { "divide", reference_divide }, { "add", reference_add },
+        { "subtract", reference_subtract }, { "multiply", reference_multiply } };
+    const size_t count = 1 << 16;
+    const int passes = 64;
+    double *x = (double*) malloc( count * sizeof( double ) );
+    double *y = (double*) malloc( count * sizeof( double ) );
+    double *r = (double*) malloc( count * sizeof( double ) );
+    float *fa = (float*) malloc( 4 * count * sizeof( float ) );
+    MTdata d = init_genrand( gRandomSeed );
+    size_t i, k;
+    int pass, shouldFlush, error = 0;
+
+    if( NULL == x || NULL == y || NULL == r || NULL == fa || NULL == d )
+    {
+        vlog_error( "Error: Unable to allocate storage for the batch reference check.\n" );
+        error = -1;
+        goto exit;
+    }
+
+    Force64BitFPUPrecision();
+
+    vlog( "\nChecking batch references against the scalar references:\n" );
+    for( k = 0; k < sizeof( unaryFuncs ) / sizeof( unaryFuncs[0] ); k++ )
+    {
+        reference_batch_d_d batch = reference_batch_for_d_d( unaryFuncs[k].f );
+        for( pass = 0; pass < passes && 0 == error; pass++ )
+        {
+            for( i = 0; i < count; i++ )
+                x[i] = DoubleFromUInt32( genrand_int32( d ) );
+            batch( x, r, count );
+            for( i = 0; i < count; i++ )
+            {
+                double correct = unaryFuncs[k].f( x[i] );
+                if( memcmp( &correct, r + i, sizeof( correct ) ) )
+                {
+                    vlog_error( "\nERROR: %s batch: %a at %a, scalar gives %a\n", unaryFuncs[k].name, r[i], x[i], correct );
+                    error = -1;
+                    break;
+                }
+            }
+        }
+        vlog( "\t%s\t%s\n", unaryFuncs[k].name, error ? "FAILED" : "passed" );
+        if( error )
+            goto exit;
+    }
+
+    for( k = 0; k < sizeof( binaryFuncs ) / sizeof( binaryFuncs[0] ); k++ )
+    {
+        reference_batch_dd_d batch = reference_batch_for_dd_d( binaryFuncs[k].f );
+        for( pass = 0; pass < passes && 0 == error; pass++ )
+        {
+            for( i = 0; i < count; i++ )
+            {
+                x[i] = DoubleFromUInt32( genrand_int32( d ) );
+                y[i] = DoubleFromUInt32( genrand_int32( d ) );
+            }
+            batch( x, y, r, count );
+            for( i = 0; i < count; i++ )
+            {
+                double correct = binaryFuncs[k].f( x[i], y[i] );
+                if( memcmp( &correct, r + i, sizeof( correct ) ) )
+                {
+                    vlog_error( "\nERROR: %s batch: %a at {%a, %a}, scalar gives %a\n", binaryFuncs[k].name, r[i], x[i], y[i], correct );
+                    error = -1;
+                    break;
+                }
+            }
+        }
+        vlog( "\t%s\t%s\n", binaryFuncs[k].name, error ? "FAILED" : "passed" );
+        if( error )
+            goto exit;
+    }
+
+    for( shouldFlush = 0; shouldFlush < 2; shouldFlush++ )
+    {
+        float *a = fa, *b = fa + count, *c = fa + 2 * count, *q = fa + 3 * count;
+        for( pass = 0; pass < passes && 0 == error; pass++ )
+        {
+            for( i = 0; i < 3 * count; i++ )
+                ((cl_uint*) fa)[i] = genrand_int32( d );
+            reference_fma_batch( a, b, c, q, count, shouldFlush );
+            for( i = 0; i < count; i++ )
+            {
+                float correct = reference_fma( a[i], b[i], c[i], shouldFlush );
+                if( memcmp( &correct, q + i, sizeof( correct ) ) )
+                {
+                    vlog_error( "\nERROR: fma batch: %a at {%a, %a, %a}, scalar gives %a\n", q[i], a[i], b[i], c[i], correct );
+                    error = -1;
+                    break;
+                }
+            }
+        }
+        vlog( "\tfma%s\t%s\n", shouldFlush ? " (ftz)" : "", error ? "FAILED" : "passed" );
+        if( error )
+            goto exit;
+    }
+
+exit:
+    free_mtdata( d );
+    free( x );
+    free( y );
+    free( r );
+    free( fa );
+    return error;
+}
+
+// Returns non-zero if f was selected on the command line and is supported by the device
+static int IsFunctionSelected( const Func *f )
+{
+    unsigned int j;
+
+    // If the user passed a list of functions to run, make sure we are in that list
+    if( gTestNameCount )
+    {
+        for( j = 0; j < gTestNameCount; j++ )
+            if( 0 == strcmp(gTestNames[j], f->name ) )
+                break;
+
+        // If this function doesn't match any on the list skip to the next function
+        if( j == gTestNameCount )
+            return 0;
+    }
+
+    // if correctly rounded divide & sqrt are supported by the implementation
+    // then test it; otherwise skip the test
+    if (!strcmp(f->name, "sqrt_cr") || !strcmp(f->name, "divide_cr"))
+    {
+        if(( gFloatCapabilities & CL_FP_CORRECTLY_ROUNDED_DIVIDE_SQRT ) == 0 )
+            return 0;
+    }
+
+    return 1;
+}
+
+// Record which test runs after the current one, phase 'phase' of functionList[i]. The phases of
+// a function run in the order of the main loop: 0 relaxed, 1 float, 2 double.
+static void SetNextTest( uint32_t i, int phase, uint32_t stop )
+{
+    gNextTestFunc = NULL;
+    for( ; i < stop; i++, phase = -1 )
+    {
+        const Func *f = functionList + i;
+
+        if( ! IsFunctionSelected( f ) )
+            continue;
+
+        if( phase < 0 && gTestFastRelaxed && f->relaxed )
+        {
+            gNextTestFunc = f;
+            gNextTestIsDouble = 0;
+            gNextTestRelaxed = 1;
+            return;
+        }
+        if( phase < 1 && gTestFloat )
+        {
+            gNextTestFunc = f;
+            gNextTestIsDouble = 0;
+            gNextTestRelaxed = 0;
+            return;
+        }
+        if( phase < 2 && gHasDouble && NULL != f->vtbl->DoubleTestFunc && NULL != f->dfunc.p )
+        {
+            gNextTestFunc = f;
+            gNextTestIsDouble = 1;
+            gNextTestRelaxed = 0;
+            return;
+        }
+    }
+}
+
+// Run test on f, with a record named <function>_<type> in the per-test report if there is one
+static int RunTest( int (*test)( const struct Func *, MTdata ), const Func *f, MTdata d, const char *type )
+{
+    char name[64];
+    int error;
+
+    snprintf( name, sizeof( name ), "%s_%s", f->name, type );
+    beginTestReport( name );
+    error = test( f, d );
+    endTestReport( name, error ? "failed" : "passed", gDevice );
+
+    return error;
+}
+
+static cl_int EmptyJob( cl_uint job_id UNUSED, cl_uint thread_id UNUSED, void *p UNUSED )
+{
+    return CL_SUCCESS;
+}
+
+// Measure the scheduling overhead per job of each ThreadPool scheduler, using jobs that do nothing
+static int BenchmarkThreadPool( void )
+{
+    static const char *names[] = { "global counter", "work stealing" };
+    static const cl_uint counts[] = { 1 << 10, 1 << 16, 1 << 20 };
+    ThreadPoolScheduler oldScheduler = ThreadPool_GetScheduler();
+    const int loops = 5;
+    size_t i;
+    int s, loop, error = 0;
+
+    vlog( "\nThread pool scheduling overhead with %u worker threads (best of %d):\n", GetThreadCount(), loops );
+    for( s = kThreadPoolGlobalCounter; s <= kThreadPoolWorkStealing; s++ )
+    {
+        ThreadPool_SetScheduler( (ThreadPoolScheduler) s );
+        for( i = 0; i < sizeof( counts ) / sizeof( counts[0] ); i++ )
+        {
+            double bestTime = INFINITY;
+            for( loop = 0; loop < loops; loop++ )
+            {
+                uint64_t startTime = GetTime();
+                if( (error = ThreadPool_Do( EmptyJob, counts[i], NULL )) )
+                {
+                    vlog_error( "Error %d from ThreadPool_Do\n", error );
+                    goto exit;
+                }
+                double current_time = SubtractTime( GetTime(), startTime );
+                if( current_time < bestTime )
+                    bestTime = current_time;
+            }
+            vlog( "\t%-16s %8u jobs: %8.1f ns / job\n", names[s], counts[i], bestTime * 1e9 / counts[i] );
+        }
+    }
+
+exit:
+    ThreadPool_SetScheduler( oldScheduler );
+    return error;
+}
+
 static void PrintUsage( void )
 {
     vlog( "%s [-acglstz]: <optional: math function names>\n", appName );
     vlog( "\toptions:\n" );
     vlog( "\t\t-a\tReport average times instead of best times\n" );
+    vlog( "\t\t-b\tCheck the batch reference functions bit for bit against the scalar ones and quit.\n" );
+    vlog( "\t\t\tsqrt, rsqrt, divide, add, subtract and multiply have SIMD batch references; sin, cos,\n" );
+    vlog( "\t\t\texp, log, pow and fma batch over the scalar ones; all other functions use the scalar ones.\n" );
     vlog( "\t\t-c\tToggle test fp correctly rounded divide and sqrt (Default: off)\n");
     vlog( "\t\t-d\tToggle double precision testing. (Default: on iff khr_fp_64 on)\n" );
     vlog( "\t\t-f\tToggle float precision testing. (Default: on)\n" );
     vlog( "\t\t-r\tToggle fast relaxed math precision testing. (Default: on)\n" );
     vlog( "\t\t-e\tToggle test as derived implementations for fast relaxed math precision. (Default: on)\n" );
+    vlog( "\t\t-G\tToggle kernel side inputs. The unary float kernels compute their inputs from the block offset instead of reading\n" );
+    vlog( "\t\t\tthem from a buffer the host uploads. Not used with -t. (Default: off)\n" );
     vlog( "\t\t-h\tPrint this message and quit\n" );
     vlog( "\t\t-p\tPrint all math function names and quit\n" );
+    vlog( "\t\t-j\tMeasure the thread pool scheduling overhead per job for each scheduler and quit\n" );
+    vlog( "\t\t-k\tToggle work stealing thread pool scheduler. (Default: off, unless CL_TEST_THREADPOOL_SCHEDULER=steal)\n" );
     vlog( "\t\t-l\tlink check only (make sure functions are present, skip accuracy checks.)\n" );
     vlog( "\t\t-m\tToggle run multi-threaded. (Default: on) )\n" );
+    vlog( "\t\t-o\tToggle overlapped verification. Double buffer each worker thread so the device runs the next slice while the host checks the current one. (Default: off)\n" );
     vlog( "\t\t-s\tStop on error\n" );
+    vlog( "\t\t-S\tToggle stratified sampling of the unary float inputs: special values, subnormals, binade edges and samples, then\n" );
+    vlog( "\t\t\trandom inputs for CL_STRATIFIED_BUDGET seconds (default %g), weighted toward the largest errors recorded\n", gStratifiedBudget );
+    vlog( "\t\t\tin the CL_STRATIFIED_HISTORY directory. * Not a valid test * (Default: off)\n" );
     vlog( "\t\t-t\tToggle timing  (on by default)\n" );
     vlog( "\t\t-w\tToggle Wimpy Mode, * Not a valid test * \n");
     vlog( "\t\t-[2^n]\tSet wimpy reduction factor, recommended range of n is 1-10, default factor(%u)\n",gWimpyReductionFactor );
@@ -776,6 +1091,8 @@ static void PrintUsage( void )
     vlog( "\tonly the named cases in the number range will run.\n" );
     vlog( "\tYou may also choose to pass no arguments, in which case all tests will be run.\n" );
     vlog( "\tYou may pass CL_DEVICE_TYPE_CPU/GPU/ACCELERATOR to select the device.\n" );
+    vlog( "\tSet CL_MATH_REFERENCE_STORE=<directory> to keep the float reference results of the unary functions\n" );
+    vlog( "\tthere and reuse them in later runs.\n" );
     vlog( "\n" );
 }
 
@@ -1121,6 +1438,13 @@ static int InitCL( void )
         vlog( "\tRunning in RTZ mode? %s\n", no_yes[0 != gIsInRTZMode] );
     vlog( "\tTininess is detected before rounding? %s\n", no_yes[0 != gCheckTininessBeforeRounding] );
     vlog( "\tWorker threads: %d\n", GetThreadCount() );
+    vlog( "\tWork stealing scheduler? %s\n", no_yes[kThreadPoolWorkStealing == ThreadPool_GetScheduler()] );
+    vlog( "\tOverlapped verification? %s\n", no_yes[0 != gOverlapVerification] );
+    vlog( "\tKernel side inputs? %s\n", no_yes[0 != gKernelInputs] );
+    vlog( "\tReference store: %s\n", gReferenceStorePath ? gReferenceStorePath : "none" );
+    vlog( "\tStratified sampling? %s\n", no_yes[0 != gStratifiedSampling] );
+    if( gStratifiedSampling )
+        vlog( "\tStratified error history: %s\n", gStratifiedHistoryPath ? gStratifiedHistoryPath : "none" );
     vlog( "\tTesting vector sizes:" );
     for( i = gMinVectorSizeIndex; i < gMaxVectorSizeIndex; i++ )
         vlog( "\t%d", sizeValues[i] );
@@ -1330,6 +1654,11 @@ int MakeKernel( const char **c, cl_uint count, const char *name, cl_kernel *k, c
 }
 
 int MakeKernels( const char **c, cl_uint count, const char *name, cl_uint kernel_count, cl_kernel *k, cl_program *p )
+{
+    return MakeKernelsRelaxed( c, count, name, kernel_count, k, p, gTestFastRelaxed );
+}
+
+int MakeKernelsRelaxed( const char **c, cl_uint count, const char *name, cl_uint kernel_count, cl_kernel *k, cl_program *p, int relaxed )
 {
     int error = 0;
     cl_uint i;
@@ -1347,7 +1676,7 @@ int MakeKernels( const char **c, cl_uint count, const char *name, cl_uint kernel
       strcat(options," -cl-fp32-correctly-rounded-divide-sqrt ");
     }
 
-    if( gTestFastRelaxed )
+    if( relaxed )
     {
       strcat(options, " -cl-fast-relaxed-math");
     }
@@ -1501,6 +1830,10 @@ uint64_t GetTime( void )
     return mach_absolute_time();
 #elif defined(_WIN32) && defined(_MSC_VER)
     return  ReadTime();
+#elif defined( __linux__ )
+    struct timespec t;
+    clock_gettime( CLOCK_MONOTONIC, &t );
+    return (uint64_t) t.tv_sec * 1000000000ULL + (uint64_t) t.tv_nsec;
 #else
     //mach_absolute_time is a high precision timer with precision < 1 microsecond.
     #warning need accurate clock here.  Times are invalid.
@@ -1524,6 +1857,8 @@ double SubtractTime( uint64_t endTime, uint64_t startTime )
         kern_return_t   err = mach_timebase_info( &info );
         if( 0 == err )
             conversion = 1e-9 * (double) info.numer / (double) info.denom;
+#elif defined( __linux__ )
+        conversion = 1e-9;      // GetTime() returns nanoseconds
 #else
     // This function consumes output from GetTime() above, and converts the time to secionds.
     #warning need accurate ticks to seconds conversion factor here. Times are invalid.
@@ -30,6 +30,15 @@
     #include <emmintrin.h>
 #endif
 
+// The batch references only use SIMD where the scalar reference is a single correctly rounded
+// IEEE operation done in the same registers, so that the results stay bit identical.
+#if (defined( __SSE2__ ) && (defined( __x86_64__ ) || defined( __SSE2_MATH__ ))) || (defined( _MSC_VER ) && defined(_M_X64))
+    #define REFERENCE_BATCH_SSE2    1
+#elif defined( __aarch64__ ) && defined( __ARM_NEON )
+    #include <arm_neon.h>
+    #define REFERENCE_BATCH_NEON    1
+#endif
+
 #ifndef M_PI_4
     #define M_PI_4 (M_PI/4)
 #endif
@@ -1884,6 +1893,186 @@ int reference_not( double x )
   return r;
 }
 
+#pragma mark -
+#pragma mark Batch references
+
+// Functions whose reference is built from libm calls and argument reduction have no SIMD path here.
+// Their batch versions just save the per element indirect call. Vectorizing them would change the
+// rounding of intermediate results, so the batch and scalar results would no longer match.
+#define REFERENCE_BATCH_LOOP_D_D( _name )                                   \
+    void reference_##_name##_batch( const double *x, double *r, size_t count ) \
+    {                                                                       \
+        size_t i;                                                           \
+        for( i = 0; i < count; i++ )                                        \
+            r[i] = reference_##_name( x[i] );                               \
+    }
+
+REFERENCE_BATCH_LOOP_D_D( sin )
+REFERENCE_BATCH_LOOP_D_D( cos )
+REFERENCE_BATCH_LOOP_D_D( exp )
+REFERENCE_BATCH_LOOP_D_D( log )
+
+void reference_pow_batch( const double *x, const double *y, double *r, size_t count )
+{
+    size_t i;
+    for( i = 0; i < count; i++ )
+        r[i] = reference_pow( x[i], y[i] );
+}
+
+void reference_sqrt_batch( const double *x, double *r, size_t count )
+{
+    size_t i = 0;
+#if defined( REFERENCE_BATCH_SSE2 )
+    for( ; i + 2 <= count; i += 2 )
+        _mm_storeu_pd( r + i, _mm_sqrt_pd( _mm_loadu_pd( x + i ) ) );
+#elif defined( REFERENCE_BATCH_NEON )
+    for( ; i + 2 <= count; i += 2 )
+        vst1q_f64( r + i, vsqrtq_f64( vld1q_f64( x + i ) ) );
+#endif
+    for( ; i < count; i++ )
+        r[i] = reference_sqrt( x[i] );
+}
+
+void reference_divide_batch( const double *x, const double *y, double *r, size_t count )
+{
+    size_t i = 0;
+#if defined( REFERENCE_BATCH_SSE2 )
+    for( ; i + 2 <= count; i += 2 )
+        _mm_storeu_pd( r + i, _mm_div_pd( _mm_loadu_pd( x + i ), _mm_loadu_pd( y + i ) ) );
+#elif defined( REFERENCE_BATCH_NEON )
+    for( ; i + 2 <= count; i += 2 )
+        vst1q_f64( r + i, vdivq_f64( vld1q_f64( x + i ), vld1q_f64( y + i ) ) );
+#endif
+    for( ; i < count; i++ )
+        r[i] = reference_divide( x[i], y[i] );
+}
+
+void reference_rsqrt_batch( const double *x, double *r, size_t count )
+{
+    size_t i = 0;
+#if defined( REFERENCE_BATCH_SSE2 )
+    const __m128d one = _mm_set1_pd( 1.0 );
+    for( ; i + 2 <= count; i += 2 )
+        _mm_storeu_pd( r + i, _mm_div_pd( one, _mm_sqrt_pd( _mm_loadu_pd( x + i ) ) ) );
+#elif defined( REFERENCE_BATCH_NEON )
+    const float64x2_t one = vdupq_n_f64( 1.0 );
+    for( ; i + 2 <= count; i += 2 )
+        vst1q_f64( r + i, vdivq_f64( one, vsqrtq_f64( vld1q_f64( x + i ) ) ) );
+#endif
+    for( ; i < count; i++ )
+        r[i] = reference_rsqrt( x[i] );
+}
+
+// reference_add, reference_subtract and reference_multiply round both operands to float and do the
+// operation in single precision, in SSE registers on x86 so x87 does not get in the way.
+#if defined( REFERENCE_BATCH_SSE2 )
+    #define REFERENCE_BATCH_FLOAT_OP( _name, _sse, _neon )                                          \
+    void reference_##_name##_batch( const double *x, const double *y, double *r, size_t count )     \
+    {                                                                                               \
+        size_t i = 0;                                                                               \
+        for( ; i + 2 <= count; i += 2 )                                                             \
+        {                                                                                           \
+            __m128 a = _mm_cvtpd_ps( _mm_loadu_pd( x + i ) );                                       \
+            __m128 b = _mm_cvtpd_ps( _mm_loadu_pd( y + i ) );                                       \
+            _mm_storeu_pd( r + i, _mm_cvtps_pd( _sse( a, b ) ) );                                   \
+        }                                                                                           \
+        for( ; i < count; i++ )                                                                     \
+            r[i] = reference_##_name( x[i], y[i] );                                                 \
+    }
+#elif defined( REFERENCE_BATCH_NEON )
+    #define REFERENCE_BATCH_FLOAT_OP( _name, _sse, _neon )                                          \
+    void reference_##_name##_batch( const double *x, const double *y, double *r, size_t count )     \
+    {                                                                                               \
+        size_t i = 0;                                                                               \
+        for( ; i + 2 <= count; i += 2 )                                                             \
+        {                                                                                           \
+            float32x2_t a = vcvt_f32_f64( vld1q_f64( x + i ) );                                     \
+            float32x2_t b = vcvt_f32_f64( vld1q_f64( y + i ) );                                     \
+            vst1q_f64( r + i, vcvt_f64_f32( _neon( a, b ) ) );                                      \
+        }                                                                                           \
+        for( ; i < count; i++ )                                                                     \
+            r[i] = reference_##_name( x[i], y[i] );                                                 \
+    }
+#else
+    #define REFERENCE_BATCH_FLOAT_OP( _name, _sse, _neon )                                          \
+    void reference_##_name##_batch( const double *x, const double *y, double *r, size_t count )     \
+    {                                                                                               \
+        size_t i;                                                                                   \
+        for( i = 0; i < count; i++ )                                                                \
+            r[i] = reference_##_name( x[i], y[i] );                                                 \
+    }
+#endif
+
+REFERENCE_BATCH_FLOAT_OP( add, _mm_add_ps, vadd_f32 )
+REFERENCE_BATCH_FLOAT_OP( subtract, _mm_sub_ps, vsub_f32 )
+REFERENCE_BATCH_FLOAT_OP( multiply, _mm_mul_ps, vmul_f32 )
+
+// reference_fma is a software fma, since the host fma may not be correctly rounded or may flush denormals
+void reference_fma_batch( const float *a, const float *b, const float *c, float *r, size_t count, int shouldFlush )
+{
+    size_t i;
+    for( i = 0; i < count; i++ )
+        r[i] = reference_fma( a[i], b[i], c[i], shouldFlush );
+}
+
+reference_batch_d_d reference_batch_for_d_d( double (*f)( double ) )
+{
+    if( f == reference_sin )    return reference_sin_batch;
+    if( f == reference_cos )    return reference_cos_batch;
+    if( f == reference_exp )    return reference_exp_batch;
+    if( f == reference_log )    return reference_log_batch;
+    if( f == reference_sqrt )   return reference_sqrt_batch;
+    if( f == reference_rsqrt )  return reference_rsqrt_batch;
+    return NULL;
+}
+
+reference_batch_dd_d reference_batch_for_dd_d( double (*f)( double, double ) )
+{
+    if( f == reference_pow )    return reference_pow_batch;
+    if( f == reference_divide ) return reference_divide_batch;
+    if( f == reference_add )    return reference_add_batch;
+    if( f == reference_subtract ) return reference_subtract_batch;
+    if( f == reference_multiply ) return reference_multiply_batch;
+    return NULL;
+}
+
+#define REFERENCE_BATCH_CHUNK   256
+
+void reference_batch_float_d_d( reference_batch_d_d f, const float *x, float *r, size_t count )
+{
+    double in[ REFERENCE_BATCH_CHUNK ], out[ REFERENCE_BATCH_CHUNK ];
+    size_t i, j, n;
+
+    for( i = 0; i < count; i += n )
+    {
+        n = count - i < REFERENCE_BATCH_CHUNK ? count - i : REFERENCE_BATCH_CHUNK;
+        for( j = 0; j < n; j++ )
+            in[j] = x[i + j];
+        f( in, out, n );
+        for( j = 0; j < n; j++ )
+            r[i + j] = (float) out[j];
+    }
+}
+
+void reference_batch_float_dd_d( reference_batch_dd_d f, const float *x, const float *y, float *r, size_t count )
+{
+    double in[ REFERENCE_BATCH_CHUNK ], in2[ REFERENCE_BATCH_CHUNK ], out[ REFERENCE_BATCH_CHUNK ];
+    size_t i, j, n;
+
+    for( i = 0; i < count; i += n )
+    {
+        n = count - i < REFERENCE_BATCH_CHUNK ? count - i : REFERENCE_BATCH_CHUNK;
+        for( j = 0; j < n; j++ )
+        {
+            in[j] = x[i + j];
+            in2[j] = y[i + j];
+        }
+        f( in, in2, out, n );
+        for( j = 0; j < n; j++ )
+            r[i + j] = (float) out[j];
+    }
+}
+
 #pragma mark -
 #pragma mark Double testing
 
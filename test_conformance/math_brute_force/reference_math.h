@@ -22,6 +22,10 @@
     #include <CL/cl.h>
 #endif
 
+// Version of the reference functions. Bump it whenever a change here or in reference_math.c changes any
+// result, so that stored reference results (see ReferenceStore.h) are rebuilt.
+#define kReferenceMathVersion   1
+
 // --  for testing float --
 double reference_sinh( double x );
 double reference_sqrt( double x );
@@ -131,6 +135,33 @@ double reference_relaxed_log2( double x );
 double reference_relaxed_pow( double x, double y);
 double reference_relaxed_reciprocal( double x );
 
+// -- batch versions of the float references: r[i] = reference_xxx( x[i] ) for i < count --
+// Results are bit identical to calling the scalar function on each element. sqrt, rsqrt, divide,
+// add, subtract and multiply use SSE2 or NEON; the others loop over the scalar reference.
+void reference_sin_batch( const double *x, double *r, size_t count );
+void reference_cos_batch( const double *x, double *r, size_t count );
+void reference_exp_batch( const double *x, double *r, size_t count );
+void reference_log_batch( const double *x, double *r, size_t count );
+void reference_sqrt_batch( const double *x, double *r, size_t count );
+void reference_rsqrt_batch( const double *x, double *r, size_t count );
+void reference_pow_batch( const double *x, const double *y, double *r, size_t count );
+void reference_divide_batch( const double *x, const double *y, double *r, size_t count );
+void reference_add_batch( const double *x, const double *y, double *r, size_t count );
+void reference_subtract_batch( const double *x, const double *y, double *r, size_t count );
+void reference_multiply_batch( const double *x, const double *y, double *r, size_t count );
+void reference_fma_batch( const float *a, const float *b, const float *c, float *r, size_t count, int shouldFlush );
+
+typedef void (*reference_batch_d_d)( const double *, double *, size_t );
+typedef void (*reference_batch_dd_d)( const double *, const double *, double *, size_t );
+
+// Returns the batch version of a scalar reference, or NULL if there is none
+reference_batch_d_d  reference_batch_for_d_d( double (*f)( double ) );
+reference_batch_dd_d reference_batch_for_dd_d( double (*f)( double, double ) );
+
+// Evaluate a batch reference over float inputs, rounding the results to float
+void reference_batch_float_d_d( reference_batch_d_d f, const float *x, float *r, size_t count );
+void reference_batch_float_dd_d( reference_batch_dd_d f, const float *x, const float *y, float *r, size_t count );
+
 // -- for testing double --
 
 long double reference_sinhl( long double x );
@@ -17,6 +17,9 @@
 
 #include <string.h>
 #include "FunctionList.h"
+#include "reference_math.h"
+#include "ReferenceStore.h"
+#include "StratifiedSampling.h"
 
 #if defined( __APPLE__ )
     #include <sys/time.h>
@@ -30,10 +33,17 @@ int TestFunc_Double_Double(const Func *f, MTdata);
 #endif
 const vtbl _unary = { "unary", TestFunc_Float_Float, TestFunc_Double_Double };
 
-static int BuildKernel( const char *name, int vectorSize, cl_uint kernel_count, cl_kernel *k, cl_program *p );
+static int BuildKernel( const char *name, int vectorSize, cl_uint kernel_count, cl_kernel *k, cl_program *p, int generateInputs );
 static int BuildKernelDouble( const char *name, int vectorSize, cl_uint kernel_count, cl_kernel *k, cl_program *p );
 
-static int BuildKernel( const char *name, int vectorSize, cl_uint kernel_count, cl_kernel *k, cl_program *p )
+// With kernel side inputs (-G) lane k of work item i tests the float with the bits base + (i * vector size + k) * scale,
+// the same input the host would have written to in[]
+static const char *laneCounts[ VECTOR_SIZE_COUNT ] = { "1", "2", "3", "4", "8", "16" };
+static const char *laneOffsets[ VECTOR_SIZE_COUNT ] = { "0", "(uint2)(0, 1)", "(uint3)(0, 1, 2)", "(uint4)(0, 1, 2, 3)",
+                                                        "(uint8)(0, 1, 2, 3, 4, 5, 6, 7)",
+                                                        "(uint16)(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)" };
+
+static int BuildKernel( const char *name, int vectorSize, cl_uint kernel_count, cl_kernel *k, cl_program *p, int generateInputs )
 {
     const char *c[] = {
                             "__kernel void math_kernel", sizeNames[vectorSize], "( __global float", sizeNames[vectorSize], "* out, __global float", sizeNames[vectorSize], "* in)\n"
@@ -79,6 +89,37 @@ static int BuildKernel( const char *name, int vectorSize, cl_uint kernel_count,
                         };
 
 
+    const char *g[] = {
+                            "__kernel void math_kernel", sizeNames[vectorSize], "( __global float", sizeNames[vectorSize], "* out, uint base, uint scale)\n"
+                            "{\n"
+                            "   int i = get_global_id(0);\n"
+                            "   uint", sizeNames[vectorSize], " u = (uint", sizeNames[vectorSize], ")( base + (uint) i * ", laneCounts[vectorSize], "u * scale ) + ", laneOffsets[vectorSize], " * scale;\n"
+                            "   out[i] = ", name, "( as_float", sizeNames[vectorSize], "( u ) );\n"
+                            "}\n"
+                        };
+    const char *g3[] = {    "__kernel void math_kernel", sizeNames[vectorSize], "( __global float* out, uint base, uint scale)\n"
+                            "{\n"
+                            "   size_t i = get_global_id(0);\n"
+                            "   uint3 u = (uint3)( base + (uint) i * 3u * scale ) + (uint3)(0, 1, 2) * scale;\n"
+                            "   float3 f0 = ", name, "( as_float3( u ) );\n"
+                            "   if( i + 1 < get_global_size(0) )\n"
+                            "       vstore3( f0, 0, out + 3*i );\n"
+                            "   else\n"
+                            "   {\n"
+                            "       size_t parity = i & 1;   // Figure out how many elements are left over after BUFFER_SIZE % (3*sizeof(float)). Assume power of two buffer size \n"
+                            "       switch( parity )\n"
+                            "       {\n"
+                            "           case 0:\n"
+                            "               out[3*i+1] = f0.y; \n"
+                            "               // fall through\n"
+                            "           case 1:\n"
+                            "               out[3*i] = f0.x; \n"
+                            "               break;\n"
+                            "       }\n"
+                            "   }\n"
+                            "}\n"
+                        };
+
     const char **kern = c;
     size_t kernSize = sizeof(c)/sizeof(c[0]);
 
@@ -88,6 +129,17 @@ static int BuildKernel( const char *name, int vectorSize, cl_uint kernel_count,
         kernSize = sizeof(c3)/sizeof(c3[0]);
     }
 
+    if( generateInputs )
+    {
+        kern = g;
+        kernSize = sizeof(g)/sizeof(g[0]);
+        if( sizeValues[vectorSize] == 3 )
+        {
+            kern = g3;
+            kernSize = sizeof(g3)/sizeof(g3[0]);
+        }
+    }
+
     char testName[32];
     snprintf( testName, sizeof( testName ) -1, "math_kernel%s", sizeNames[vectorSize] );
 
@@ -164,6 +216,7 @@ typedef struct BuildKernelInfo
     cl_kernel   **kernels;
     cl_program  *programs;
     const char  *nameInCode;
+    int         generateInputs;    // float only: the kernels make their own inputs
 }BuildKernelInfo;
 
 static cl_int BuildKernel_FloatFn( cl_uint job_id, cl_uint thread_id UNUSED, void *p );
@@ -171,7 +224,7 @@ static cl_int BuildKernel_FloatFn( cl_uint job_id, cl_uint thread_id UNUSED, voi
 {
     BuildKernelInfo *info = (BuildKernelInfo*) p;
     cl_uint i = info->offset + job_id;
-    return BuildKernel( info->nameInCode, i, info->kernel_count, info->kernels[i], info->programs + i );
+    return BuildKernel( info->nameInCode, i, info->kernel_count, info->kernels[i], info->programs + i, info->generateInputs );
 }
 
 static cl_int BuildKernel_DoubleFn( cl_uint job_id, cl_uint thread_id UNUSED, void *p );
@@ -182,7 +235,7 @@ static cl_int BuildKernel_DoubleFn( cl_uint job_id, cl_uint thread_id UNUSED, vo
     return BuildKernelDouble( info->nameInCode, i, info->kernel_count, info->kernels[i], info->programs + i );
 }
 
-//Thread specific data for a worker thread
+//Thread specific data for a worker thread. In overlapped mode each worker thread owns two of these.
 typedef struct ThreadInfo
 {
     cl_mem      inBuf;                              // input buffer for the thread
@@ -190,6 +243,12 @@ typedef struct ThreadInfo
     float       maxError;                           // max error value. Init to 0.
     double      maxErrorValue;                      // position of the max error value.  Init to 0.
     cl_command_queue tQueue;                        // per thread command queue to improve performance
+    void        *out[ VECTOR_SIZE_COUNT ];          // mapped results of the job in flight
+    cl_event    readEvent;                          // signaled once out[] may be read
+    cl_uint     jobID;                              // job_id of the job in flight
+    int         pending;                            // non-zero if the job in flight has not been verified yet
+    float       *bucketError;                       // stratified mode: largest error in each bucket of inputs
+    cl_uint     jobsRun;                            // stratified mode: number of jobs verified
 }ThreadInfo;
 
 typedef struct TestInfo
@@ -200,6 +259,7 @@ typedef struct TestInfo
     cl_kernel   *k[VECTOR_SIZE_COUNT ];             // arrays of thread-specific kernels for each worker thread:  k[vector_size][thread_id]
     ThreadInfo  *tinfo;                             // An array of thread specific information for each worker thread
     cl_uint     threadCount;                        // Number of worker threads
+    cl_uint     bufferSets;                         // ThreadInfos per worker thread: 2 in overlapped mode, otherwise 1
     cl_uint     step;                               // step between each chunk and the next.
     cl_uint     scale;                              // stride between individual test values
     float       ulps;                               // max_allowed ulps
@@ -207,17 +267,27 @@ typedef struct TestInfo
 
     int         isRangeLimited;                     // 1 if the function is only to be evaluated over a range
     float       half_sin_cos_tan_limit;
+    ReferenceStore *store;                          // stored reference results, NULL if none
+    StratifiedSampler *sampler;                     // source of the inputs in stratified mode, otherwise NULL
+    cl_uint     coverageJobs;                       // stratified mode: jobs that run the coverage set
+    uint64_t    startTime;                          // stratified mode: start of the random jobs' time budget
+    int         generateInputs;                     // non-zero if the kernels make their own inputs instead of reading inBuf
 }TestInfo;
 
 static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *p );
+static cl_int FinishFloat( cl_uint job_id, cl_uint thread_id, void *p );
+static cl_int UnmapResults( ThreadInfo *tinfo );
+static ReferenceStore *OpenReferenceStoreFloat( const TestInfo *job );
 
 int TestFunc_Float_Float(const Func *f, MTdata d)
 {
     TestInfo    test_info;
     cl_int      error;
     size_t      i, j;
+    cl_uint     setCount;
     float       maxError = 0.0f;
     double      maxErrorVal = 0.0;
+    cl_ulong    stratifiedInputs = 0;
     int skipTestingRelaxed = ( gTestFastRelaxed && strcmp(f->name,"tan") == 0 );
 
     logFunctionInfo(f->name,sizeof(cl_float),gTestFastRelaxed);
@@ -225,18 +295,41 @@ int TestFunc_Float_Float(const Func *f, MTdata d)
     // Init test_info
     memset( &test_info, 0, sizeof( test_info ) );
     test_info.threadCount = GetThreadCount();
+    test_info.bufferSets = gOverlapVerification ? 2 : 1;
+    setCount = test_info.threadCount * test_info.bufferSets;
 
-    test_info.subBufferSize = BUFFER_SIZE / (sizeof( cl_float) * RoundUpToNextPowerOfTwo(test_info.threadCount));
+    test_info.subBufferSize = BUFFER_SIZE / (sizeof( cl_float) * RoundUpToNextPowerOfTwo(setCount));
     test_info.scale =  1;
-    if (gWimpyMode)
+    if (gWimpyMode && !gStratifiedSampling)
     {
-        test_info.subBufferSize = gWimpyBufferSize / (sizeof( cl_float) * RoundUpToNextPowerOfTwo(test_info.threadCount));
+        test_info.subBufferSize = gWimpyBufferSize / (sizeof( cl_float) * RoundUpToNextPowerOfTwo(setCount));
         test_info.scale =  (cl_uint) sizeof(cl_float) * 2 * gWimpyReductionFactor;
     }
     test_info.step = (cl_uint) test_info.subBufferSize * test_info.scale;
     test_info.f = f;
     test_info.ulps = gIsEmbedded ? f->float_embedded_ulps : f->float_ulps;
     test_info.ftz = f->ftz || gForceFTZ || 0 == (CL_FP_DENORM & gFloatCapabilities);
+
+    // In stratified mode the jobs take their inputs from the sampler instead of striding over all of them.
+    // The job count stays that of the exhaustive test, but the random jobs stop once the time budget is spent.
+    if( gStratifiedSampling && !gSkipCorrectnessTesting )
+    {
+        char name[128];
+        snprintf( name, sizeof( name ), "%s%s", f->name, gTestFastRelaxed ? "_relaxed" : "" );
+        test_info.sampler = StratifiedSampler_CreateFloat( name, gTestFastRelaxed ? f->relaxed_error : test_info.ulps, genrand_int32( d ) );
+        if( NULL == test_info.sampler )
+        {
+            vlog_error( "Error: Unable to allocate storage for the stratified inputs.\n" );
+            error = CL_OUT_OF_HOST_MEMORY;
+            goto exit;
+        }
+        test_info.coverageJobs = StratifiedSampler_CoverageJobs( test_info.sampler, test_info.subBufferSize );
+    }
+
+    // Kernel side inputs only work for the plain sweep over the inputs. The timing loop
+    // wants other inputs and relaxed math replaces some inputs of sin, cos and reciprocal.
+    test_info.generateInputs = gKernelInputs && NULL == test_info.sampler && !gMeasureTimes &&
+                               !( gTestFastRelaxed && ( 0 == strcmp( f->name, "sin" ) || 0 == strcmp( f->name, "cos" ) || 0 == strcmp( f->name, "reciprocal" ) ) );
     // cl_kernels aren't thread safe, so we make one for each vector size for every thread
     for( i = gMinVectorSizeIndex; i < gMaxVectorSizeIndex; i++ )
     {
@@ -250,17 +343,28 @@ int TestFunc_Float_Float(const Func *f, MTdata d)
         }
         memset( test_info.k[i], 0, array_size );
     }
-    test_info.tinfo = (ThreadInfo*)malloc( test_info.threadCount * sizeof(*test_info.tinfo) );
+    test_info.tinfo = (ThreadInfo*)malloc( setCount * sizeof(*test_info.tinfo) );
     if( NULL == test_info.tinfo )
     {
         vlog_error( "Error: Unable to allocate storage for thread specific data.\n" );
         error = CL_OUT_OF_HOST_MEMORY;
         goto exit;
     }
-    memset( test_info.tinfo, 0, test_info.threadCount * sizeof(*test_info.tinfo) );
-    for( i = 0; i < test_info.threadCount; i++ )
+    memset( test_info.tinfo, 0, setCount * sizeof(*test_info.tinfo) );
+    for( i = 0; i < setCount; i++ )
     {
         cl_buffer_region region = { i * test_info.subBufferSize * sizeof( cl_float), test_info.subBufferSize * sizeof( cl_float) };
+        if( test_info.sampler )
+        {
+            test_info.tinfo[i].bucketError = (float*) calloc( kStratifiedBucketCount, sizeof( float ) );
+            if( NULL == test_info.tinfo[i].bucketError )
+            {
+                vlog_error( "Error: Unable to allocate storage for thread specific data.\n" );
+                error = CL_OUT_OF_HOST_MEMORY;
+                goto exit;
+            }
+        }
+
         test_info.tinfo[i].inBuf = clCreateSubBuffer( gInBuffer, CL_MEM_READ_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &region, &error);
         if( error || NULL == test_info.tinfo[i].inBuf)
         {
@@ -277,11 +381,20 @@ int TestFunc_Float_Float(const Func *f, MTdata d)
                 goto exit;
             }
         }
-        test_info.tinfo[i].tQueue = clCreateCommandQueueWithProperties(gContext, gDevice, 0, &error);
-        if( NULL == test_info.tinfo[i].tQueue || error )
+        // The buffer sets of a thread share its queue, so that they execute in order
+        if( i % test_info.bufferSets )
         {
-            vlog_error( "clCreateCommandQueue failed. (%d)\n", error );
-            goto exit;
+            test_info.tinfo[i].tQueue = test_info.tinfo[i - 1].tQueue;
+            clRetainCommandQueue( test_info.tinfo[i].tQueue );
+        }
+        else
+        {
+            test_info.tinfo[i].tQueue = clCreateCommandQueueWithProperties(gContext, gDevice, 0, &error);
+            if( NULL == test_info.tinfo[i].tQueue || error )
+            {
+                vlog_error( "clCreateCommandQueue failed. (%d)\n", error );
+                goto exit;
+            }
         }
 
     }
@@ -302,17 +415,28 @@ int TestFunc_Float_Float(const Func *f, MTdata d)
 
     // Init the kernels
     {
-        BuildKernelInfo build_info = { gMinVectorSizeIndex, test_info.threadCount, test_info.k, test_info.programs, f->nameInCode };
+        BuildKernelInfo build_info = { gMinVectorSizeIndex, test_info.threadCount, test_info.k, test_info.programs, f->nameInCode, test_info.generateInputs };
         if( (error = ThreadPool_Do( BuildKernel_FloatFn, gMaxVectorSizeIndex - gMinVectorSizeIndex, &build_info ) ))
             goto exit;
     }
 
     if( !gSkipCorrectnessTesting || skipTestingRelaxed)
     {
+        if( !gSkipCorrectnessTesting )
+            test_info.store = OpenReferenceStoreFloat( &test_info );
+
+        test_info.startTime = GetTime();
         error = ThreadPool_Do( TestFloat, (cl_uint) ((1ULL<<32) / test_info.step), &test_info );
 
+        // Verify the jobs still in flight after the last one was launched
+        if( CL_SUCCESS == error && test_info.bufferSets > 1 )
+            error = ThreadPool_Do( FinishFloat, test_info.threadCount, &test_info );
+
+        ReferenceStore_Close( test_info.store );
+        test_info.store = NULL;
+
         // Accumulate the arithmetic errors
-        for( i = 0; i < test_info.threadCount; i++ )
+        for( i = 0; i < setCount; i++ )
         {
             if( test_info.tinfo[i].maxError > maxError )
             {
@@ -321,10 +445,28 @@ int TestFunc_Float_Float(const Func *f, MTdata d)
             }
         }
 
+        // Remember where the largest errors were, failures included, so that the next run looks harder there
+        if( test_info.sampler )
+        {
+            float bucketError[ kStratifiedBucketCount ];
+            for( j = 0; j < kStratifiedBucketCount; j++ )
+            {
+                bucketError[j] = 0.0f;
+                for( i = 0; i < setCount; i++ )
+                    if( test_info.tinfo[i].bucketError[j] > bucketError[j] )
+                        bucketError[j] = test_info.tinfo[i].bucketError[j];
+            }
+            for( i = 0; i < setCount; i++ )
+                stratifiedInputs += (cl_ulong) test_info.tinfo[i].jobsRun * test_info.subBufferSize;
+            StratifiedSampler_Record( test_info.sampler, bucketError );
+        }
+
         if( error )
             goto exit;
 
-        if( gWimpyMode )
+        if( test_info.sampler )
+            vlog( "Stratified pass (%llu inputs)", (unsigned long long) stratifiedInputs );
+        else if( gWimpyMode )
             vlog( "Wimp pass" );
         else
             vlog( "passed" );
@@ -401,6 +543,8 @@ int TestFunc_Float_Float(const Func *f, MTdata d)
     vlog( "\n" );
 
 exit:
+    ReferenceStore_Close( test_info.store );
+    StratifiedSampler_Release( test_info.sampler );
     for( i = gMinVectorSizeIndex; i < gMaxVectorSizeIndex; i++ )
     {
         clReleaseProgram(test_info.programs[i]);
@@ -414,8 +558,11 @@ exit:
     }
     if( test_info.tinfo )
     {
-        for( i = 0; i < test_info.threadCount; i++ )
+        for( i = 0; i < setCount; i++ )
         {
+            if( test_info.tinfo[i].pending )
+                UnmapResults( test_info.tinfo + i );
+            free( test_info.tinfo[i].bucketError );
             clReleaseMemObject(test_info.tinfo[i].inBuf);
             for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
                 clReleaseMemObject(test_info.tinfo[i].outBuf[j]);
@@ -428,30 +575,111 @@ exit:
     return error;
 }
 
+static cl_int EnqueueFloat( const TestInfo *job, cl_uint job_id, cl_uint thread_id, ThreadInfo *tinfo );
+static cl_int VerifyFloat( const TestInfo *job, ThreadInfo *tinfo );
+
 static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data )
 {
     const TestInfo *job = (const TestInfo *) data;
+    ThreadInfo *tinfo = job->tinfo + thread_id * job->bufferSets;
+    ThreadInfo *prev = NULL;
+    cl_int error;
+
+    // In stratified mode the random jobs have nothing to do once the time budget is spent
+    if( job->sampler && job_id >= job->coverageJobs && SubtractTime( GetTime(), job->startTime ) > gStratifiedBudget )
+        return CL_SUCCESS;
+
+    // In overlapped mode, launch this job in whichever buffer set is free and
+    // verify the job left in flight in the other one by the previous call
+    // while the device works on this one.
+    if( job->bufferSets > 1 )
+    {
+        if( tinfo->pending )
+            prev = tinfo++;
+        else if( tinfo[1].pending )
+            prev = tinfo + 1;
+    }
+
+    if( (error = EnqueueFloat( job, job_id, thread_id, tinfo )) )
+        return error;
+
+    if( job->bufferSets > 1 )
+        return prev ? VerifyFloat( job, prev ) : CL_SUCCESS;
+
+    return VerifyFloat( job, tinfo );
+}
+
+// Verify the jobs TestFloat left in flight in overlapped mode. job_id is the worker thread that owns them.
+static cl_int FinishFloat( cl_uint job_id, cl_uint thread_id UNUSED, void *data )
+{
+    const TestInfo *job = (const TestInfo *) data;
+    ThreadInfo *tinfo = job->tinfo + job_id * job->bufferSets;
+    cl_uint i;
+    cl_int error;
+
+    for( i = 0; i < job->bufferSets; i++ )
+        if( tinfo[i].pending && (error = VerifyFloat( job, tinfo + i )) )
+            return error;
+
+    return CL_SUCCESS;
+}
+
+static cl_int UnmapResults( ThreadInfo *tinfo )
+{
+    cl_uint j;
+    cl_int error;
+
+    for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
+    {
+        if( (error = clEnqueueUnmapMemObject( tinfo->tQueue, tinfo->outBuf[j], tinfo->out[j], 0, NULL, NULL)) )
+        {
+            vlog_error( "Error: clEnqueueUnmapMemObject %d failed 2! err: %d\n", j, error );
+            return error;
+        }
+    }
+
+    if( tinfo->readEvent )
+    {
+        clReleaseEvent( tinfo->readEvent );
+        tinfo->readEvent = NULL;
+    }
+    tinfo->pending = 0;
+
+    return CL_SUCCESS;
+}
+
+// Open the reference store for job, see ReferenceStore.h. The results depend on the version of the
+// reference code, on the inputs, which are set by the scale and relaxed math, and on the mode. The ulp
+// bound doesn't change them and is kept as metadata.
+static ReferenceStore *OpenReferenceStoreFloat( const TestInfo *job )
+{
+    float   ulps = gTestFastRelaxed ? job->f->relaxed_error : job->ulps;
+    cl_ulong count = (1ULL << 32) / job->scale;
+    char    key[512];
+    char    metadata[64];
+
+    if( NULL == gReferenceStorePath || job->sampler || job->subBufferSize % kReferenceStoreChunk || count > SIZE_MAX )
+        return NULL;
+
+    sprintf( key, "function: %s\ntype: float\nreference: %d\nscale: %u\nftz: %d\nrelaxed: %d\n",
+             job->f->name, kReferenceMathVersion, job->scale, job->ftz, gTestFastRelaxed );
+    sprintf( metadata, "ulps: %a\n", ulps );
+
+    return ReferenceStore_Open( job->f->name, key, metadata, (size_t) count, sizeof( cl_float ) );
+}
+
+// Fill the input buffer of tinfo for job_id, run the kernels and start reading back the results
+static cl_int EnqueueFloat( const TestInfo *job, cl_uint job_id, cl_uint thread_id, ThreadInfo *tinfo )
+{
     size_t  buffer_elements = job->subBufferSize;
     size_t  buffer_size = buffer_elements * sizeof( cl_float );
+    size_t  set = tinfo - job->tinfo;
     cl_uint scale = job->scale;
     cl_uint base = job_id * (cl_uint) job->step;
-    ThreadInfo *tinfo = job->tinfo + thread_id;
-    float   ulps = job->ulps;
-    fptr    func = job->f->func;
     const char * fname = job->f->name;
-    if ( gTestFastRelaxed  )
-    {
-        ulps = job->f->relaxed_error;
-        func = job->f->rfunc;
-    }
-
-    cl_uint j, k;
+    cl_uint j;
     cl_int error;
 
-    int isRangeLimited = job->isRangeLimited;
-    float half_sin_cos_tan_limit = job->half_sin_cos_tan_limit;
-    int ftz = job->ftz;
-
     // start the map of the output arrays
     cl_event e[ VECTOR_SIZE_COUNT ];
     cl_uint  *out[ VECTOR_SIZE_COUNT ];
@@ -469,11 +697,14 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data )
     if( (error = clFlush(tinfo->tQueue) ))
         vlog( "clFlush failed\n" );
 
-    // Write the new values to the input array
-    cl_uint *p = (cl_uint*) gIn + thread_id * buffer_elements;
-    for( j = 0; j < buffer_elements; j++ )
+    // Write the new values to the input array, unless the kernels make them up themselves
+    cl_uint *p = (cl_uint*) gIn + set * buffer_elements;
+    if( job->sampler )
+        StratifiedSampler_Fill( job->sampler, job_id, p, buffer_elements );
+    for( j = 0; j < buffer_elements && !job->generateInputs; j++ )
     {
-      p[j] = base + j * scale;
+      if( NULL == job->sampler )
+          p[j] = base + j * scale;
       if( gTestFastRelaxed )
       {
         float p_j = *(float *) &p[j];
@@ -491,7 +722,7 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data )
       }
     }
 
-    if( (error = clEnqueueWriteBuffer( tinfo->tQueue, tinfo->inBuf, CL_FALSE, 0, buffer_size, p, 0, NULL, NULL) ))
+    if( !job->generateInputs && (error = clEnqueueWriteBuffer( tinfo->tQueue, tinfo->inBuf, CL_FALSE, 0, buffer_size, p, 0, NULL, NULL) ))
     {
         vlog_error( "Error: clEnqueueWriteBuffer failed! err: %d\n", error );
         return error;
@@ -526,7 +757,12 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data )
         cl_program program = job->programs[j];
 
         if( ( error = clSetKernelArg( kernel, 0, sizeof( tinfo->outBuf[j] ), &tinfo->outBuf[j] ))){ LogBuildError(program); return error; }
-        if( ( error = clSetKernelArg( kernel, 1, sizeof( tinfo->inBuf ), &tinfo->inBuf ) )) { LogBuildError(program); return error; }
+        if( job->generateInputs )
+        {
+            if( ( error = clSetKernelArg( kernel, 1, sizeof( base ), &base ) )) { LogBuildError(program); return error; }
+            if( ( error = clSetKernelArg( kernel, 2, sizeof( scale ), &scale ) )) { LogBuildError(program); return error; }
+        }
+        else if( ( error = clSetKernelArg( kernel, 1, sizeof( tinfo->inBuf ), &tinfo->inBuf ) )) { LogBuildError(program); return error; }
 
         if( (error = clEnqueueNDRangeKernel(tinfo->tQueue, kernel, 1, NULL, &vectorCount, NULL, 0, NULL, NULL)))
         {
@@ -534,36 +770,96 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data )
             return error;
         }
     }
-
+    // Read the data back -- no need to wait for the first N-1 buffers. This is an in order queue.
+    // The map of the last one signals readEvent once everything is done.
+    for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
+    {
+        cl_event *readEvent = j + 1 < gMaxVectorSizeIndex ? NULL : &tinfo->readEvent;
+        tinfo->out[j] = clEnqueueMapBuffer( tinfo->tQueue, tinfo->outBuf[j], CL_FALSE, CL_MAP_READ, 0, buffer_size, 0, NULL, readEvent, &error);
+        if( error || NULL == tinfo->out[j] )
+        {
+            vlog_error( "Error: clEnqueueMapBuffer %d failed! err: %d\n", j, error );
+            return error;
+        }
+    }
+    tinfo->jobID = job_id;
+    tinfo->pending = 1;
 
     // Get that moving
     if( (error = clFlush(tinfo->tQueue) ))
         vlog( "clFlush 2 failed\n" );
 
-    if( gSkipCorrectnessTesting )
-        return CL_SUCCESS;
+    return CL_SUCCESS;
+}
 
-    //Calculate the correctly rounded reference result
-    float *r = (float *)gOut_Ref + thread_id * buffer_elements;
-    float *s = (float *)p;
-    for( j = 0; j < buffer_elements; j++ )
-        r[j] = (float) func.f_f( s[j] );
+#define kReferenceChunk     4096        // inputs per chunk of reference results
 
-    // Read the data back -- no need to wait for the first N-1 buffers. This is an in order queue.
-    for( j = gMinVectorSizeIndex; j + 1 < gMaxVectorSizeIndex; j++ )
+// Compute the reference results for the job in flight in tinfo and check the device results against them
+static cl_int VerifyFloat( const TestInfo *job, ThreadInfo *tinfo )
+{
+    size_t  buffer_elements = job->subBufferSize;
+    size_t  set = tinfo - job->tinfo;
+    cl_uint base = tinfo->jobID * (cl_uint) job->step;
+    float   ulps = job->ulps;
+    fptr    func = job->f->func;
+    const char * fname = job->f->name;
+    if ( gTestFastRelaxed  )
     {
-        out[j] = (uint32_t*) clEnqueueMapBuffer( tinfo->tQueue, tinfo->outBuf[j], CL_FALSE, CL_MAP_READ, 0, buffer_size, 0, NULL, NULL, &error);
-        if( error || NULL == out[j] )
-        {
-            vlog_error( "Error: clEnqueueMapBuffer %d failed! err: %d\n", j, error );
-            return error;
-        }
+        ulps = job->f->relaxed_error;
+        func = job->f->rfunc;
     }
+
+    cl_uint j, k;
+    cl_int error;
+    cl_uint **out = (cl_uint **) tinfo->out;
+
+    int isRangeLimited = job->isRangeLimited;
+    float half_sin_cos_tan_limit = job->half_sin_cos_tan_limit;
+    int ftz = job->ftz;
+
+    if( gSkipCorrectnessTesting )
+        return UnmapResults( tinfo );
+
+    //Calculate the correctly rounded reference result, unless it is in the reference store.
+    //The store holds the result for every tested input in order, so this job's results start at base / scale.
+    float *r = (float *)gOut_Ref + set * buffer_elements;
+    float *s = (float *)gIn + set * buffer_elements;
+    size_t storeIndex = base / job->scale;
+    float *stored = job->store ? (float *) ReferenceStore_Lookup( job->store, storeIndex, buffer_elements ) : NULL;
+    float *reserved = NULL;
+    reference_batch_d_d batch = reference_batch_for_d_d( func.f_f );
+    if( stored )
+        r = stored;
+    else if( job->store && (reserved = (float *) ReferenceStore_Reserve( job->store, storeIndex, buffer_elements )) )
+        r = reserved;
+
+    // With kernel side inputs no one has written the inputs yet. Make them here a chunk at a time,
+    // so that the reference is computed from inputs that are still in the cache.
+    for( j = 0; j < buffer_elements; j += kReferenceChunk )
+    {
+        cl_uint n = buffer_elements - j < kReferenceChunk ? (cl_uint)( buffer_elements - j ) : kReferenceChunk;
+
+        if( job->generateInputs )
+            for( k = 0; k < n; k++ )
+                ((cl_uint*) s)[j + k] = base + (j + k) * job->scale;
+
+        if( stored )
+            continue;
+
+        if( batch )
+            reference_batch_float_d_d( batch, s + j, r + j, n );
+        else
+            for( k = 0; k < n; k++ )
+                r[j + k] = (float) func.f_f( s[j + k] );
+    }
+
+    if( reserved )
+        ReferenceStore_Commit( job->store, storeIndex, buffer_elements );
+
     // Wait for the last buffer
-    out[j] = (uint32_t*) clEnqueueMapBuffer( tinfo->tQueue, tinfo->outBuf[j], CL_TRUE, CL_MAP_READ, 0, buffer_size, 0, NULL, NULL, &error);
-    if( error || NULL == out[j] )
+    if( (error = clWaitForEvents( 1, &tinfo->readEvent ) ))
     {
-        vlog_error( "Error: clEnqueueMapBuffer %d failed! err: %d\n", j, error );
+        vlog_error( "Error: clWaitForEvents failed! err: %d\n", error );
         return error;
     }
 
@@ -571,6 +867,11 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data )
     uint32_t *t = (uint32_t *)r;
     for( j = 0; j < buffer_elements; j++ )
     {
+        // Skip ahead to the next result that is not bitwise identical to the reference
+        j = (cl_uint) FindMismatch32( t, out, gMinVectorSizeIndex, gMaxVectorSizeIndex, j, buffer_elements );
+        if( j == buffer_elements )
+            break;
+
         for( k = gMinVectorSizeIndex; k < gMaxVectorSizeIndex; k++ )
         {
             uint32_t *q = out[k];
@@ -725,6 +1026,12 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data )
                     tinfo->maxError = fabsf(err);
                     tinfo->maxErrorValue = s[j];
                 }
+                if( tinfo->bucketError )
+                {
+                    float *bucket = tinfo->bucketError + StratifiedBucketFloat( ((cl_uint*) s)[j] );
+                    if( fabsf( err ) > *bucket )
+                        *bucket = fabsf( err );
+                }
                 if( fail )
                 {
                     vlog_error( "\nERROR: %s%s: %f ulp error at %a (0x%8.8x): *%a vs. %a\n", job->f->name, sizeNames[k], err, ((float*) s)[j], ((uint32_t*) s)[j], ((float*) t)[j], test);
@@ -734,18 +1041,14 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data )
         }
     }
 
-    for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
-    {
-        if( (error = clEnqueueUnmapMemObject( tinfo->tQueue, tinfo->outBuf[j], out[j], 0, NULL, NULL)) )
-        {
-            vlog_error( "Error: clEnqueueUnmapMemObject %d failed 2! err: %d\n", j, error );
-            return error;
-        }
-    }
+    if( (error = UnmapResults( tinfo )) )
+        return error;
 
     if( (error = clFlush(tinfo->tQueue) ))
         vlog( "clFlush 3 failed\n" );
 
+    tinfo->jobsRun++;
+
 
     if( 0 == ( base & 0x0fffffff) )
     {
@@ -764,21 +1067,57 @@ static cl_int TestFloat( cl_uint job_id, cl_uint thread_id, void *data )
 
 
 
+static cl_int EnqueueDouble( const TestInfo *job, cl_uint job_id, cl_uint thread_id, ThreadInfo *tinfo );
+static cl_int VerifyDouble( const TestInfo *job, ThreadInfo *tinfo );
+
 static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
 {
     const TestInfo *job = (const TestInfo *) data;
+    ThreadInfo *tinfo = job->tinfo + thread_id * job->bufferSets;
+    ThreadInfo *prev = NULL;
+    cl_int error;
+
+    // See TestFloat
+    if( job->bufferSets > 1 )
+    {
+        if( tinfo->pending )
+            prev = tinfo++;
+        else if( tinfo[1].pending )
+            prev = tinfo + 1;
+    }
+
+    if( (error = EnqueueDouble( job, job_id, thread_id, tinfo )) )
+        return error;
+
+    if( job->bufferSets > 1 )
+        return prev ? VerifyDouble( job, prev ) : CL_SUCCESS;
+
+    return VerifyDouble( job, tinfo );
+}
+
+static cl_int FinishDouble( cl_uint job_id, cl_uint thread_id UNUSED, void *data )
+{
+    const TestInfo *job = (const TestInfo *) data;
+    ThreadInfo *tinfo = job->tinfo + job_id * job->bufferSets;
+    cl_uint i;
+    cl_int error;
+
+    for( i = 0; i < job->bufferSets; i++ )
+        if( tinfo[i].pending && (error = VerifyDouble( job, tinfo + i )) )
+            return error;
+
+    return CL_SUCCESS;
+}
+
+static cl_int EnqueueDouble( const TestInfo *job, cl_uint job_id, cl_uint thread_id, ThreadInfo *tinfo )
+{
     size_t  buffer_elements = job->subBufferSize;
     size_t  buffer_size = buffer_elements * sizeof( cl_double );
+    size_t  set = tinfo - job->tinfo;
     cl_uint scale = job->scale;
     cl_uint base = job_id * (cl_uint) job->step;
-    ThreadInfo *tinfo = job->tinfo + thread_id;
-    float   ulps = job->ulps;
-    dptr    func = job->f->dfunc;
-    cl_uint j, k;
+    cl_uint j;
     cl_int error;
-    int ftz = job->ftz;
-
-    Force64BitFPUPrecision();
 
     // start the map of the output arrays
     cl_event e[ VECTOR_SIZE_COUNT ];
@@ -798,7 +1137,7 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
         vlog( "clFlush failed\n" );
 
     // Write the new values to the input array
-    cl_double *p = (cl_double*) gIn + thread_id * buffer_elements;
+    cl_double *p = (cl_double*) gIn + set * buffer_elements;
     for( j = 0; j < buffer_elements; j++ )
         p[j] = DoubleFromUInt32( base + j * scale);
 
@@ -845,36 +1184,55 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
             return error;
         }
     }
-
+    // Read the data back -- no need to wait for the first N-1 buffers. This is an in order queue.
+    // The map of the last one signals readEvent once everything is done.
+    for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
+    {
+        cl_event *readEvent = j + 1 < gMaxVectorSizeIndex ? NULL : &tinfo->readEvent;
+        tinfo->out[j] = clEnqueueMapBuffer( tinfo->tQueue, tinfo->outBuf[j], CL_FALSE, CL_MAP_READ, 0, buffer_size, 0, NULL, readEvent, &error);
+        if( error || NULL == tinfo->out[j] )
+        {
+            vlog_error( "Error: clEnqueueMapBuffer %d failed! err: %d\n", j, error );
+            return error;
+        }
+    }
+    tinfo->jobID = job_id;
+    tinfo->pending = 1;
 
     // Get that moving
     if( (error = clFlush(tinfo->tQueue) ))
         vlog( "clFlush 2 failed\n" );
 
+    return CL_SUCCESS;
+}
+
+static cl_int VerifyDouble( const TestInfo *job, ThreadInfo *tinfo )
+{
+    size_t  buffer_elements = job->subBufferSize;
+    size_t  set = tinfo - job->tinfo;
+    cl_uint base = tinfo->jobID * (cl_uint) job->step;
+    float   ulps = job->ulps;
+    dptr    func = job->f->dfunc;
+    cl_uint j, k;
+    cl_int error;
+    cl_ulong **out = (cl_ulong **) tinfo->out;
+    int ftz = job->ftz;
+
+    Force64BitFPUPrecision();
+
     if( gSkipCorrectnessTesting )
-        return CL_SUCCESS;
+        return UnmapResults( tinfo );
 
     //Calculate the correctly rounded reference result
-    cl_double *r = (cl_double *)gOut_Ref + thread_id * buffer_elements;
-    cl_double *s = (cl_double *)p;
+    cl_double *r = (cl_double *)gOut_Ref + set * buffer_elements;
+    cl_double *s = (cl_double *)gIn + set * buffer_elements;
     for( j = 0; j < buffer_elements; j++ )
         r[j] = (cl_double) func.f_f( s[j] );
 
-    // Read the data back -- no need to wait for the first N-1 buffers. This is an in order queue.
-    for( j = gMinVectorSizeIndex; j + 1 < gMaxVectorSizeIndex; j++ )
-    {
-        out[j] = (cl_ulong*) clEnqueueMapBuffer( tinfo->tQueue, tinfo->outBuf[j], CL_FALSE, CL_MAP_READ, 0, buffer_size, 0, NULL, NULL, &error);
-        if( error || NULL == out[j] )
-        {
-            vlog_error( "Error: clEnqueueMapBuffer %d failed! err: %d\n", j, error );
-            return error;
-        }
-    }
     // Wait for the last buffer
-    out[j] = (cl_ulong*) clEnqueueMapBuffer( tinfo->tQueue, tinfo->outBuf[j], CL_TRUE, CL_MAP_READ, 0, buffer_size, 0, NULL, NULL, &error);
-    if( error || NULL == out[j] )
+    if( (error = clWaitForEvents( 1, &tinfo->readEvent ) ))
     {
-        vlog_error( "Error: clEnqueueMapBuffer %d failed! err: %d\n", j, error );
+        vlog_error( "Error: clWaitForEvents failed! err: %d\n", error );
         return error;
     }
 
@@ -883,6 +1241,11 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
     cl_ulong *t = (cl_ulong *)r;
     for( j = 0; j < buffer_elements; j++ )
     {
+        // Skip ahead to the next result that is not bitwise identical to the reference
+        j = (cl_uint) FindMismatch64( t, out, gMinVectorSizeIndex, gMaxVectorSizeIndex, j, buffer_elements );
+        if( j == buffer_elements )
+            break;
+
         for( k = gMinVectorSizeIndex; k < gMaxVectorSizeIndex; k++ )
         {
             cl_ulong *q = out[k];
@@ -944,14 +1307,8 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
         }
     }
 
-    for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
-    {
-        if( (error = clEnqueueUnmapMemObject( tinfo->tQueue, tinfo->outBuf[j], out[j], 0, NULL, NULL)) )
-        {
-            vlog_error( "Error: clEnqueueUnmapMemObject %d failed 2! err: %d\n", j, error );
-            return error;
-        }
-    }
+    if( (error = UnmapResults( tinfo )) )
+        return error;
 
     if( (error = clFlush(tinfo->tQueue) ))
         vlog( "clFlush 3 failed\n" );
@@ -972,11 +1329,14 @@ static cl_int TestDouble( cl_uint job_id, cl_uint thread_id, void *data )
     return CL_SUCCESS;
 }
 
+static cl_int FinishDouble( cl_uint job_id, cl_uint thread_id, void *p );
+
 int TestFunc_Double_Double(const Func *f, MTdata d)
 {
     TestInfo    test_info;
     cl_int      error;
     size_t      i, j;
+    cl_uint     setCount;
     float       maxError = 0.0f;
     double      maxErrorVal = 0.0;
 #if defined( __APPLE__ )
@@ -990,11 +1350,13 @@ int TestFunc_Double_Double(const Func *f, MTdata d)
     // Init test_info
     memset( &test_info, 0, sizeof( test_info ) );
     test_info.threadCount = GetThreadCount();
-    test_info.subBufferSize = BUFFER_SIZE / (sizeof( cl_double) * RoundUpToNextPowerOfTwo(test_info.threadCount));
+    test_info.bufferSets = gOverlapVerification ? 2 : 1;
+    setCount = test_info.threadCount * test_info.bufferSets;
+    test_info.subBufferSize = BUFFER_SIZE / (sizeof( cl_double) * RoundUpToNextPowerOfTwo(setCount));
     test_info.scale =  1;
     if (gWimpyMode)
     {
-        test_info.subBufferSize = gWimpyBufferSize / (sizeof( cl_double) * RoundUpToNextPowerOfTwo(test_info.threadCount));
+        test_info.subBufferSize = gWimpyBufferSize / (sizeof( cl_double) * RoundUpToNextPowerOfTwo(setCount));
         test_info.scale =  (cl_uint) sizeof(cl_double) * 2 * gWimpyReductionFactor;
     }
    test_info.step = (cl_uint) test_info.subBufferSize * test_info.scale;
@@ -1016,15 +1378,15 @@ int TestFunc_Double_Double(const Func *f, MTdata d)
         }
         memset( test_info.k[i], 0, array_size );
     }
-    test_info.tinfo = (ThreadInfo*)malloc( test_info.threadCount * sizeof(*test_info.tinfo) );
+    test_info.tinfo = (ThreadInfo*)malloc( setCount * sizeof(*test_info.tinfo) );
     if( NULL == test_info.tinfo )
     {
         vlog_error( "Error: Unable to allocate storage for thread specific data.\n" );
         error = CL_OUT_OF_HOST_MEMORY;
         goto exit;
     }
-    memset( test_info.tinfo, 0, test_info.threadCount * sizeof(*test_info.tinfo) );
-    for( i = 0; i < test_info.threadCount; i++ )
+    memset( test_info.tinfo, 0, setCount * sizeof(*test_info.tinfo) );
+    for( i = 0; i < setCount; i++ )
     {
         cl_buffer_region region = { i * test_info.subBufferSize * sizeof( cl_double), test_info.subBufferSize * sizeof( cl_double) };
         test_info.tinfo[i].inBuf = clCreateSubBuffer( gInBuffer, CL_MEM_READ_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &region, &error);
@@ -1045,11 +1407,20 @@ int TestFunc_Double_Double(const Func *f, MTdata d)
                 goto exit;
             }
         }
-        test_info.tinfo[i].tQueue = clCreateCommandQueueWithProperties(gContext, gDevice, 0, &error);
-        if( NULL == test_info.tinfo[i].tQueue || error )
+        // The buffer sets of a thread share its queue, so that they execute in order
+        if( i % test_info.bufferSets )
         {
-            vlog_error( "clCreateCommandQueue failed. (%d)\n", error );
-            goto exit;
+            test_info.tinfo[i].tQueue = test_info.tinfo[i - 1].tQueue;
+            clRetainCommandQueue( test_info.tinfo[i].tQueue );
+        }
+        else
+        {
+            test_info.tinfo[i].tQueue = clCreateCommandQueueWithProperties(gContext, gDevice, 0, &error);
+            if( NULL == test_info.tinfo[i].tQueue || error )
+            {
+                vlog_error( "clCreateCommandQueue failed. (%d)\n", error );
+                goto exit;
+            }
         }
     }
 
@@ -1064,8 +1435,12 @@ int TestFunc_Double_Double(const Func *f, MTdata d)
     {
         error = ThreadPool_Do( TestDouble, (cl_uint) ((1ULL<<32) / test_info.step), &test_info );
 
+        // Verify the jobs still in flight after the last one was launched
+        if( CL_SUCCESS == error && test_info.bufferSets > 1 )
+            error = ThreadPool_Do( FinishDouble, test_info.threadCount, &test_info );
+
         // Accumulate the arithmetic errors
-        for( i = 0; i < test_info.threadCount; i++ )
+        for( i = 0; i < setCount; i++ )
         {
             if( test_info.tinfo[i].maxError > maxError )
             {
@@ -1174,8 +1549,10 @@ exit:
     }
     if( test_info.tinfo )
     {
-        for( i = 0; i < test_info.threadCount; i++ )
+        for( i = 0; i < setCount; i++ )
         {
+            if( test_info.tinfo[i].pending )
+                UnmapResults( test_info.tinfo + i );
             clReleaseMemObject(test_info.tinfo[i].inBuf);
             for( j = gMinVectorSizeIndex; j < gMaxVectorSizeIndex; j++ )
                 clReleaseMemObject(test_info.tinfo[i].outBuf[j]);
@@ -23,10 +23,12 @@
 #include <sys/sysctl.h>
 #endif
 #include <unistd.h>
+#include <fcntl.h>
 #define streamDup(fd1) dup(fd1)
 #define streamDup2(fd1,fd2) dup2(fd1,fd2)
 #endif
 #include <limits.h>
+#include <string>
 #include "test_printf.h"
 
 #if defined(_WIN32)
@@ -59,6 +61,26 @@ static void releaseOutputStream(int fd);
 //Get analysis buffer to verify the correctess of printed data
 static void getAnalysisBuffer(char* analysisBuffer);
 
+//Output capture for the batched mode (-b): stdout is redirected into a pipe while a test runs,
+//and what each test printed is read back from it, without going through the filesystem
+struct OutputCapture
+{
+    int savedFd;        // stdout while it isn't captured
+    int readFd;
+    int writeFd;
+};
+
+//Create the pipe, returns -1 on failure
+static int openCapture(OutputCapture* capture);
+static void closeCapture(OutputCapture* capture);
+
+//Redirect stdout into the pipe / restore it
+static void beginCapture(OutputCapture* capture);
+static void endCapture(OutputCapture* capture);
+
+//Get what was printed since the last call, in the same form as getAnalysisBuffer
+static void getCapturedBuffer(OutputCapture* capture, char* analysisBuffer);
+
 //Kernel builder helper functions
 
 //Check if the test case is for kernel that has argument
@@ -73,6 +95,12 @@ static int isKernelPFormat(testCase* pTestCase,size_t testId);
 // Make a program that uses printf for the given type/format,
 static cl_program makePrintfProgram(cl_kernel *kernel_ptr, const cl_context context,const unsigned int testId,const unsigned int testNum,bool isLongSupport = true,bool is64bAddrSpace = false);
 
+// Make a program with a kernel for each selected format of the given type
+static cl_program makeBatchedPrintfProgram(cl_kernel *kernels, const cl_context context, const unsigned int testId, const bool *selected);
+
+// Execute the printf test for the given kernel and type/format
+static int runTest(cl_command_queue queue, cl_context context, cl_kernel kernel, const unsigned int testId, const unsigned int testNum, cl_device_id device, OutputCapture* capture);
+
 // Creates and execute the printf test for the given device, context, type/format
 static int doTest(cl_command_queue queue, cl_context context, const unsigned int testId, const unsigned int testNum, cl_device_id device,bool isLongSupport = true);
 
@@ -145,6 +173,115 @@ static void getAnalysisBuffer(char* analysisBuffer)
     fclose(fp);
 }
 
+#if defined(_WIN32)
+// There are no non-blocking anonymous pipes here, so the capture goes through the file as in the default mode
+
+static int openCapture(OutputCapture* capture)
+{
+    capture->savedFd = capture->readFd = capture->writeFd = -1;
+    return 0;
+}
+
+static void closeCapture(OutputCapture* capture)
+{
+}
+
+static void beginCapture(OutputCapture* capture)
+{
+    capture->savedFd = acquireOutputStream();
+}
+
+static void endCapture(OutputCapture* capture)
+{
+    releaseOutputStream(capture->savedFd);
+}
+
+static void getCapturedBuffer(OutputCapture* capture, char* analysisBuffer)
+{
+    getAnalysisBuffer(analysisBuffer);
+}
+
+#else
+
+//-----------------------------------------
+// openCapture
+//-----------------------------------------
+static int openCapture(OutputCapture* capture)
+{
+    int fds[2];
+    capture->savedFd = capture->readFd = capture->writeFd = -1;
+    if(pipe(fds) != 0)
+    {
+        log_error("Failed to create the output capture pipe ('%s')\n", strerror(errno));
+        return -1;
+    }
+    // Drain without blocking once the test printed all it will print
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    capture->readFd = fds[0];
+    capture->writeFd = fds[1];
+    return 0;
+}
+
+//-----------------------------------------
+// closeCapture
+//-----------------------------------------
+static void closeCapture(OutputCapture* capture)
+{
+    if(capture->readFd >= 0)
+        close(capture->readFd);
+    if(capture->writeFd >= 0)
+        close(capture->writeFd);
+    capture->readFd = capture->writeFd = -1;
+}
+
+//-----------------------------------------
+// beginCapture
+//-----------------------------------------
+static void beginCapture(OutputCapture* capture)
+{
+    fflush(stdout);
+    capture->savedFd = streamDup(fileno(stdout));
+    streamDup2(capture->writeFd, fileno(stdout));
+}
+
+//-----------------------------------------
+// endCapture
+//-----------------------------------------
+static void endCapture(OutputCapture* capture)
+{
+    releaseOutputStream(capture->savedFd);
+}
+
+//-----------------------------------------
+// getCapturedBuffer
+//-----------------------------------------
+static void getCapturedBuffer(OutputCapture* capture, char* analysisBuffer)
+{
+    std::string output;
+    char chunk[4096];
+    ssize_t n;
+    size_t pos = 0;
+
+    fflush(stdout);
+    while((n = read(capture->readFd, chunk, sizeof(chunk))) > 0)
+        output.append(chunk, (size_t)n);
+
+    // Keep the last piece fgets would return, like getAnalysisBuffer does for the file
+    memset(analysisBuffer,0,ANALYSIS_BUFFER_SIZE);
+    while(pos < output.size())
+    {
+        size_t len = output.find('\n', pos);
+        len = (len == std::string::npos ? output.size() : len + 1) - pos;
+        if(len > ANALYSIS_BUFFER_SIZE - 1)
+            len = ANALYSIS_BUFFER_SIZE - 1;
+        memcpy(analysisBuffer, output.data() + pos, len);
+        analysisBuffer[len] = '\0';
+        pos += len;
+    }
+}
+
+#endif
+
 //-----------------------------------------
 // isKernelArgument
 //-----------------------------------------
@@ -196,94 +333,59 @@ int waitForEvent(cl_event* event)
 //-----------------------------------------
 
 //-----------------------------------------
-// makePrintfProgram
+// appendKernelSource
 //-----------------------------------------
-static cl_program makePrintfProgram(cl_kernel *kernel_ptr, const cl_context context,const unsigned int testId,const unsigned int testNum,bool isLongSupport,bool is64bAddrSpace)
+static void appendKernelSource(std::string& source, const char* kernelName, const unsigned int testId, const unsigned int testNum)
 {
-    int err,i;
-    cl_program program;
-    cl_device_id devID;
-    char buildLog[ 1024 * 128 ];
-    char testname[256] = {0};
-    char addrSpaceArgument[256] = {0};
-    char addrSpacePAddArgument[256] = {0};
-
-    //Program Source code for int,float,octal,hexadecimal,char,string
-    const char *sourceGen[] = {
-        "__kernel void ", testname,
-        "(void)\n",
-        "{\n"
-        "   printf(\"",
-        allTestCase[testId]->_genParameters[testNum].genericFormat,
-        "\\n\",",
-        allTestCase[testId]->_genParameters[testNum].dataRepresentation,
-        ");",
-        "}\n"
-    };
-    //Program Source code for vector
-    const char *sourceVec[] = {
-        "__kernel void ", testname,
-        "(void)\n",
-        "{\n",
-        allTestCase[testId]->_genParameters[testNum].dataType,
-        allTestCase[testId]->_genParameters[testNum].vectorSize,
-        " tmp = (",
-        allTestCase[testId]->_genParameters[testNum].dataType,
-        allTestCase[testId]->_genParameters[testNum].vectorSize,
-        ")",
-        allTestCase[testId]->_genParameters[testNum].dataRepresentation,
-        ";",
-        "   printf(\"",
-        allTestCase[testId]->_genParameters[testNum].vectorFormatFlag,
-        "v",
-        allTestCase[testId]->_genParameters[testNum].vectorSize,
-        allTestCase[testId]->_genParameters[testNum].vectorFormatSpecifier,
-        "\\n\",",
-        "tmp);",
-        "}\n"
-    };
-    //Program Source code for address space
-    const char *sourceAddrSpace[] = {
-        "__kernel void ", testname,"(",addrSpaceArgument,
-        ")\n{\n",
-        allTestCase[testId]->_genParameters[testNum].addrSpaceVariableTypeQualifier,
-        "printf(",
-        allTestCase[testId]->_genParameters[testNum].genericFormat,
-        ",",
-        allTestCase[testId]->_genParameters[testNum].addrSpaceParameter,
-        "); ",
-        addrSpacePAddArgument,
-        "\n}\n"
-    };
+    const printDataGenParameters& params = allTestCase[testId]->_genParameters[testNum];
 
-    //Update testname
-    sprintf(testname,"%s%d","test",testId);
-
-    //Update addrSpaceArgument and addrSpacePAddArgument types, based on FULL_PROFILE/EMBEDDED_PROFILE
-    if(allTestCase[testId]->_type == TYPE_ADDRESS_SPACE)
-    {
-        sprintf(addrSpaceArgument, "%s",allTestCase[testId]->_genParameters[testNum].addrSpaceArgumentTypeQualifier);
-
-        sprintf(addrSpacePAddArgument,allTestCase[testId]->_genParameters[testNum].addrSpacePAdd);
-    }
-
-    if (strlen(addrSpaceArgument) == 0)
-        sprintf(addrSpaceArgument,"void");
-
-    // create program based on its type
+    source += "__kernel void ";
+    source += kernelName;
 
     if(allTestCase[testId]->_type == TYPE_VECTOR)
     {
-        err = create_single_kernel_helper(context, &program, NULL, sizeof(sourceVec) / sizeof(sourceVec[0]), sourceVec, NULL);
+        //Program Source code for vector
+        source += "(void)\n{\n";
+        source += std::string(params.dataType) + params.vectorSize + " tmp = (" + params.dataType + params.vectorSize + ")" + params.dataRepresentation + ";";
+        source += std::string("   printf(\"") + params.vectorFormatFlag + "v" + params.vectorSize + params.vectorFormatSpecifier + "\\n\"," + "tmp);";
+        source += "}\n";
     }
     else if(allTestCase[testId]->_type == TYPE_ADDRESS_SPACE)
     {
-        err = create_single_kernel_helper(context, &program, NULL, sizeof(sourceAddrSpace) / sizeof(sourceAddrSpace[0]), sourceAddrSpace, NULL);
+        //Program Source code for address space, its argument types depend on FULL_PROFILE/EMBEDDED_PROFILE
+        source += "(";
+        source += strlen(params.addrSpaceArgumentTypeQualifier) ? params.addrSpaceArgumentTypeQualifier : "void";
+        source += ")\n{\n";
+        source += std::string(params.addrSpaceVariableTypeQualifier) + "printf(" + params.genericFormat + "," + params.addrSpaceParameter + "); ";
+        source += params.addrSpacePAdd;
+        source += "\n}\n";
     }
     else
     {
-        err = create_single_kernel_helper(context, &program, NULL, sizeof(sourceGen) / sizeof(sourceGen[0]), sourceGen, NULL);
+        //Program Source code for int,float,octal,hexadecimal,char,string
+        source += "(void)\n{\n";
+        source += std::string("   printf(\"") + params.genericFormat + "\\n\"," + params.dataRepresentation + ");";
+        source += "}\n";
     }
+}
+
+//-----------------------------------------
+// makePrintfProgram
+//-----------------------------------------
+static cl_program makePrintfProgram(cl_kernel *kernel_ptr, const cl_context context,const unsigned int testId,const unsigned int testNum,bool isLongSupport,bool is64bAddrSpace)
+{
+    int err;
+    cl_program program;
+    char testname[256] = {0};
+    std::string source;
+
+    //Update testname
+    sprintf(testname,"%s%d","test",testId);
+
+    // create program based on its type
+    appendKernelSource(source, testname, testId, testNum);
+    const char* sourceStr = source.c_str();
+    err = create_single_kernel_helper(context, &program, NULL, 1, &sourceStr, NULL);
 
     if (!program || err) {
         log_error("create_single_kernel_helper failed\n");
@@ -299,6 +401,52 @@ static cl_program makePrintfProgram(cl_kernel *kernel_ptr, const cl_context cont
     return program;
 }
 
+//-----------------------------------------
+// makeBatchedPrintfProgram
+//-----------------------------------------
+static cl_program makeBatchedPrintfProgram(cl_kernel *kernels, const cl_context context, const unsigned int testId, const bool *selected)
+{
+    int err;
+    cl_program program;
+    char testname[256];
+    std::string source;
+
+    // One kernel per selected format, all in one program
+    for(unsigned int testNum = 0; testNum < allTestCase[testId]->_testNum; ++testNum)
+    {
+        if(!selected[testNum])
+            continue;
+        sprintf(testname,"test%d_%u",testId,testNum);
+        appendKernelSource(source, testname, testId, testNum);
+    }
+
+    const char* sourceStr = source.c_str();
+    err = create_single_kernel_helper(context, &program, NULL, 1, &sourceStr, NULL);
+    if (!program || err) {
+        log_error("create_single_kernel_helper failed for the %s batch, falling back to one program per test\n", strType[testId]);
+        return NULL;
+    }
+
+    for(unsigned int testNum = 0; testNum < allTestCase[testId]->_testNum; ++testNum)
+    {
+        kernels[testNum] = NULL;
+        if(!selected[testNum])
+            continue;
+        sprintf(testname,"test%d_%u",testId,testNum);
+        kernels[testNum] = clCreateKernel(program, testname, &err);
+        if ( err ) {
+            log_error("clCreateKernel failed (%d)\n", err);
+            while(testNum-- > 0)
+                if(kernels[testNum])
+                    clReleaseKernel(kernels[testNum]);
+            clReleaseProgram(program);
+            return NULL;
+        }
+    }
+
+    return program;
+}
+
 //-----------------------------------------
 // isLongSupported
 //-----------------------------------------
@@ -403,13 +551,11 @@ static bool is64bAddressSpace(cl_device_id  device_id)
         return false;
 }
 //-----------------------------------------
-// doTest
+// runTest
 //-----------------------------------------
-static int doTest(cl_command_queue queue, cl_context context, const unsigned int testId, const unsigned int testNum, cl_device_id device,bool isLongSupport)
+static int runTest(cl_command_queue queue, cl_context context, cl_kernel kernel, const unsigned int testId, const unsigned int testNum, cl_device_id device, OutputCapture* capture)
 {
-    int err;
-    cl_program program;
-    cl_kernel  kernel;
+    int err = CL_SUCCESS;
     cl_mem d_out;
     char _analysisBuffer[ANALYSIS_BUFFER_SIZE];
     cl_uint out32 = 0;
@@ -418,13 +564,6 @@ static int doTest(cl_command_queue queue, cl_context context, const unsigned int
    // Define an index space (global work size) of threads for execution.
    size_t globalWorkSize[1];
 
-    program = makePrintfProgram(&kernel, context,testId,testNum,isLongSupport,is64bAddressSpace(device));
-    if (!program || !kernel) {
-        ++s_test_fail;
-        ++s_test_cnt;
-        return -1;
-    }
-
     //For address space test if there is kernel argument - set it
     if(allTestCase[testId]->_type == TYPE_ADDRESS_SPACE )
     {
@@ -505,7 +644,10 @@ static int doTest(cl_command_queue queue, cl_context context, const unsigned int
     //
     //Get the output printed from the kernel to _analysisBuffer
     //and verify its correctness
-    getAnalysisBuffer(_analysisBuffer);
+    if(capture)
+        getCapturedBuffer(capture, _analysisBuffer);
+    else
+        getAnalysisBuffer(_analysisBuffer);
     if(!is64bAddressSpace(device)) //32-bit address space
     {
         if(0 != verifyOutputBuffer(_analysisBuffer,allTestCase[testId],testNum,(cl_ulong) out32))
@@ -517,6 +659,27 @@ static int doTest(cl_command_queue queue, cl_context context, const unsigned int
             err = ++s_test_fail;
     }
 exit:
+    return err;
+}
+
+//-----------------------------------------
+// doTest
+//-----------------------------------------
+static int doTest(cl_command_queue queue, cl_context context, const unsigned int testId, const unsigned int testNum, cl_device_id device,bool isLongSupport)
+{
+    int err;
+    cl_program program;
+    cl_kernel  kernel = NULL;
+
+    program = makePrintfProgram(&kernel, context,testId,testNum,isLongSupport,is64bAddressSpace(device));
+    if (!program || !kernel) {
+        ++s_test_fail;
+        ++s_test_cnt;
+        return -1;
+    }
+
+    err = runTest(queue, context, kernel, testId, testNum, device, NULL);
+
     if(clReleaseKernel(kernel) != CL_SUCCESS)
         log_error("clReleaseKernel failed\n");
     if(clReleaseProgram(program) != CL_SUCCESS)
@@ -524,14 +687,86 @@ exit:
     ++s_test_cnt;
     return err;
 }
+
+//-----------------------------------------
+// printTestCase
+//-----------------------------------------
+static void printTestCase(const unsigned int testId, const unsigned int testNum)
+{
+    if(allTestCase[testId]->_type == TYPE_VECTOR)
+        log_info("%d)testing printf(\"%sv%s%s\",%s)\n",testNum,allTestCase[testId]->_genParameters[testNum].vectorFormatFlag,allTestCase[testId]->_genParameters[testNum].vectorSize,
+        allTestCase[testId]->_genParameters[testNum].vectorFormatSpecifier,allTestCase[testId]->_genParameters[testNum].dataRepresentation);
+    else if(allTestCase[testId]->_type == TYPE_ADDRESS_SPACE)
+    {
+        if(isKernelArgument(allTestCase[testId], testNum))
+            log_info("%d)testing kernel //argument %s \n   printf(%s,%s)\n",testNum,allTestCase[testId]->_genParameters[testNum].addrSpaceArgumentTypeQualifier,
+            allTestCase[testId]->_genParameters[testNum].genericFormat,allTestCase[testId]->_genParameters[testNum].addrSpaceParameter);
+        else
+            log_info("%d)testing kernel //variable %s \n   printf(%s,%s)\n",testNum,allTestCase[testId]->_genParameters[testNum].addrSpaceVariableTypeQualifier,
+            allTestCase[testId]->_genParameters[testNum].genericFormat,allTestCase[testId]->_genParameters[testNum].addrSpaceParameter);
+    }
+    else
+        log_info("%d)testing printf(\"%s\",%s)\n",testNum,allTestCase[testId]->_genParameters[testNum].genericFormat,allTestCase[testId]->_genParameters[testNum].dataRepresentation);
+}
+
+//-----------------------------------------
+// doBatchedTests
+//-----------------------------------------
+static int doBatchedTests(cl_command_queue queue, cl_context context, const unsigned int testId, cl_device_id device, OutputCapture* capture)
+{
+    const unsigned int count = allTestCase[testId]->_testNum;
+    bool* selected = new bool[count];
+    cl_kernel* kernels = new cl_kernel[count];
+    cl_program program;
+
+    // Long support for varible type
+    for(unsigned int testNum = 0;testNum < count;++testNum)
+        selected[testNum] = !(allTestCase[testId]->_type == TYPE_VECTOR && !strcmp(allTestCase[testId]->_genParameters[testNum].dataType,"long") && !isLongSupported(device));
+
+    program = makeBatchedPrintfProgram(kernels, context, testId, selected);
+    if(!program)
+    {
+        delete [] kernels;
+        delete [] selected;
+        return -1;
+    }
+
+    for(unsigned int testNum = 0;testNum < count;++testNum)
+    {
+        printTestCase(testId,testNum);
+        if(!selected[testNum])
+            continue;
+
+        beginCapture(capture);
+        int err = runTest(queue, context, kernels[testNum], testId, testNum, device, capture);
+        endCapture(capture);
+        ++s_test_cnt;
+
+        if(err != 0)
+            log_error("*** FAILED ***\n\n");
+        else
+            log_info("Passed\n");
+
+        if(clReleaseKernel(kernels[testNum]) != CL_SUCCESS)
+            log_error("clReleaseKernel failed\n");
+    }
+
+    if(clReleaseProgram(program) != CL_SUCCESS)
+        log_error("clReleaseProgram failed\n");
+    delete [] kernels;
+    delete [] selected;
+    return 0;
+}
+
 //-----------------------------------------
 // printUsage
 //-----------------------------------------
 static void printUsage( void )
 {
-    log_info("test_printf:  [-cghw] [start_test_num] \n");
+    log_info("test_printf:  [-bcghw] [start_test_num] \n");
     log_info("  default is to run the full test on the default device\n");
     log_info("  start_test_num will start running from that num\n");
+    log_info("  -b  build all the formats of a type into one program and capture the output through a pipe\n");
 }
 
 //-----------------------------------------
@@ -589,6 +824,8 @@ int main(int argc, const char* argv[]) {
     cl_device_id      device_id;
     uint32_t      device_frequency = 0;
     uint32_t       compute_devices = 0;
+    bool           batched = false;
+    OutputCapture  capture;
 
 
 
@@ -636,6 +873,9 @@ int main(int argc, const char* argv[]) {
             while(*arg != '\0')
             {
                 switch(*arg) {
+                    case 'b':
+                        batched = true;
+                        break;
                     case 'h':
                         printUsage();
                         return 0;
@@ -716,6 +956,9 @@ int main(int argc, const char* argv[]) {
 
     log_info( "Test binary built %s %s\n", __DATE__, __TIME__ );
 
+    if(batched && openCapture(&capture) != 0)
+        batched = false;
+
     fd = acquireOutputStream();
 
     cl_context context = clCreateContext(NULL, 1, &device_id, notify_callback, NULL, NULL);
@@ -734,24 +977,14 @@ int main(int argc, const char* argv[]) {
         else {
             releaseOutputStream(fd);
             log_info("\n*** Testing printf for %s ***\n",strType[testId]);
+            bool done = batched && doBatchedTests(queue, context, testId, device_id, &capture) == 0;
             fd = acquireOutputStream();
+            if(done)
+                continue;
             //For all formats
             for(unsigned int testNum = 0;testNum < allTestCase[testId]->_testNum;++testNum){
                 releaseOutputStream(fd);
-                if(allTestCase[testId]->_type == TYPE_VECTOR)
-                    log_info("%d)testing printf(\"%sv%s%s\",%s)\n",testNum,allTestCase[testId]->_genParameters[testNum].vectorFormatFlag,allTestCase[testId]->_genParameters[testNum].vectorSize,
-                    allTestCase[testId]->_genParameters[testNum].vectorFormatSpecifier,allTestCase[testId]->_genParameters[testNum].dataRepresentation);
-                else if(allTestCase[testId]->_type == TYPE_ADDRESS_SPACE)
-                {
-                    if(isKernelArgument(allTestCase[testId], testNum))
-                        log_info("%d)testing kernel //argument %s \n   printf(%s,%s)\n",testNum,allTestCase[testId]->_genParameters[testNum].addrSpaceArgumentTypeQualifier,
-                        allTestCase[testId]->_genParameters[testNum].genericFormat,allTestCase[testId]->_genParameters[testNum].addrSpaceParameter);
-                    else
-                        log_info("%d)testing kernel //variable %s \n   printf(%s,%s)\n",testNum,allTestCase[testId]->_genParameters[testNum].addrSpaceVariableTypeQualifier,
-                        allTestCase[testId]->_genParameters[testNum].genericFormat,allTestCase[testId]->_genParameters[testNum].addrSpaceParameter);
-                }
-                else
-                    log_info("%d)testing printf(\"%s\",%s)\n",testNum,allTestCase[testId]->_genParameters[testNum].genericFormat,allTestCase[testId]->_genParameters[testNum].dataRepresentation);
+                printTestCase(testId,testNum);
                 fd = acquireOutputStream();
 
                 // Long support for varible type
@@ -792,6 +1025,8 @@ int main(int argc, const char* argv[]) {
 
     releaseOutputStream(fd);
 
+    if(batched)
+        closeCapture(&capture);
 
     if (s_test_fail == 0) {
         if (s_test_cnt > 1)
@@ -8,7 +8,7 @@
 #//
 #******************************************************************/
 
-import os, re, sys, subprocess, time, commands, tempfile, math, string
+import os, re, sys, subprocess, time, commands, tempfile, math, string, json, zlib
 
 DEBUG = 0
 
@@ -27,6 +27,14 @@ def write_help_info() :
  print(" [CL_DEVICE_TYPE(s) to test] - list of CL device types to test, default is CL_DEVICE_TYPE_DEFAULT.")
  print(" [log=path/to/log/file/] - provide a path for the test log file, default is in the current directory.")
  print("   (Note: spaces are not allowed in the log file path.")
+ print(" [jobs=N] - run up to N tests at the same time, default is 1.")
+ print(" [memory=MB] - do not start a test if the peak memory recorded for it and the running tests would exceed MB.")
+ print(" [shard=K/N] - run only shard K (1 to N) of the selected tests. Tests are assigned by a hash of their name,")
+ print("   so every host computes the same split whatever its history file holds.")
+ print(" [history=path/to/history.json] - test durations and peak memory used for scheduling, updated after the run.")
+ print("   Default is opencl_conformance_history.json in the current directory.")
+ print(" [results=path/to/results.json] - also write the results of this run in a form merge= can read.")
+ print(" [merge=a.json,b.json,...] - merge the results of several shards into one log, in test list order, and exit.")
 
 
 # Get the time formatted nicely
@@ -267,6 +275,244 @@ def run_tests(tests) :
 
 
 
+# Parallel and sharded execution
+#
+# Tests run as separate processes, each writing to its own temporary file. Results are written to the log in
+# test list order whatever order the tests finish in, so logs of the same run are identical however it was
+# scheduled. Tests expected to take longest are started first; the expectations come from the history file.
+
+default_expected_duration = 60.0
+
+def history_key(device, test):
+ (test_name, test_dir) = test
+ return device + ":" + test_name + ":" + test_dir
+
+def load_history(filename):
+ if (not os.path.exists(filename)):
+  return {}
+ try:
+  return json.load(open(filename, 'r'))
+ except (IOError, ValueError):
+  print("Could not read history file " + filename + ", scheduling without it.")
+  return {}
+
+def save_history(filename, history):
+ try:
+  json.dump(history, open(filename, 'w'), indent=1, sort_keys=True)
+ except IOError:
+  print("Could not write history file " + filename)
+
+def expected_duration(history, device, test):
+ entry = history.get(history_key(device, test))
+ if (entry):
+  return entry["duration"]
+ # Unknown tests are assumed to be average ones
+ known = [h["duration"] for h in history.values()]
+ if (len(known) > 0):
+  return sum(known) / len(known)
+ return default_expected_duration
+
+def expected_memory(history, device, test):
+ entry = history.get(history_key(device, test))
+ if (entry):
+  return entry.get("memory", 0)
+ return 0
+
+# Split the tests into shards by a hash of the test name and command. The split only depends on the test
+# itself, not on the history file, which every host updates with its own runs, so the shards never overlap
+# or miss a test.
+def get_shard(tests, shard, shard_count):
+ return [test for test in tests if (zlib.crc32(test[0] + ":" + test[1]) & 0xffffffff) % shard_count == shard - 1]
+
+# Returns (return code or None if still running, peak memory in MB)
+def poll_test(p):
+ if (not hasattr(os, "wait4")):
+  return (p.poll(), 0)
+ try:
+  (pid, status, usage) = os.wait4(p.pid, os.WNOHANG)
+ except OSError:
+  return (p.poll(), 0)
+ if (pid == 0):
+  return (None, 0)
+ if (os.WIFSIGNALED(status)):
+  p.returncode = -os.WTERMSIG(status)
+ else:
+  p.returncode = os.WEXITSTATUS(status)
+ # ru_maxrss is in bytes on Mac OS X and in kilobytes elsewhere
+ if (sys.platform == "darwin"):
+  return (p.returncode, usage.ru_maxrss / (1024 * 1024))
+ return (p.returncode, usage.ru_maxrss / 1024)
+
+# Look for failures in the output of a finished test, as run_test_checking_output does while it runs
+def check_test_output(output_name, returncode):
+ failures_this_run = 0
+ log_lines = []
+ messages = []
+ if (returncode < 0):
+  messages.append("           ==> ERROR: test killed/crashed: " + str(returncode)+ ".")
+ for line in open(output_name, 'r').read().splitlines():
+  if (re.search(".*(FAILED|ERROR).*", line)):
+   messages.append("           ==> " + line)
+  if (re.search(".*FAILED.*", line)):
+   failures_this_run = failures_this_run + 1
+  if (re.search(".*(PASSED).*", line)):
+   messages.append("               " + line)
+  log_lines.append("     " + line)
+ if (returncode == 0 and failures_this_run > 0):
+  messages.append("           ==> ERROR: Test returned 0, but number of FAILED lines reported is " + str(failures_this_run) +".")
+  return (failures_this_run, log_lines, messages)
+ return (returncode, log_lines, messages)
+
+def write_test_result(result) :
+ (test_name, test_dir) = result["test"]
+ log_file.write("========================================================================================\n")
+ log_file.write("(" + result["start"] + ")     Running Tests: " + test_dir +"\n")
+ log_file.write("========================================================================================\n")
+ log_file.write("     ----------------------------------------------------------------------------------------\n")
+ log_file.write("     (" + result["start"] + ")     Running Sub Test: " + test_name + "\n")
+ log_file.write("     ----------------------------------------------------------------------------------------\n")
+ for line in result["messages"]:
+  log_file.write(line + "\n")
+ for line in result["log"]:
+  log_file.write(line + "\n")
+ log_file.write("     ----------------------------------------------------------------------------------------\n")
+ if (result["result"] != 0):
+  log_file.write("  *******************************************************************************************\n")
+  log_file.write("  *  ("+result["end"]+")     Test " + test_name + " ==> FAILED: " + str(result["result"])+"\n")
+  log_file.write("  *******************************************************************************************\n")
+ else:
+  log_file.write("     ("+result["end"]+")     Test " + test_name +" passed in " + str(result["run_time"]) + "s\n")
+ log_file.write("     ----------------------------------------------------------------------------------------\n")
+ log_file.write("\n")
+ log_file.flush()
+
+def start_test(test):
+ (test_name, test_dir) = test
+ program_to_run = test_dir_without_args = test_dir.split(None, 1)[0]
+ if ( os.sep == '\\' ) : program_to_run += ".exe"
+ if (not os.path.exists(current_directory + os.sep + program_to_run)) :
+  return (None, None, "           ==> ERROR: test file (" + current_directory + os.sep + program_to_run +") does not exist.  Failing test.")
+ (output_fd, output_name) = tempfile.mkstemp()
+ try:
+  p = subprocess.Popen(current_directory + os.sep + test_dir, stderr=output_fd, stdout=output_fd, shell=True,
+                       cwd=os.path.dirname(current_directory+os.sep+test_dir_without_args))
+ except OSError, e:
+  os.close(output_fd)
+  os.remove(output_name)
+  return (None, None, "           ==> ERROR: failed to execute test. Failing test. : " + str(e))
+ os.close(output_fd)
+ return (p, output_name, None)
+
+def run_tests_parallel(tests, jobs, memory_budget, history, device) :
+  results = [None] * len(tests)
+  order = sorted(range(len(tests)), key=lambda i: (-expected_duration(history, device, tests[i]), i))
+  running = {}      # test index -> (process, output file, start time, start time string)
+  next_to_log = 0
+  finished = 0
+  try:
+   while (finished < len(tests)):
+    # Start tests while there are free slots. The longest test that fits in the memory budget goes first;
+    # a test that does not fit waits for running tests to finish while smaller ones are started.
+    while (len(order) > 0 and len(running) < jobs):
+     i = None
+     in_use = sum([expected_memory(history, device, tests[j]) for j in running.keys()])
+     for candidate in order:
+      if (memory_budget <= 0 or len(running) == 0 or in_use + expected_memory(history, device, tests[candidate]) <= memory_budget):
+       i = candidate
+       break
+     if (i == None):
+      break
+     order.remove(i)
+     (test_name, test_dir) = tests[i]
+     print("("+get_time()+")     BEGIN  " + test_name.ljust(40))
+     sys.stdout.flush()
+     (p, output_name, error) = start_test(tests[i])
+     if (p == None):
+      print(error)
+      results[i] = {"test": tests[i], "result": -1, "run_time": 0, "memory": 0, "start": get_time(), "end": get_time(), "log": [], "messages": [error]}
+      finished = finished + 1
+     else:
+      running[i] = (p, output_name, time.time(), get_time())
+
+    # Collect finished tests
+    for i in sorted(running.keys()):
+     (p, output_name, start_time, start_string) = running[i]
+     (returncode, memory) = poll_test(p)
+     if (returncode == None):
+      continue
+     del running[i]
+     run_time = time.time() - start_time
+     (result, log_lines, messages) = check_test_output(output_name, returncode)
+     os.remove(output_name)
+     results[i] = {"test": tests[i], "result": result, "run_time": run_time, "memory": memory, "start": start_string, "end": get_time(), "log": log_lines, "messages": messages}
+     finished = finished + 1
+     (test_name, test_dir) = tests[i]
+     for message in messages:
+      print(message)
+     if (result == 0):
+      print("("+get_time()+")     PASSED " + test_name.ljust(40) +": (" + str(int(run_time)).rjust(3) + "s, " + str(finished).rjust(3) + os.sep + str(len(tests)) +" done)")
+     else:
+      print("("+get_time()+")     FAILED " + test_name.ljust(40) +": (" + str(int(run_time)).rjust(3) + "s, " + str(finished).rjust(3) + os.sep + str(len(tests)) +" done)")
+     sys.stdout.flush()
+
+    # Log the results in test list order
+    while (next_to_log < len(tests) and results[next_to_log] != None):
+     write_test_result(results[next_to_log])
+     next_to_log = next_to_log + 1
+
+    time.sleep(0.1)
+  except KeyboardInterrupt:
+   write_screen_log("\nFAILED: Execution interrupted.  Killing " + str(len(running)) + " running test processes.")
+   for (p, output_name, start_time, start_string) in running.values():
+    try:
+     os.kill(p.pid, 9)
+    except OSError:
+     pass
+   log_file.close()
+   sys.exit(-1)
+
+  # Only record tests that ran
+  for result in results:
+   if (result["run_time"] > 0):
+    history[history_key(device, result["test"])] = {"duration": result["run_time"], "memory": result["memory"]}
+  return results
+
+def write_results_file(filename, device_results):
+ try:
+  json.dump(device_results, open(filename, 'w'), indent=1)
+ except IOError:
+  print("Could not write results file " + filename)
+
+# Merge the results files of several shards: every test is logged in test list order
+def merge_results(filenames):
+ merged = {}
+ device_order = []
+ for filename in filenames:
+  for (device, entries) in json.load(open(filename, 'r')):
+   if (device not in merged):
+    merged[device] = []
+    device_order.append(device)
+   merged[device].extend(entries)
+ total_failures = 0
+ total_tests = 0
+ for device in device_order:
+  write_screen_log(("Results for CL_DEVICE_TYPE " + device).center(90))
+  failures = 0
+  for (index, result) in sorted(merged[device], key=lambda entry: entry[0]):
+   result["test"] = tuple(result["test"])
+   write_test_result(result)
+   if (result["result"] != 0):
+    failures = failures + 1
+    write_screen_log("FAILED " + result["test"][0])
+  total_tests = total_tests + len(merged[device])
+  if (failures == 0):
+   write_screen_log(">> TEST on " + device + " PASSED")
+  else:
+   write_screen_log(">> TEST on " + device + " FAILED (" + str(failures) + " FAILURES)")
+  total_failures = total_failures + failures
+ write_screen_log("("+get_time()+") Merge complete.  " + str(total_failures) + " failures for " + str(total_tests) + " tests.")
+ return total_failures
+
 
 
 # ########################
@@ -289,6 +535,43 @@ try:
 except IOError:
  print "Could not open log file " + log_file_name
 
+# Parallel execution and sharding options
+jobs = 1
+memory_budget = 0
+shard = 0
+shard_count = 1
+history_file_name = "opencl_conformance_history.json"
+results_file_name = None
+merge_file_names = None
+option_pattern = "^(log|jobs|memory|shard|history|results|merge)=(\S+)"
+for arg in sys.argv[2:]:
+ match = re.search(option_pattern, arg)
+ if (not match):
+  continue
+ (key, value) = match.groups()
+ if (key == "jobs"):
+  jobs = max(1, int(value))
+ elif (key == "memory"):
+  memory_budget = int(value)
+ elif (key == "shard"):
+  shard_match = re.search("^(\d+)/(\d+)$", value)
+  if (not shard_match or int(shard_match.group(1)) < 1 or int(shard_match.group(1)) > int(shard_match.group(2))):
+   print("FAILED: shard must be K/N with 1 <= K <= N, not " + value)
+   sys.exit(-1)
+  shard = int(shard_match.group(1))
+  shard_count = int(shard_match.group(2))
+ elif (key == "history"):
+  history_file_name = value
+ elif (key == "results"):
+  results_file_name = value
+ elif (key == "merge"):
+  merge_file_names = value.split(",")
+
+if (merge_file_names != None):
+ total_failures = merge_results(merge_file_names)
+ log_file.close()
+ sys.exit(0 if total_failures == 0 else 1)
+
 # Determine which devices to test
 device_types = ["CL_DEVICE_TYPE_DEFAULT", "CL_DEVICE_TYPE_CPU", "CL_DEVICE_TYPE_GPU", "CL_DEVICE_TYPE_ACCELERATOR", "CL_DEVICE_TYPE_ALL"]
 devices_to_test = []
@@ -308,7 +591,7 @@ num_of_patterns_to_match = 0
 for arg in sys.argv[2:]:
  if arg in device_types:
   continue
- if re.search("log=(\S+)", arg):
+ if re.search(option_pattern, arg):
   continue
  num_of_patterns_to_match = num_of_patterns_to_match + 1
  found_it = False
@@ -336,6 +619,9 @@ for (test_name, test_command) in tests:
  write_screen_log(test_name.ljust(50) + " (" + test_command +")")
 
 # Run the tests
+parallel = jobs > 1 or shard_count > 1 or results_file_name != None
+history = load_history(history_file_name)
+all_results = []
 total_failures = 0
 for device_to_test in devices_to_test:
  os.environ['CL_DEVICE_TYPE'] = device_to_test
@@ -344,7 +630,16 @@ for device_to_test in devices_to_test:
  write_screen_log(("Setting CL_DEVICE_TYPE to " + device_to_test).center(90))
  write_screen_log("========================================================================================")
  write_screen_log("========================================================================================")
- failures = run_tests(tests)
+ if (parallel):
+  device_tests = tests
+  if (shard_count > 1):
+   device_tests = get_shard(tests, shard, shard_count)
+   write_screen_log("Shard " + str(shard) + " of " + str(shard_count) + ": " + str(len(device_tests)) + " of " + str(len(tests)) + " tests.")
+  results = run_tests_parallel(device_tests, jobs, memory_budget, history, device_to_test)
+  failures = len([r for r in results if r["result"] != 0])
+  all_results.append((device_to_test, [(tests.index(r["test"]), r) for r in results]))
+ else:
+  failures = run_tests(tests)
  write_screen_log("========================================================================================")
  if (failures == 0):
   write_screen_log(">> TEST on " + device_to_test + " PASSED")
@@ -354,4 +649,8 @@ for device_to_test in devices_to_test:
  total_failures = total_failures + failures
 
 write_screen_log("("+get_time()+") Testing complete.  " + str(total_failures) + " failures for " + str(len(tests)) + " tests.")
+if (parallel):
+ save_history(history_file_name, history)
+ if (results_file_name != None):
+  write_results_file(results_file_name, all_results)
 log_file.close()
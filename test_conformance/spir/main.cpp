@@ -27,10 +27,12 @@
 #include "../../test_common/harness/kernelHelpers.h"
 #include "../../test_common/harness/typeWrappers.h"
 #include "../../test_common/harness/os_helpers.h"
+#include "../../test_common/harness/ThreadPool.h"
 
 #include "exceptions.h"
 #include "run_build_test.h"
 #include "run_services.h"
+#include "suite_archive.h"
 
 #include <list>
 #include <algorithm>
@@ -46,6 +48,7 @@
 #endif
 
 static int no_unzip = 0;
+static int parallel_builds = 0;
 
 class custom_cout : public std::streambuf
 {
@@ -219,98 +222,18 @@ static bool extractKernelAttribute(std::string& kernel_attributes,
   return false;
 }
 
-// Extracts suite with the given name, and saves it to disk.
-static void extract_suite(const char *suiteName)
-{
-  mz_zip_archive zip_archive;
-
-  // Composing the name of the archive.
-  char* dir = get_exe_dir();
-  std::string archiveName(dir);
-  archiveName.append(dir_sep());
-  archiveName.append(suiteName);
-  archiveName.append(".zip");
-  free(dir);
-
-#if defined(_WIN32)
-      _mkdir(suiteName);
-#else
-      mkdir(suiteName, S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
-#endif
-
-  memset(&zip_archive, 0, sizeof(zip_archive));
-  if (!mz_zip_reader_init_file(&zip_archive, archiveName.c_str(), 0))
-      throw Exceptions::ArchiveError(MZ_DATA_ERROR);
-
-  // Get and print information about each file in the archive.
-  for (size_t i = 0; i < mz_zip_reader_get_num_files(&zip_archive); i++)
-  {
-      mz_zip_archive_file_stat fileStat;
-      size_t fileSize = 0;
-
-      if (!mz_zip_reader_file_stat(&zip_archive, i, &fileStat))
-      {
-          mz_zip_reader_end(&zip_archive);
-          throw Exceptions::ArchiveError(MZ_DATA_ERROR);
-      }
-      const std::string fileName = fileStat.m_filename;
-
-      // If the file is a directory, skip it. We create suite folder at the beggining.
-      if (mz_zip_reader_is_file_a_directory(&zip_archive, fileStat.m_file_index))
-      {
-          continue;
-      }
-
-      // Extracting the file.
-      void *p = mz_zip_reader_extract_file_to_heap(&zip_archive,
-                                                   fileName.c_str(),
-                                                   &fileSize, 0);
-      if (!p)
-      {
-          mz_zip_reader_end(&zip_archive);
-          throw std::runtime_error("mz_zip_reader_extract_file_to_heap() failed!\n");
-      }
-
-      // Writing the file back to the disk
-      std::fstream file(fileName.c_str(),
-                        std::ios_base::trunc | std::ios_base::in |
-                        std::ios_base::out | std::ios_base::binary);
-      if (!file.is_open())
-      {
-          std::string msg = "Failed to open ";
-          msg.append(fileName);
-          throw Exceptions::TestError(msg);
-      }
-
-      file.write((const char*)p, fileSize);
-      if (file.bad())
-      {
-          std::string msg("Failed to write into ");
-          msg.append(fileName);
-          throw Exceptions::TestError(msg);
-      }
-
-      // Cleanup.
-      file.flush();
-      file.close();
-      free(p);
-  }
-  mz_zip_reader_end(&zip_archive);
-}
-
 //
-// Extracts the given suite package if needed.
-// return true if the suite was extracted, false otherwise.
+// Loads the given suite package into memory if needed.
+// return true if the suite was loaded, false otherwise.
 //
 static bool try_extract(const char* suite)
 {
-    if(no_unzip == 0)
+    if(no_unzip == 0 && load_suite_archive(suite))
     {
-        std::cout << "Extracting test suite " << suite << std::endl;
-        extract_suite(suite);
-        std::cout << "Done." << std::endl;
+        std::cout << "Loaded test suite " << suite << std::endl;
+        return true;
     }
-    return true;
+    return false;
 }
 
 bool test_suite(cl_device_id device, cl_uint size_t_width, const char *folder,
@@ -326,17 +249,44 @@ bool test_suite(cl_device_id device, cl_uint size_t_width, const char *folder,
     unsigned int tests_passed = 0;
     CounterEventHandler SuccE(tests_passed, number_of_tests);
     std::list<std::string> ErrList;
-    for (unsigned int i = 0; i < number_of_tests; ++i)
+    bool extensionAvailable = (strlen(extension) == 0) || is_extension_available(device, extension);
+
+    // In the parallel mode the programs of the next few tests are built at once
+    // on the thread pool, in one context, and then the tests run in order.
+    clContextWrapper context;
+    clCommandQueueWrapper queue;
+    unsigned int window = 1;
+    if (parallel_builds && extensionAvailable)
     {
-        AccumulatorEventHandler FailE(ErrList, test_name[i]);
-        if((strlen(extension) != 0) && (!is_extension_available(device, extension)))
+        create_context_and_queue(device, &context, &queue);
+        window = 4 * GetThreadCount();
+    }
+
+    for (unsigned int first = 0; first < number_of_tests; first += window)
+    {
+        unsigned int count = std::min(window, number_of_tests - first);
+        BuildTestPrograms *programs = NULL;
+        if (parallel_builds && extensionAvailable)
         {
-            (SuccE)(test_name[i], "");
-            std::cout << test_name[i] << "... Skipped. (Cannot run on device due to missing extension: " << extension << " )." << std::endl;
-            continue;
+            programs = new BuildTestPrograms[count];
+            build_test_programs(context, queue, device, deviceCapabilities, folder,
+                                test_name + first, count, size_t_width, programs);
+        }
+
+        for (unsigned int i = first; i < first + count; ++i)
+        {
+            AccumulatorEventHandler FailE(ErrList, test_name[i]);
+            if(!extensionAvailable)
+            {
+                (SuccE)(test_name[i], "");
+                std::cout << test_name[i] << "... Skipped. (Cannot run on device due to missing extension: " << extension << " )." << std::endl;
+                continue;
+            }
+            TestRunner testRunner(&SuccE, &FailE, deviceCapabilities);
+            testRunner.runBuildTest(device, folder, test_name[i], size_t_width,
+                                    programs ? &programs[i - first] : NULL);
         }
-        TestRunner testRunner(&SuccE, &FailE, deviceCapabilities);
-        testRunner.runBuildTest(device, folder, test_name[i], size_t_width);
+        delete [] programs;
     }
 
     std::cout << std::endl;
@@ -6762,13 +6712,14 @@ static int ParseCommandLine (int argc, const char *argv[],
     /* Special case: just list the tests */
     if( ( argc > 1 ) && (!strcmp( argv[ 1 ], "-list" ) || !strcmp( argv[ 1 ], "-h" ) || !strcmp( argv[ 1 ], "--help" )))
     {
-        log_info( "Usage: %s [<suite name>] [pid<num>] [id<num>] [<device type>] [w32] [no-unzip]\n", argv[0] );
+        log_info( "Usage: %s [<suite name>] [pid<num>] [id<num>] [<device type>] [w32] [no-unzip] [parallel[<num>]]\n", argv[0] );
         log_info( "\t<suite name>\tOne or more of: (default all)\n");
         log_info( "\tpid<num>\t\tIndicates platform at index <num> should be used (default 0).\n" );
         log_info( "\tid<num>\t\tIndicates device at index <num> should be used (default 0).\n" );
         log_info( "\t<device_type>\tcpu|gpu|accelerator|<CL_DEVICE_TYPE_*> (default CL_DEVICE_TYPE_DEFAULT)\n" );
         log_info( "\tw32\t\tIndicates device address bits is 32.\n" );
         log_info( "\tno-unzip\t\tDo not extract test files from Zip; use existing.\n" );
+        log_info( "\tparallel[<num>]\tBuild the programs of several tests at once, on <num> threads (default one per core).\n" );
 
         for( unsigned int i = 0; i < (sizeof(spir_suites) / sizeof(sub_suite)); i++ )
         {
@@ -6810,6 +6761,13 @@ static int ParseCommandLine (int argc, const char *argv[],
             no_unzip = 1;
             argc--;
         }
+        else if( strncmp( argv[ argc - 1 ], "parallel", 8 ) == 0 )
+        {
+            parallel_builds = 1;
+            if( argv[ argc - 1 ][8] != '\0' )
+                SetThreadCount( atoi( &(argv[ argc - 1 ][8]) ) );
+            argc--;
+        }
         else break;
     }
 
@@ -32,6 +32,7 @@
 #include "../../test_common/harness/typeWrappers.h"
 #include "../../test_common/harness/clImageHelper.h"
 #include "../../test_common/harness/os_helpers.h"
+#include "../../test_common/harness/ThreadPool.h"
 
 #include "exceptions.h"
 #include "kernelargs.h"
@@ -300,18 +301,8 @@ static bool run_test(cl_context context, cl_command_queue queue, cl_program clpr
     return true;
 }
 
-TestRunner::TestRunner(EventHandler *success, EventHandler *failure,
-                       const OclExtensions& devExt):
-    m_successHandler(success), m_failureHandler(failure), m_devExt(&devExt) {}
-
-/**
- Based on the test name build the cl file name, the bc file name and execute
- the kernel for both modes (cl and bc).
- */
-bool TestRunner::runBuildTest(cl_device_id device, const char *folder,
-                              const char *test_name, cl_uint size_t_width)
+static const KhrSupport& get_khr_db()
 {
-    int failures = 0;
     // Composing the name of the CSV file.
     char* dir = get_exe_dir();
     std::string csvName(dir);
@@ -319,66 +310,190 @@ bool TestRunner::runBuildTest(cl_device_id device, const char *folder,
     csvName.append("khr.csv");
     free(dir);
 
-    log_info("%s...\n", test_name);
+    return *KhrSupport::get(csvName);
+}
 
-    // Figure out whether the test can run on the device. If not, we skip it.
-    const KhrSupport& khrDb = *KhrSupport::get(csvName);
+/**
+ Returns why the test can't run on the device, or an empty string if it can.
+ */
+static std::string get_skip_reason(cl_device_id device, const OclExtensions& devExt,
+                                   const char *folder, const char *test_name)
+{
+    const KhrSupport& khrDb = get_khr_db();
     cl_bool images = khrDb.isImagesRequired(folder, test_name);
     cl_bool images3D = khrDb.isImages3DRequired(folder, test_name);
 
-    char deviceProfile[64];
-    clGetDeviceInfo(device, CL_DEVICE_PROFILE, sizeof(deviceProfile), &deviceProfile, NULL);
-    std::string device_profile(deviceProfile, 64);
-
     if(images == CL_TRUE && checkForImageSupport(device) != 0)
-    {
-        (*m_successHandler)(test_name, "");
-        std::cout << "Skipped. (Cannot run on device due to Images is not supported)." << std::endl;
-        return true;
-    }
+        return "Cannot run on device due to Images is not supported";
 
     if(images3D == CL_TRUE && checkFor3DImageSupport(device) != 0)
-    {
-        (*m_successHandler)(test_name, "");
-        std::cout << "Skipped. (Cannot run on device as 3D images are not supported)." << std::endl;
-        return true;
-    }
+        return "Cannot run on device as 3D images are not supported";
 
     OclExtensions requiredExt = khrDb.getRequiredExtensions(folder, test_name);
-    if(!m_devExt->supports(requiredExt))
+    if(!devExt.supports(requiredExt))
     {
-        (*m_successHandler)(test_name, "");
-        std::cout << "Skipped. (Cannot run on device due to missing extensions: " << m_devExt->get_missing(requiredExt) << " )." << std::endl;
-        return true;
+        std::stringstream reason;
+        reason << "Cannot run on device due to missing extensions: " << devExt.get_missing(requiredExt) << " ";
+        return reason.str();
     }
+    return std::string();
+}
 
+/**
+ Creates and builds the cl and the bc program of the test.
+ Returns false with the build log if either fails to build.
+ */
+static bool build_programs(cl_context context, cl_device_id device, const char *folder,
+                           const char *test_name, cl_uint size_t_width,
+                           clProgramWrapper& clprog, clProgramWrapper& bcprog, std::string& log)
+{
     std::string cl_file_path, bc_file;
     // Build cl file name based on the test name
     get_cl_file_path(folder, test_name, cl_file_path);
     // Build bc file name based on the test name
     get_bc_file_path(folder, test_name, bc_file, size_t_width);
-    gRG.init(1);
-    //
-    // Processing each kernel in the program separately
-    //
-    clContextWrapper context;
-    clCommandQueueWrapper queue;
-    create_context_and_queue(device, &context, &queue);
-    clProgramWrapper clprog = create_program_from_cl(context, cl_file_path);
-    clProgramWrapper bcprog = create_program_from_bc(context, bc_file);
+    clprog = create_program_from_cl(context, cl_file_path);
+    bcprog = create_program_from_bc(context, bc_file);
 
     // Building the programs.
     BuildTask clBuild(clprog, device, "-cl-kernel-arg-info");
     if (!clBuild.execute()) {
-        std::cerr << clBuild.getErrorLog() << std::endl;
+        log = clBuild.getErrorLog();
         return false;
     }
 
     SpirBuildTask bcBuild(bcprog, device, "-x spir -spir-std=1.2 -cl-kernel-arg-info");
     if (!bcBuild.execute()) {
-        std::cerr << bcBuild.getErrorLog() << std::endl;
+        log = bcBuild.getErrorLog();
         return false;
     }
+    return true;
+}
+
+struct BuildJobInfo
+{
+    cl_device_id        device;
+    const OclExtensions *devExt;
+    const char          *folder;
+    const char          **test_name;
+    cl_uint             size_t_width;
+    BuildTestPrograms   *programs;
+};
+
+static cl_int build_test_job(cl_uint job_id, cl_uint thread_id, void *userInfo)
+{
+    BuildJobInfo* info = (BuildJobInfo*)userInfo;
+    BuildTestPrograms& programs = info->programs[job_id];
+    const char* test_name = info->test_name[job_id];
+
+    // Exceptions must not leave the thread pool, runBuildTest throws them again.
+    try
+    {
+        if (!get_skip_reason(info->device, *info->devExt, info->folder, test_name).empty())
+            programs.status = BuildTestPrograms::SKIPPED;
+        else if (build_programs(programs.context, info->device, info->folder, test_name,
+                                info->size_t_width, programs.clprog, programs.bcprog,
+                                programs.message))
+            programs.status = BuildTestPrograms::BUILT;
+        else
+            programs.status = BuildTestPrograms::BUILD_FAILED;
+    }
+    catch (const Exceptions::TestError& e)
+    {
+        programs.status = BuildTestPrograms::EXCEPTION;
+        programs.message = e.what();
+        programs.errorCode = e.getErrorCode();
+    }
+    catch (const std::exception& e)
+    {
+        programs.status = BuildTestPrograms::EXCEPTION;
+        programs.message = e.what();
+        programs.errorCode = 1;
+    }
+    return 0;
+}
+
+void build_test_programs(cl_context context, cl_command_queue queue, cl_device_id device,
+                         const OclExtensions& devExt, const char *folder,
+                         const char *test_name[], unsigned int count,
+                         cl_uint size_t_width, BuildTestPrograms *programs)
+{
+    BuildJobInfo info = { device, &devExt, folder, test_name, size_t_width, programs };
+
+    // Load the CSV file before the jobs look up the tests in it.
+    get_khr_db();
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        programs[i].context = context;
+        programs[i].queue = queue;
+    }
+    if (count)
+        ThreadPool_Do(build_test_job, count, &info);
+}
+
+TestRunner::TestRunner(EventHandler *success, EventHandler *failure,
+                       const OclExtensions& devExt):
+    m_successHandler(success), m_failureHandler(failure), m_devExt(&devExt) {}
+
+/**
+ Based on the test name build the cl file name, the bc file name and execute
+ the kernel for both modes (cl and bc).
+ */
+bool TestRunner::runBuildTest(cl_device_id device, const char *folder,
+                              const char *test_name, cl_uint size_t_width,
+                              BuildTestPrograms *prebuilt)
+{
+    int failures = 0;
+
+    log_info("%s...\n", test_name);
+
+    // Figure out whether the test can run on the device. If not, we skip it.
+    std::string skipReason = get_skip_reason(device, *m_devExt, folder, test_name);
+    if (!skipReason.empty())
+    {
+        (*m_successHandler)(test_name, "");
+        std::cout << "Skipped. (" << skipReason << ")." << std::endl;
+        return true;
+    }
+
+    gRG.init(1);
+    //
+    // Processing each kernel in the program separately
+    //
+    clContextWrapper ownContext;
+    clCommandQueueWrapper ownQueue;
+    clProgramWrapper ownClprog, ownBcprog;
+    cl_context context;
+    cl_command_queue queue;
+    cl_program clprog, bcprog;
+    if (prebuilt)
+    {
+        if (BuildTestPrograms::EXCEPTION == prebuilt->status)
+            throw Exceptions::TestError(prebuilt->message, prebuilt->errorCode);
+        if (BuildTestPrograms::BUILD_FAILED == prebuilt->status) {
+            std::cerr << prebuilt->message << std::endl;
+            return false;
+        }
+        context = prebuilt->context;
+        queue = prebuilt->queue;
+        clprog = prebuilt->clprog;
+        bcprog = prebuilt->bcprog;
+    }
+    else
+    {
+        std::string log;
+        create_context_and_queue(device, &ownContext, &ownQueue);
+        if (!build_programs(ownContext, device, folder, test_name, size_t_width,
+                            ownClprog, ownBcprog, log)) {
+            std::cerr << log << std::endl;
+            return false;
+        }
+        context = ownContext;
+        queue = ownQueue;
+        clprog = ownClprog;
+        bcprog = ownBcprog;
+    }
 
     KernelEnumerator clkernel_enumerator(clprog),
                      bckernel_enumerator(bcprog);
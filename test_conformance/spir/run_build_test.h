@@ -21,6 +21,8 @@
 #include <vector>
 #include <utility>
 
+#include "../../test_common/harness/typeWrappers.h"
+
 class OclExtensions;
 
 struct EventHandler{
@@ -114,6 +116,31 @@ private:
     cl_context   m_context;
 };
 
+/*
+ * The programs of one build test, built ahead of running it by build_test_programs.
+ */
+struct BuildTestPrograms{
+    enum Status { SKIPPED, BUILT, BUILD_FAILED, EXCEPTION };
+
+    BuildTestPrograms(): context(NULL), queue(NULL), status(SKIPPED), errorCode(0) {}
+
+    cl_context       context;  // shared by all the tests, not owned
+    cl_command_queue queue;
+    clProgramWrapper clprog, bcprog;
+    Status           status;
+    std::string      message;  // the build log, or the error that stopped the build
+    int              errorCode;
+};
+
+/*
+ * Builds the programs of count tests in the given context, concurrently on the
+ * thread pool. Tests that can't run on the device are not built.
+ */
+void build_test_programs(cl_context context, cl_command_queue queue, cl_device_id device,
+                         const OclExtensions& devExt, const char *folder,
+                         const char *test_name[], unsigned int count,
+                         cl_uint size_t_width, BuildTestPrograms *programs);
+
 class TestRunner{
     EventHandler*const m_successHandler, *const m_failureHandler;
     const OclExtensions *m_devExt;
@@ -122,8 +149,11 @@ public:
     TestRunner(EventHandler *success, EventHandler *failure,
                const OclExtensions& devExt);
 
+    // Runs the test with the programs from build_test_programs if given,
+    // otherwise in a context of its own.
     bool runBuildTest(cl_device_id device, const char *folder,
-                      const char *test_name, cl_uint size_t_width);
+                      const char *test_name, cl_uint size_t_width,
+                      BuildTestPrograms *prebuilt = NULL);
 };
 
 //
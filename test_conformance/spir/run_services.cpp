@@ -31,6 +31,7 @@
 #include "exceptions.h"
 #include "datagen.h"
 #include "run_services.h"
+#include "suite_archive.h"
 
 #define XSTR(A) STR(A)
 #define STR(A) #A
@@ -122,10 +123,13 @@ void create_context_and_queue(cl_device_id device, cl_context *out_context, cl_c
 }
 
 /**
- Loads the kernel text from the given text file
+ Loads the kernel text from the given text file, or from the suite archive it was loaded from
  */
 std::string load_file_cl( const std::string& file_name)
 {
+    if (const std::string* archived = find_suite_file(file_name))
+        return *archived;
+
     std::ifstream ifs(file_name.c_str());
     if( !ifs.good() )
         throw Exceptions::TestError("Can't load the cl File " + file_name, 1);
@@ -134,12 +138,20 @@ std::string load_file_cl( const std::string& file_name)
 }
 
 /**
- Loads the kernel IR from the given binary file in SPIR BC format
+ Loads the kernel IR from the given binary file in SPIR BC format, or from the suite archive it was loaded from
  */
 void* load_file_bc( const std::string& file_name, size_t *binary_size)
 {
     assert(binary_size && "binary_size arg should be valid");
 
+    if (const std::string* archived = find_suite_file(file_name))
+    {
+        *binary_size = archived->size();
+        void* buffer = malloc(*binary_size);
+        memcpy(buffer, archived->data(), *binary_size);
+        return buffer;
+    }
+
     std::ifstream file(file_name.c_str(), std::ios::binary);
 
     if( !file.good() )
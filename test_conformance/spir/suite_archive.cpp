@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "../../test_common/harness/compat.h"
+
+#include <string.h>
+#include <fstream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "../../test_common/harness/os_helpers.h"
+#include "../../test_common/harness/ThreadPool.h"
+#include "../../test_common/miniz/miniz.h"
+
+#include "exceptions.h"
+#include "suite_archive.h"
+
+// Files of all the archives loaded so far, by name
+static std::map<std::string, std::string> archived_files;
+static std::set<std::string> loaded_suites;
+
+struct ExtractInfo
+{
+    mz_zip_archive* zip;
+    std::vector<mz_uint> indices;       // archive index of each file
+    std::vector<std::string*> contents; // where to decompress each file, sized to fit
+    std::vector<char> failed;
+};
+
+// A memory backed reader keeps no state while it decompresses, so all the jobs share it.
+static cl_int extract_file(cl_uint job_id, cl_uint thread_id, void *userInfo)
+{
+    ExtractInfo* info = (ExtractInfo*)userInfo;
+    std::string& content = *info->contents[job_id];
+
+    if (!mz_zip_reader_extract_to_mem_no_alloc(info->zip, info->indices[job_id],
+                                               content.empty() ? NULL : &content[0],
+                                               content.size(), 0, NULL, 0))
+        info->failed[job_id] = 1;
+    return 0;
+}
+
+bool load_suite_archive(const char *suiteName)
+{
+    if (!loaded_suites.insert(suiteName).second)
+        return false;
+
+    // Composing the name of the archive.
+    char* dir = get_exe_dir();
+    std::string archiveName(dir);
+    archiveName.append(dir_sep());
+    archiveName.append(suiteName);
+    archiveName.append(".zip");
+    free(dir);
+
+    // Read the whole archive with one sequential read.
+    std::ifstream file(archiveName.c_str(), std::ios::binary);
+    std::vector<char> archive;
+    if (file.good())
+    {
+        file.seekg(0, std::ios::end);
+        archive.resize((size_t)file.tellg());
+        file.seekg(0, std::ios::beg);
+        if (!archive.empty())
+            file.read(&archive[0], archive.size());
+    }
+    if (archive.empty() || !file.good())
+    {
+        loaded_suites.erase(suiteName);
+        throw Exceptions::ArchiveError(MZ_DATA_ERROR);
+    }
+    file.close();
+
+    mz_zip_archive zip_archive;
+    memset(&zip_archive, 0, sizeof(zip_archive));
+    if (!mz_zip_reader_init_mem(&zip_archive, &archive[0], archive.size(), 0))
+    {
+        loaded_suites.erase(suiteName);
+        throw Exceptions::ArchiveError(MZ_DATA_ERROR);
+    }
+
+    // Index the archive and make room for every file, then decompress them all at once.
+    ExtractInfo info;
+    info.zip = &zip_archive;
+    for (mz_uint i = 0; i < mz_zip_reader_get_num_files(&zip_archive); i++)
+    {
+        mz_zip_archive_file_stat fileStat;
+
+        if (!mz_zip_reader_file_stat(&zip_archive, i, &fileStat))
+        {
+            mz_zip_reader_end(&zip_archive);
+            loaded_suites.erase(suiteName);
+            throw Exceptions::ArchiveError(MZ_DATA_ERROR);
+        }
+
+        // Directories only hold the names of their files.
+        if (mz_zip_reader_is_file_a_directory(&zip_archive, i))
+            continue;
+
+        std::string& content = archived_files[fileStat.m_filename];
+        content.assign((size_t)fileStat.m_uncomp_size, '\0');
+        info.indices.push_back(i);
+        info.contents.push_back(&content);
+    }
+    info.failed.assign(info.indices.size(), 0);
+
+    if (!info.indices.empty())
+        ThreadPool_Do(extract_file, (cl_uint)info.indices.size(), &info);
+
+    for (size_t i = 0; i < info.indices.size(); i++)
+    {
+        if (info.failed[i])
+        {
+            std::string msg("Failed to decompress ");
+            // Drop the whole suite, so that its files aren't served half loaded.
+            for (size_t j = 0; j < info.indices.size(); j++)
+            {
+                mz_zip_archive_file_stat fileStat;
+                if (mz_zip_reader_file_stat(&zip_archive, info.indices[j], &fileStat))
+                {
+                    if (i == j)
+                        msg.append(fileStat.m_filename);
+                    archived_files.erase(fileStat.m_filename);
+                }
+            }
+            mz_zip_reader_end(&zip_archive);
+            loaded_suites.erase(suiteName);
+            throw Exceptions::TestError(msg);
+        }
+    }
+    mz_zip_reader_end(&zip_archive);
+    return true;
+}
+
+const std::string* find_suite_file(const std::string& file_name)
+{
+    std::map<std::string, std::string>::const_iterator it = archived_files.find(file_name);
+    return it == archived_files.end() ? NULL : &it->second;
+}
@@ -0,0 +1,36 @@
+//
+// Copyright (c) 2017 The Khronos Group Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef __SUITE_ARCHIVE_H
+#define __SUITE_ARCHIVE_H
+
+#include <string>
+
+/**
+ Reads the archive of the given suite (<exe dir>/<suite>.zip) into memory and
+ decompresses all its files in parallel on the thread pool. The files are kept
+ under the names they have in the archive, "<suite>/<file>", which are the names
+ get_cl_file_path, get_bc_file_path and get_h_file_path build.
+ Each archive is only read once, later calls return false.
+ Must not be called while other threads look up files.
+ */
+bool load_suite_archive(const char *suiteName);
+
+/**
+ Returns the content of the given file if it was loaded from a suite archive, NULL otherwise
+ */
+const std::string* find_suite_file(const std::string& file_name);
+
+#endif